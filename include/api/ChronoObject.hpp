@@ -40,8 +40,10 @@ public:
     static void wait(const chrono::ClockTime & clock_time);
     /*! \details This method delays based on a chrono::MicroTime value. */
     static void wait(const chrono::MicroTime & micro_time);
+#if !defined __link
     /*! \details This method delays based on a chrono::Time value. */
     static void wait(const chrono::Time & time);
+#endif
 };
 
 /*! \brief Chrono Work Object
@@ -69,8 +71,10 @@ public:
     static void wait(const chrono::ClockTime & clock_time){ ChronoInfoObject::wait(clock_time); }
     /*! \details This method delays based on a chrono::MicroTime value. */
     static void wait(const chrono::MicroTime & micro_time){ ChronoInfoObject::wait(micro_time); }
+#if !defined __link
     /*! \details This method delays based on a chrono::Time value. */
     static void wait(const chrono::Time & time){ ChronoInfoObject::wait(time); }
+#endif
 
 };
 
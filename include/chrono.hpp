@@ -9,6 +9,7 @@
  * objects.
  *
  * - MicroTime: 32-bit value for microseconds
+ * - NanoTime: 64-bit value for nanoseconds
  * - ClockTime: 64-bit value for seconds and nanoseconds (clock as in CPU clock)
  * - Time: 32-bit value in seconds (basically a time_t object)
  *
@@ -41,9 +42,11 @@ namespace chrono {}
 
 #include "chrono/ClockTime.hpp"
 #include "chrono/MicroTime.hpp"
+#include "chrono/NanoTime.hpp"
 #include "chrono/Timer.hpp"
 #include "chrono/Time.hpp"
 #include "chrono/Clock.hpp"
+#include "chrono/ProfileZone.hpp"
 
 #include "chrono/MicroTimer.hpp"
 
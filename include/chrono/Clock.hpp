@@ -5,6 +5,11 @@
 
 #include "../api/ChronoObject.hpp"
 #include "ClockTime.hpp"
+#include "NanoTime.hpp"
+
+#if defined __link && defined __x86_64__
+#include <x86intrin.h>
+#endif
 
 namespace chrono {
 
@@ -16,12 +21,35 @@ namespace chrono {
  * a 64-bit value with seconds and nanoseconds based
  * on struct timeval.
  *
+ * Use MONOTONIC for measuring durations. On the desktop, it doesn't
+ * jump when the system time is changed (for example, by NTP). Stratify OS
+ * only has the realtime clock so MONOTONIC is the same as REALTIME there.
+ *
+ * \code
+ * #include <sapi/chrono.hpp>
+ *
+ * u64 start = Clock::get_nanoseconds();
+ * //code to measure
+ * u64 duration = Clock::get_nanoseconds() - start;
+ * \endcode
+ *
+ * On x86-64 desktops, calibrate_fast_clock() enables a fast path for get_fast_nanoseconds()
+ * that reads the CPU time stamp counter rather than calling clock_gettime().
+ *
  */
 class Clock : public api::ChronoInfoObject {
 public:
 
     enum {
-        REALTIME /*! Realtime clock ID used with get_time() and get_resolution() */ = CLOCK_REALTIME
+        REALTIME /*! Realtime clock ID used with get_time() and get_resolution() */ = CLOCK_REALTIME,
+#if defined __link
+        MONOTONIC /*! Monotonic clock ID (not affected by changes to the system time) */ = CLOCK_MONOTONIC,
+#if defined CLOCK_MONOTONIC_RAW
+        MONOTONIC_RAW /*! Monotonic clock ID that is also not slewed by NTP (Linux only) */ = CLOCK_MONOTONIC_RAW,
+#endif
+#else
+        MONOTONIC /*! Same as REALTIME on Stratify OS */ = CLOCK_REALTIME,
+#endif
     };
 
     /*! \details Assigns the value of CLOCK_REALTIME to this object */
@@ -29,6 +57,54 @@ public:
 
     /*! \details Gets the resolution of the specified clock. */
     static ClockTime get_resolution(int clock_id = REALTIME);
+
+    /*! \details Returns the value of a clock in nanoseconds.
+     *
+     * @param clock_id The clock to read (MONOTONIC by default)
+     * @return The number of nanoseconds or zero if the clock could not be read
+     *
+     */
+    static u64 get_nanoseconds(int clock_id = MONOTONIC);
+
+    /*! \details Enables the fast path for get_fast_nanoseconds().
+     *
+     * @param duration How long to measure the time stamp counter against MONOTONIC
+     * @return Zero if the fast path is enabled or -1 if it isn't available (not
+     * an x86-64 desktop or the CPU doesn't have an invariant time stamp counter)
+     *
+     * This should be called once (before starting any threads that use get_fast_nanoseconds()).
+     * A longer \a duration makes the conversion more accurate: 10ms is good to a few
+     * parts per million. The fast clock doesn't follow NTP adjustments, so the
+     * calibration can be repeated (while no other threads are reading the fast clock) to keep it close to MONOTONIC in long running programs.
+     *
+     */
+    static int calibrate_fast_clock(const MicroTime & duration = MicroTime(10000));
+
+    /*! \details Returns true if calibrate_fast_clock() has enabled the fast path. */
+    static bool is_fast_clock_calibrated(){ return m_fast_multiplier != 0; }
+
+    /*! \details Returns the time in nanoseconds from the fastest available clock.
+     *
+     * If calibrate_fast_clock() has enabled the fast path, the time is read
+     * from the CPU time stamp counter (a few nanoseconds). Otherwise, this is the same
+     * as get_nanoseconds(MONOTONIC). The values are on the same time base as MONOTONIC
+     * so they can be mixed with get_nanoseconds() for short intervals.
+     *
+     */
+    static u64 get_fast_nanoseconds(){
+#if defined __link && defined __x86_64__
+        if( m_fast_multiplier ){
+            u64 ticks = __rdtsc() - m_fast_base_ticks;
+            return m_fast_base_nanoseconds + (u64)(((unsigned __int128)ticks * m_fast_multiplier) >> 32);
+        }
+#endif
+        return get_nanoseconds(MONOTONIC);
+    }
+
+private:
+    static u64 m_fast_multiplier; //nanoseconds per tick (32.32 fixed point)
+    static u64 m_fast_base_ticks;
+    static u64 m_fast_base_nanoseconds;
 };
 
 }
@@ -0,0 +1,124 @@
+/*! \file */ //Copyright 2011-2018 Tyler Gilbert; All Rights Reserved
+
+#ifndef CHRONO_NANO_TIME_HPP_
+#define CHRONO_NANO_TIME_HPP_
+
+#include <mcu/types.h>
+#include <time.h>
+
+#include "../api/ChronoObject.hpp"
+#include "ClockTime.hpp"
+#include "MicroTime.hpp"
+
+namespace chrono {
+
+/*! \details Defines the type for a chrono::NanoTime value. */
+typedef u64 nano_time_t;
+
+/*! \brief NanoTime Class
+ * \details The NanoTime class is the 64-bit nanosecond counterpart
+ * of MicroTime. It is good for about 584 years so it doesn't
+ * wrap like MicroTime (which wraps after about 71 minutes).
+ *
+ * It is handy for measuring durations that are shorter than
+ * a microsecond or longer than an hour.
+ *
+ * \code
+ * Timer t;
+ * t.start();
+ * //code to measure
+ * NanoTime duration = t.nanoseconds();
+ * printf("%lld ns\n", duration.nanoseconds());
+ * \endcode
+ *
+ */
+class NanoTime : public api::ChronoInfoObject {
+public:
+
+    /*! \details Constructs a NanoTime object using a u64 value.
+     *
+     * The default initial value is zero.
+     *
+     */
+    NanoTime(nano_time_t nanoseconds = 0){ m_value_nanoseconds = nanoseconds; }
+
+    /*! \details Constructs a NanoTime object from a ClockTime (negative values are treated as zero). */
+    NanoTime(const ClockTime & clock_time){
+        if( clock_time.seconds() < 0 ){
+            m_value_nanoseconds = 0;
+        } else {
+            m_value_nanoseconds = (u64)clock_time.seconds() * 1000000000ULL + clock_time.nanoseconds();
+        }
+    }
+
+    /*! \details Constructs a NanoTime object from a MicroTime. */
+    NanoTime(const MicroTime & micro_time){
+        m_value_nanoseconds = (u64)micro_time.microseconds() * 1000ULL;
+    }
+
+    /*! \details Create a NanoTime object from a second value. */
+    static NanoTime from_seconds(u32 sec){ return NanoTime(sec*1000000000ULL); }
+
+    /*! \details Create a NanoTime object from a millisecond value. */
+    static NanoTime from_milliseconds(u32 msec){ return NanoTime(msec*1000000ULL); }
+
+    /*! \details Create a NanoTime object from a microsecond value. */
+    static NanoTime from_microseconds(u32 usec){ return NanoTime(usec*1000ULL); }
+
+    /*! \details Create a NanoTime object from a nanosecond value. */
+    static NanoTime from_nanoseconds(nano_time_t nanoseconds){ return NanoTime(nanoseconds); }
+
+    /*! \details Returns the nanoseconds() value when
+     * the compiler wants to convert to an unsigned 64-bit value.
+     *
+     */
+    operator nano_time_t () const { return nanoseconds(); }
+
+    /*! \details Returns true if the time is set to a valid value. */
+    bool is_valid() const {
+        return m_value_nanoseconds != (u64)-1;
+    }
+
+    /*! \details Returns a NanoTime object set to the invalid time. */
+    static NanoTime invalid(){ return NanoTime((u64)-1); }
+
+    NanoTime & operator += (const NanoTime & nano_time){
+        m_value_nanoseconds += nano_time.nanoseconds();
+        return *this;
+    }
+
+    NanoTime & operator -= (const NanoTime & nano_time){
+        m_value_nanoseconds -= nano_time.nanoseconds();
+        return *this;
+    }
+
+    /*! \details Sets the value of the time in nanoseconds. */
+    void set_nanoseconds(nano_time_t nanoseconds){ m_value_nanoseconds = nanoseconds; }
+
+    /*! \details Returns the value in seconds. */
+    u32 seconds() const { return m_value_nanoseconds / 1000000000ULL; }
+
+    /*! \details Returns the value in milliseconds. */
+    u64 milliseconds() const { return m_value_nanoseconds / 1000000ULL; }
+
+    /*! \details Returns the value in microseconds. */
+    u64 microseconds() const { return m_value_nanoseconds / 1000ULL; }
+
+    /*! \details Returns the value in nanoseconds. */
+    nano_time_t nanoseconds() const { return m_value_nanoseconds; }
+
+    /*! \details Returns the value as a ClockTime object. */
+    ClockTime clock_time() const {
+        return ClockTime(m_value_nanoseconds / 1000000000ULL, m_value_nanoseconds % 1000000000ULL);
+    }
+
+    /*! \details Returns the value as a MicroTime object (rounded to the nearest microsecond). */
+    MicroTime micro_time() const { return MicroTime((m_value_nanoseconds + 500) / 1000); }
+
+private:
+    nano_time_t m_value_nanoseconds;
+};
+
+}
+
+#endif /* CHRONO_NANO_TIME_HPP_ */
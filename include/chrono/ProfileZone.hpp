@@ -0,0 +1,198 @@
+/*! \file */ //Copyright 2011-2018 Tyler Gilbert; All Rights Reserved
+
+#ifndef CHRONO_PROFILEZONE_HPP_
+#define CHRONO_PROFILEZONE_HPP_
+
+#include <mcu/types.h>
+#include "../api/ChronoObject.hpp"
+#include "Clock.hpp"
+
+namespace sys {
+class Printer;
+}
+
+namespace fmt {
+class JsonWriter;
+}
+
+namespace chrono {
+
+/*! \brief Profile Zone Class
+ * \details A ProfileZone collects timing statistics for a section
+ * of code: the number of times it ran, the total, minimum and maximum
+ * duration and a histogram of the durations.
+ *
+ * The histogram has a bucket for each power of 2 nanoseconds. Bucket
+ * \a n counts durations from 2^(n-1) up to (but not including) 2^n nanoseconds (bucket 0 counts
+ * durations of zero). Everything is stored in the zone so measuring doesn't allocate memory.
+ *
+ * The easiest way to use zones is with the SAPI_PROFILE_ZONE() macro. It
+ * declares a static zone and measures the rest of the enclosing scope.
+ *
+ * \code
+ * #include <sapi/chrono.hpp>
+ * #include <sapi/sys.hpp>
+ *
+ * void filter(){
+ *   SAPI_PROFILE_ZONE("filter");
+ *   //code to measure
+ * }
+ *
+ * for(u32 i=0; i < 1000; i++){
+ *   filter();
+ * }
+ *
+ * Printer p;
+ * ProfileZone::print_all(p); //count, total, min, max and p50/p90/p99 for each zone
+ * \endcode
+ *
+ * Zones can also be declared explicitly and measured with ProfileScope
+ * (or record()).
+ *
+ * \code
+ * static ProfileZone decode_zone("decode");
+ *
+ * void decode(){
+ *   ProfileScope scope(decode_zone);
+ *   //code to measure
+ * }
+ * \endcode
+ *
+ * Zones can be updated from several threads at the same time. The
+ * statistics are updated with atomic operations, so a dump taken while
+ * code is being measured may be off by the samples in progress.
+ *
+ * Zones register themselves when they are constructed and must not be destroyed
+ * (declare them static or at file scope). Defining SAPI_PROFILE_DISABLE when compiling
+ * removes SAPI_PROFILE_ZONE() entirely.
+ *
+ */
+class ProfileZone : public api::ChronoInfoObject {
+public:
+
+    enum {
+        BUCKET_COUNT = 32 /*! The number of histogram buckets (the last one holds everything from about 1 second) */
+    };
+
+    /*! \details Constructs and registers a new zone.
+     *
+     * @param name The name of the zone (it must stay in scope, for example, a string literal)
+     *
+     */
+    ProfileZone(const char * name);
+
+    /*! \details Returns the name of the zone. */
+    const char * name() const { return m_name; }
+
+    /*! \details Adds a duration to the statistics.
+     *
+     * @param nanoseconds The duration (longer durations are saturated to about 4.3 seconds)
+     *
+     */
+    void record(u32 nanoseconds);
+
+    /*! \details Returns the number of durations recorded. */
+    u32 count() const { return __atomic_load_n(&m_count, __ATOMIC_RELAXED); }
+
+    /*! \details Returns the total of the durations in nanoseconds. */
+    u64 total() const;
+
+    /*! \details Returns the shortest duration in nanoseconds (zero if count() is zero). */
+    u32 min() const { return count() ? __atomic_load_n(&m_min, __ATOMIC_RELAXED) : 0; }
+
+    /*! \details Returns the longest duration in nanoseconds. */
+    u32 max() const { return __atomic_load_n(&m_max, __ATOMIC_RELAXED); }
+
+    /*! \details Returns the average duration in nanoseconds. */
+    u32 mean() const { return count() ? total() / count() : 0; }
+
+    /*! \details Returns the number of durations in histogram bucket \a idx. */
+    u32 bucket(u32 idx) const { return __atomic_load_n(m_buckets + idx, __ATOMIC_RELAXED); }
+
+    /*! \details Returns an estimate of a percentile in nanoseconds.
+     *
+     * @param percent The percentile (for example, 99)
+     * @return The upper limit of the histogram bucket that holds the percentile (but not more than max())
+     *
+     */
+    u32 percentile(u32 percent) const;
+
+    /*! \details Clears the statistics. */
+    void reset();
+
+    /*! \details Returns the next zone in the list of all zones. */
+    ProfileZone * next() const { return m_next; }
+
+    /*! \details Returns the first zone in the list of all zones (null if there are none). */
+    static ProfileZone * first(){ return __atomic_load_n(&m_first, __ATOMIC_ACQUIRE); }
+
+    /*! \details Clears the statistics of all zones. */
+    static void reset_all();
+
+    /*! \details Prints the statistics of all the zones that have been used. */
+    static void print_all(sys::Printer & printer);
+
+    /*! \details Writes the statistics of all zones as a JSON object (one key per zone).
+     *
+     * @return Zero on success or -1 if the JSON could not be written
+     *
+     */
+    static int save_all(fmt::JsonWriter & json);
+
+    /*! \details Returns the current time in nanoseconds (used to measure durations).
+     *
+     * This is Clock::get_fast_nanoseconds() so calling Clock::calibrate_fast_clock()
+     * at startup reduces the cost of measuring on x86-64 desktops.
+     *
+     */
+    static u64 timestamp(){ return Clock::get_fast_nanoseconds(); }
+
+private:
+    const char * m_name;
+    ProfileZone * m_next;
+    u32 m_count;
+    u32 m_total_low;
+    u32 m_total_high;
+    u32 m_min;
+    u32 m_max;
+    u32 m_buckets[BUCKET_COUNT];
+
+    static ProfileZone * m_first;
+};
+
+/*! \brief Profile Scope Class
+ * \details A ProfileScope measures the time from when it is
+ * constructed until it goes out of scope and records it in a ProfileZone.
+ *
+ */
+class ProfileScope {
+public:
+    /*! \details Starts measuring for \a zone. */
+    ProfileScope(ProfileZone & zone) : m_zone(zone){ m_start = ProfileZone::timestamp(); }
+
+    /*! \details Records the time since the scope was constructed. */
+    ~ProfileScope(){
+        u64 duration = ProfileZone::timestamp() - m_start;
+        m_zone.record(duration > 0xffffffff ? 0xffffffff : (u32)duration);
+    }
+
+private:
+    ProfileZone & m_zone;
+    u64 m_start;
+};
+
+}
+
+#define SAPI_PROFILE_CONCAT_(a, b) a##b
+#define SAPI_PROFILE_CONCAT(a, b) SAPI_PROFILE_CONCAT_(a, b)
+
+#if defined SAPI_PROFILE_DISABLE
+#define SAPI_PROFILE_ZONE(name) do {} while(0)
+#else
+/*! \details Measures the rest of the enclosing scope in a static zone called \a name. */
+#define SAPI_PROFILE_ZONE(name) \
+    static chrono::ProfileZone SAPI_PROFILE_CONCAT(sapi_profile_zone_, __LINE__)(name); \
+    chrono::ProfileScope SAPI_PROFILE_CONCAT(sapi_profile_scope_, __LINE__)(SAPI_PROFILE_CONCAT(sapi_profile_zone_, __LINE__))
+#endif
+
+#endif /* CHRONO_PROFILEZONE_HPP_ */
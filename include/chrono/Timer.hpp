@@ -3,12 +3,14 @@
 
 #include "ClockTime.hpp"
 #include "MicroTime.hpp"
+#include "NanoTime.hpp"
 
 namespace chrono {
 
 /*! \brief Timer Class
  * \details This class implements a logical timer based on the Stratify OS
- * system timer.
+ * system timer. On the desktop, it uses the monotonic clock (see Clock::MONOTONIC)
+ * so it isn't affected when the system time is changed.
  *
  * Physical timers are controlled using the hal::Tmr class.
  *
@@ -56,7 +58,6 @@ public:
     static void wait_sec(u32 timeout){ wait_seconds(timeout); }
     static void wait_msec(u32 timeout){ wait_milliseconds(timeout); }
     static void wait_usec(u32 timeout){ wait_microseconds(timeout); }
-#if !defined __link
 
     /*! \details Constructs an empty Timer. */
     Timer();
@@ -159,11 +160,18 @@ public:
      *
      * @return The number of seconds that have elapsed since start.
      */
-    u32 seconds() const { return calc_value().seconds(); }
+    u32 seconds() const { return clock_time().seconds(); }
 
     /*! \details Returns the value of the timer as a ClockTime object. */
     ClockTime clock_time() const;
 
+    /*! \details Returns the value of the timer in nanoseconds.
+     *
+     * Unlike microseconds(), the value doesn't wrap after about 71 minutes.
+     *
+     */
+    NanoTime nanoseconds() const { return NanoTime(clock_time()); }
+
     //deprecated
     u32 calc_sec() const { return seconds(); }
     u32 sec() const { return seconds(); }
@@ -176,16 +184,11 @@ public:
      */
     void stop();
 
-#endif
-
 private:
     MicroTime calc_value() const;
 
-
-#if !defined __link
     ClockTime m_start;
     ClockTime m_stop;
-#endif
 };
 
 }
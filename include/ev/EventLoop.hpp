@@ -7,6 +7,8 @@
 
 #include "../api/WorkObject.hpp"
 #include "../chrono/Timer.hpp"
+#include "../sys/Channel.hpp"
+#include "../sys/Executor.hpp"
 #include "EventHandler.hpp"
 #include "Event.hpp"
 
@@ -19,6 +21,11 @@ typedef struct MCU_PACK {
     u16 period_msec;
 } event_loop_attr_t;
 
+typedef struct {
+    sys::Executor::function_t function;
+    void * args;
+} event_loop_post_t;
+
 
 /*! \brief Event Loop Attributes
  * \details This class defines attributes that apply to an ui::EventLoop.
@@ -141,11 +148,19 @@ protected:
  * }
  * \endcode
  *
+ * The event loop is also a sys::Executor. Other threads can use post() to
+ * run a function on the thread that executes the loop (for example, to
+ * handle the result of a sys::Future without locking the data used by
+ * the event handlers). Posted functions are executed after process_events().
  *
  */
-class EventLoop: public EventLoopAttr, public api::EvWorkObject {
+class EventLoop: public EventLoopAttr, public api::EvWorkObject, public sys::Executor {
 public:
 
+    enum {
+        POST_COUNT = 8 /*! The number of posted functions that can be waiting */
+    };
+
     /*! \details Constructs a new headless (no display) event loop.
      *
      * @param start_event_handler The initial element to process
@@ -240,6 +255,24 @@ public:
      */
     virtual EventHandler * catch_null_handler(EventHandler * last_event_handler){ return 0; }
 
+    /*! \details Queues \a function to be executed by the loop (see sys::Executor).
+     *
+     * @param function The function to execute
+     * @param args The argument passed to \a function
+     * @return Zero on success or -1 if POST_COUNT functions are already waiting
+     *
+     * This method can be called from any thread.
+     *
+     */
+    int post(function_t function, void * args);
+
+    /*! \details Executes the functions queued with post().
+     *
+     * This is called by loop() after process_events().
+     *
+     */
+    void process_posted();
+
     //maybe these should be private and accessed through Friends?
     static EventHandler * handle_event(EventHandler * current_event_handler, const Event & event, EventLoop * event_loop = 0);
     static void handle_transition(EventHandler * current_event_handler, EventHandler * next_event_handler);
@@ -285,6 +318,7 @@ private:
     EventHandler * m_current_event_handler;
     chrono::Timer m_update_timer;
     chrono::Timer m_loop_timer;
+    sys::Channel<event_loop_post_t> m_posted;
 
 };
 
@@ -9,8 +9,18 @@
 namespace fmt {}
 
 #include "fmt/Bmp.hpp"
+#include "fmt/CborReader.hpp"
+#include "fmt/CborWriter.hpp"
+#include "fmt/ChromeTrace.hpp"
+#include "fmt/JsonDocument.hpp"
+#include "fmt/JsonReader.hpp"
+#include "fmt/JsonWriter.hpp"
 #include "fmt/Wav.hpp"
+#include "fmt/WavReader.hpp"
+#include "fmt/WavWriter.hpp"
 #include "fmt/Son.hpp"
+#include "fmt/XmlIndex.hpp"
+#include "fmt/XmlReader.hpp"
 
 #if !defined __link
 #include "fmt/Xml.hpp"
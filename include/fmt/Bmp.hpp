@@ -8,12 +8,44 @@
 #include "../sys/File.hpp"
 #include "../api/FmtObject.hpp"
 
+#if !defined __link
+#include "../sgfx/Bitmap.hpp"
+#endif
+
 namespace fmt {
 
-/*! \brief BMP File format */
+/*! \brief BMP File format
+ * \details The Bmp class reads and writes BMP files.
+ *
+ * read_pixel() reads one pixel at a time. To decode a whole image,
+ * use read_levels() (or load() to decode straight into an sgfx::Bitmap).
+ * These read as many rows as fit in buffer_size() bytes with each
+ * read() and convert 24 and 32 bits per pixel images to 1, 2, 4 or 8 bits per
+ * pixel gray levels using a threshold or an ordered (4x4 Bayer) dither.
+ *
+ * \code
+ * #include <sapi/fmt.hpp>
+ * #include <sapi/sgfx.hpp>
+ *
+ * Bmp bmp("/home/splash.bmp");
+ * Bitmap bitmap;
+ * bmp.load(bitmap, Bmp::FLAG_DITHER); //bitmap is allocated to fit the image
+ * \endcode
+ *
+ */
 class Bmp: public api::FmtFileObject {
 public:
 
+	enum {
+		DEFAULT_BUFFER_SIZE = 2048 /*! The default number of bytes read at a time by read_levels() and load() */
+	};
+
+	/*! \details Flags for converting pixels to gray levels. */
+	enum {
+		FLAG_THRESHOLD = 0 /*! Pixels are rounded to the nearest level (1 bpp uses the threshold) */,
+		FLAG_DITHER = (1<<0) /*! Pixels are dithered with a 4x4 ordered dither */
+	};
+
 	/*! \details Constructs a new bitmap object and opens the bitmap as a read-only file. */
 	Bmp(const char * name);
 
@@ -29,9 +61,22 @@ public:
 	/*! \details Returns the bitmap planes (after bitmap has been opened). */
 	u16 planes() const { return m_dib.planes; }
 
-	/*! \details Calculates the bytes needed to store one row of data (after bitmap has been opened). */
+	/*! \details Calculates the bytes needed to store one row of data (after bitmap has been opened).
+	 *
+	 * Rows are padded to a multiple of 4 bytes.
+	 */
 	unsigned int calc_row_size() const;
 
+	/*! \details Sets the number of bytes that read_levels() and load() read at a time.
+	 *
+	 * At least one row is always read. Larger buffers use fewer reads (or Link
+	 * transfers on the host).
+	 */
+	void set_buffer_size(u32 size){ m_buffer_size = size; }
+
+	/*! \details Returns the number of bytes read_levels() and load() read at a time. */
+	u32 buffer_size() const { return m_buffer_size; }
+
 	/*! \details Opens the specified bitmap as readonly. */
 	int open_readonly(const char * name);
 
@@ -62,6 +107,60 @@ public:
 	 */
 	int read_pixel(u8 * pixel, u32 pixel_size, bool mono = false, u8 thres = 128);
 
+	/*! \details Callback used by read_levels() for each row of gray levels.
+	 *
+	 * @param context The context passed to read_levels()
+	 * @param y The row (zero is the top of the image)
+	 * @param levels One gray level per pixel (width() values)
+	 * @return Zero to continue or less than zero to stop
+	 */
+	typedef int (*row_callback_t)(void * context, s32 y, const u8 * levels);
+
+	/*! \details Reads the whole image and converts it to gray levels.
+	 *
+	 * @param callback Called once for each row (in file order, usually bottom to top)
+	 * @param context Passed to \a callback
+	 * @param bits_per_pixel The number of bits in each level (1, 2, 4 or 8)
+	 * @param o_flags FLAG_THRESHOLD or FLAG_DITHER
+	 * @param threshold The brightness for a pixel to be on at 1 bpp (without FLAG_DITHER)
+	 * @return Zero on success or -1 if the file can't be read or the image isn't 24 or 32 bpp (errno is EINVAL)
+	 *
+	 */
+	int read_levels(row_callback_t callback, void * context, u8 bits_per_pixel, u32 o_flags = FLAG_THRESHOLD, u8 threshold = 128);
+
+	/*! \details Converts a row of 24 or 32 bpp BMP pixels (blue, green, red) to gray levels.
+	 *
+	 * @param levels The destination for \a width levels
+	 * @param row The BMP pixels
+	 * @param width The number of pixels
+	 * @param row_bits_per_pixel 24 or 32
+	 * @param bits_per_pixel The number of bits in each level (1, 2, 4 or 8)
+	 * @param y The row (used by FLAG_DITHER)
+	 * @param o_flags FLAG_THRESHOLD or FLAG_DITHER
+	 * @param threshold The brightness for a pixel to be on at 1 bpp (without FLAG_DITHER)
+	 */
+	static void convert_row(u8 * levels, const u8 * row, u32 width, u16 row_bits_per_pixel, u8 bits_per_pixel, s32 y, u32 o_flags, u8 threshold = 128);
+
+#if !defined __link
+	/*! \details Decodes the image into \a bitmap.
+	 *
+	 * @param bitmap The destination (it is resized or allocated to fit the image)
+	 * @param o_flags FLAG_THRESHOLD or FLAG_DITHER
+	 * @param threshold The brightness for a pixel to be on at 1 bpp (without FLAG_DITHER)
+	 * @return Zero on success or -1 on failure
+	 *
+	 * The image is converted to sgfx::Bitmap::bits_per_pixel() gray levels.
+	 *
+	 */
+	int load(sgfx::Bitmap & bitmap, u32 o_flags = FLAG_THRESHOLD, u8 threshold = 128);
+
+	/*! \details Creates a 24 bpp gray scale BMP file from \a bitmap.
+	 *
+	 * The file is written one row at a time.
+	 */
+	int save(const char * name, const sgfx::Bitmap & bitmap);
+#endif
+
 	typedef struct MCU_PACK {
 		u16 signature;
 		u32 size;
@@ -86,6 +185,7 @@ private:
 
 	bmp_dib_t m_dib;
 	u32 m_offset;
+	u32 m_buffer_size;
 };
 
 };
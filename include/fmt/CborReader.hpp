@@ -0,0 +1,223 @@
+/*! \file */ //Copyright 2011-2018 Tyler Gilbert; All Rights Reserved
+
+#ifndef FMT_CBORREADER_HPP_
+#define FMT_CBORREADER_HPP_
+
+#include "../api/FmtObject.hpp"
+#include "../var/ConstString.hpp"
+#include "../var/Data.hpp"
+
+struct json_t;
+
+namespace fmt {
+
+class Json;
+
+/*! \brief CBOR Reader Class
+ * \details The CborReader class parses CBOR (RFC 8949, see CborWriter)
+ * one event at a time in the same way JsonReader parses JSON text.
+ *
+ * The reader walks a buffer that holds the whole message (for example, a
+ * message received with sys::Messenger or a socket). It doesn't
+ * allocate or copy anything: strings and byte strings point into the buffer.
+ * Strings are not zero terminated so use value_length() (or
+ * is_value()) with value().
+ *
+ * \code
+ * #include <sapi/fmt.hpp>
+ *
+ * CborReader cbor(message);
+ * int event;
+ * while( (event = cbor.next()) > CborReader::END ){
+ *   if( (event == CborReader::KEY) && cbor.is_value("count") ){
+ *     cbor.next();
+ *     printf("count is %ld\n", cbor.to_integer());
+ *   }
+ * }
+ * if( event == CborReader::ERROR ){
+ *   printf("bad message at %ld\n", cbor.position());
+ * }
+ * \endcode
+ *
+ * Objects and arrays with a known length and an indefinite length are
+ * handled the same way: next() returns END_OBJECT or END_ARRAY after the
+ * last value. Keys that are text strings are returned as KEY events. Other
+ * keys (CBOR allows any value as a key) are returned as normal events and is_key() is true.
+ *
+ * A string with an indefinite length is returned as an event with a
+ * value_length() of zero followed by an event for each chunk of the
+ * string (is_chunk() is true for the chunks).
+ *
+ * Tags are not events: tag() returns the tag of the current value.
+ *
+ */
+class CborReader : public api::FmtWorkObject {
+public:
+
+    enum {
+        MAX_DEPTH = 31 /*! The maximum number of nested objects and arrays */
+    };
+
+    /*! \details Events returned by next(). */
+    enum event {
+        ERROR = -1 /*! The input is not valid CBOR */,
+        END /*! There is no more input */,
+        OBJECT /*! An object (map) starts */,
+        END_OBJECT /*! An object ends */,
+        ARRAY /*! An array starts */,
+        END_ARRAY /*! An array ends */,
+        KEY /*! A text key in an object (value() is the key) */,
+        STRING /*! A text string (value() points to the UTF-8 text) */,
+        BYTES /*! A byte string (value() points to the bytes) */,
+        INTEGER /*! An integer */,
+        FLOAT /*! A floating point number (16, 32 or 64 bits) */,
+        TRUE /*! The value true */,
+        FALSE /*! The value false */,
+        ZERO /*! The value null */,
+        UNDEFINED /*! The value undefined */,
+        SIMPLE /*! Another simple value (to_integer() is the value) */
+    };
+
+    /*! \details Constructs a reader for the CBOR in \a data (the data is not copied). */
+    CborReader(const var::Data & data);
+
+    /*! \details Constructs a reader for \a size bytes of CBOR at \a buffer. */
+    CborReader(const void * buffer, u32 size);
+
+    /*! \details Parses the next event.
+     *
+     * @return The event (see enum event); END when there is no more input and ERROR if the input is not valid
+     *
+     * After ERROR, next() keeps returning ERROR and error_number()
+     * is EINVAL.
+     *
+     * Several values can appear at the top level (a CBOR sequence).
+     *
+     */
+    int next();
+
+    /*! \details Skips the rest of the current object or array.
+     *
+     * @return Zero on success or -1 if the input is not valid
+     *
+     * Call this after next() returns OBJECT or ARRAY. The next
+     * call to next() returns the event after the matching END_OBJECT or END_ARRAY.
+     *
+     */
+    int skip();
+
+    /*! \details Reads the next value (and everything in it) into \a json.
+     *
+     * @return Zero on success or -1 at the end of the input or if the value can't be converted
+     *
+     * Byte strings are converted to base64 strings, undefined and
+     * other simple values to null, and keys must be strings.
+     *
+     */
+    int read_json(Json & json);
+
+    /*! \details Returns the last event returned by next(). */
+    int event() const { return m_event; }
+
+    /*! \details Returns a pointer to the key, string or bytes of the current event.
+     *
+     * The pointer is into the input buffer and the string is not zero terminated.
+     *
+     */
+    const char * value() const { return (const char*)m_value; }
+
+    /*! \details Returns the number of bytes in value(). */
+    u32 value_length() const { return m_value_length; }
+
+    /*! \details Returns true if the current key or string is \a value. */
+    bool is_value(const var::ConstString & value) const;
+
+    /*! \details Returns the current integer (or the current float converted to an integer). */
+    s32 to_integer() const { return (s32)to_s64(); }
+
+    /*! \details Returns the current integer as a 64-bit value. */
+    s64 to_s64() const;
+
+    /*! \details Returns the current number as a float. */
+    float to_float() const { return (float)to_double(); }
+
+    /*! \details Returns the current number as a double. */
+    double to_double() const;
+
+    /*! \details Returns true if the current event is TRUE. */
+    bool to_bool() const { return m_event == TRUE; }
+
+    /*! \details Returns true if the current integer is negative. */
+    bool is_negative() const { return m_is_negative; }
+
+    /*! \details Returns true if the current value is a key in an object. */
+    bool is_key() const { return m_is_key; }
+
+    /*! \details Returns true if the current event is a chunk of an indefinite length string. */
+    bool is_chunk() const { return m_is_chunk; }
+
+    /*! \details Returns true if the current value has a tag. */
+    bool is_tagged() const { return m_is_tagged; }
+
+    /*! \details Returns the tag of the current value (if is_tagged() is true). */
+    u64 tag() const { return m_tag; }
+
+    /*! \details Returns the number of values in the current array or key/value pairs in the current object.
+     *
+     * This is valid after next() returns OBJECT or ARRAY. It is -1 if
+     * the length is indefinite.
+     *
+     */
+    s32 count() const { return m_count; }
+
+    /*! \details Returns the number of objects and arrays that contain the current event. */
+    u32 depth() const { return m_depth; }
+
+    /*! \details Returns the offset of the current event in the input. */
+    u32 position() const { return m_position; }
+
+private:
+    const u8 * m_input;
+    u32 m_input_size;
+    u32 m_input_position;
+
+    const u8 * m_value;
+    u32 m_value_length;
+    u64 m_argument;
+    u64 m_tag;
+    double m_real;
+    s32 m_count;
+
+    u32 m_is_object; //bit n is set if level n is an object
+    u32 m_is_definite; //bit n is set if level n has a known length
+    u32 m_index[MAX_DEPTH+1]; //number of items read at each level
+    u32 m_end[MAX_DEPTH+1]; //number of items at definite levels
+
+    u32 m_position;
+    u8 m_depth;
+    u8 m_chunk_major; //non-zero while reading the chunks of a string
+    s8 m_event;
+    bool m_is_negative;
+    bool m_is_key;
+    bool m_is_chunk;
+    bool m_is_chunk_key;
+    bool m_is_tagged;
+
+    void init(const void * buffer, u32 size);
+    int fail();
+    bool is_in_object() const { return (m_is_object & ((u32)1 << m_depth)) != 0; }
+    bool is_definite() const { return (m_is_definite & ((u32)1 << m_depth)) != 0; }
+    bool is_key_position() const { return is_in_object() && ((m_index[m_depth] & 1) == 0); }
+    int read_argument(u8 info, u64 & argument);
+    int next_chunk();
+    int value_event(int event);
+    int open_container(int event, u8 info, u64 count);
+    int close_container();
+    json_t * read_json_value(int event, var::Data & chunks);
+    int read_chunks(var::Data & chunks);
+
+};
+
+}
+
+#endif /* FMT_CBORREADER_HPP_ */
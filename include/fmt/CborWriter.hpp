@@ -0,0 +1,260 @@
+/*! \file */ //Copyright 2011-2018 Tyler Gilbert; All Rights Reserved
+
+#ifndef FMT_CBORWRITER_HPP_
+#define FMT_CBORWRITER_HPP_
+
+#include "../api/FmtObject.hpp"
+#include "../var/ConstString.hpp"
+#include "../var/Data.hpp"
+
+namespace sys {
+class File;
+}
+
+namespace fmt {
+
+class JsonValue;
+
+/*! \brief CBOR Writer Class
+ * \details The CborWriter class writes CBOR (Concise Binary Object
+ * Representation, RFC 8949) directly to a sys::File (including sockets
+ * and devices) or a var::Data object.
+ *
+ * CBOR has the same data model as JSON (objects, arrays, strings,
+ * numbers, true, false and null) plus byte strings and tags, but it is
+ * binary: numbers are written in as few bytes as possible and strings are
+ * not escaped. A document is usually a fraction of the size of the same JSON text and
+ * it is much faster to write and read (see CborReader).
+ *
+ * The methods are the same as JsonWriter. Output goes through a small
+ * buffer inside the object that is written to the destination each time it
+ * fills up.
+ *
+ * \code
+ * #include <sapi/fmt.hpp>
+ * #include <sapi/var.hpp>
+ *
+ * Data message;
+ * CborWriter cbor(message);
+ * cbor.open_object();
+ * cbor.write_string("name", "sensor A");
+ * cbor.write_number("count", 3);
+ * cbor.open_array("samples", 3); //the number of items is known
+ * for(u32 i=0; i < 3; i++){
+ *   cbor.write_float(i*0.5f);
+ * }
+ * cbor.close(); //closes "samples" and the root object then flushes
+ * //message.size() is 41 bytes (the same JSON text is 53 bytes)
+ * \endcode
+ *
+ * Objects and arrays are written with an indefinite length (a
+ * terminating byte is written when they are closed) unless the number of
+ * items is passed when they are opened. Writing more or fewer values than
+ * the given count is an error (close_object() and close_array() are still called
+ * to keep track of the nesting).
+ *
+ * Floating point numbers are written in the smallest format (16, 32 or
+ * 64 bits) that represents the value exactly.
+ *
+ * Values written outside of any object or array are written one after
+ * another (a CBOR sequence).
+ *
+ */
+class CborWriter : public api::FmtWorkObject {
+public:
+
+    enum {
+        BUFFER_SIZE = 128 /*! The number of bytes buffered before writing to the destination */,
+        MAX_DEPTH = 31 /*! The maximum number of nested objects and arrays */
+    };
+
+    /*! \details CBOR major types (the top 3 bits of the first byte of each item). */
+    enum major {
+        MAJOR_UNSIGNED = 0 /*! Unsigned integer */,
+        MAJOR_NEGATIVE = 1 /*! Negative integer (-1 - argument) */,
+        MAJOR_BYTES = 2 /*! Byte string */,
+        MAJOR_STRING = 3 /*! UTF-8 string */,
+        MAJOR_ARRAY = 4 /*! Array */,
+        MAJOR_OBJECT = 5 /*! Map (object) */,
+        MAJOR_TAG = 6 /*! Tag */,
+        MAJOR_SIMPLE = 7 /*! Float, true, false, null and break */
+    };
+
+    /*! \details Constructs a writer that writes to \a file. */
+    CborWriter(const sys::File & file);
+
+    /*! \details Constructs a writer that writes to \a data (starting at the beginning). */
+    CborWriter(var::Data & data);
+
+    /*! \details Flushes any buffered output (see flush()). */
+    ~CborWriter();
+
+    /*! \details Starts a new object (with an indefinite length). */
+    int open_object();
+    /*! \details Starts a new object with \a count key/value pairs. */
+    int open_object(u32 count);
+    /*! \details Starts a new object as the value of \a key. */
+    int open_object(const var::ConstString & key){ return write_key(key) < 0 ? -1 : open_object(); }
+    /*! \details Starts a new object with \a count key/value pairs as the value of \a key. */
+    int open_object(const var::ConstString & key, u32 count){ return write_key(key) < 0 ? -1 : open_object(count); }
+    /*! \details Ends the current object.
+     *
+     * @return Zero on success or -1 if the current container is not an
+     * object or it has the wrong number of values (errno is EINVAL)
+     */
+    int close_object();
+
+    /*! \details Starts a new array (with an indefinite length). */
+    int open_array();
+    /*! \details Starts a new array with \a count values. */
+    int open_array(u32 count);
+    /*! \details Starts a new array as the value of \a key. */
+    int open_array(const var::ConstString & key){ return write_key(key) < 0 ? -1 : open_array(); }
+    /*! \details Starts a new array with \a count values as the value of \a key. */
+    int open_array(const var::ConstString & key, u32 count){ return write_key(key) < 0 ? -1 : open_array(count); }
+    /*! \details Ends the current array (see close_object()). */
+    int close_array();
+
+    /*! \details Writes the key for the next value in an object.
+     *
+     * @return Zero on success or -1 if the current container is
+     * not an object or the last key has no value (errno is EINVAL)
+     *
+     */
+    int write_key(const var::ConstString & key);
+
+    /*! \details Writes a (UTF-8) string value. */
+    int write_string(const var::ConstString & value);
+    /*! \details Writes a string value with \a key. */
+    int write_string(const var::ConstString & key, const var::ConstString & value){
+        return write_key(key) < 0 ? -1 : write_string(value);
+    }
+
+    /*! \details Writes a byte string (binary data that isn't text). */
+    int write_bytes(const void * buffer, u32 size);
+    /*! \details Writes a byte string with \a key. */
+    int write_bytes(const var::ConstString & key, const void * buffer, u32 size){
+        return write_key(key) < 0 ? -1 : write_bytes(buffer, size);
+    }
+
+    /*! \details Writes a number value. */
+    int write_number(int value){ return write_signed64(value); }
+    /*! \details Writes a number value. */
+    int write_number(unsigned int value){ return write_unsigned64(value); }
+    /*! \details Writes a number value. */
+    int write_number(long value){ return write_signed64(value); }
+    /*! \details Writes a number value. */
+    int write_number(unsigned long value){ return write_unsigned64(value); }
+    /*! \details Writes a number value. */
+    int write_number(long long value){ return write_signed64(value); }
+    /*! \details Writes a number value. */
+    int write_number(unsigned long long value){ return write_unsigned64(value); }
+    /*! \details Writes a number value with \a key. */
+    template<typename T> int write_number(const var::ConstString & key, T value){
+        return write_key(key) < 0 ? -1 : write_number(value);
+    }
+
+    /*! \details Writes a floating point number (16 or 32 bits). */
+    int write_float(float value);
+    /*! \details Writes a floating point number with \a key. */
+    int write_float(const var::ConstString & key, float value){
+        return write_key(key) < 0 ? -1 : write_float(value);
+    }
+
+    /*! \details Writes a floating point number (16, 32 or 64 bits). */
+    int write_double(double value);
+    /*! \details Writes a floating point number with \a key. */
+    int write_double(const var::ConstString & key, double value){
+        return write_key(key) < 0 ? -1 : write_double(value);
+    }
+
+    /*! \details Writes true or false. */
+    int write_bool(bool value);
+    /*! \details Writes true or false with \a key. */
+    int write_bool(const var::ConstString & key, bool value){
+        return write_key(key) < 0 ? -1 : write_bool(value);
+    }
+
+    /*! \details Writes null. */
+    int write_null();
+    /*! \details Writes null with \a key. */
+    int write_null(const var::ConstString & key){
+        return write_key(key) < 0 ? -1 : write_null();
+    }
+
+    /*! \details Writes a tag for the next value.
+     *
+     * Tags add meaning to a value (for example, 1 means the next
+     * value is a POSIX time). The tag is not a value itself so the next call
+     * must write the value.
+     *
+     */
+    int write_tag(u32 tag);
+
+    /*! \details Writes a JSON value (and everything in it).
+     *
+     * Integers, reals, strings, true, false and null are written as the
+     * same CBOR type. Objects and arrays are written with their lengths.
+     *
+     */
+    int write_json(const JsonValue & value);
+    /*! \details Writes a JSON value with \a key. */
+    int write_json(const var::ConstString & key, const JsonValue & value){
+        return write_key(key) < 0 ? -1 : write_json(value);
+    }
+
+    /*! \details Writes the buffered output to the destination.
+     *
+     * @return Zero on success or -1 if the destination could not be written
+     *
+     */
+    int flush();
+
+    /*! \details Closes all open objects and arrays then flushes the output. */
+    int close();
+
+    /*! \details Returns the number of open objects and arrays. */
+    u32 depth() const { return m_depth; }
+
+    /*! \details Returns the total number of bytes written (including buffered bytes). */
+    u32 size() const { return m_flushed_size + m_buffer_size; }
+
+    /*! \details Returns true if writing to the destination has failed.
+     *
+     * Once the destination fails, all methods return -1.
+     *
+     */
+    bool is_failed() const { return m_is_failed; }
+
+private:
+    const sys::File * m_file;
+    var::Data * m_data;
+    u32 m_flushed_size;
+    u32 m_buffer_size;
+    u32 m_is_object; //bit n is set if level n is an object
+    u32 m_is_definite; //bit n is set if level n was opened with a count
+    u32 m_remaining[MAX_DEPTH+1]; //values left to write at definite levels
+    u8 m_depth;
+    bool m_is_key_written;
+    bool m_is_failed;
+    u8 m_buffer[BUFFER_SIZE];
+
+    void init();
+    bool is_in_object() const { return (m_is_object & ((u32)1 << m_depth)) != 0; }
+    bool is_definite() const { return (m_is_definite & ((u32)1 << m_depth)) != 0; }
+    int start_value();
+    int open_container(u8 major, bool is_object, bool is_definite, u32 count);
+    int close_container(bool is_object);
+    int write_head(u8 major, u64 value);
+    int write_signed64(s64 value);
+    int write_unsigned64(u64 value);
+    int write_text(u8 major, const void * buffer, u32 length);
+    int write_raw(const void * buffer, u32 length);
+    u8 * reserve(u32 length);
+    int write_destination(const u8 * buffer, u32 length);
+
+};
+
+}
+
+#endif /* FMT_CBORWRITER_HPP_ */
@@ -0,0 +1,99 @@
+/*! \file */ //Copyright 2011-2018 Tyler Gilbert; All Rights Reserved
+
+#ifndef FMT_CHROMETRACE_HPP_
+#define FMT_CHROMETRACE_HPP_
+
+#include "JsonWriter.hpp"
+#include "../sys/TraceRing.hpp"
+
+namespace fmt {
+
+/*! \brief Chrome Trace Class
+ * \details The ChromeTrace class converts dumps saved by sys::TraceRing
+ * to the Chrome trace event JSON format. The output can be opened with
+ * chrome://tracing or https://ui.perfetto.dev.
+ *
+ * BEGIN and END records become duration events, INSTANT records
+ * become instant events and COUNTER records are plotted as counters. Each thread
+ * that wrote records is shown on its own track.
+ *
+ * \code
+ * #include <sapi/fmt.hpp>
+ *
+ * static const char * const event_names[] = {
+ *   "filter",
+ *   "sample count"
+ * };
+ *
+ * Data dump; //loaded from the dump saved on the device
+ * Data json;
+ * ChromeTrace trace(json);
+ * trace.set_event_names(event_names, 2);
+ * trace.write(dump);
+ * trace.close();
+ * \endcode
+ *
+ * More than one dump can be written before calling close() (for example,
+ * dumps that were saved one after another).
+ *
+ */
+class ChromeTrace : public api::FmtWorkObject {
+public:
+
+    /*! \details Constructs an object that writes JSON to \a file. */
+    ChromeTrace(const sys::File & file);
+
+    /*! \details Constructs an object that writes JSON to \a data (resized as needed). */
+    ChromeTrace(var::Data & data);
+
+    /*! \details Closes the JSON document if close() hasn't been called. */
+    ~ChromeTrace();
+
+    /*! \details Sets the names of the application events.
+     *
+     * @param names A list of names where the index is the event ID (the list must stay in scope)
+     * @param count The number of names in the list
+     *
+     * Events without a name are called "event N". The library events
+     * (sys::TraceRing::EVENT_LIBRARY and above) are always named.
+     *
+     */
+    void set_event_names(const char * const * names, u32 count){ m_names = names; m_name_count = count; }
+
+    /*! \details Writes the records in \a dump as trace events.
+     *
+     * @param dump The data saved by sys::TraceRing::save()
+     * @return The number of events written or -1 if \a dump is not a valid dump (EINVAL) or the output could not be written
+     *
+     */
+    int write(const var::Data & dump);
+
+    /*! \details Finishes the JSON document and flushes the output.
+     *
+     * @return Zero on success or -1 if the output could not be written
+     *
+     */
+    int close();
+
+    /*! \details Returns the total number of records that were dropped by the rings that saved the dumps. */
+    u32 dropped() const { return m_dropped; }
+
+    /*! \details Returns the name of a library event (or null if \a event is not a library event). */
+    static const char * library_event_name(u16 event);
+
+private:
+    JsonWriter m_json;
+    const char * const * m_names;
+    u32 m_name_count;
+    u32 m_dropped;
+    bool m_is_started;
+    bool m_is_closed;
+
+    void init();
+    int start();
+    int write_record(const sys::trace_record_t & record);
+};
+
+}
+
+#endif /* FMT_CHROMETRACE_HPP_ */
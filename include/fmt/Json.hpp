@@ -215,6 +215,10 @@ private:
     friend class JsonInteger;
     friend class JsonString;
     friend class JsonNull;
+    friend class JsonPath;
+    friend class JsonQuery;
+    friend class CborWriter;
+    friend class CborReader;
     json_t * m_value;
     bool m_is_observer;
 
@@ -0,0 +1,240 @@
+/*! \file */ //Copyright 2011-2018 Tyler Gilbert; All Rights Reserved
+
+#ifndef FMT_JSONDOCUMENT_HPP_
+#define FMT_JSONDOCUMENT_HPP_
+
+#include "../api/FmtObject.hpp"
+#include "../var/ConstString.hpp"
+#include "../var/String.hpp"
+#include "../var/Vector.hpp"
+#include "../var/Data.hpp"
+
+namespace sys {
+class File;
+}
+
+namespace fmt {
+
+/*! \cond */
+typedef struct {
+    u32 info; //type (lower 4 bits) and string length or number of items
+    u32 value; //string offset, number, or position of the first item
+} json_document_node_t;
+/*! \endcond */
+
+class JsonDocument;
+
+/*! \brief JSON View Class
+ * \details The JsonView class is a read-only reference to a
+ * value in a JsonDocument. It has the same accessors as
+ * JsonValue, JsonObject and JsonArray so code that reads JSON
+ * can use either one.
+ *
+ * A JsonView is two pointers so it can be copied freely. It is valid
+ * as long as the JsonDocument it came from.
+ *
+ */
+class JsonView : public api::FmtInfoObject {
+public:
+
+    /*! \details Constructs an invalid view. */
+    JsonView(){
+        m_document = 0;
+        m_node = 0;
+    }
+
+    /*! \details Value types (same names as JsonValue::type). */
+    enum type {
+        INVALID = -1,
+        OBJECT,
+        ARRAY,
+        STRING,
+        REAL,
+        INTEGER,
+        TRUE,
+        FALSE,
+        ZERO
+    };
+
+    /*! \details Returns true if the view refers to a value. */
+    bool is_valid() const { return m_node != 0; }
+
+    /*! \details Returns the type of the value (INVALID if is_valid() is false). */
+    enum type type() const {
+        if( m_node ){
+            return (enum type)(m_node->info & 0x0f);
+        }
+        return INVALID;
+    }
+
+    bool is_object() const { return type() == OBJECT; }
+    bool is_array() const { return type() == ARRAY; }
+    bool is_string() const { return type() == STRING; }
+    bool is_real() const { return type() == REAL; }
+    bool is_integer() const { return type() == INTEGER; }
+    bool is_true() const { return type() == TRUE; }
+    bool is_false() const { return type() == FALSE; }
+    bool is_null() const { return type() == ZERO; }
+    bool is_zero() const { return is_null(); }
+
+    /*! \details Returns this view (for compatibility with JsonValue::to_object()). */
+    const JsonView & to_object() const { return *this; }
+    /*! \details Returns this view (for compatibility with JsonValue::to_array()). */
+    const JsonView & to_array() const { return *this; }
+
+    /*! \details Returns a copy of the value as a string (see JsonValue::to_string()).
+     *
+     * Use to_const_string() to access a string value without copying it.
+     *
+     */
+    var::String to_string() const;
+
+    /*! \details Returns a string value (without copying it) or an empty string if the value is not a string. */
+    var::ConstString to_const_string() const;
+
+    /*! \details Returns the number of bytes in a string value (strings may contain zeros). */
+    u32 string_length() const { return is_string() ? (m_node->info >> 4) : 0; }
+
+    /*! \details Returns the value as a float (strings are converted). */
+    float to_real() const;
+    /*! \details Returns the value as an integer (strings are converted). */
+    int to_integer() const;
+    /*! \details Returns true if the value is true. */
+    bool to_bool() const { return is_true(); }
+
+    /*! \details Returns the number of items in an object or array (zero for other types). */
+    u32 count() const {
+        if( is_object() || is_array() ){
+            return m_node->info >> 4;
+        }
+        return 0;
+    }
+
+    /*! \details Returns the value of \a key in an object.
+     *
+     * Keys are sorted when the document is parsed so this takes O(log n) time.
+     * If \a key is not in the object (or this is not an object), the returned view is not valid.
+     *
+     */
+    JsonView at(const var::ConstString & key) const;
+
+    /*! \details Returns the value at \a idx in an array or object.
+     *
+     * Object values are in the same order as key_at().
+     *
+     */
+    JsonView at(u32 idx) const;
+
+    /*! \details Returns the key at \a idx in an object (keys are in sorted order). */
+    var::ConstString key_at(u32 idx) const;
+
+    /*! \details Returns a copy of the keys in an object (see JsonObject::keys()). */
+    var::Vector<var::String> keys() const;
+
+private:
+    friend class JsonDocument;
+    JsonView(const JsonDocument * document, const json_document_node_t * node){
+        m_document = document;
+        m_node = node;
+    }
+    const JsonDocument * m_document;
+    const json_document_node_t * m_node;
+};
+
+/*! \brief JSON Document Class
+ * \details The JsonDocument class parses JSON into a read-only
+ * tree that is stored in a single block of memory.
+ *
+ * Json::load() (jansson) allocates memory for every value and a
+ * hash table for every object. JsonDocument counts the values
+ * first, allocates one block of 8 bytes per value (keys included), and
+ * parses the text in place: strings are unescaped and zero terminated
+ * in the input buffer, and views point directly at them.
+ *
+ * The items of each object and array are next to each other in
+ * memory so JsonView::at(u32) takes constant time. The keys of each
+ * object are sorted so JsonView::at(const ConstString&) uses a
+ * binary search. If a key appears more than once, the last value is kept.
+ *
+ * \code
+ * #include <sapi/fmt.hpp>
+ *
+ * JsonDocument document;
+ * if( document.load("/home/settings.json") == 0 ){
+ *   JsonView network = document.root().at("network");
+ *   printf("ssid is %s\n", network.at("ssid").to_const_string().str());
+ *   JsonView channels = network.at("channels");
+ *   for(u32 i=0; i < channels.count(); i++){
+ *     printf("channel %d\n", channels.at(i).to_integer());
+ *   }
+ * } else {
+ *   printf("error at %ld\n", document.error_position());
+ * }
+ * \endcode
+ *
+ * Integers that don't fit in 32 bits are stored as REAL values.
+ *
+ */
+class JsonDocument : public api::FmtWorkObject {
+public:
+
+    enum {
+        MAX_DEPTH = 31 /*! The maximum number of nested objects and arrays */
+    };
+
+    JsonDocument();
+
+    /*! \details Parses JSON text in place.
+     *
+     * @param data The JSON text (data.size() bytes)
+     * @return Zero on success or -1 if the text is not valid JSON (errno is EINVAL)
+     *
+     * The contents of \a data are modified and \a data must
+     * remain valid while the document is used.
+     *
+     */
+    int parse(var::Data & data);
+
+    /*! \details Parses a copy of \a json. */
+    int parse(const var::ConstString & json);
+
+    /*! \details Loads and parses the file at \a path. */
+    int load(const var::ConstString & path);
+
+    /*! \details Loads and parses the rest of \a file. */
+    int load(const sys::File & file);
+
+    /*! \details Frees the memory used by the document (root() is no longer valid). */
+    void clear();
+
+    /*! \details Returns the top level value (not valid if parsing failed). */
+    JsonView root() const {
+        if( m_count == 0 ){
+            return JsonView();
+        }
+        return JsonView(this, nodes());
+    }
+
+    /*! \details Returns the number of values in the document (keys included). */
+    u32 count() const { return m_count; }
+
+    /*! \details Returns the position in the text where parsing failed. */
+    u32 error_position() const { return m_error_position; }
+
+private:
+    friend class JsonView;
+    var::Data m_nodes;
+    var::Data m_text_buffer;
+    const char * m_text;
+    u32 m_count;
+    u32 m_error_position;
+
+    const json_document_node_t * nodes() const { return (const json_document_node_t *)m_nodes.data_const(); }
+    int parse_text(char * text, u32 length);
+    int fail(const char * text, const char * position);
+
+};
+
+}
+
+#endif /* FMT_JSONDOCUMENT_HPP_ */
@@ -0,0 +1,188 @@
+/*! \file */ //Copyright 2011-2018 Tyler Gilbert; All Rights Reserved
+
+#ifndef FMT_JSONPATH_HPP_
+#define FMT_JSONPATH_HPP_
+
+#include "../api/FmtObject.hpp"
+#include "../var/ConstString.hpp"
+#include "../var/Vector.hpp"
+#include "../var/Data.hpp"
+#include "Json.hpp"
+#include "JsonDocument.hpp"
+
+namespace fmt {
+
+/*! \cond */
+typedef struct {
+    u32 key; //offset of the zero terminated key
+    u32 index; //array index
+    u32 flags; //key, index or wildcard
+} json_path_segment_t;
+/*! \endcond */
+
+/*! \brief JSON Path Class
+ * \details The JsonPath class is a path to a value in a JSON
+ * document that is parsed once and can be used to find values in
+ * many documents.
+ *
+ * Two syntaxes are accepted:
+ *
+ * - JSON Pointer (RFC 6901): "/devices/3/sensors/temp". A segment is
+ *   used as a key in an object and, if it is a number, as an index
+ *   in an array. "~1" is a slash and "~0" is a tilde in a key.
+ *   A segment that is "*" matches every item of an object or array.
+ * - A subset of JSONPath: "$.devices[3].sensors['temp']". A name is
+ *   only used as a key and a bracketed number is only used as an index.
+ *   ".*" and "[*]" match every item of an object or array.
+ *
+ * An empty path (or "$") refers to the top level value.
+ *
+ * \code
+ * #include <sapi/fmt/JsonPath.hpp>
+ *
+ * Json json;
+ * json.load("/home/devices.json");
+ * JsonPath temperature("/devices/3/sensors/temp");
+ * JsonValue value = temperature.find(json);
+ * if( value.is_valid() ){
+ *   printf("temp is %f\n", value.to_real());
+ * }
+ * \endcode
+ *
+ * find() looks up each key directly with jansson (or with
+ * JsonView for a JsonDocument) without creating an intermediate
+ * JsonObject or JsonArray for each level. To read many values from the same
+ * document, use JsonQuery.
+ *
+ */
+class JsonPath : public api::FmtWorkObject {
+public:
+
+    /*! \details Constructs an empty path (refers to the top level value). */
+    JsonPath();
+
+    /*! \details Constructs and compiles \a path (check is_valid()). */
+    JsonPath(const var::ConstString & path);
+
+    /*! \details Compiles \a path.
+     *
+     * @return Zero on success or -1 if the syntax is not valid (errno is EINVAL)
+     */
+    int compile(const var::ConstString & path);
+
+    /*! \details Returns true if the last call to compile() succeeded. */
+    bool is_valid() const { return m_is_valid; }
+
+    /*! \details Returns the number of segments in the path. */
+    u32 count() const { return m_count; }
+
+    /*! \details Returns true if the path contains a wildcard. */
+    bool is_wildcard() const;
+
+    /*! \details Returns the value at the path in \a root.
+     *
+     * The returned value refers to memory owned by \a root. If
+     * nothing matches, the returned value is not valid. If the
+     * path has wildcards, the first match is returned.
+     *
+     */
+    JsonValue find(const JsonValue & root) const;
+
+    /*! \details Returns the value at the path in \a root (see above). */
+    JsonView find(const JsonView & root) const;
+
+    /*! \details Finds all the values that match the path.
+     *
+     * @param root The top level value
+     * @param results Matches are appended to this vector
+     * @return The number of matches
+     */
+    int find_all(const JsonValue & root, var::Vector<JsonValue> & results) const;
+
+    /*! \details Finds all the values that match the path (see above). */
+    int find_all(const JsonView & root, var::Vector<JsonView> & results) const;
+
+private:
+    friend class JsonQuery;
+    var::Data m_segments;
+    var::Data m_keys;
+    u32 m_count;
+    bool m_is_valid;
+
+    static int compile(const var::ConstString & path, var::Data & segments, u32 & count, var::Data & keys, u32 & key_size);
+
+};
+
+/*! \brief JSON Query Class
+ * \details The JsonQuery class finds the values of many
+ * paths (see JsonPath) in one pass over a JSON document.
+ *
+ * The paths are sorted when they are added so that paths
+ * with the same beginning share the work of finding it: "/network/ssid" and
+ * "/network/password" look up "network" once.
+ *
+ * \code
+ * #include <sapi/fmt/JsonPath.hpp>
+ *
+ * JsonQuery query;
+ * int ssid = query.add("/network/ssid");
+ * int password = query.add("/network/password");
+ * int rate = query.add("$.sensors[0].rate");
+ *
+ * JsonDocument document;
+ * document.load("/home/settings.json");
+ * JsonView values[3];
+ * query.find(document.root(), values);
+ * printf("ssid is %s\n", values[ssid].to_const_string().str());
+ * \endcode
+ *
+ * If a path has wildcards, the first match is found.
+ *
+ */
+class JsonQuery : public api::FmtWorkObject {
+public:
+
+    JsonQuery();
+
+    /*! \details Compiles and adds \a path to the query.
+     *
+     * @return The index of the path in the results (or -1 if \a path is not valid)
+     */
+    int add(const var::ConstString & path);
+
+    /*! \details Returns the number of paths in the query. */
+    u32 count() const { return m_start.count() ? m_start.count() - 1 : 0; }
+
+    /*! \details Removes all the paths. */
+    void clear();
+
+    /*! \details Finds the value of each path in \a root.
+     *
+     * @param root The top level value
+     * @param results An array of count() values (the result of path \a n is in results[n])
+     * @return The number of paths that were found
+     *
+     * The results of paths that aren't found are not valid.
+     *
+     */
+    int find(const JsonValue & root, JsonValue * results) const;
+
+    /*! \details Finds the value of each path in \a root (see above). */
+    int find(const JsonView & root, JsonView * results) const;
+
+private:
+    var::Data m_segments;
+    var::Data m_keys;
+    u32 m_segment_count;
+    u32 m_key_size;
+    var::Vector<u32> m_start; //first segment of each path (plus one extra for the end)
+    var::Vector<u32> m_order; //paths in sorted order
+    var::Vector<u32> m_prefix; //number of segments each path in m_order shares with the one before it
+
+    int compare(u32 a, u32 b, u32 & common) const;
+
+};
+
+}
+
+#endif /* FMT_JSONPATH_HPP_ */
@@ -0,0 +1,231 @@
+/*! \file */ //Copyright 2011-2018 Tyler Gilbert; All Rights Reserved
+
+#ifndef FMT_JSONREADER_HPP_
+#define FMT_JSONREADER_HPP_
+
+#include "../api/FmtObject.hpp"
+#include "../var/ConstString.hpp"
+#include "../var/Data.hpp"
+#include "ReaderInput.hpp"
+
+namespace sys {
+class File;
+}
+
+namespace fmt {
+
+/*! \brief JSON Reader Class
+ * \details The JsonReader class parses JSON text one event at a time
+ * (like a SAX or pull parser) without building a tree.
+ *
+ * Unlike Json::load(), which allocates memory for every value in the
+ * document, JsonReader uses a fixed amount of memory no matter how large the
+ * input is: an input buffer, a buffer for the current key or value
+ * (\a max_token_size bytes), and a buffer for the current path.
+ *
+ * \code
+ * #include <sapi/fmt.hpp>
+ * #include <sapi/sys.hpp>
+ *
+ * File f;
+ * f.open("/home/settings.json", File::RDONLY);
+ * JsonReader json(f);
+ * int event;
+ * while( (event = json.next()) > JsonReader::END ){
+ *   if( event == JsonReader::NUMBER ){
+ *     printf("%s = %f\n", json.path().str(), json.to_float());
+ *   }
+ * }
+ * if( event == JsonReader::ERROR ){
+ *   printf("error at line %d column %d\n", json.line(), json.column());
+ * }
+ * \endcode
+ *
+ * ### Paths
+ *
+ * The path of the current value is available with path(). Keys and
+ * array indices are separated with a slash (for example, "/network/ssid"
+ * or "/samples/2/time"). The top level value has an empty path.
+ *
+ * A filter limits next() to the values that match a list of paths. Each
+ * segment of a filter path can be "*" to match any key or index. Objects and
+ * arrays that can't contain a match are skipped without creating any events.
+ * If a filter matches an object or array, all the events inside it are
+ * returned (up to the matching END_OBJECT or END_ARRAY).
+ *
+ * \code
+ * const ConstString paths[] = { "/network/ssid", "/samples/" "*" };
+ * json.set_filter(paths, 2);
+ * while( json.next() > JsonReader::END ){
+ *   //only called for /network/ssid and the events of each item in samples
+ *   printf("%s = %s\n", json.path().str(), json.value().str());
+ * }
+ * \endcode
+ *
+ */
+class JsonReader : public api::FmtWorkObject {
+public:
+
+    enum {
+        BUFFER_SIZE = 256 /*! The number of bytes read from a file or callback at a time */,
+        MAX_DEPTH = 31 /*! The maximum number of nested objects and arrays */,
+        MAX_PATH_SIZE = 256 /*! The maximum length of path() */
+    };
+
+    /*! \details Events returned by next(). */
+    enum event {
+        ERROR = -1 /*! The input is not valid JSON (or could not be read) */,
+        END /*! There is no more input */,
+        OBJECT /*! An object starts */,
+        END_OBJECT /*! An object ends */,
+        ARRAY /*! An array starts */,
+        END_ARRAY /*! An array ends */,
+        KEY /*! A key in an object (value() is the key) */,
+        STRING /*! A string value (value() is the unescaped string) */,
+        NUMBER /*! A number value (value() is the number as text) */,
+        TRUE /*! The value true */,
+        FALSE /*! The value false */,
+        ZERO /*! The value null */
+    };
+
+    /*! \details Constructs a reader for \a file.
+     *
+     * @param file The file to read (the reader doesn't open or close it)
+     * @param max_token_size The longest string or key that can be read
+     */
+    JsonReader(const sys::File & file, u32 max_token_size = 256);
+
+    /*! \details Constructs a reader for JSON text in \a data (the data is not copied). */
+    JsonReader(const var::Data & data, u32 max_token_size = 256);
+
+    /*! \details Constructs a reader that gets its input from \a callback. */
+    JsonReader(reader_load_t callback, void * context, u32 max_token_size = 256);
+
+    /*! \details Parses the next event.
+     *
+     * @return The event (see enum event); END when there is no more input and ERROR if the input is not valid
+     *
+     * After ERROR, next() keeps returning ERROR and error_number()
+     * is EINVAL for invalid JSON, ENOSPC if a token or path is too long, or
+     * the error from reading the input.
+     *
+     * Several values can appear at the top level (for example, one
+     * per line as written by JsonWriter).
+     *
+     */
+    int next();
+
+    /*! \details Skips the rest of the current object or array.
+     *
+     * @return Zero on success or -1 if the input ends or can't be read
+     *
+     * Call this after next() returns OBJECT or ARRAY. The next
+     * call to next() returns the event after the matching END_OBJECT or END_ARRAY.
+     * The skipped text is only checked for matching brackets.
+     *
+     */
+    int skip();
+
+    /*! \details Sets the paths that next() will return.
+     *
+     * @param paths A pointer to the paths (the pointer is stored so the paths must remain valid)
+     * @param count The number of paths (zero to return all events)
+     *
+     * When a filter is set, next() doesn't return KEY events.
+     *
+     */
+    void set_filter(const var::ConstString * paths, u32 count){
+        m_filter = paths;
+        m_filter_count = count;
+    }
+
+    /*! \details Returns the last event returned by next(). */
+    int event() const { return m_event; }
+
+    /*! \details Returns the key, string or number text of the current event. */
+    var::ConstString value() const { return var::ConstString(m_token.cdata_const()); }
+
+    /*! \details Returns the number of bytes in value() (strings may contain zeros). */
+    u32 value_length() const { return m_token_size; }
+
+    /*! \details Returns the current number as an integer (or zero if it is not an integer). */
+    s32 to_integer() const;
+
+    /*! \details Returns the current number as a float. */
+    float to_float() const;
+
+    /*! \details Returns true if the current event is TRUE. */
+    bool to_bool() const { return m_event == TRUE; }
+
+    /*! \details Returns the path of the current value (see Paths above). */
+    var::ConstString path() const { return var::ConstString(m_path.cdata_const()); }
+
+    /*! \details Returns the number of objects and arrays that contain the current event. */
+    u32 depth() const { return m_depth; }
+
+    /*! \details Returns the line number (starting at 1) of the current position. */
+    u32 line() const { return m_input.line(); }
+    /*! \details Returns the column number (starting at 1) of the current position. */
+    u32 column() const { return m_input.column(); }
+    /*! \details Returns the number of bytes parsed. */
+    u32 position() const { return m_input.position(); }
+
+    /*! \details Returns true if \a path matches \a filter (see Paths above).
+     *
+     * If \a is_prefix is true, this returns true if a path that starts with
+     * \a path can match \a filter.
+     */
+    static bool is_path_match(const char * filter, const char * path, bool is_prefix = false);
+
+private:
+    enum state {
+        STATE_VALUE,
+        STATE_VALUE_OR_END,
+        STATE_KEY,
+        STATE_KEY_OR_END,
+        STATE_COLON,
+        STATE_COMMA_OR_END
+    };
+
+    ReaderInput m_input;
+
+    var::Data m_token;
+    u32 m_token_size;
+    var::Data m_path;
+    u32 m_path_length;
+
+    u32 m_is_object; //bit n is set if level n is an object
+    u32 m_index[MAX_DEPTH+1];
+    u16 m_path_offset[MAX_DEPTH+1];
+    u8 m_depth;
+    u8 m_state;
+    u8 m_match_depth;
+    s8 m_event;
+
+    const var::ConstString * m_filter;
+    u32 m_filter_count;
+
+    void init(u32 max_token_size);
+    int next_event();
+    int fail(int error_number);
+    int skip_whitespace();
+    int parse_value(int c);
+    int parse_string();
+    int parse_number(int c);
+    int parse_literal(const char * literal, int event);
+    int push_token(char c);
+    int push_utf8(u32 code);
+    int open_container(int event);
+    int close_container(int event);
+    int after_value();
+    int set_path_key();
+    int set_path_index();
+    int append_path(const char * segment, u32 length);
+    bool is_in_object() const { return (m_is_object & ((u32)1 << m_depth)) != 0; }
+    bool is_filter_match(bool is_prefix) const;
+
+};
+
+}
+
+#endif /* FMT_JSONREADER_HPP_ */
@@ -0,0 +1,222 @@
+/*! \file */ //Copyright 2011-2018 Tyler Gilbert; All Rights Reserved
+
+#ifndef FMT_JSONWRITER_HPP_
+#define FMT_JSONWRITER_HPP_
+
+#include "../api/FmtObject.hpp"
+#include "../var/ConstString.hpp"
+#include "../var/Data.hpp"
+
+namespace sys {
+class File;
+}
+
+namespace fmt {
+
+/*! \brief JSON Writer Class
+ * \details The JsonWriter class writes JSON text directly to a
+ * sys::File (including sockets and devices) or a var::Data object.
+ *
+ * Output goes through a small buffer inside the object that is written
+ * to the destination each time it fills up, so very large documents
+ * can be created without holding them in memory. Strings and keys are
+ * escaped, numbers are written as JSON numbers, and the nesting of
+ * objects and arrays is tracked (up to MAX_DEPTH levels) to place
+ * the commas and catch mismatched close_object()/close_array() calls.
+ *
+ * \code
+ * #include <sapi/fmt.hpp>
+ * #include <sapi/sys.hpp>
+ *
+ * File f;
+ * f.create("/home/telemetry.json");
+ * JsonWriter json(f);
+ * json.open_object();
+ * json.write_string("name", "sensor \"A\"");
+ * json.write_number("count", 3);
+ * json.open_array("samples");
+ * for(u32 i=0; i < 3; i++){
+ *   json.write_float(i*0.5f);
+ * }
+ * json.close(); //closes "samples" and the root object then flushes
+ * f.close();
+ *
+ * //{"name":"sensor \"A\"","count":3,"samples":[0.0,0.5,1.0]}
+ * \endcode
+ *
+ * When writing to a var::Data object, the data is resized as
+ * needed (unless it refers to fixed memory, in which case writing past
+ * the end fails with ENOSPC). The size of the data is the number of
+ * bytes written.
+ *
+ * Values written outside of any object or array are separated with
+ * a newline (one JSON value per line).
+ *
+ * \sa var::JsonString (builds a small document in a String)
+ *
+ */
+class JsonWriter : public api::FmtWorkObject {
+public:
+
+    enum {
+        BUFFER_SIZE = 128 /*! The number of bytes buffered before writing to the destination */,
+        MAX_DEPTH = 31 /*! The maximum number of nested objects and arrays */
+    };
+
+    /*! \details Constructs a writer that writes to \a file. */
+    JsonWriter(const sys::File & file);
+
+    /*! \details Constructs a writer that writes to \a data (starting at the beginning). */
+    JsonWriter(var::Data & data);
+
+    /*! \details Flushes any buffered output (see flush()). */
+    ~JsonWriter();
+
+    /*! \details Starts a new object. */
+    int open_object();
+    /*! \details Starts a new object as the value of \a key. */
+    int open_object(const var::ConstString & key){ return write_key(key) < 0 ? -1 : open_object(); }
+    /*! \details Ends the current object.
+     *
+     * @return Zero on success or -1 if the current container is not an object (errno is EINVAL)
+     */
+    int close_object();
+
+    /*! \details Starts a new array. */
+    int open_array();
+    /*! \details Starts a new array as the value of \a key. */
+    int open_array(const var::ConstString & key){ return write_key(key) < 0 ? -1 : open_array(); }
+    /*! \details Ends the current array.
+     *
+     * @return Zero on success or -1 if the current container is not an array (errno is EINVAL)
+     */
+    int close_array();
+
+    /*! \details Writes the key for the next value in an object.
+     *
+     * @return Zero on success or -1 if the current container is
+     * not an object or the last key has no value (errno is EINVAL)
+     *
+     * The keyed versions of the write methods call this method
+     * before writing the value.
+     */
+    int write_key(const var::ConstString & key);
+
+    /*! \details Writes a string value (escaped as needed). */
+    int write_string(const var::ConstString & value);
+    /*! \details Writes a string value with \a key. */
+    int write_string(const var::ConstString & key, const var::ConstString & value){
+        return write_key(key) < 0 ? -1 : write_string(value);
+    }
+
+    /*! \details Writes a number value. */
+    int write_number(int value){ return write_signed(value); }
+    /*! \details Writes a number value. */
+    int write_number(unsigned int value){ return write_unsigned(value); }
+    /*! \details Writes a number value. */
+    int write_number(long value){ return sizeof(long) == 4 ? write_signed(value) : write_signed64(value); }
+    /*! \details Writes a number value. */
+    int write_number(unsigned long value){ return sizeof(long) == 4 ? write_unsigned(value) : write_unsigned64(value); }
+    /*! \details Writes a number value. */
+    int write_number(long long value){ return write_signed64(value); }
+    /*! \details Writes a number value. */
+    int write_number(unsigned long long value){ return write_unsigned64(value); }
+    /*! \details Writes a number value with \a key. */
+    template<typename T> int write_number(const var::ConstString & key, T value){
+        return write_key(key) < 0 ? -1 : write_number(value);
+    }
+
+    /*! \details Writes a floating point number.
+     *
+     * The shortest digits that read back as \a value are written (see var::StringUtil::ftoa()).
+     * JSON can't represent infinity or NaN so these are written as null.
+     *
+     */
+    int write_float(float value);
+    /*! \details Writes a floating point number with \a key. */
+    int write_float(const var::ConstString & key, float value){
+        return write_key(key) < 0 ? -1 : write_float(value);
+    }
+
+    /*! \details Writes \a value divided by 10 to the power of \a decimal_places.
+     *
+     * The digits are exact (no floating point rounding) so this suits large
+     * fixed point values such as microsecond timestamps with a nanosecond
+     * fraction: write_fixed(1234567, 3) writes 1234.567. At most 18 decimal places are written.
+     *
+     */
+    int write_fixed(s64 value, u32 decimal_places);
+    /*! \details Writes a fixed point number with \a key. */
+    int write_fixed(const var::ConstString & key, s64 value, u32 decimal_places){
+        return write_key(key) < 0 ? -1 : write_fixed(value, decimal_places);
+    }
+
+    /*! \details Writes true or false. */
+    int write_bool(bool value);
+    /*! \details Writes true or false with \a key. */
+    int write_bool(const var::ConstString & key, bool value){
+        return write_key(key) < 0 ? -1 : write_bool(value);
+    }
+
+    /*! \details Writes null. */
+    int write_null();
+    /*! \details Writes null with \a key. */
+    int write_null(const var::ConstString & key){
+        return write_key(key) < 0 ? -1 : write_null();
+    }
+
+    /*! \details Writes the buffered output to the destination.
+     *
+     * @return Zero on success or -1 if the destination could not be written
+     *
+     */
+    int flush();
+
+    /*! \details Closes all open objects and arrays then flushes the output. */
+    int close();
+
+    /*! \details Returns the number of open objects and arrays. */
+    u32 depth() const { return m_depth; }
+
+    /*! \details Returns the total number of bytes written (including buffered bytes). */
+    u32 size() const { return m_flushed_size + m_buffer_size; }
+
+    /*! \details Returns true if writing to the destination has failed.
+     *
+     * Once the destination fails, all methods return -1.
+     *
+     */
+    bool is_failed() const { return m_is_failed; }
+
+private:
+    const sys::File * m_file;
+    var::Data * m_data;
+    u32 m_flushed_size;
+    u32 m_buffer_size;
+    u32 m_is_object; //bit n is set if level n is an object
+    u32 m_is_empty; //bit n is set if level n doesn't have any values yet
+    u8 m_depth;
+    bool m_is_key_written;
+    bool m_is_failed;
+    char m_buffer[BUFFER_SIZE];
+
+    void init();
+    bool is_in_object() const { return (m_is_object & (1<<m_depth)) != 0; }
+    int start_value();
+    int write_separator();
+    int open_container(char c, bool is_object);
+    int close_container(char c, bool is_object);
+    int write_signed(s32 value);
+    int write_unsigned(u32 value);
+    int write_signed64(s64 value);
+    int write_unsigned64(u64 value);
+    int write_quoted(const char * str, u32 length);
+    int write_raw(const char * str, u32 length);
+    char * reserve(u32 length);
+    int write_destination(const char * buffer, u32 length);
+
+};
+
+}
+
+#endif /* FMT_JSONWRITER_HPP_ */
@@ -0,0 +1,130 @@
+/*! \file */ //Copyright 2011-2018 Tyler Gilbert; All Rights Reserved
+
+#ifndef FMT_READERINPUT_HPP_
+#define FMT_READERINPUT_HPP_
+
+#include <stddef.h>
+#include "../var/Data.hpp"
+
+namespace sys {
+class File;
+}
+
+namespace fmt {
+
+/*! \details Callback used by JsonReader and XmlReader to load more data.
+ *
+ * @param buffer The destination for the data
+ * @param buflen The maximum number of bytes to load
+ * @param context The context passed to the reader constructor
+ * @return The number of bytes loaded, zero at the end of the input or (size_t)-1 on error
+ *
+ * This is the same signature as json_load_callback_t so the same callback
+ * can be used with Json::load().
+ */
+typedef size_t (*reader_load_t)(void * buffer, size_t buflen, void * context);
+
+/*! \details Same as reader_load_t (the name used before XmlReader shared it). */
+typedef reader_load_t json_reader_load_t;
+
+/*! \brief Reader Input Class
+ * \details The ReaderInput class is the input used internally by the
+ * JsonReader and XmlReader pull parsers. It reads a file or callback one
+ * buffer at a time (or uses data that is already in memory) and keeps
+ * track of the line, column and byte position.
+ *
+ * Parsers read one byte at a time with peek() and read(). To copy runs
+ * of bytes that don't need processing, they can use available() and data()
+ * to see the buffered bytes and consume() to move past them.
+ *
+ * This class is not part of the API (it is not included by sapi/fmt.hpp).
+ *
+ */
+class ReaderInput {
+public:
+    ReaderInput();
+
+    /*! \details Reads the input from \a file \a buffer_size bytes at a time. */
+    void set_file(const sys::File & file, u32 buffer_size);
+
+    /*! \details Uses the bytes in \a data as the entire input (the data is not copied). */
+    void set_data(const var::Data & data);
+
+    /*! \details Reads the input from \a callback \a buffer_size bytes at a time. */
+    void set_callback(reader_load_t callback, void * context, u32 buffer_size);
+
+    /*! \details Returns the next byte without reading it or -1 at the end of the input. */
+    int peek(){
+        if( (m_input_position == m_input_size) && (load() <= 0) ){
+            return -1;
+        }
+        return (u8)m_input[m_input_position];
+    }
+
+    /*! \details Reads the next byte.
+     *
+     * @return The byte or -1 at the end of the input
+     *
+     */
+    int read();
+
+    /*! \details Returns the number of buffered bytes (loading more if the buffer is empty).
+     *
+     * Zero is returned at the end of the input or if the input can't be read
+     * (see load_error()).
+     */
+    u32 available(){
+        if( (m_input_position == m_input_size) && (load() <= 0) ){
+            return 0;
+        }
+        return m_input_size - m_input_position;
+    }
+
+    /*! \details Returns a pointer to the buffered bytes (see available()). */
+    const char * data() const { return m_input + m_input_position; }
+
+    /*! \details Moves past \a count buffered bytes (\a count must not be more than available()). */
+    void consume(u32 count);
+
+    /*! \details Returns the error from reading the input (zero if there is no error). */
+    int load_error() const { return m_load_error; }
+
+    /*! \details Returns the line number (starting at 1) of the current position. */
+    u32 line() const { return m_line; }
+    /*! \details Returns the column number (starting at 1) of the current position. */
+    u32 column() const { return m_column; }
+    /*! \details Returns the number of bytes read. */
+    u32 position() const { return m_position; }
+
+    /*! \details Writes the UTF-8 encoding of \a code to \a dest.
+     *
+     * @param dest The destination (up to 4 bytes are written)
+     * @param code The code point (up to 0x10ffff)
+     * @return The number of bytes written
+     *
+     */
+    static u32 encode_utf8(char * dest, u32 code);
+
+private:
+    const sys::File * m_file;
+    reader_load_t m_callback;
+    void * m_context;
+
+    var::Data m_buffer;
+    const char * m_input;
+    u32 m_input_size;
+    u32 m_input_position;
+    bool m_is_input_end;
+    int m_load_error;
+
+    u32 m_line;
+    u32 m_column;
+    u32 m_position;
+
+    int load();
+
+};
+
+}
+
+#endif /* FMT_READERINPUT_HPP_ */
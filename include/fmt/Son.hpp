@@ -12,6 +12,8 @@
 
 #include "../api/FmtObject.hpp"
 #include "../var/String.hpp"
+#include "../var/Data.hpp"
+#include "JsonDocument.hpp"
 #include "../sys/Timer.hpp" //for chrono::MicroTime
 
 
@@ -88,6 +90,26 @@ namespace fmt {
  *  get converted to float value. If the JSON data is converted to SON, all numbers will
  *  be in float format.
  *
+ * ### Indexed Reads
+ *
+ * Each read_*() call finds its value by walking the file from the root, so reading
+ * many values from a large file reads the file many times. create_index() reads
+ * the file once (using to_json()) and keeps a sorted copy of its values in memory.
+ * After that, read_str(), read_num(), read_unum(), read_float() and read_bool() look up
+ * values in the index. read_data(), seek() and reading a float value still use the file
+ * (to_json() text doesn't keep every bit of a float).
+ *
+ * \code
+ * son.open_read("/home/settings.son");
+ * son.create_index(); //reads the whole file once
+ * u32 value = son.read_unum("value"); //doesn't read the file
+ * son.read_str("time.hour", buffer, 32);
+ * \endcode
+ *
+ * Values that aren't in the index (or can't be converted exactly) are read from
+ * the file as before. A successful edit() marks the index as out of date and it is
+ * rebuilt before the next indexed read. close() and the open methods remove the index.
+ *
  */
 class Son : public api::FmtWorkObject {
 public:
@@ -181,14 +203,14 @@ public:
 	 * @param name The path/name of the file to open
 	 * @return Less than zero for an error
 	 */
-	int open_append(const char * name){ return son_api()->append(&m_son, name, m_stack, m_stack_size); }
+	int open_append(const char * name){ remove_index(); return son_api()->append(&m_son, name, m_stack, m_stack_size); }
 
 	/*! \details Opens a SON file for reading.
 	 *
 	 * @param name Name of the file
 	 * @return Zero on success
 	 */
-	int open_read(const char * name){ return son_api()->open(&m_son, name); }
+	int open_read(const char * name){ remove_index(); return son_api()->open(&m_son, name); }
 
 	/*! \details Opens a SON message for reading.
 	 *
@@ -196,8 +218,8 @@ public:
 	 * @param nbyte The number of bytes in the message
 	 * @return Zero on success
 	 */
-	int open_message(void * message, int nbyte){ return son_api()->open_message(&m_son, message, nbyte); }
-	int open_message(var::Data & data){ return son_api()->open_message(&m_son, data.data(), data.capacity()); }
+	int open_message(void * message, int nbyte){ remove_index(); return son_api()->open_message(&m_son, message, nbyte); }
+	int open_message(var::Data & data){ remove_index(); return son_api()->open_message(&m_son, data.data(), data.capacity()); }
 
 	int open_read_message(void * message, int nbyte){ return open_message(message, nbyte); }
 	int open_read_message(var::Data & data){ return open_message(data); }
@@ -207,7 +229,7 @@ public:
 	 * @param name Name of the file
 	 * @return Zero on success
 	 */
-	int open_edit(const char * name){ return son_api()->edit(&m_son, name); }
+	int open_edit(const char * name){ remove_index(); return son_api()->edit(&m_son, name); }
 
 	/*! \details Opens a SON message for editing.
 	 *
@@ -215,10 +237,31 @@ public:
 	 * @param nbyte The number of bytes in the message
 	 * @return Zero on success
 	 */
-	int open_edit_message(void * message, int nbyte){ return son_api()->edit_message(&m_son, message, nbyte); }
+	int open_edit_message(void * message, int nbyte){ remove_index(); return son_api()->edit_message(&m_son, message, nbyte); }
 
 	/*! \details Closes a SON file. */
-	int close(){ return son_api()->close(&m_son); }
+	int close(){ remove_index(); return son_api()->close(&m_son); }
+
+	/*! \details Reads the open file and creates an index of its values.
+	 *
+	 * @return Zero on success or -1 if the file can't be converted (see Indexed Reads above)
+	 *
+	 * The index uses about as much memory as to_json() output plus
+	 * 8 bytes per value.
+	 *
+	 */
+	int create_index();
+
+	/*! \details Removes the index and frees its memory. */
+	void remove_index(){
+		m_is_indexed = false;
+		m_is_index_stale = false;
+		m_index.clear();
+		m_index_text.free();
+	}
+
+	/*! \details Returns true if create_index() was called for the open file. */
+	bool is_indexed() const { return m_is_indexed; }
 
 	/*! \details Seeks to the location of the access code and gets the size of the data in bytes.
 	 *
@@ -418,7 +461,7 @@ public:
 	 * @param capacity Size of \a str buffer
 	 * @return The number of bytes actually read
 	 */
-	int read_str(const char * access, char * str, son_size_t capacity){ return son_api()->read_str(&m_son, access, str, capacity); }
+	int read_str(const char * access, char * str, son_size_t capacity);
 
 	/*! \details Reads the specified key as a string.  If the original
 	 * key was not written as a string, it will be converted to a string.  For example,
@@ -428,15 +471,7 @@ public:
 	 * @param str var::String reference
 	 * @return The number of bytes actually read
 	 */
-	int read_str(const char * access, var::String & str){
-        //first seek and get the size
-        son_size_t size;
-        if( seek(access, size) >= 0 ){
-            str.set_capacity(size+1);
-            return son_api()->read_str(&m_son, access, str.cdata(), str.capacity());
-        }
-        return -1;
-	}
+	int read_str(const char * access, var::String & str);
 
 	/*! \details Reads the specified key as a number (s32).  If the original
 	 * key was not written as a s32, it will be converted to one.  A string
@@ -445,7 +480,7 @@ public:
 	 * @param access Key parameters
 	 * @return The number
 	 */
-	s32 read_num(const char * access){ return son_api()->read_num(&m_son, access); }
+	s32 read_num(const char * access);
 
 	/*! \details Reads the specified key as a number (u32).  If the original
 	 * key was not written as a s32, it will be converted to one.  A string
@@ -454,7 +489,7 @@ public:
 	 * @param access Key parameters
 	 * @return The number
 	 */
-	u32 read_unum(const char * access){ return son_api()->read_unum(&m_son, access); }
+	u32 read_unum(const char * access);
 
 	/*! \details Reads the specified key as a number (float).
 	 *
@@ -467,7 +502,7 @@ public:
 	 *
 	 *
 	 */
-	float read_float(const char * access){ return son_api()->read_float(&m_son, access); }
+	float read_float(const char * access);
 
 	/*! \details Reads the specified key as data.  Regardless of the storage
 	 * type, the key will be returned as binary data.
@@ -484,7 +519,7 @@ public:
 	 * @param access Key parameters
 	 * @return True if the key is found and is true; false otherwise.
 	 */
-	bool read_bool(const char * access){ return son_api()->read_bool(&m_son, access); }
+	bool read_bool(const char * access);
 
 	/*! \details Edits a float value.
 	 *
@@ -492,7 +527,7 @@ public:
 	 * @param v The new value to write
 	 * @return Zero on success
 	 */
-	int edit(const char * access, float v){ return son_api()->edit_float(&m_son, access, v); }
+	int edit(const char * access, float v){ return update_index(son_api()->edit_float(&m_son, access, v)); }
 
 	/*! \details Edits a data value.
 	 *
@@ -505,7 +540,7 @@ public:
 	 * will be truncated to that size.
 	 *
 	 */
-	int edit(const char * access,  const void * data, son_size_t size){ return son_api()->edit_data(&m_son, access, data, size); }
+	int edit(const char * access,  const void * data, son_size_t size){ return update_index(son_api()->edit_data(&m_son, access, data, size)); }
 
 	/*! \details Edits a string value.
 	 *
@@ -517,7 +552,7 @@ public:
 	 * string, the new string will be truncated to fit.
 	 *
 	 */
-	int edit(const char * access, const char * str){ return son_api()->edit_str(&m_son, access, str); }
+	int edit(const char * access, const char * str){ return update_index(son_api()->edit_str(&m_son, access, str)); }
 
 	/*! \details Edits a string value.
 	 *
@@ -529,7 +564,7 @@ public:
 	 * string, the new string will be truncated to fit.
 	 *
 	 */
-	int edit(const char * access, const var::String & v){ return son_api()->edit_str(&m_son, access, v.c_str()); }
+	int edit(const char * access, const var::String & v){ return update_index(son_api()->edit_str(&m_son, access, v.c_str())); }
 
 	/*! \details Edits a number value (signed 32-bit).
 	 *
@@ -537,7 +572,7 @@ public:
 	 * @param v The new value
 	 * @return Zero on success
 	 */
-	int edit(const char * access, s32 v){ return son_api()->edit_num(&m_son, access, v); }
+	int edit(const char * access, s32 v){ return update_index(son_api()->edit_num(&m_son, access, v)); }
 
 	/*! \details Edits a number value (unsigned 32-bit).
 	 *
@@ -545,7 +580,7 @@ public:
 	 * @param v The new value
 	 * @return Zero on success
 	 */
-	int edit(const char * access, u32 v){ return son_api()->edit_unum(&m_son, access, v); }
+	int edit(const char * access, u32 v){ return update_index(son_api()->edit_unum(&m_son, access, v)); }
 
 	/*! \details Edits a boolean value.
 	 *
@@ -553,7 +588,7 @@ public:
 	 * @param v The new value
 	 * @return Zero on success
 	 */
-	int edit(const char * access, bool v){ return son_api()->edit_bool(&m_son, access, v); }
+	int edit(const char * access, bool v){ return update_index(son_api()->edit_bool(&m_son, access, v)); }
 
 	typedef enum {
 		ERR_NONE /*! This value indicates no error has occurred. */ = SON_ERR_NONE,
@@ -619,6 +654,21 @@ private:
 	son_stack_t * m_stack;
 	u16 m_stack_size;
 	bool m_is_stack_needs_free;
+	bool m_is_indexed;
+	bool m_is_index_stale;
+	JsonDocument m_index;
+	var::Data m_index_text;
+	u32 m_index_size;
+
+	int update_index(int result){
+		if( (result >= 0) && m_is_indexed ){
+			m_is_index_stale = true;
+		}
+		return result;
+	}
+
+	JsonView find_index(const char * access);
+	static int append_index_text(void * context, const char * entry);
 };
 
 };
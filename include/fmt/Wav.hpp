@@ -8,7 +8,9 @@
 
 namespace fmt {
 
-/*! \brief WAV File format */
+/*! \brief WAV File format
+ * \details See WavReader and WavWriter to stream the samples in a WAV file.
+ */
 class Wav : public api::FmtFileObject {
 public:
 	/*! \details Constructs a new WAV object and open the WAV as a read-only file. */
@@ -0,0 +1,162 @@
+/*! \file */ //Copyright 2011-2018 Tyler Gilbert; All Rights Reserved
+
+#ifndef FMT_WAVREADER_HPP_
+#define FMT_WAVREADER_HPP_
+
+#include "../api/FmtObject.hpp"
+#include "../var/ConstString.hpp"
+#include "../var/Data.hpp"
+#include "../sys/File.hpp"
+
+#if !defined __link
+#include "../dsp/SignalData.hpp"
+#endif
+
+namespace fmt {
+
+/*! \brief WAV Reader Class
+ * \details The WavReader class reads the samples in a WAV file
+ * one block of frames at a time.
+ *
+ * The RIFF chunks in the file are parsed when it is opened: the "fmt " chunk
+ * describes the samples and chunks that aren't needed (such as "LIST") are
+ * skipped until the "data" chunk is found.
+ *
+ * A frame is one sample for each channel. Samples can be read as they are
+ * stored in the file (interleaved) or converted and separated into one
+ * array (or dsp signal) per channel. 8, 16, 24 and 32 bit PCM and 32 bit float
+ * samples can be converted to q1.15, q1.31 or float.
+ *
+ * \code
+ * #include <sapi/fmt.hpp>
+ * #include <sapi/dsp.hpp>
+ *
+ * WavReader wav;
+ * if( wav.open("/home/recording.wav") == 0 ){
+ *   SignalQ31 signals[2];
+ *   while( wav.read(signals, 256) > 0 ){
+ *     //signals[0] is the left channel and signals[1] is the right channel
+ *   }
+ * }
+ * \endcode
+ *
+ * If the size of the data chunk is zero or is larger than the file (for
+ * example, a recording that was not closed), the frames up to the end of the file are read.
+ *
+ */
+class WavReader : public api::FmtWorkObject {
+public:
+
+    enum {
+        BUFFER_SIZE = 1024 /*! The number of bytes read at a time when samples are converted */,
+        MAX_CHANNELS = 8 /*! The number of channels that can be read into dsp signals */
+    };
+
+    /*! \details Sample formats (the format code in the "fmt " chunk). */
+    enum {
+        FORMAT_PCM = 1 /*! Integer samples */,
+        FORMAT_FLOAT = 3 /*! IEEE float samples */,
+        FORMAT_EXTENSIBLE = 0xfffe /*! The format is in the extension of the "fmt " chunk */
+    };
+
+    WavReader();
+    ~WavReader();
+
+    /*! \details Opens the WAV file at \a path and parses the header.
+     *
+     * @return Zero on success or -1 if the file can't be opened or isn't a
+     * WAV file that can be read (errno is EINVAL)
+     */
+    int open(const var::ConstString & path);
+
+    /*! \details Closes the file. */
+    int close();
+
+    /*! \details Returns the sample format (FORMAT_PCM or FORMAT_FLOAT). */
+    u16 format() const { return m_format; }
+    /*! \details Returns the number of channels. */
+    u16 channels() const { return m_channels; }
+    /*! \details Returns the number of frames per second. */
+    u32 sample_rate() const { return m_sample_rate; }
+    /*! \details Returns the number of bits in each sample. */
+    u16 bits_per_sample() const { return m_bits_per_sample; }
+    /*! \details Returns the number of bytes in each frame. */
+    u16 block_align() const { return m_block_align; }
+    /*! \details Returns the number of frames in the file. */
+    u32 frame_count() const { return m_frame_count; }
+    /*! \details Returns the next frame that will be read. */
+    u32 frame() const { return m_frame; }
+    /*! \details Returns the offset of the first frame in the file. */
+    u32 data_offset() const { return m_data_offset; }
+
+    /*! \details Moves to \a frame.
+     *
+     * @return Zero on success or -1 if \a frame is past the end of the file
+     */
+    int seek(u32 frame);
+
+    /*! \details Reads frames as they are stored in the file (interleaved).
+     *
+     * @param buffer The destination (at least \a frames * block_align() bytes)
+     * @param frames The number of frames to read
+     * @return The number of frames read (zero at the end of the file) or -1 on error
+     */
+    int read(void * buffer, u32 frames);
+
+    /*! \details Reads and converts frames to q1.15 samples.
+     *
+     * @param channels An array of channels() pointers; each one must point to room for \a frames samples
+     * @param frames The number of frames to read
+     * @return The number of frames read (zero at the end of the file) or -1 on error
+     */
+    int read(s16 * const * channels, u32 frames);
+
+    /*! \details Reads and converts frames to q1.31 samples (see above). */
+    int read(s32 * const * channels, u32 frames);
+
+    /*! \details Reads and converts frames to float samples from -1.0 to 1.0 (see above). */
+    int read(float * const * channels, u32 frames);
+
+#if !defined __link
+    /*! \details Reads and converts frames into one signal per channel.
+     *
+     * @param signals An array of channels() signals
+     * @param frames The number of frames to read
+     * @return The number of frames read (zero at the end of the file) or -1 on error
+     *
+     * Each signal is resized to the number of frames that are read (it
+     * is only reallocated if it is too small).
+     *
+     */
+    int read(dsp::SignalQ15 * signals, u32 frames);
+
+    /*! \details Reads and converts frames into one signal per channel (see above). */
+    int read(dsp::SignalQ31 * signals, u32 frames);
+
+    /*! \details Reads and converts frames into one signal per channel (see above). */
+    int read(dsp::SignalF32 * signals, u32 frames);
+#endif
+
+private:
+    sys::File m_file;
+    var::Data m_buffer;
+    u32 m_sample_rate;
+    u32 m_data_offset;
+    u32 m_frame_count;
+    u32 m_frame;
+    u16 m_format;
+    u16 m_channels;
+    u16 m_bits_per_sample;
+    u16 m_block_align;
+
+    int parse_header();
+    template<typename T> int read_frames(T * const * channels, u32 frames);
+#if !defined __link
+    template<typename T, typename S> int read_signals(S * signals, u32 frames);
+#endif
+
+};
+
+}
+
+#endif /* FMT_WAVREADER_HPP_ */
@@ -0,0 +1,139 @@
+/*! \file */ //Copyright 2011-2018 Tyler Gilbert; All Rights Reserved
+
+#ifndef FMT_WAVWRITER_HPP_
+#define FMT_WAVWRITER_HPP_
+
+#include "../api/FmtObject.hpp"
+#include "../var/ConstString.hpp"
+#include "../var/Data.hpp"
+#include "../sys/File.hpp"
+#include "WavReader.hpp"
+
+namespace fmt {
+
+/*! \brief WAV Writer Class
+ * \details The WavWriter class writes a WAV file as samples are
+ * produced (for example, while recording from hal::I2S).
+ *
+ * The header is written when the file is created. The sizes in the
+ * header are updated when the file is closed (or when update_header() is
+ * called) so the file doesn't need to be written twice.
+ *
+ * \code
+ * #include <sapi/fmt.hpp>
+ * #include <sapi/dsp.hpp>
+ *
+ * WavWriter wav;
+ * wav.create("/home/recording.wav", 48000, 2, 16);
+ * SignalQ31 signals[2];
+ * //fill signals[0] (left) and signals[1] (right) with the same number of samples
+ * wav.write(signals);
+ * wav.close();
+ * \endcode
+ *
+ * Samples can be written as they are stored in the file (interleaved) or
+ * from one array (or dsp signal) per channel. q1.15, q1.31 and float
+ * samples are converted to the format of the file: 8, 16, 24 or 32 bit
+ * PCM or 32 bit float.
+ *
+ * A WAV file can't be larger than 4GB. write() fails with
+ * EFBIG when the file is full.
+ *
+ */
+class WavWriter : public api::FmtWorkObject {
+public:
+
+    enum {
+        BUFFER_SIZE = WavReader::BUFFER_SIZE /*! The number of bytes written at a time when samples are converted */,
+        HEADER_SIZE = 44 /*! The size of the header written by create() */
+    };
+
+    WavWriter();
+    ~WavWriter();
+
+    /*! \details Creates a WAV file and writes the header.
+     *
+     * @param path The path to the file (an existing file is replaced)
+     * @param sample_rate The number of frames per second
+     * @param channels The number of channels
+     * @param bits_per_sample 8, 16, 24 or 32
+     * @param format WavReader::FORMAT_PCM or WavReader::FORMAT_FLOAT (32 bits only)
+     * @return Zero on success or -1 on error
+     */
+    int create(const var::ConstString & path, u32 sample_rate, u16 channels, u16 bits_per_sample, u16 format = WavReader::FORMAT_PCM);
+
+    /*! \details Writes the sizes in the header and closes the file. */
+    int close();
+
+    /*! \details Writes the sizes in the header without closing the file.
+     *
+     * Call this once in a while during a long recording so the file is
+     * valid even if it is never closed.
+     */
+    int update_header();
+
+    /*! \details Returns the number of frames that have been written. */
+    u32 frame_count() const { return m_frame_count; }
+
+    /*! \details Returns the number of channels. */
+    u16 channels() const { return m_channels; }
+
+    /*! \details Returns the number of bytes in each frame. */
+    u16 block_align() const { return m_block_align; }
+
+    /*! \details Writes frames that are already in the format of the file (interleaved).
+     *
+     * @param buffer The frames (\a frames * block_align() bytes)
+     * @param frames The number of frames
+     * @return The number of frames written or -1 on error
+     */
+    int write(const void * buffer, u32 frames);
+
+    /*! \details Converts and writes q1.15 samples.
+     *
+     * @param channels An array of channels() pointers to \a frames samples each
+     * @param frames The number of frames
+     * @return The number of frames written or -1 on error
+     */
+    int write(const s16 * const * channels, u32 frames);
+
+    /*! \details Converts and writes q1.31 samples (see above). */
+    int write(const s32 * const * channels, u32 frames);
+
+    /*! \details Converts and writes float samples from -1.0 to 1.0 (see above). */
+    int write(const float * const * channels, u32 frames);
+
+#if !defined __link
+    /*! \details Converts and writes one signal per channel.
+     *
+     * @param signals An array of channels() signals with the same count()
+     * @return The number of frames written or -1 on error
+     */
+    int write(const dsp::SignalQ15 * signals);
+
+    /*! \details Converts and writes one signal per channel (see above). */
+    int write(const dsp::SignalQ31 * signals);
+
+    /*! \details Converts and writes one signal per channel (see above). */
+    int write(const dsp::SignalF32 * signals);
+#endif
+
+private:
+    sys::File m_file;
+    var::Data m_buffer;
+    u32 m_frame_count;
+    u16 m_format;
+    u16 m_channels;
+    u16 m_bits_per_sample;
+    u16 m_block_align;
+
+    template<typename T> int write_frames(const T * const * channels, u32 frames);
+#if !defined __link
+    template<typename T, typename S> int write_signals(const S * signals);
+#endif
+
+};
+
+}
+
+#endif /* FMT_WAVWRITER_HPP_ */
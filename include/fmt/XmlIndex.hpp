@@ -0,0 +1,183 @@
+/*! \file */ //Copyright 2011-2018 Tyler Gilbert; All Rights Reserved
+
+#ifndef FMT_XMLINDEX_HPP_
+#define FMT_XMLINDEX_HPP_
+
+#include "../api/FmtObject.hpp"
+#include "../var/ConstString.hpp"
+#include "../var/String.hpp"
+#include "../var/Data.hpp"
+#include "XmlReader.hpp"
+
+namespace sys {
+class File;
+}
+
+namespace fmt {
+
+/*! \cond */
+typedef struct {
+    u32 name; //name id
+    u32 text; //offset of the text in the string pool
+    u32 attributes; //offset of the first attribute name (names and values alternate)
+    u32 attribute_count;
+    u32 parent;
+    u32 first_child;
+    u32 next_sibling;
+    u32 children; //position of the children in the child table (sorted by name)
+    u32 child_count;
+    u32 offset; //offset of the element in the input
+    u32 size; //size of the element in the input
+} xml_index_element_t;
+/*! \endcond */
+
+/*! \brief XML Index Class
+ * \details The XmlIndex class reads an XML document once
+ * (using XmlReader) and keeps an index of its elements so that values
+ * can be looked up many times without reading the document again.
+ *
+ * For each element, the index has the name, the text, the attributes, the parent,
+ * the children, and the offset and size of the element in the input.
+ * Element names are stored once no matter how many times they are used. The
+ * children of each element are sorted by name so finding a key takes
+ * O(log n) time for each level of the key.
+ *
+ * Keys use the same syntax as Xml::get_value() (see the example file in Xml):
+ *
+ * - "gpx(version)" = 1.0
+ * - "gpx.wpt.ele" = 44.586548
+ * - "gpx.wpt[1].name" = 5067
+ * - "gpx.wpt[1](lat)" = 42.439227
+ *
+ * \code
+ * #include <sapi/fmt.hpp>
+ *
+ * XmlIndex xml;
+ * String value;
+ * if( xml.load("/home/track.gpx") == 0 ){
+ *   xml.get_value(value, "gpx.wpt[1].name");
+ *   s32 waypoint = xml.find("gpx.wpt");
+ *   while( waypoint >= 0 ){
+ *     printf("%s\n", xml.attribute(waypoint, "lat").str());
+ *     waypoint = xml.next_sibling(waypoint);
+ *   }
+ * }
+ * \endcode
+ *
+ * Elements are numbered in the order they start in the document. The
+ * text of an element is all of its text (not including the text of its children).
+ *
+ */
+class XmlIndex : public api::FmtWorkObject {
+public:
+
+    XmlIndex();
+
+    /*! \details Loads and indexes the file at \a path. */
+    int load(const var::ConstString & path);
+
+    /*! \details Loads and indexes the rest of \a file (offsets are from the current position of \a file). */
+    int load(const sys::File & file);
+
+    /*! \details Indexes the XML text \a xml. */
+    int parse(const var::ConstString & xml);
+
+    /*! \details Indexes all the events from \a reader.
+     *
+     * @return Zero on success or -1 if the XML is not valid (see XmlReader::next())
+     *
+     */
+    int parse(XmlReader & reader);
+
+    /*! \details Frees the memory used by the index. */
+    void clear();
+
+    /*! \details Returns the number of elements in the index. */
+    u32 count() const { return m_count; }
+
+    /*! \details Finds the element described by \a key.
+     *
+     * @param key The element to find (for example, "gpx.wpt[1]")
+     * @param element The element that \a key is relative to (-1 for the top level)
+     * @return The element index or -1 if the element isn't in the document
+     *
+     * An attribute at the end of \a key is ignored.
+     *
+     */
+    s32 find(const var::ConstString & key, s32 element = -1) const;
+
+    /*! \details Gets the text of an element or the value of an attribute.
+     *
+     * @param dest The destination for the value
+     * @param key The element or attribute (see above)
+     * @param element The element that \a key is relative to (-1 for the top level)
+     * @return Zero on success or -1 if \a key isn't in the document
+     *
+     */
+    int get_value(var::String & dest, const var::ConstString & key, s32 element = -1) const;
+
+    /*! \details Returns the name of \a element. */
+    var::ConstString name(u32 element) const;
+
+    /*! \details Returns the text of \a element. */
+    var::ConstString text(u32 element) const;
+
+    /*! \details Returns the number of attributes of \a element. */
+    u32 attribute_count(u32 element) const;
+
+    /*! \details Returns the value of the attribute called \a name (empty if \a element doesn't have it). */
+    var::ConstString attribute(u32 element, const var::ConstString & name) const;
+
+    /*! \details Returns the parent of \a element (or -1 for a top level element). */
+    s32 parent(u32 element) const;
+
+    /*! \details Returns the first child of \a element (-1 for the first top level element). */
+    s32 first_child(s32 element) const;
+
+    /*! \details Returns the next sibling of \a element (or -1 if it is the last). */
+    s32 next_sibling(u32 element) const;
+
+    /*! \details Returns the number of children of \a element (-1 for the number of top level elements). */
+    u32 child_count(s32 element) const;
+
+    /*! \details Returns the offset of \a element in the input (the position of its start tag). */
+    u32 offset(u32 element) const;
+
+    /*! \details Returns the number of bytes in the input from the start of \a element to the end of its end tag. */
+    u32 size(u32 element) const;
+
+    /*! \details Returns the position in the input where parsing failed. */
+    u32 error_position() const { return m_error_position; }
+
+private:
+    var::Data m_elements;
+    var::Data m_children;
+    var::Data m_strings;
+    var::Data m_names; //offset of each unique name in m_strings
+    var::Data m_name_table; //hash table of name ids
+    u32 m_count;
+    u32 m_string_size;
+    u32 m_name_count;
+    u32 m_root_count;
+    u32 m_error_position;
+
+    xml_index_element_t * elements(){ return (xml_index_element_t*)m_elements.data(); }
+    const xml_index_element_t * elements() const { return (const xml_index_element_t*)m_elements.data_const(); }
+    const char * string(u32 offset) const { return m_strings.cdata_const() + offset; }
+
+    int append_element();
+    int append_string(const char * value, u32 length);
+    int reserve_strings(u32 length);
+    s32 add_name(const char * name, u32 length);
+    s32 find_name(const char * name, u32 length) const;
+    int build_children();
+    s32 find_child(s32 element, u32 name, u32 index) const;
+    s32 find_element(const char * key, s32 element, const char ** attribute) const;
+
+    static u32 hash(const char * name, u32 length);
+
+};
+
+}
+
+#endif /* FMT_XMLINDEX_HPP_ */
@@ -0,0 +1,198 @@
+/*! \file */ //Copyright 2011-2018 Tyler Gilbert; All Rights Reserved
+
+#ifndef FMT_XMLREADER_HPP_
+#define FMT_XMLREADER_HPP_
+
+#include "../api/FmtObject.hpp"
+#include "../var/ConstString.hpp"
+#include "../var/Data.hpp"
+#include "ReaderInput.hpp"
+
+namespace sys {
+class File;
+}
+
+namespace fmt {
+
+/*! \brief XML Reader Class
+ * \details The XmlReader class parses XML text one event at a time
+ * (a pull parser) without building a tree.
+ *
+ * Xml::get_value() and Xml::find() search the file from the
+ * beginning for each query. XmlReader reads the input once, in
+ * blocks of BUFFER_SIZE bytes, and uses a fixed amount of memory: an input
+ * buffer, a buffer for the current name, a buffer for the current
+ * value (\a max_token_size bytes), and a buffer for the current path.
+ *
+ * \code
+ * #include <sapi/fmt.hpp>
+ * #include <sapi/sys.hpp>
+ *
+ * File f;
+ * f.open("/home/track.gpx", File::RDONLY);
+ * XmlReader xml(f);
+ * int event;
+ * while( (event = xml.next()) > XmlReader::END ){
+ *   if( event == XmlReader::ATTRIBUTE ){
+ *     printf("%s(%s) = %s\n", xml.path().str(), xml.name().str(), xml.value().str());
+ *   } else if( event == XmlReader::TEXT ){
+ *     printf("%s = %s\n", xml.path().str(), xml.value().str());
+ *   }
+ * }
+ * if( event == XmlReader::ERROR ){
+ *   printf("error at line %d column %d\n", xml.line(), xml.column());
+ * }
+ * \endcode
+ *
+ * The path of an element is the names of the elements that contain it
+ * separated with slashes (for example, "/gpx/wpt/name").
+ * An empty element (<wpt/>) creates a START_ELEMENT event followed by an
+ * END_ELEMENT event.
+ *
+ * Entities (&amp;lt; &amp;gt; &amp;amp; &amp;quot; &amp;apos; and character references) are
+ * decoded. CDATA sections are returned as TEXT events. Text that is only
+ * whitespace is skipped. The XML declaration, processing instructions,
+ * comments and the document type declaration are skipped.
+ *
+ */
+class XmlReader : public api::FmtWorkObject {
+public:
+
+    enum {
+        BUFFER_SIZE = 256 /*! The number of bytes read from a file or callback at a time */,
+        MAX_DEPTH = 31 /*! The maximum number of nested elements */,
+        MAX_NAME_SIZE = 63 /*! The longest element or attribute name */,
+        MAX_PATH_SIZE = 256 /*! The maximum length of path() */
+    };
+
+    /*! \details Events returned by next(). */
+    enum event {
+        ERROR = -1 /*! The input is not valid XML (or could not be read) */,
+        END /*! There is no more input */,
+        START_ELEMENT /*! An element starts (name() is the name of the element) */,
+        ATTRIBUTE /*! An attribute of the current element (name() and value()) */,
+        TEXT /*! Text in the current element (value() is the decoded text) */,
+        END_ELEMENT /*! An element ends (name() is the name of the element) */
+    };
+
+    /*! \details Constructs a reader for \a file.
+     *
+     * @param file The file to read (the reader doesn't open or close it)
+     * @param max_token_size The longest attribute value that can be read
+     */
+    XmlReader(const sys::File & file, u32 max_token_size = 256);
+
+    /*! \details Constructs a reader for XML text in \a data (the data is not copied). */
+    XmlReader(const var::Data & data, u32 max_token_size = 256);
+
+    /*! \details Constructs a reader that gets its input from \a callback (see reader_load_t). */
+    XmlReader(reader_load_t callback, void * context, u32 max_token_size = 256);
+
+    /*! \details Parses the next event.
+     *
+     * @return The event (see enum event); END when there is no more input and ERROR if the input is not valid
+     *
+     * After ERROR, next() keeps returning ERROR and error_number()
+     * is EINVAL for invalid XML, ENOSPC if a name, value or path is too long, or
+     * the error from reading the input.
+     *
+     * Text that is longer than \a max_token_size is returned in
+     * more than one TEXT event.
+     *
+     */
+    int next();
+
+    /*! \details Skips the rest of the current element.
+     *
+     * @return Zero on success or -1 if the input ends or can't be read
+     *
+     * Call this after next() returns START_ELEMENT (or ATTRIBUTE). The
+     * next call to next() returns the event after the matching END_ELEMENT.
+     *
+     */
+    int skip();
+
+    /*! \details Returns the last event returned by next(). */
+    int event() const { return m_event; }
+
+    /*! \details Returns the element name (START_ELEMENT, END_ELEMENT) or attribute name (ATTRIBUTE). */
+    var::ConstString name() const { return var::ConstString(m_name.cdata_const()); }
+
+    /*! \details Returns the attribute value (ATTRIBUTE) or text (TEXT) of the current event. */
+    var::ConstString value() const { return var::ConstString(m_token.cdata_const()); }
+
+    /*! \details Returns the number of bytes in value(). */
+    u32 value_length() const { return m_token_size; }
+
+    /*! \details Returns the path of the current element (see above). */
+    var::ConstString path() const { return var::ConstString(m_path.cdata_const()); }
+
+    /*! \details Returns the depth of the current element (1 for the top level element). */
+    u32 depth() const { return m_depth; }
+
+    /*! \details Returns the line number (starting at 1) of the current position. */
+    u32 line() const { return m_input.line(); }
+    /*! \details Returns the column number (starting at 1) of the current position. */
+    u32 column() const { return m_input.column(); }
+    /*! \details Returns the number of bytes parsed. */
+    u32 position() const { return m_input.position(); }
+
+    /*! \details Returns the position of the '<' that starts the current tag.
+     *
+     * After START_ELEMENT, this is the offset of the element in the input. After
+     * END_ELEMENT, position() is the offset of the byte after the element.
+     *
+     */
+    u32 tag_position() const { return m_tag_position; }
+
+private:
+    enum state {
+        STATE_CONTENT,
+        STATE_TEXT,
+        STATE_CDATA,
+        STATE_ATTRIBUTES,
+        STATE_END_ELEMENT
+    };
+
+    ReaderInput m_input;
+
+    var::Data m_name;
+    var::Data m_token;
+    u32 m_token_size;
+    var::Data m_path;
+    u32 m_path_length;
+
+    u16 m_path_offset[MAX_DEPTH+1];
+    u8 m_depth;
+    u8 m_state;
+    u8 m_bracket_count; //']' characters that might end a CDATA section
+    s8 m_event;
+
+    u32 m_tag_position;
+
+    void init(u32 max_token_size);
+    int next_event();
+    int fail(int error_number);
+    int skip_whitespace();
+    int skip_until(const char * terminator);
+    int skip_declaration();
+    int match(const char * text);
+    int parse_markup();
+    int parse_start_tag();
+    int parse_end_tag();
+    int parse_attribute(int c);
+    int parse_text();
+    int parse_cdata();
+    int parse_name(int c);
+    int parse_reference();
+    int push_token(char c);
+    int push_utf8(u32 code);
+    int open_element(u32 length);
+    void close_element();
+    void set_element_name();
+
+};
+
+}
+
+#endif /* FMT_XMLREADER_HPP_ */
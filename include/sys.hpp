@@ -14,7 +14,6 @@ namespace sys {}
 
 #if !defined __link
 #include "sys/Assets.hpp"
-#include "sys/Aio.hpp"
 #include "sys/Mq.hpp"
 #include "sys/Sem.hpp"
 #include "sys/Signal.hpp"
@@ -27,11 +26,20 @@ namespace sys {}
 #include "sys/Link.hpp"
 #endif
 
+#include "sys/Aio.hpp"
+#include "sys/AioQueue.hpp"
+#include "sys/AioStream.hpp"
 #include "sys/Mutex.hpp"
+#include "sys/Channel.hpp"
+#include "sys/Executor.hpp"
+#include "sys/Future.hpp"
 #include "sys/Thread.hpp"
+#include "sys/ThreadPool.hpp"
 #include "sys/Task.hpp"
+#include "sys/TaskMonitor.hpp"
 #include "sys/Cli.hpp"
 #include "sys/Printer.hpp"
+#include "sys/TraceRing.hpp"
 #include "sys/Sys.hpp"
 #include "sys/Appfs.hpp"
 #include "sys/Dir.hpp"
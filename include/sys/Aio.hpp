@@ -4,7 +4,7 @@
 #ifndef AIO_HPP_
 #define AIO_HPP_
 
-#ifndef __link
+#if !defined __win32
 
 #include <cstring>
 #include <errno.h>
@@ -18,6 +18,10 @@ class Device;
 
 namespace sys {
 
+class AioBatch;
+class AioQueue;
+class AioStream;
+
 /*! \brief Asynchronous IO Class */
 /*! \details The Asynchronous IO class is used for performing asynchronous operations on
  * hardware devices.  When calling synchronous IO, the read/write function is called and then
@@ -55,10 +59,19 @@ namespace sys {
  * }
  * \endcode
  *
+ * To start several operations at once (with one system call) use AioBatch. AioQueue
+ * calls a function when each operation completes and AioStream keeps a device
+ * supplied with buffers.
+ *
+ * On the desktop, Aio works with local file descriptors (from ::open()) using POSIX AIO.
+ * sys::File can't be used there because its descriptors refer to files on the device.
  *
  */
 class Aio : public api::SysWorkObject {
 	friend class hal::Device;
+	friend class AioBatch;
+	friend class AioQueue;
+	friend class AioStream;
 public:
 
 	/*! \details Constructs an empy AIO object. */
@@ -72,6 +85,7 @@ public:
 	 *
 	 */
 	Aio(volatile void * buf, int nbytes, int offset = 0){
+		memset(&m_aio_var, 0, sizeof(struct aiocb));
 		m_aio_var.aio_buf = buf;
 		m_aio_var.aio_nbytes = nbytes;
 		m_aio_var.aio_offset = offset;
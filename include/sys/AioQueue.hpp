@@ -0,0 +1,272 @@
+/*! \file */ //Copyright 2011-2018 Tyler Gilbert; All Rights Reserved
+
+#ifndef SYS_AIOQUEUE_HPP_
+#define SYS_AIOQUEUE_HPP_
+
+#if !defined __win32
+
+#include "Aio.hpp"
+#include "Executor.hpp"
+
+namespace sys {
+
+class File;
+
+/*! \brief Asynchronous IO Batch Class
+ * \details The AioBatch class starts a list of Aio operations with
+ * one call to lio_listio() rather than one aio_read() or aio_write()
+ * call for each operation.
+ *
+ * \code
+ * #include <sapi/sys.hpp>
+ *
+ * File file;
+ * file.open("/home/data.bin", File::READONLY);
+ *
+ * char header[64];
+ * char block[512];
+ * Aio header_aio(header, 64, 0);
+ * Aio block_aio(block, 512, 4096);
+ *
+ * AioBatch batch;
+ * batch.add_read(file, header_aio);
+ * batch.add_read(file, block_aio);
+ * batch.submit(); //both reads are started
+ *
+ * //do something else
+ *
+ * batch.suspend(); //wait for both to complete
+ * printf("read %d and %d bytes\n", header_aio.ret(), block_aio.ret());
+ * \endcode
+ *
+ * The Aio objects (and their buffers) must stay in scope until the
+ * operations complete.
+ *
+ */
+class AioBatch : public api::SysWorkObject {
+public:
+
+    enum {
+#if defined __link
+        MAX_COUNT = 32 /*! The maximum number of operations in a batch */
+#else
+        MAX_COUNT = 8 /*! The maximum number of operations in a batch */
+#endif
+    };
+
+    /*! \details Constructs an empty batch. */
+    AioBatch(){ clear(); }
+
+    /*! \details Adds a read of the file descriptor \a fd to the batch.
+     *
+     * @param fd The file descriptor to read (it must stay open)
+     * @param aio The buffer, size and offset (or channel) to read
+     * @return Zero on success or -1 if the batch is full (errno is ENOSPC)
+     *
+     */
+    int add_read(int fd, Aio & aio){ return add(fd, aio, LIO_READ); }
+
+    /*! \details Adds a write to the file descriptor \a fd to the batch (see add_read()). */
+    int add_write(int fd, Aio & aio){ return add(fd, aio, LIO_WRITE); }
+
+#if !defined __link
+    /*! \details Adds a read of \a file (or device) to the batch. */
+    int add_read(const File & file, Aio & aio);
+
+    /*! \details Adds a write to \a file (or device) to the batch. */
+    int add_write(const File & file, Aio & aio);
+#endif
+
+    /*! \details Starts all the operations in the batch and returns without waiting.
+     *
+     * @return Zero on success or -1 if any of the operations could not be started
+     *
+     * If an operation could not be started, its Aio::error() has the reason.
+     *
+     */
+    int submit();
+
+    /*! \details Starts all the operations and waits for them to complete.
+     *
+     * @return Zero if all of the operations succeeded or -1 if any failed
+     *
+     */
+    int execute();
+
+    /*! \details Waits for all the operations to complete.
+     *
+     * @param timeout_usec The maximum time to wait in microseconds (0 to wait indefinitely)
+     * @return Zero when all the operations are complete or -1 if the timeout elapsed (errno is EAGAIN)
+     *
+     */
+    int suspend(int timeout_usec = 0);
+
+    /*! \details Returns true if all the operations have completed. */
+    bool is_done() const;
+
+    /*! \details Returns the number of operations in the batch. */
+    u32 count() const { return m_count; }
+
+    /*! \details Returns the operation at \a idx. */
+    Aio & at(u32 idx) const { return *m_aios[idx]; }
+
+    /*! \details Removes all the operations (call after they have completed). */
+    void clear(){ m_count = 0; }
+
+private:
+    friend class AioQueue;
+
+    int add(int fd, Aio & aio, int opcode);
+
+    u32 m_count;
+    Aio * m_aios[MAX_COUNT];
+    struct aiocb * m_list[MAX_COUNT];
+};
+
+/*! \brief Asynchronous IO Queue Class
+ * \details The AioQueue class keeps track of Aio operations that are in
+ * progress and calls a function for each one as it completes.
+ *
+ * process() waits for at least one operation to complete then calls the
+ * functions of all the operations that have completed. The functions are
+ * called on the thread that calls process() unless an Executor
+ * is set with set_executor(). The executor can be an ev::EventLoop
+ * (the completion is handled on the UI thread) or a ThreadPool.
+ *
+ * \code
+ * #include <sapi/sys.hpp>
+ * #include <sapi/hal.hpp>
+ *
+ * static void handle_samples(void * context, Aio & aio){
+ *   int bytes = aio.ret();
+ *   //use the samples
+ * }
+ *
+ * Adc adc(0);
+ * adc.init();
+ *
+ * AioQueue queue;
+ * Aio aio[4];
+ * //the buffers are set up with Aio::set_buf()
+ * for(u32 i=0; i < 4; i++){
+ *   queue.read(adc, aio[i], handle_samples);
+ * }
+ *
+ * while( queue.pending() ){
+ *   queue.process(); //calls handle_samples() as each read completes
+ * }
+ * \endcode
+ *
+ * The operations are started and process() is called on one thread.
+ *
+ */
+class AioQueue : public api::SysWorkObject {
+public:
+
+    /*! \details The function called when an operation completes.
+     *
+     * The function should call Aio::ret() to get the number of bytes
+     * transferred (or -1 if the operation failed).
+     *
+     */
+    typedef void (*callback_t)(void * context, Aio & aio);
+
+    /*! \details Constructs a new queue.
+     *
+     * @param count The maximum number of operations in progress at the same time
+     *
+     * Use is_valid() to check if the memory was allocated. The queue
+     * must not be destroyed until pending() is zero.
+     *
+     */
+    AioQueue(u32 count = AioBatch::MAX_COUNT);
+    ~AioQueue();
+
+    /*! \details Returns true if the memory for the queue was allocated. */
+    bool is_valid() const { return m_entries != 0; }
+
+    /*! \details Sets where the completion functions are executed (null to call them from process()). */
+    void set_executor(Executor * executor){ m_executor = executor; }
+
+    /*! \details Starts reading \a fd and calls \a callback when it completes.
+     *
+     * @return Zero on success or -1 if the queue is full (EAGAIN) or the read could not be started
+     *
+     */
+    int read(int fd, Aio & aio, callback_t callback, void * context = 0){ return start(fd, aio, LIO_READ, callback, context); }
+
+    /*! \details Starts writing \a fd and calls \a callback when it completes (see read()). */
+    int write(int fd, Aio & aio, callback_t callback, void * context = 0){ return start(fd, aio, LIO_WRITE, callback, context); }
+
+#if !defined __link
+    /*! \details Starts reading \a file (or device) and calls \a callback when it completes. */
+    int read(const File & file, Aio & aio, callback_t callback, void * context = 0);
+
+    /*! \details Starts writing \a file (or device) and calls \a callback when it completes. */
+    int write(const File & file, Aio & aio, callback_t callback, void * context = 0);
+#endif
+
+    /*! \details Starts all the operations in \a batch.
+     *
+     * @param batch The operations to start (see AioBatch)
+     * @param callback The function to call when each operation completes
+     * @param context The first argument passed to \a callback
+     * @return Zero on success or -1 if there isn't room for the whole batch (EAGAIN)
+     * or an operation could not be started
+     *
+     * If some of the operations were started and others were not (errno is EIO),
+     * all of them are still passed to \a callback (Aio::ret() is -1 for
+     * the ones that failed). Otherwise, \a callback is not called for a batch that
+     * could not be started.
+     *
+     */
+    int submit(AioBatch & batch, callback_t callback, void * context = 0);
+
+    /*! \details Waits for operations to complete and handles them.
+     *
+     * @param timeout_usec The maximum time to wait in microseconds (0 to wait indefinitely)
+     * @return The number of operations that completed (zero if the timeout elapsed)
+     * or -1 if there are no operations in progress (EINVAL)
+     *
+     */
+    int process(int timeout_usec = 0);
+
+    /*! \details Handles any operations that have completed without waiting.
+     *
+     * @return The number of operations that completed
+     *
+     */
+    int process_completed();
+
+    /*! \details Returns the number of operations in progress (or waiting for their function to be called). */
+    u32 pending() const { return __atomic_load_n(&m_pending, __ATOMIC_ACQUIRE); }
+
+    /*! \details Returns the maximum number of operations. */
+    u32 count() const { return m_count; }
+
+private:
+    typedef struct {
+        Aio * aio;
+        callback_t callback;
+        void * context;
+        AioQueue * queue;
+        u32 state;
+    } entry_t;
+
+    entry_t * m_entries;
+    struct aiocb ** m_list;
+    u32 m_count;
+    u32 m_pending;
+    Executor * m_executor;
+
+    entry_t * add(Aio & aio, callback_t callback, void * context);
+    int start(int fd, Aio & aio, int opcode, callback_t callback, void * context);
+    void complete(entry_t * entry);
+    static void * execute_callback(void * args);
+};
+
+}
+
+#endif
+
+#endif /* SYS_AIOQUEUE_HPP_ */
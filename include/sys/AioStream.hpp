@@ -0,0 +1,153 @@
+/*! \file */ //Copyright 2011-2018 Tyler Gilbert; All Rights Reserved
+
+#ifndef SYS_AIOSTREAM_HPP_
+#define SYS_AIOSTREAM_HPP_
+
+#if !defined __win32
+
+#include "Aio.hpp"
+#include "../var/Data.hpp"
+
+namespace sys {
+
+class File;
+
+/*! \brief Asynchronous IO Stream Class
+ * \details The AioStream class keeps a device (or file) busy by
+ * always having an operation in progress. While the application handles one
+ * buffer, the device fills (or empties) the other one (double buffering or ping-pong).
+ *
+ * The stream is driven by calling update(). It waits for the oldest buffer,
+ * passes it to the callback then starts the next operation with it.
+ *
+ * \code
+ * #include <sapi/sys.hpp>
+ * #include <sapi/hal.hpp>
+ *
+ * static int handle_samples(void * context, void * buffer, u32 size){
+ *   //process the samples while the Adc fills the other buffer
+ *   return 0; //or -1 to stop
+ * }
+ *
+ * Adc adc(0);
+ * adc.init();
+ *
+ * AioStream stream(512); //two 512 byte buffers
+ * stream.start(adc, AioStream::READ, handle_samples, 0, 0); //reads channel 0
+ * while( stream.update() >= 0 ){
+ *   //update() returns after each buffer is handled
+ * }
+ * \endcode
+ *
+ * When writing (to a Dac or I2S for example), the callback fills the buffer
+ * and returns the number of bytes to write (zero to finish).
+ *
+ * For files, pass \a is_sequential to start() so that each operation
+ * uses the next offset. For devices, the offset is usually a channel and stays the same.
+ *
+ */
+class AioStream : public api::SysWorkObject {
+public:
+
+    /*! \details The function that handles each buffer.
+     *
+     * For READ, \a size is the number of bytes read. The return value
+     * is less than zero to stop the stream.
+     *
+     * For WRITE, \a size is the size of the buffer. The function fills the
+     * buffer and returns the number of bytes to write (zero to stop).
+     *
+     */
+    typedef int (*callback_t)(void * context, void * buffer, u32 size);
+
+    enum {
+        READ /*! Read from the device */,
+        WRITE /*! Write to the device */
+    };
+
+    enum {
+        MAX_BUFFER_COUNT = 4 /*! The maximum number of buffers */
+    };
+
+    /*! \details Constructs a new stream.
+     *
+     * @param buffer_size The number of bytes in each buffer
+     * @param buffer_count The number of buffers (2 to MAX_BUFFER_COUNT)
+     *
+     * Use is_valid() to check if the buffers were allocated.
+     *
+     */
+    AioStream(u32 buffer_size, u32 buffer_count = 2);
+
+    /*! \details Waits for any operations in progress to complete. */
+    ~AioStream();
+
+    /*! \details Returns true if the buffers were allocated. */
+    bool is_valid() const { return m_data.capacity() != 0; }
+
+    /*! \details Starts streaming data from or to the file descriptor \a fd.
+     *
+     * @param fd The file descriptor (it must stay open until the stream stops)
+     * @param direction READ or WRITE
+     * @param callback The function that handles each buffer
+     * @param context The first argument passed to \a callback
+     * @param offset The offset (or channel) for the operations
+     * @param is_sequential True to increment the offset after each operation (for files)
+     * @return Zero on success or -1 if the stream is already running (EBUSY) or the operations could not be started
+     *
+     * For WRITE, \a callback is called to fill each buffer before this method returns.
+     *
+     */
+    int start(int fd, int direction, callback_t callback, void * context = 0, int offset = 0, bool is_sequential = false);
+
+#if !defined __link
+    /*! \details Starts streaming data from or to \a file (or device) (see start() above). */
+    int start(const File & file, int direction, callback_t callback, void * context = 0, int offset = 0, bool is_sequential = false);
+#endif
+
+    /*! \details Waits for the next buffer and handles it.
+     *
+     * @param timeout_usec The maximum time to wait in microseconds (0 to wait indefinitely)
+     * @return The number of bytes read or written, zero if the timeout elapsed,
+     * or -1 if the stream has stopped (error_number() is set if an operation failed)
+     *
+     */
+    int update(int timeout_usec = 0);
+
+    /*! \details Stops the stream once the operations in progress have completed.
+     *
+     * The data from reads that are in progress is discarded.
+     *
+     */
+    void stop();
+
+    /*! \details Returns true if the stream has operations in progress. */
+    bool is_running() const { return m_active_count > 0; }
+
+    /*! \details Returns the offset for the next operation. */
+    int offset() const { return m_offset; }
+
+private:
+    int submit(u32 idx, u32 nbytes);
+    void * buffer(u32 idx) const { return (char*)m_data.data() + idx*m_buffer_size; }
+
+    var::Data m_data;
+    Aio m_aio[MAX_BUFFER_COUNT];
+    u32 m_buffer_size;
+    u32 m_buffer_count;
+    u32 m_current;
+    u32 m_active_count;
+    int m_fd;
+    int m_direction;
+    int m_offset;
+    bool m_is_sequential;
+    bool m_is_stopping;
+    callback_t m_callback;
+    void * m_context;
+};
+
+}
+
+#endif
+
+#endif /* SYS_AIOSTREAM_HPP_ */
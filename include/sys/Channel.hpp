@@ -0,0 +1,280 @@
+/*! \file */ //Copyright 2011-2018 Tyler Gilbert; All Rights Reserved
+
+#ifndef SYS_CHANNEL_HPP_
+#define SYS_CHANNEL_HPP_
+
+#if !defined __win32
+
+#include <new>
+#include <cstdlib>
+#include <semaphore.h>
+#include "../api/SysObject.hpp"
+#include "../chrono/ClockTime.hpp"
+
+namespace sys {
+
+/*! \brief Channel Object
+ * \details The ChannelObject manages the positions and the
+ * semaphores used by the Channel template class. Applications
+ * should use Channel rather than this class.
+ *
+ */
+class ChannelObject : public api::SysWorkObject {
+public:
+
+    /*! \details Returns the number of items the channel can hold. */
+    u32 count() const { return m_count; }
+
+    /*! \details Returns the number of items in the channel.
+     *
+     * When other threads are pushing and popping, the value
+     * is only a snapshot.
+     *
+     */
+    u32 calc_used() const;
+
+    /*! \details Returns true if the channel was created successfully. */
+    bool is_valid() const { return m_count != 0; }
+
+protected:
+    ChannelObject(u32 count, u32 cell_size);
+    ~ChannelObject();
+
+    enum {
+        WAIT_BLOCK,
+        WAIT_TRY,
+        WAIT_TIMED
+    };
+
+    int wait_free(int type, const chrono::ClockTime & timeout){ return wait(&m_free, type, timeout); }
+    int wait_used(int type, const chrono::ClockTime & timeout){ return wait(&m_used, type, timeout); }
+    void post_free(){ sem_post(&m_free); }
+    void post_used(){ sem_post(&m_used); }
+
+    static void yield();
+
+    u32 m_count;
+    u32 m_enqueue_position;
+#if defined __link
+    //keeps producers and consumers on separate cache lines
+    u8 m_padding[60];
+#endif
+    u32 m_dequeue_position;
+
+private:
+    //the semaphores and cells can't be shared by two objects
+    ChannelObject(const ChannelObject & a);
+    ChannelObject & operator = (const ChannelObject & a);
+
+    int wait(sem_t * sem, int type, const chrono::ClockTime & timeout);
+
+    sem_t m_free;
+    sem_t m_used;
+};
+
+/*! \brief Channel Class
+ * \details The Channel class is a bounded first-in first-out
+ * queue that any number of threads can push to and pop from.
+ *
+ * Items are stored in a fixed array of cells that each have
+ * a sequence number. Producers and consumers claim cells by
+ * atomically advancing a position so they do not serialize on a
+ * lock. Threads that can't proceed (the channel is full for
+ * producers or empty for consumers) sleep on a semaphore rather
+ * than polling.
+ *
+ * Items are copied by value so \a T can be a plain data structure
+ * or a pointer to a larger object.
+ *
+ * \code
+ * #include <sapi/sys.hpp>
+ *
+ * Channel<u32> channel(64);
+ *
+ * //producer thread
+ * channel.push(100);
+ *
+ * //consumer thread
+ * u32 value;
+ * if( channel.pop_timed(value, ClockTime(1, 0)) < 0 ){
+ *   //nothing arrived in one second
+ * }
+ * \endcode
+ *
+ * Unlike sys::Mq, the data does not pass through the kernel and
+ * there is no limit on the size of \a T.
+ *
+ */
+template<typename T> class Channel : public ChannelObject {
+public:
+
+    /*! \details Constructs a new channel.
+     *
+     * @param count The number of items the channel can hold (rounded up to a power of two)
+     *
+     * Use is_valid() to check if the memory was allocated. If \a count
+     * cells don't fit in the address space, the error number is ENOMEM.
+     *
+     */
+    Channel(u32 count) : ChannelObject(count, sizeof(cell_t)){
+        if( m_count == 0 ){
+            m_cells = 0;
+            return;
+        }
+        m_cells = (cell_t*)set_error_number_if_null(malloc(m_count*sizeof(cell_t)));
+        if( m_cells == 0 ){
+            m_count = 0;
+            return;
+        }
+        for(u32 i=0; i < m_count; i++){
+            m_cells[i].sequence = i;
+        }
+    }
+
+    ~Channel(){
+        if( m_cells ){
+            for(u32 i=m_dequeue_position; i != m_enqueue_position; i++){
+                m_cells[i & (m_count-1)].value.~T();
+            }
+            ::free(m_cells);
+        }
+    }
+
+    /*! \details Pushes an item on the channel.
+     *
+     * @param value The item to push
+     * @return Zero on success
+     *
+     * If the channel is full, this method blocks until another
+     * thread pops an item.
+     *
+     */
+    int push(const T & value){
+        return push(value, WAIT_BLOCK, chrono::ClockTime());
+    }
+
+    /*! \details Pushes an item on the channel or times out.
+     *
+     * @param value The item to push
+     * @param timeout The maximum amount of time to wait for space
+     * @return Zero on success or -1 with error_number() set to ETIMEDOUT
+     *
+     */
+    int push_timed(const T & value, const chrono::ClockTime & timeout){
+        return push(value, WAIT_TIMED, timeout);
+    }
+
+    /*! \details Pushes an item on the channel if there is space.
+     *
+     * @return Zero on success or -1 with error_number() set to EAGAIN if the channel is full
+     */
+    int try_push(const T & value){
+        return push(value, WAIT_TRY, chrono::ClockTime());
+    }
+
+    /*! \details Pops an item from the channel.
+     *
+     * @param value A reference to the destination
+     * @return Zero on success
+     *
+     * If the channel is empty, this method blocks until another
+     * thread pushes an item.
+     *
+     */
+    int pop(T & value){
+        return pop(value, WAIT_BLOCK, chrono::ClockTime());
+    }
+
+    /*! \details Pops an item from the channel or times out.
+     *
+     * @param value A reference to the destination
+     * @param timeout The maximum amount of time to wait for an item
+     * @return Zero on success or -1 with error_number() set to ETIMEDOUT
+     *
+     */
+    int pop_timed(T & value, const chrono::ClockTime & timeout){
+        return pop(value, WAIT_TIMED, timeout);
+    }
+
+    /*! \details Pops an item from the channel if one is available.
+     *
+     * @return Zero on success or -1 with error_number() set to EAGAIN if the channel is empty
+     */
+    int try_pop(T & value){
+        return pop(value, WAIT_TRY, chrono::ClockTime());
+    }
+
+private:
+    typedef struct {
+        u32 sequence;
+        T value;
+    } cell_t;
+
+    cell_t * m_cells;
+
+    int push(const T & value, int type, const chrono::ClockTime & timeout){
+        if( wait_free(type, timeout) < 0 ){
+            return -1;
+        }
+
+        cell_t * cell;
+        u32 position = __atomic_load_n(&m_enqueue_position, __ATOMIC_RELAXED);
+        for(;;){
+            cell = m_cells + (position & (m_count-1));
+            s32 difference = (s32)(__atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE) - position);
+            if( difference == 0 ){
+                if( __atomic_compare_exchange_n(&m_enqueue_position, &position, position+1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED) ){
+                    break;
+                }
+            } else {
+                if( difference < 0 ){
+                    //a consumer is still copying out of this cell
+                    yield();
+                }
+                position = __atomic_load_n(&m_enqueue_position, __ATOMIC_RELAXED);
+            }
+        }
+
+        new((void*)&cell->value) T(value);
+        __atomic_store_n(&cell->sequence, position+1, __ATOMIC_RELEASE);
+        post_used();
+        return 0;
+    }
+
+    int pop(T & value, int type, const chrono::ClockTime & timeout){
+        if( wait_used(type, timeout) < 0 ){
+            return -1;
+        }
+
+        cell_t * cell;
+        u32 position = __atomic_load_n(&m_dequeue_position, __ATOMIC_RELAXED);
+        for(;;){
+            cell = m_cells + (position & (m_count-1));
+            s32 difference = (s32)(__atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE) - (position+1));
+            if( difference == 0 ){
+                if( __atomic_compare_exchange_n(&m_dequeue_position, &position, position+1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED) ){
+                    break;
+                }
+            } else {
+                if( difference < 0 ){
+                    //a producer is still copying into this cell
+                    yield();
+                }
+                position = __atomic_load_n(&m_dequeue_position, __ATOMIC_RELAXED);
+            }
+        }
+
+        value = cell->value;
+        cell->value.~T();
+        __atomic_store_n(&cell->sequence, position + m_count, __ATOMIC_RELEASE);
+        post_free();
+        return 0;
+    }
+
+};
+
+}
+
+#endif
+
+#endif /* SYS_CHANNEL_HPP_ */
@@ -0,0 +1,40 @@
+/*! \file */ //Copyright 2011-2018 Tyler Gilbert; All Rights Reserved
+
+#ifndef SYS_EXECUTOR_HPP_
+#define SYS_EXECUTOR_HPP_
+
+namespace sys {
+
+/*! \brief Executor Class
+ * \details An Executor is something that can run a function later on
+ * another thread or at a better time: sys::ThreadPool runs it on a
+ * worker and ev::EventLoop runs it on the thread that executes the loop.
+ *
+ * Classes that hand work to other code (such as Future::then()) take an
+ * Executor so the application decides where the work runs.
+ *
+ */
+class Executor {
+public:
+
+    /*! \details The function that is executed (the same as Thread::handler_function_t). */
+    typedef void * (*function_t)(void * args);
+
+    virtual ~Executor(){}
+
+    /*! \details Queues \a function to be executed.
+     *
+     * @param function The function to execute
+     * @param args The argument passed to \a function
+     * @return Zero if the function was queued or -1 if it could not be
+     *
+     * The return value of \a function is ignored.
+     *
+     */
+    virtual int post(function_t function, void * args) = 0;
+
+};
+
+}
+
+#endif /* SYS_EXECUTOR_HPP_ */
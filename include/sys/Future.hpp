@@ -0,0 +1,416 @@
+/*! \file */ //Copyright 2011-2018 Tyler Gilbert; All Rights Reserved
+
+#ifndef SYS_FUTURE_HPP_
+#define SYS_FUTURE_HPP_
+
+#if !defined __win32
+
+#include <new>
+#include <errno.h>
+#include <pthread.h>
+#include "../api/SysObject.hpp"
+#include "../chrono/ClockTime.hpp"
+#include "Executor.hpp"
+
+namespace sys {
+
+template<typename T> class Future;
+template<typename T> class Promise;
+class FutureContinuation;
+
+/*! \brief Future State
+ * \details The FutureState class holds the state shared by a Promise
+ * and its Futures (whether the result is ready, the error and the functions
+ * to call when it is). Applications should use Promise and Future rather
+ * than this class.
+ *
+ * The state is reference counted and deleted when the last Promise or
+ * Future using it is destroyed.
+ *
+ */
+class FutureState {
+public:
+
+    enum {
+        PENDING,
+        READY,
+        FAILED
+    };
+
+    FutureState();
+    virtual ~FutureState();
+
+    void reference(){ __atomic_add_fetch(&m_reference_count, 1, __ATOMIC_RELAXED); }
+    void release(){
+        if( __atomic_sub_fetch(&m_reference_count, 1, __ATOMIC_ACQ_REL) == 0 ){
+            delete this;
+        }
+    }
+
+    int state() const { return __atomic_load_n(&m_state, __ATOMIC_ACQUIRE); }
+    bool is_pending() const { return state() == PENDING; }
+    bool is_failed() const { return state() == FAILED; }
+    int error() const { return m_error; }
+
+    void lock(){ pthread_mutex_lock(&m_mutex); }
+    void unlock(){ pthread_mutex_unlock(&m_mutex); }
+
+    //must be called with the lock held; unlocks and runs the continuations
+    void complete(int error);
+
+    int fail(int error);
+    int wait(const chrono::ClockTime * timeout);
+    void add_continuation(FutureContinuation * continuation);
+
+private:
+    u32 m_reference_count;
+    u32 m_state;
+    int m_error;
+    pthread_mutex_t m_mutex;
+    pthread_cond_t m_cond;
+    FutureContinuation * m_continuations;
+};
+
+/*! \brief Future Value
+ * \details The FutureValue class adds storage for the value to FutureState.
+ */
+template<typename T> class FutureValue : public FutureState {
+public:
+    int set_value(const T & value){
+        lock();
+        if( !is_pending() ){
+            unlock();
+            return -1;
+        }
+        m_value = value;
+        complete(0);
+        return 0;
+    }
+
+    T m_value;
+};
+
+/*! \brief Future Continuation
+ * \details A FutureContinuation is a function that is called when a
+ * future is ready (see Future::then()). It is used internally.
+ */
+class FutureContinuation {
+public:
+    typedef void (*invoke_t)(FutureContinuation * continuation);
+    typedef void (*callback_t)();
+
+    FutureContinuation(FutureState * source, FutureState * target, invoke_t invoke, callback_t function, void * context, Executor * executor);
+    ~FutureContinuation();
+
+    //runs the continuation on the executor (or immediately if there isn't one)
+    void dispatch();
+
+    FutureState * m_source;
+    FutureState * m_target;
+    invoke_t m_invoke;
+    callback_t m_function;
+    void * m_context;
+    Executor * m_executor;
+    u32 m_index; //position in when_all() and when_any()
+    FutureContinuation * m_next;
+
+private:
+    static void * execute(void * args);
+};
+
+/*! \brief Future Object
+ * \details The FutureObject class has the methods of Future that
+ * don't depend on the type of the value. It is also used to pass futures
+ * of different types to when_all() and when_any().
+ *
+ */
+class FutureObject : public api::SysWorkObject {
+public:
+
+    ~FutureObject();
+
+    FutureObject & operator = (const FutureObject & a);
+
+    /*! \details Returns true if the future is associated with a Promise. */
+    bool is_valid() const { return m_shared != 0; }
+
+    /*! \details Returns true if the value or an error has been set. */
+    bool is_ready() const { return m_shared && !m_shared->is_pending(); }
+
+    /*! \details Returns true if the promise failed (see Promise::set_error()). */
+    bool is_failed() const { return m_shared && m_shared->is_failed(); }
+
+    /*! \details Waits until the future is ready.
+     *
+     * @return Zero when the future is ready (or failed) and -1 if the future isn't valid
+     *
+     */
+    int wait() const { return wait(0); }
+
+    /*! \details Waits until the future is ready or \a timeout has elapsed.
+     *
+     * @param timeout The maximum time to wait
+     * @return Zero when the future is ready (or failed) or -1 if the timeout elapsed (errno is ETIMEDOUT)
+     *
+     */
+    int wait(const chrono::ClockTime & timeout) const { return wait(&timeout); }
+
+    /*! \details Returns a future that is ready when all of \a futures are ready.
+     *
+     * @param futures A list of futures (of any type)
+     * @param count The number of futures in the list
+     * @return A future whose value is \a count
+     *
+     * If any of the futures fail, the returned future fails with the error of the first one
+     * to fail (once all of them are ready).
+     *
+     */
+    static Future<u32> when_all(const FutureObject * const * futures, u32 count);
+
+    /*! \details Returns a future that is ready when any of \a futures is ready.
+     *
+     * @param futures A list of futures (of any type)
+     * @param count The number of futures in the list
+     * @return A future whose value is the index of the first future that is ready (or failed)
+     *
+     */
+    static Future<u32> when_any(const FutureObject * const * futures, u32 count);
+
+protected:
+    FutureObject(FutureState * shared = 0);
+    FutureObject(const FutureObject & a);
+
+    int wait(const chrono::ClockTime * timeout) const;
+    int get_state() const;
+    void add_continuation(FutureState * target, FutureContinuation::invoke_t invoke, FutureContinuation::callback_t function, void * context, Executor * executor) const;
+
+    FutureState * m_shared;
+
+private:
+    static Future<u32> when(const FutureObject * const * futures, u32 count, bool is_any);
+    static void invoke_group(FutureContinuation * continuation);
+};
+
+/*! \brief Future Class
+ * \details A Future is the result of work that is done somewhere else
+ * (another thread, a ThreadPool, an interrupt handler). The code doing the work holds the Promise and sets
+ * the value (or an error) when it is done. The code that needs the result holds the Future and
+ * can:
+ *
+ * - wait for the value with get() (optionally with a timeout)
+ * - check is_ready() without blocking
+ * - attach a function with then() that is called with the value when it is ready
+ *
+ * \code
+ * #include <sapi/sys.hpp>
+ *
+ * typedef struct {
+ *   Promise<u32> promise;
+ *   const char * path;
+ * } load_t;
+ *
+ * static void * load_file(void * args){
+ *   load_t * load = (load_t*)args;
+ *   //read the file ...
+ *   load->promise.set_value(bytes_read);
+ *   return 0;
+ * }
+ *
+ * static int check_size(const u32 & size, bool & result, void * context){
+ *   result = size > 0;
+ *   return 0; //or an error number to fail the next future
+ * }
+ *
+ * ThreadPool pool;
+ * pool.create();
+ * load_t load;
+ * load.path = "/home/data.bin";
+ * Future<u32> size = load.promise.get_future();
+ * pool.post(load_file, &load);
+ *
+ * //check_size() runs on the pool as soon as the file is loaded
+ * Future<bool> is_ok = size.then(check_size, 0, &pool);
+ *
+ * bool value;
+ * if( is_ok.get(value, ClockTime(5, 0)) < 0 ){
+ *   //timed out or failed: error_number() has the reason
+ * }
+ * \endcode
+ *
+ * Futures can be copied; all the copies refer to the same result.
+ * The value type \a T must have a default constructor and be assignable.
+ *
+ */
+template<typename T> class Future : public FutureObject {
+    template<typename U> friend class Future;
+    friend class Promise<T>;
+    friend class FutureObject;
+public:
+
+    /*! \details Constructs an invalid future (see Promise::get_future()). */
+    Future(){}
+
+    /*! \details Waits for the value.
+     *
+     * @param value Where to copy the value
+     * @return Zero on success or -1 if the promise failed (error_number() is the error
+     * passed to Promise::set_error()) or the future is not valid (EINVAL)
+     *
+     */
+    int get(T & value) const { return get(value, 0); }
+
+    /*! \details Waits for the value for up to \a timeout.
+     *
+     * @return Zero on success or -1 if the timeout elapsed (errno is ETIMEDOUT) or the promise failed
+     *
+     */
+    int get(T & value, const chrono::ClockTime & timeout) const { return get(value, &timeout); }
+
+    /*! \details Returns the value without waiting (only valid if is_ready() is true and is_failed() is false). */
+    const T & value() const { return ((FutureValue<T>*)m_shared)->m_value; }
+
+    /*! \details Calls \a function with the value when it is ready.
+     *
+     * @param function The function to call: it sets \a result and returns zero on success or an error number
+     * @param context The last argument passed to \a function
+     * @param executor Where to run \a function (null to run it on the thread that sets the value)
+     * @return A future for the result of \a function
+     *
+     * If this future fails, \a function is not called and the returned
+     * future fails with the same error. If this future is already ready,
+     * \a function is executed (or posted) before this method returns.
+     *
+     * Continuations can be chained to make a pipeline where each step
+     * runs on the executor that suits it (for example, compute on a ThreadPool and
+     * updating the display on the ev::EventLoop) without any thread
+     * blocking.
+     *
+     */
+    template<typename U> Future<U> then(int (*function)(const T & value, U & result, void * context), void * context = 0, Executor * executor = 0) const {
+        FutureValue<U> * target = new (std::nothrow) FutureValue<U>();
+        Future<U> result(target);
+        if( target == 0 ){
+            set_error_number(ENOMEM);
+            return result;
+        }
+        //the continuation owns the first reference to the target
+        add_continuation(target, invoke_then<U>, (FutureContinuation::callback_t)function, context, executor);
+        return result;
+    }
+
+private:
+    Future(FutureState * shared) : FutureObject(shared){}
+
+    int get(T & value, const chrono::ClockTime * timeout) const {
+        if( wait(timeout) < 0 ){
+            return -1;
+        }
+        if( get_state() < 0 ){
+            return -1;
+        }
+        value = this->value();
+        return 0;
+    }
+
+    template<typename U> static void invoke_then(FutureContinuation * continuation){
+        typedef int (*then_function_t)(const T & value, U & result, void * context);
+        FutureValue<U> * target = (FutureValue<U>*)continuation->m_target;
+        U result;
+        int error;
+
+        if( continuation->m_source->is_failed() ){
+            target->fail(continuation->m_source->error());
+            return;
+        }
+
+        error = ((then_function_t)continuation->m_function)(((FutureValue<T>*)continuation->m_source)->m_value, result, continuation->m_context);
+        if( error ){
+            target->fail(error);
+        } else {
+            target->set_value(result);
+        }
+    }
+};
+
+/*! \brief Promise Class
+ * \details A Promise is the side of a Future that sets the value (see Future for an example).
+ *
+ * The value (or an error) can only be set once. If the Promise is
+ * destroyed without setting either, its futures fail with EPIPE.
+ *
+ * set_value() and set_error() can be called from any thread. Any
+ * continuations (see Future::then()) without an executor run on
+ * that thread before the method returns.
+ *
+ */
+template<typename T> class Promise : public api::SysWorkObject {
+public:
+
+    /*! \details Constructs a new promise (use is_valid() to check that the memory was allocated). */
+    Promise(){
+        m_shared = new (std::nothrow) FutureValue<T>();
+    }
+
+    ~Promise(){
+        if( m_shared ){
+            m_shared->fail(EPIPE);
+            m_shared->release();
+        }
+    }
+
+    /*! \details Returns true if the promise was created successfully. */
+    bool is_valid() const { return m_shared != 0; }
+
+    /*! \details Returns a future for the value of this promise. */
+    Future<T> get_future() const { return Future<T>(m_shared); }
+
+    /*! \details Sets the value and wakes any threads waiting on the future.
+     *
+     * @return Zero on success or -1 if the value or error was already set (errno is EBUSY)
+     *
+     */
+    int set_value(const T & value){
+        if( m_shared == 0 ){
+            set_error_number(ENOMEM);
+            return -1;
+        }
+        if( m_shared->set_value(value) < 0 ){
+            set_error_number(EBUSY);
+            return -1;
+        }
+        return 0;
+    }
+
+    /*! \details Fails the future with \a error_number (for example, EIO).
+     *
+     * @return Zero on success or -1 if the value or error was already set (errno is EBUSY)
+     *
+     */
+    int set_error(int error_number){
+        if( m_shared == 0 ){
+            set_error_number(ENOMEM);
+            return -1;
+        }
+        if( m_shared->fail(error_number) < 0 ){
+            set_error_number(EBUSY);
+            return -1;
+        }
+        return 0;
+    }
+
+    /*! \details Returns true if the value or an error has been set. */
+    bool is_ready() const { return m_shared && !m_shared->is_pending(); }
+
+private:
+    //a promise can't be copied (there is one writer)
+    Promise(const Promise & a);
+    Promise & operator = (const Promise & a);
+
+    FutureValue<T> * m_shared;
+};
+
+}
+
+#endif
+
+#endif /* SYS_FUTURE_HPP_ */
@@ -9,6 +9,8 @@
 #include "../fmt/Son.hpp"
 #include "File.hpp"
 #include "Mutex.hpp"
+#include "Signal.hpp"
+#include "../hal/Device.hpp"
 #include "../var/ConstString.hpp"
 
 namespace sys {
@@ -16,12 +18,40 @@ namespace sys {
 /*! \brief Messenger Class
  * \details This class creates a new thread dedicated to handling message passing.
  *
+ * The device is opened twice so that receiving and sending don't block
+ * each other: the listener thread waits for messages on one descriptor while
+ * send_message() and send_messages() write on the other.
+ *
+ * Incoming messages are received in a pool of buffer_count() buffers. Each
+ * message is passed to handle_message() as a fmt::Son opened directly on its buffer
+ * (the message is not copied). The message stays valid until buffer_count() more
+ * messages have been received, so handle_message() can keep a pointer to it (for
+ * example, to process it on another thread).
+ *
+ * When no message is available, the listener thread sleeps for timeout(). If
+ * set_signal() is used, the device wakes the thread as soon as data is ready.
+ *
+ * \code
+ * class MyMessenger : public Messenger {
+ * public:
+ *   void handle_message(fmt::Son & message){
+ *     printf("value is %ld\n", message.read_num("value"));
+ *   }
+ * };
+ *
+ * MyMessenger messenger;
+ * messenger.set_buffer_count(4);
+ * messenger.set_signal(Signal::USR2); //wake up when data is ready
+ * messenger.start("/dev/link-transport", 0, 1);
+ * \endcode
+ *
  */
 class Messenger : public api::SysWorkObject {
 public:
 
 	enum {
-		CHANNEL_DISABLED = 255
+		CHANNEL_DISABLED = 255,
+		MAX_BUFFER_COUNT = 16 /*! The maximum number of receive buffers */
 	};
 
 	/*! \details Constructs a new messenger with the specified \a stack size for the thread.
@@ -53,13 +83,24 @@ public:
 	 * @return Zero if message was successfully queued
 	 *
 	 * This method will acquire a mutex on the messenger
-	 * before sending. The mutex may be locked waiting for an
-	 * incoming message in which case send_message() will wait
-	 * until that completes before sending.
+	 * before sending. The mutex is only held by threads that are sending
+	 * (the listener thread receives on a separate descriptor).
 	 *
 	 */
 	int send_message(fmt::Son & message);
 
+	/*! \details Sends several messages.
+	 *
+	 * @param messages A list of pointers to the messages
+	 * @param count The number of messages
+	 * @return The number of messages sent (less than \a count if a message fails) or -1 if none were sent
+	 *
+	 * The mutex is acquired once for all the messages so other threads can't
+	 * send messages in between.
+	 *
+	 */
+	int send_messages(fmt::Son * const * messages, u32 count);
+
 	/*! \details Handles incoming messages.
 	 *
 	 * @param message A reference to the incoming message
@@ -75,12 +116,41 @@ public:
 
 	void set_max_message_size(u16 size){ m_max_message_size = size; }
 
+	/*! \details Returns the number of receive buffers. */
+	u8 buffer_count() const { return m_buffer_count; }
+
+	/*! \details Sets the number of receive buffers (must be called before start()).
+	 *
+	 * Each buffer is max_message_size() bytes. The value is limited to MAX_BUFFER_COUNT.
+	 *
+	 */
+	void set_buffer_count(u8 count){
+		if( count == 0 ){ count = 1; }
+		if( count > MAX_BUFFER_COUNT ){ count = MAX_BUFFER_COUNT; }
+		m_buffer_count = count;
+	}
+
+#if !defined __link
+	/*! \details Sets the signal used to wake the listener thread (must be called before start()).
+	 *
+	 * @param signo The signal number (zero to disable)
+	 *
+	 * When enabled, the listener thread asks the device to send \a signo when data is
+	 * ready on the read channel (see hal::DeviceSignal). The signal interrupts the
+	 * wait between receive attempts so messages are handled as soon as they arrive. If the
+	 * device doesn't support signal actions, the listener waits for timeout() as usual.
+	 *
+	 */
+	void set_signal(int signo){ m_signo = signo; }
+#endif
+
 	u16 timeout() const { return m_timeout_ms; }
 
 	void set_timeout(u16 timeout_ms){
 		m_timeout_ms = timeout_ms;
 	}
 
+	/*! \details Returns the memory used for the receive buffers. */
 	var::Data & data(){ return m_message_data; }
 
 	int fileno() const { return m_device.fileno(); }
@@ -91,15 +161,22 @@ public:
 private:
 	static void * listener_work(void * args);
 	void listener();
+#if !defined __link
+	static void handle_signal(int signo, siginfo_t * info, void * context);
+#endif
 
 	volatile bool m_stop;
 	volatile bool m_is_stopped;
+	volatile bool m_is_message_ready;
 	Thread m_listener;
 	u8 m_read_channel;
 	u8 m_write_channel;
+	u8 m_buffer_count;
 	u16 m_max_message_size;
 	u16 m_timeout_ms;
-	File m_device;
+	int m_signo;
+	hal::Device m_device;
+	File m_write_device;
 	sys::Mutex m_mutex;
 	var::Data m_message_data;
 };
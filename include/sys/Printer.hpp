@@ -18,6 +18,7 @@ namespace chrono{
 class ClockTime;
 class MicroTime;
 class Time;
+class ProfileZone;
 }
 
 
@@ -56,6 +57,7 @@ public:
     Printer & operator << (const chrono::ClockTime & a);
     Printer & operator << (const chrono::MicroTime & a);
     Printer & operator << (const chrono::Time & a);
+    Printer & operator << (const chrono::ProfileZone & a);
     Printer & operator << (s32 a);
     Printer & operator << (u32 a);
     Printer & operator << (s16 a);
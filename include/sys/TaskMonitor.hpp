@@ -0,0 +1,210 @@
+/*! \file */ //Copyright 2011-2018 Tyler Gilbert; All Rights Reserved
+
+#ifndef SYS_TASKMONITOR_HPP_
+#define SYS_TASKMONITOR_HPP_
+
+#if !defined __win32
+
+#include <mcu/types.h>
+#include "../api/SysObject.hpp"
+#include "../chrono/MicroTime.hpp"
+#include "Task.hpp"
+#include "Thread.hpp"
+#include "Mutex.hpp"
+
+namespace fmt {
+class JsonWriter;
+}
+
+namespace sys {
+
+/*! \details A sample of one task as it is stored in the TaskMonitor ring. */
+typedef struct MCU_PACK {
+    u32 timestamp /*! Milliseconds since the first sample */;
+    u32 pid /*! The process ID of the task */;
+    u16 tid /*! The task ID */;
+    u16 cpu /*! Share of the CPU since the previous sample in hundredths of a percent (10000 is 100%) */;
+    u32 heap_size /*! Heap in use (zero for threads) */;
+    u32 stack_size /*! Stack in use */;
+} task_sample_t;
+
+/*! \details The statistics for one task (see TaskMonitor::get_stats()). */
+typedef struct {
+    char name[24] /*! The name of the task */;
+    u32 pid /*! The process ID */;
+    u32 tid /*! The task ID */;
+    u32 sample_count /*! The number of samples taken since the task was first seen */;
+    u16 cpu /*! The CPU share of the last sample in hundredths of a percent */;
+    u16 cpu_max /*! The highest CPU share of any sample */;
+    u16 cpu_mean /*! The average CPU share of all samples */;
+    u16 resd;
+    u32 heap_size /*! The heap in use at the last sample */;
+    u32 heap_max /*! The highest heap use that was sampled */;
+    u32 stack_size /*! The stack in use at the last sample */;
+    u32 stack_max /*! The highest stack use that was sampled */;
+    s32 heap_trend /*! Change in heap use in bytes per second over the samples in the ring */;
+    s32 stack_trend /*! Change in stack use in bytes per second over the samples in the ring */;
+} task_stats_t;
+
+/*! \brief Task Monitor Class
+ * \details The TaskMonitor class periodically samples the attributes
+ * of every task (see Task and TaskInfo) and keeps the samples
+ * in a circular buffer. It calculates the share of the CPU that each task
+ * used between samples along with the high-water marks and trends
+ * of the heap and stack.
+ *
+ * The CPU share is the increase in a task's timer() divided by the increase
+ * of all the timers (including the idle task). It doesn't depend on the units
+ * of the task timers or on the exact sampling period.
+ *
+ * \code
+ * #include <sapi/sys.hpp>
+ * #include <sapi/fmt.hpp>
+ *
+ * TaskMonitor monitor(512); //the ring holds 512 task samples
+ * monitor.start(MicroTime::from_milliseconds(100)); //sample 10 times a second in a new thread
+ *
+ * //run the application
+ *
+ * monitor.stop();
+ * File f;
+ * f.create("/home/tasks.json");
+ * JsonWriter json(f);
+ * monitor.save(json);
+ * json.close();
+ * \endcode
+ *
+ * Rather than starting a thread, sample() can be called periodically
+ * (for example, from an ev::EventLoop update).
+ *
+ * On the desktop, Task reads the attributes from the connected device
+ * using the link protocol. A TaskMonitor running on the desktop
+ * samples the device without any code running on the device.
+ *
+ */
+class TaskMonitor : public api::SysWorkObject {
+public:
+
+    enum {
+#if defined __link
+        DEFAULT_STACK_SIZE = 256*1024 /*! The default stack size of the sampling thread */
+#else
+        DEFAULT_STACK_SIZE = 4096 /*! The default stack size of the sampling thread */
+#endif
+    };
+
+    /*! \details Constructs a new task monitor.
+     *
+     * @param sample_count The number of task samples the ring holds
+     * @param task_count The number of task slots to monitor (zero to use Task::count_total())
+     * @param stack_size The stack size of the sampling thread (see start())
+     *
+     */
+    TaskMonitor(u32 sample_count, u32 task_count = 0, int stack_size = DEFAULT_STACK_SIZE);
+    ~TaskMonitor();
+
+    /*! \details Samples every task.
+     *
+     * @return The number of enabled tasks that were sampled or -1 if the tasks could not be read
+     *
+     * The first sample of a task only sets the starting value of its timer
+     * so its CPU share is zero.
+     *
+     */
+    int sample();
+
+    /*! \details Starts a thread that calls sample() periodically.
+     *
+     * @param period The time between samples
+     * @param prio The priority of the sampling thread
+     * @param policy The scheduling policy of the sampling thread
+     * @return Zero on success or -1 if the thread is already running or could not be created
+     *
+     */
+    int start(const chrono::MicroTime & period, int prio = 0, enum Sched::policy policy = Sched::OTHER);
+
+    /*! \details Stops the sampling thread (waits for it to finish). */
+    int stop();
+
+    /*! \details Returns true if the sampling thread is running. */
+    bool is_running() const { return __atomic_load_n(&m_is_running, __ATOMIC_ACQUIRE); }
+
+    /*! \details Returns the time between samples used by the sampling thread. */
+    const chrono::MicroTime & period() const { return m_period; }
+
+    /*! \details Gets the statistics of a task.
+     *
+     * @param tid The task ID
+     * @param stats A reference for the destination statistics
+     * @return Zero on success or -1 if the task isn't enabled or hasn't been sampled (EINVAL)
+     *
+     */
+    int get_stats(u32 tid, task_stats_t & stats);
+
+    /*! \details Returns the number of task slots that are monitored. */
+    u32 task_count() const { return m_task_count; }
+
+    /*! \details Returns the number of samples in the ring. */
+    u32 count() const { return m_count; }
+
+    /*! \details Returns the number of samples that were overwritten because the ring was full. */
+    u32 dropped() const { return m_dropped; }
+
+    /*! \details Copies a sample from the ring.
+     *
+     * @param idx The index of the sample where zero is the oldest sample
+     * @param sample A reference for the destination sample
+     * @return Zero on success or -1 if \a idx is not less than count() (EINVAL)
+     *
+     */
+    int get_sample(u32 idx, task_sample_t & sample);
+
+    /*! \details Clears the samples and the statistics. */
+    void clear();
+
+    /*! \details Writes the statistics and the samples of each task as a JSON object.
+     *
+     * CPU shares are written as percentages. Each task has a "samples" array with
+     * [timestamp (ms), cpu (%), heap, stack] entries from the oldest to the newest.
+     *
+     * @return Zero on success or -1 if the JSON could not be written
+     *
+     */
+    int save(fmt::JsonWriter & json);
+
+private:
+    typedef struct {
+        task_stats_t stats;
+        u64 timer;
+        u64 delta;
+        u64 cpu_total;
+        bool is_enabled;
+    } task_state_t;
+
+    Task m_task;
+    Mutex m_mutex;
+    Thread m_thread;
+    chrono::MicroTime m_period;
+    task_sample_t * m_samples;
+    task_state_t * m_states;
+    u32 m_sample_count;
+    u32 m_task_count;
+    u32 m_head;
+    u32 m_count;
+    u32 m_dropped;
+    u64 m_start;
+    bool m_is_running;
+    bool m_is_stopping;
+
+    int initialize();
+    void push(const task_sample_t & sample);
+    const task_sample_t & at(u32 idx) const { return m_samples[(m_head + m_sample_count - m_count + idx) % m_sample_count]; }
+    void calculate_trends(task_stats_t & stats) const;
+    static void * sample_thread(void * args);
+};
+
+}
+
+#endif
+
+#endif /* SYS_TASKMONITOR_HPP_ */
@@ -0,0 +1,313 @@
+/*! \file */ //Copyright 2011-2018 Tyler Gilbert; All Rights Reserved
+
+#ifndef SYS_THREADPOOL_HPP_
+#define SYS_THREADPOOL_HPP_
+
+#if !defined __win32
+
+#include <pthread.h>
+#include <semaphore.h>
+#include "../api/SysObject.hpp"
+#include "Thread.hpp"
+#include "Mutex.hpp"
+#include "Executor.hpp"
+
+namespace sys {
+
+class ThreadPool;
+
+/*! \brief Thread Task Class
+ * \details A ThreadTask is a function and its arguments that a
+ * ThreadPool executes on one of its workers. It is also the handle
+ * used to wait for the function to finish and to get its return value.
+ *
+ * The pool does not copy or allocate tasks so the task object must stay in
+ * scope until it is done.
+ *
+ * Tasks can depend on other tasks (see add_dependency()). A task
+ * that is submitted before its dependencies are done is held by the pool and
+ * queued when the last one finishes. This makes it easy to run a small
+ * graph of jobs.
+ *
+ * \code
+ * #include <sapi/sys.hpp>
+ *
+ * static void * load(void * args);
+ * static void * filter(void * args);
+ * static void * save(void * args);
+ *
+ * ThreadPool pool;
+ * pool.create();
+ *
+ * ThreadTask load_task(load, &context);
+ * ThreadTask filter_task(filter, &context);
+ * ThreadTask save_task(save, &context);
+ *
+ * filter_task.add_dependency(load_task);
+ * save_task.add_dependency(filter_task);
+ *
+ * //the order of submission doesn't matter
+ * pool.submit(save_task);
+ * pool.submit(filter_task);
+ * pool.submit(load_task);
+ *
+ * pool.wait(save_task);
+ * \endcode
+ *
+ * Once a task is done, it can be submitted again (with the same
+ * dependencies).
+ *
+ */
+class ThreadTask : public api::SysWorkObject {
+    friend class ThreadPool;
+public:
+
+    /*! \details The function that is executed (the same as Thread::handler_function_t). */
+    typedef void * (*task_function_t)(void * args);
+
+    enum {
+        MAX_DEPENDENTS = 4 /*! The number of tasks that can depend on one task */
+    };
+
+    /*! \details Task states. */
+    enum state {
+        IDLE /*! The task has not been submitted */,
+        WAITING /*! The task is submitted and waiting for its dependencies */,
+        QUEUED /*! The task is queued on a worker */,
+        RUNNING /*! The task is running */,
+        DONE /*! The task has finished */
+    };
+
+    /*! \details Constructs a new task.
+     *
+     * @param function The function to execute
+     * @param args The arguments passed to \a function
+     *
+     */
+    ThreadTask(task_function_t function = 0, void * args = 0);
+
+    /*! \details Sets the function and arguments.
+     *
+     * @return Zero on success or -1 if the task is submitted and not done (errno is EBUSY)
+     *
+     */
+    int set_function(task_function_t function, void * args = 0);
+
+    /*! \details Makes this task wait for \a task to finish before running.
+     *
+     * @param task The task that must finish first
+     * @return Zero on success or -1 with errno set to EBUSY if either task is submitted and not done
+     * or ENOSPC if \a task already has MAX_DEPENDENTS dependents
+     *
+     * Dependencies must be added before the tasks are submitted.
+     *
+     */
+    int add_dependency(ThreadTask & task);
+
+    /*! \details Returns the state of the task (see enum state). */
+    int state() const { return __atomic_load_n(&m_state, __ATOMIC_ACQUIRE); }
+
+    /*! \details Returns true if the task has finished. */
+    bool is_done() const { return state() == DONE; }
+
+    /*! \details Returns the value returned by the task function (valid once is_done() is true). */
+    void * result() const { return m_result; }
+
+private:
+    task_function_t m_function;
+    void * m_args;
+    void * m_result;
+    ThreadTask * m_dependents[MAX_DEPENDENTS];
+    u32 m_dependent_count;
+    u32 m_dependency_count;
+    u32 m_remaining; //dependencies left plus one until the task is submitted
+    u32 m_state;
+    bool m_is_posted; //allocated by ThreadPool::post()
+
+    bool is_busy() const;
+};
+
+/*! \brief Thread Pool Class
+ * \details The ThreadPool class runs tasks (see ThreadTask) on a fixed set
+ * of worker threads (sys::Thread) so that applications don't need
+ * to create a thread for each job.
+ *
+ * Each worker has its own queue of tasks. Tasks submitted from a worker
+ * (for example, a task that splits up its own work) go on that worker's
+ * queue and are executed newest first which keeps the data in the cache. A worker
+ * with an empty queue takes the oldest task from another worker
+ * (work stealing) so the load is balanced without a single shared
+ * queue that all the workers fight over. Idle workers sleep on a
+ * semaphore.
+ *
+ * \code
+ * #include <sapi/sys.hpp>
+ *
+ * static void scale(void * context, u32 begin, u32 end){
+ *   float * samples = (float*)context;
+ *   for(u32 i=begin; i < end; i++){
+ *     samples[i] *= 0.5f;
+ *   }
+ * }
+ *
+ * ThreadPool pool; //one worker per core on the desktop
+ * pool.create();
+ *
+ * //splits the range into blocks of 1024 and runs them on all the workers
+ * pool.parallel_for(0, count, 1024, scale, samples);
+ * \endcode
+ *
+ * On the desktop, the default number of workers is the number of
+ * processors. On Stratify OS it is DEFAULT_WORKER_COUNT.
+ *
+ * The stack size is passed to the constructor and the priority and
+ * scheduling policy (see Sched) to create() the same as for sys::Thread.
+ *
+ * Threads waiting on a task with wait() or parallel_for() execute other queued
+ * tasks while they wait so tasks can safely wait on tasks they submit.
+ *
+ * ThreadPool is also an Executor: post() runs a function without a
+ * ThreadTask (the pool allocates one) which is how Future::then()
+ * continuations are run on the pool.
+ *
+ */
+class ThreadPool : public api::SysWorkObject, public Executor {
+public:
+
+    /*! \details The function executed by parallel_for() for each block of the range. */
+    typedef void (*range_function_t)(void * context, u32 begin, u32 end);
+
+    enum {
+#if defined __link
+        MAX_WORKER_COUNT = 64 /*! The maximum number of worker threads */,
+        DEFAULT_WORKER_COUNT = 4 /*! The number of workers if the number of processors isn't known */,
+        DEFAULT_STACK_SIZE = 1024*1024 /*! The default stack size of each worker */,
+        QUEUE_SIZE = 256 /*! The number of tasks each worker can hold */
+#else
+        MAX_WORKER_COUNT = 8 /*! The maximum number of worker threads */,
+        DEFAULT_WORKER_COUNT = 2 /*! The default number of worker threads */,
+        DEFAULT_STACK_SIZE = 4096 /*! The default stack size of each worker */,
+        QUEUE_SIZE = 16 /*! The number of tasks each worker can hold */
+#endif
+    };
+
+    /*! \details Constructs a new thread pool.
+     *
+     * @param worker_count The number of worker threads (zero for the default)
+     * @param stack_size The stack size of each worker
+     *
+     * The workers are started by create().
+     *
+     */
+    ThreadPool(u32 worker_count = 0, int stack_size = DEFAULT_STACK_SIZE);
+
+    /*! \details Stops the workers (see destroy()). */
+    ~ThreadPool();
+
+    /*! \details Starts the worker threads.
+     *
+     * @param prio The priority of the workers
+     * @param policy The scheduling policy of the workers
+     * @return Zero on success or -1 if the workers could not be created
+     *
+     */
+    int create(int prio = 0, enum Sched::policy policy = Sched::OTHER);
+
+    /*! \details Stops and joins the worker threads.
+     *
+     * Tasks that are already queued are executed first. Tasks waiting
+     * on dependencies that never finish are not executed.
+     *
+     */
+    int destroy();
+
+    /*! \details Sets the priority of all the workers (see Thread::set_priority()). */
+    int set_priority(int prio, enum Sched::policy policy = Sched::RR);
+
+    /*! \details Returns the number of worker threads. */
+    u32 worker_count() const { return m_worker_count; }
+
+    /*! \details Returns true if the workers are running. */
+    bool is_valid() const { return m_workers != 0; }
+
+    /*! \details Submits a task to be executed.
+     *
+     * @param task The task to execute (it must stay in scope until it is done)
+     * @return Zero on success or -1 if the task is already submitted (errno is EBUSY)
+     * or has no function (errno is EINVAL)
+     *
+     * If the task depends on tasks that are not done, it is queued when they
+     * finish. If the queue is full or the pool has not been created,
+     * the task is executed before this method returns.
+     *
+     */
+    int submit(ThreadTask & task);
+
+    /*! \details Executes \a function on a worker (see Executor).
+     *
+     * @return Zero on success or -1 if the task could not be allocated (errno is ENOMEM)
+     *
+     * The task is allocated and freed by the pool so there is nothing to wait on.
+     *
+     */
+    int post(function_t function, void * args);
+
+    /*! \details Waits for \a task to finish.
+     *
+     * @return Zero on success or -1 if the task has not been submitted (errno is EINVAL)
+     *
+     * The calling thread executes queued tasks while it waits.
+     *
+     */
+    int wait(ThreadTask & task);
+
+    /*! \details Executes \a function for each block of a range on all the workers.
+     *
+     * @param begin The first index
+     * @param end One past the last index
+     * @param grain The number of indices in each block (at least 1)
+     * @param function The function to call for each block
+     * @param context The first argument passed to \a function
+     * @return Zero when all the blocks have been executed
+     *
+     * The calling thread executes blocks too and this method
+     * returns when they are all done. Blocks are handed out one at a time
+     * so workers that finish early take more blocks. The grain should be
+     * large enough that each block takes much longer than
+     * a context switch.
+     *
+     */
+    int parallel_for(u32 begin, u32 end, u32 grain, range_function_t function, void * context = 0);
+
+private:
+    class Worker;
+
+    Worker * m_workers;
+    u32 m_worker_count;
+    int m_stack_size;
+    u32 m_next_worker;
+    u32 m_queued_count; //tasks that are in the queues
+    u32 m_waiter_count; //threads blocked in wait()
+    u32 m_sleeping_count; //idle workers that have not been posted
+    bool m_is_stopping;
+    sem_t m_work; //posted once for each queued task
+    pthread_mutex_t m_done_mutex;
+    pthread_cond_t m_done_cond;
+
+    static void * worker_thread(void * args);
+    Worker * current_worker() const;
+    void queue(ThreadTask * task);
+    ThreadTask * take_task(Worker * worker);
+    void execute(ThreadTask * task);
+    void stop(u32 started_count);
+    void sleep();
+    void wake_worker();
+    void notify_waiters();
+
+};
+
+}
+
+#endif
+
+#endif /* SYS_THREADPOOL_HPP_ */
@@ -28,6 +28,9 @@ namespace sys {
  * - Type (message, waring, critical, or error)
  * - Message (limited to 20 bytes)
  *
+ * Each message is formatted as text and sent to the kernel. To trace
+ * code that runs often (or on the desktop), use TraceRing instead.
+ *
  */
 #if defined __link
 class Trace {
@@ -0,0 +1,209 @@
+/*! \file */ //Copyright 2011-2018 Tyler Gilbert; All Rights Reserved
+
+#ifndef SYS_TRACERING_HPP_
+#define SYS_TRACERING_HPP_
+
+#include <mcu/types.h>
+#include "../api/SysObject.hpp"
+
+namespace var {
+class Data;
+}
+
+namespace sys {
+
+/*! \details A trace record as it is stored in a dump (see TraceRing::save()). */
+typedef struct MCU_PACK {
+    u32 timestamp_low /*! Nanoseconds since an arbitrary time (low 32 bits) */;
+    u32 timestamp_high /*! Nanoseconds (high 32 bits) */;
+    u32 thread_id /*! The thread that wrote the record */;
+    u16 event /*! The event ID */;
+    u8 type /*! TraceRing::BEGIN, TraceRing::END, TraceRing::INSTANT or TraceRing::COUNTER */;
+    u8 resd;
+    u32 args[2] /*! Event specific values */;
+} trace_record_t;
+
+/*! \details The header of a dump (followed by \a count records). */
+typedef struct MCU_PACK {
+    u32 magic /*! Always TraceRing::MAGIC */;
+    u16 version /*! The format version (TraceRing::VERSION) */;
+    u16 record_size /*! sizeof(trace_record_t) */;
+    u32 count /*! The number of records that follow */;
+    u32 dropped /*! The number of records that were overwritten (or being written) when the dump was saved (0xffffffff if there are more) */;
+} trace_dump_header_t;
+
+/*! \brief Trace Ring Class
+ * \details The TraceRing class records fixed-size binary events
+ * (a timestamp, an event ID and two values) in a circular buffer. When
+ * the buffer is full, the oldest records are overwritten.
+ *
+ * Writing a record doesn't format any text, take a lock or make a system call
+ * (except to read the clock) so it is cheap enough to leave on in production code. Any thread
+ * can write to the ring at the same time; each record has the ID of the
+ * thread that wrote it.
+ *
+ * The ring is saved as a binary dump that can be sent to the desktop
+ * (as a file or over the link protocol) and converted to Chrome trace JSON using
+ * fmt::ChromeTrace (open it with chrome://tracing or Perfetto).
+ *
+ * \code
+ * #include <sapi/sys.hpp>
+ *
+ * enum {
+ *   EVENT_FILTER,
+ *   EVENT_SAMPLE_COUNT
+ * };
+ *
+ * TraceRing ring(1024);
+ * TraceRing::set_default(&ring); //the SAPI_TRACE macros write here
+ *
+ * SAPI_TRACE_BEGIN(EVENT_FILTER, sample_count);
+ * //filter the samples
+ * SAPI_TRACE_END(EVENT_FILTER, 0);
+ * SAPI_TRACE_COUNTER(EVENT_SAMPLE_COUNT, sample_count);
+ *
+ * Data dump;
+ * ring.save(dump);
+ * File f;
+ * f.create("/home/trace.bin");
+ * f.write(dump);
+ * \endcode
+ *
+ * Defining SAPI_TRACE_DISABLE when compiling removes the SAPI_TRACE macros
+ * entirely (including the ones in the library).
+ *
+ * Application event IDs must be less than EVENT_LIBRARY. The library uses
+ * the IDs above that to trace the event loop, files and the link protocol.
+ *
+ * For messages that are sent to the Stratify OS system trace, use Trace.
+ *
+ */
+class TraceRing : public api::SysWorkObject {
+public:
+
+    enum {
+        BEGIN /*! The start of a duration (the matching END has the same event ID and thread) */,
+        END /*! The end of a duration */,
+        INSTANT /*! Something happened at a point in time */,
+        COUNTER /*! The value of a counter changed (the first arg is the value) */
+    };
+
+    enum {
+        MAGIC = 0x43525453 /*! The first word of a dump ("STRC") */,
+        VERSION = 1 /*! The version of the dump format */
+    };
+
+    enum {
+        EVENT_LIBRARY = 0xff00 /*! The first event ID used by the library */,
+        EVENT_EVENT_LOOP_PROCESS = EVENT_LIBRARY /*! ev::EventLoop::process_events() */,
+        EVENT_EVENT_LOOP_POSTED /*! ev::EventLoop running posted functions */,
+        EVENT_EVENT_LOOP_HANDLE /*! ev::EventLoop::handle_event() (args: event type) */,
+        EVENT_FILE_READ /*! sys::File::read() (args: bytes requested, bytes read) */,
+        EVENT_FILE_WRITE /*! sys::File::write() (args: bytes requested, bytes written) */,
+        EVENT_LINK_READ /*! sys::Link::read() (args: bytes requested, bytes read) */,
+        EVENT_LINK_WRITE /*! sys::Link::write() (args: bytes requested, bytes written) */,
+        EVENT_LIBRARY_LAST = EVENT_LINK_WRITE
+    };
+
+    /*! \details Constructs a new ring.
+     *
+     * @param count The number of records (rounded up to a power of 2)
+     *
+     * Each record uses 28 bytes. Use is_valid() to check if the memory was
+     * allocated (error_number() is ENOMEM if it wasn't or if \a count
+     * is too big). The ring should have more records than there are threads writing to it.
+     *
+     */
+    TraceRing(u32 count);
+    ~TraceRing();
+
+    /*! \details Returns true if the memory for the ring was allocated. */
+    bool is_valid() const { return m_slots != 0; }
+
+    /*! \details Returns the number of records the ring holds. */
+    u32 count() const { return m_mask + 1; }
+
+    /*! \details Returns the number of records written since the ring was created (or cleared) modulo 2^32. */
+    u32 written() const { return __atomic_load_n(&m_position, __ATOMIC_RELAXED); }
+
+    /*! \details Writes a record.
+     *
+     * @param event The event ID
+     * @param type BEGIN, END, INSTANT or COUNTER
+     * @param arg0 The first value saved with the event
+     * @param arg1 The second value saved with the event
+     *
+     */
+    void record(u16 event, u8 type, u32 arg0 = 0, u32 arg1 = 0);
+
+    /*! \details Saves the records in the ring to \a dump (a trace_dump_header_t followed by the records, oldest first).
+     *
+     * @return The number of records saved or -1 if \a dump could not be allocated
+     *
+     * Records can be written while the ring is saved. Records that
+     * are overwritten while they are copied are not saved (they are counted as dropped).
+     *
+     */
+    int save(var::Data & dump) const;
+
+    /*! \details Discards all the records (no other threads should be writing). */
+    void clear();
+
+    /*! \details Sets the ring used by the SAPI_TRACE macros (null to stop tracing). */
+    static void set_default(TraceRing * ring){ __atomic_store_n(&m_default, ring, __ATOMIC_RELEASE); }
+
+    /*! \details Returns the ring used by the SAPI_TRACE macros. */
+    static TraceRing * get_default(){ return __atomic_load_n(&m_default, __ATOMIC_ACQUIRE); }
+
+    /*! \details Writes a record to the default ring (if there is one). */
+    static void trace(u16 event, u8 type, u32 arg0 = 0, u32 arg1 = 0){
+        TraceRing * ring = get_default();
+        if( ring ){
+            ring->record(event, type, arg0, arg1);
+        }
+    }
+
+    /*! \details Returns the timestamp used for records in nanoseconds (see chrono::Clock::get_fast_nanoseconds()). */
+    static u64 timestamp();
+
+private:
+    enum {
+        RECORD_WORDS = sizeof(trace_record_t) / sizeof(u32)
+    };
+
+    typedef struct {
+        u32 sequence; //sequence(position) once the record is complete (0 while it is written)
+        u32 words[RECORD_WORDS];
+    } slot_t;
+
+    slot_t * m_slots;
+    u32 m_mask;
+    u32 m_position;
+    u32 m_is_full;
+    u32 m_wrap_count;
+
+    static u32 max_count();
+    static u32 sequence(u32 position);
+
+    static TraceRing * m_default;
+};
+
+}
+
+#if defined SAPI_TRACE_DISABLE
+#define SAPI_TRACE_BEGIN(event, arg) do {} while(0)
+#define SAPI_TRACE_END(event, arg) do {} while(0)
+#define SAPI_TRACE_INSTANT(event, arg0, arg1) do {} while(0)
+#define SAPI_TRACE_COUNTER(event, value) do {} while(0)
+#else
+/*! \details Starts a duration on the default ring (the arg is saved with the event). */
+#define SAPI_TRACE_BEGIN(event, arg) sys::TraceRing::trace(event, sys::TraceRing::BEGIN, arg)
+/*! \details Ends a duration on the default ring. */
+#define SAPI_TRACE_END(event, arg) sys::TraceRing::trace(event, sys::TraceRing::END, arg)
+/*! \details Records an instant event on the default ring. */
+#define SAPI_TRACE_INSTANT(event, arg0, arg1) sys::TraceRing::trace(event, sys::TraceRing::INSTANT, arg0, arg1)
+/*! \details Records the value of a counter on the default ring. */
+#define SAPI_TRACE_COUNTER(event, value) sys::TraceRing::trace(event, sys::TraceRing::COUNTER, value)
+#endif
+
+#endif /* SYS_TRACERING_HPP_ */
@@ -12,11 +12,16 @@
  *
  * - Data: manages static and dynamic allocation of memory ensuring no memory leaks
  * - String: An embedded friendly String object that implements many methods from std::string
- * - Queue: similar to std::queue (inherits LinkedList)
+ * - Queue: similar to std::queue (uses a growable ring buffer)
+ * - List: similar to std::list (doubly linked list)
  * - Vector: similar to std::vector (inherits Data)
- * - Ring: template class for creating first-in first-out buffers of fixed size (inherits Data)
+ * - Ring: lock-free single-producer/single-consumer FIFO buffer of fixed size (inherits Data)
  * - Token: Breaks strings into tokens (inherits String)
  * - Array: similar to std::array
+ * - HashMap: similar to std::unordered_map (open addressing in contiguous memory)
+ * - HashSet: similar to std::unordered_set
+ * - FlatMap: similar to std::map (sorted keys in contiguous memory)
+ * - SmallVector: a vector that stores a few items without allocating memory
  *
  *
  */
@@ -29,12 +34,18 @@ namespace var {}
 #include "var/Ring.hpp"
 #include "var/LinkedList.hpp"
 #include "var/Queue.hpp"
+#include "var/List.hpp"
 #include "var/ConstString.hpp"
 #include "var/String.hpp"
 #include "var/StringUtil.hpp"
 #include "var/Token.hpp"
 #include "var/Vector.hpp"
 #include "var/Array.hpp"
+#include "var/Hash.hpp"
+#include "var/HashMap.hpp"
+#include "var/HashSet.hpp"
+#include "var/FlatMap.hpp"
+#include "var/SmallVector.hpp"
 
 using namespace var;
 
@@ -93,6 +93,12 @@ public:
     /*! \details Compares to a c-string (inequality). */
     bool operator!=(const ConstString & a) const { return compare(a) != 0; }
 
+    /*! \details Returns true if this string sorts before \a a (see strcmp()). */
+    bool operator<(const ConstString & a) const { return strcmp(str(), a.str()) < 0; }
+
+    /*! \details Returns true if this string sorts after \a a (see strcmp()). */
+    bool operator>(const ConstString & a) const { return strcmp(str(), a.str()) > 0; }
+
     /*! \details Converts to an integer.
      *
      * \code
@@ -192,6 +198,15 @@ public:
 protected:
     void set_string_pointer(const char * s);
 
+    /*! \details Finds \a n bytes at \a a in the \a len bytes at \a s starting at \a pos.
+     *
+     * Short patterns are found using memchr() and memcmp(). Longer
+     * patterns use the Boyer-Moore-Horspool algorithm which
+     * skips ahead by up to the length of the pattern after each comparison.
+     *
+     */
+    static u32 find_bytes(const char * s, u32 len, const char * a, u32 n, u32 pos = 0);
+
 private:
     const char * m_string;
 };
@@ -239,6 +239,18 @@ public:
     //doesn't really make sense to set the capacity because it will always jump to the next largest block
     int set_capacity(u32 s){ return set_size(s); }
 
+    /*! \details Makes sure the capacity is at least \a s bytes without changing size().
+     *
+     * @param s The minimum number of bytes needed
+     * @return Zero on success or -1 if the memory can't be allocated
+     *
+     * When more memory is needed, the capacity is doubled (or increased
+     * to \a s if that is more). Data that grows a little at a time is
+     * then only copied a few times.
+     *
+     */
+    int reserve(u32 s);
+
 
     /*!
      * \details Returns the effective size of the data.
@@ -273,14 +285,14 @@ public:
 	 *
 	 * \sa set()
 	 */
-	void * data() const { return m_mem_write; }
+	void * data() const { set_modified(); return m_mem_write; }
 
     /*! \details Returns a char pointer to the data.
 	 * This will return zero if the data is readonly.
 	 *
 	 * \sa set()
 	 */
-	char * cdata() const { return (char *)m_mem_write; }
+	char * cdata() const { set_modified(); return (char *)m_mem_write; }
 
     /*! \details Returns a pointer to const char data.
 	 */
@@ -473,11 +485,31 @@ public:
 protected:
     void copy_object(const Data & a);
 
+    /*! \details Returns true if the data may have been written since clear_modified().
+     *
+     * The data is marked as modified when data() or cdata() is called and
+     * when it is filled. Classes that keep information about the contents
+     * (like the length of a var::String) use this to know when to
+     * recalculate it.
+     *
+     */
+    bool is_modified() const { return (m_o_flags & FLAG_IS_MODIFIED) != 0; }
+    void clear_modified() const { m_o_flags &= ~FLAG_IS_MODIFIED; }
+
+    /*! \details Returns a pointer to the data without marking it as modified.
+     *
+     * This is for classes that update their own information
+     * when they write the data.
+     *
+     */
+    char * cdata_untracked() const { return (char *)m_mem_write; }
+
 private:
 
     friend class ConstString;
 
     void set_needs_free() const { m_o_flags |= FLAG_NEEDS_FREE; }
+    void set_modified() const { m_o_flags |= FLAG_IS_MODIFIED; }
     void clear_needs_free() const { m_o_flags &= ~FLAG_NEEDS_FREE; }
 
     bool needs_free() const { return m_o_flags & FLAG_NEEDS_FREE; }
@@ -493,7 +525,8 @@ private:
 
     enum {
         FLAG_NEEDS_FREE = (1<<0),
-        FLAG_IS_TRANSFER_OWNERSHIP = (1<<1)
+        FLAG_IS_TRANSFER_OWNERSHIP = (1<<1),
+        FLAG_IS_MODIFIED = (1<<2)
     };
     mutable u32 m_o_flags;
 
@@ -0,0 +1,299 @@
+/*! \file */ //Copyright 2011-2018 Tyler Gilbert; All Rights Reserved
+
+#ifndef VAR_FLATMAP_HPP_
+#define VAR_FLATMAP_HPP_
+
+#include <errno.h>
+#include "Vector.hpp"
+#include "Array.hpp"
+
+namespace var {
+
+/*! \brief Flat Map Class
+ * \details The FlatMap class is an ordered associative
+ * container similar to std::map that keeps its keys and values in
+ * two sorted, contiguous var::Vector objects.
+ *
+ * Lookups use a binary search over the keys only so they
+ * touch very little memory. Insertion and removal move the
+ * entries that follow so FlatMap is best for data that is built
+ * once and read many times (configuration keys, menu trees, command
+ * line options). Use the bulk constructors when the data is
+ * available up front: they sort in O(n log n) rather than
+ * inserting one entry at a time.
+ *
+ * \code
+ * #include <sapi/var.hpp>
+ *
+ * const ConstString names[] = { "volume", "brightness", "contrast" };
+ * const u8 values[] = { 10, 80, 50 };
+ *
+ * FlatMap<ConstString, u8> settings(names, values, 3); //sorted once
+ *
+ * const u8 * brightness = settings.find("brightness");
+ *
+ * for(u32 i=0; i < settings.count(); i++){
+ *   //keys are in order: brightness, contrast, volume
+ *   printf("%s = %d\n", settings.key_at(i).str(), settings.value_at(i));
+ * }
+ * \endcode
+ *
+ * \a K must provide operator<() and operator==().
+ *
+ * ### Memory Footprint
+ *
+ * The memory used for \a n entries on Stratify OS (4-byte pointers, 8 bytes of
+ * malloc overhead per allocation) is approximately:
+ *
+ * | Container | Bytes for \a n entries | u16 key, u16 value, n = 64 |
+ * |-----------|-------------------------|-----------------------------|
+ * | FlatMap<K,V> | n*(sizeof(K)+sizeof(V)) + 2 allocations | 256 + 16 |
+ * | var::HashMap<K,V> | (n*8/7)*(sizeof(K)+sizeof(V)+1) + 1 allocation | 640 + 8 (128 slots) |
+ * | var::List of key/value pairs | n*(sizeof(K)+sizeof(V)+8+8) | 1280 |
+ *
+ * Each var::List node carries two pointers and its own malloc overhead,
+ * and walking the list visits a different heap block for every entry.
+ *
+ */
+template<typename K, typename V> class FlatMap : public api::VarWorkObject {
+public:
+
+    /*! \details Constructs an empty map. */
+    FlatMap(){}
+
+    /*! \details Constructs a map from unsorted keys and values.
+     *
+     * @param keys A pointer to the keys
+     * @param values A pointer to the values (one for each key)
+     * @param count The number of keys
+     *
+     * If a key appears more than once, the last value is kept.
+     *
+     */
+    FlatMap(const K * keys, const V * values, u32 count){
+        assign(keys, values, count);
+    }
+
+    /*! \details Constructs a map from unsorted keys and values stored in var::Vector objects. */
+    FlatMap(const Vector<K> & keys, const Vector<V> & values){
+        assign(keys.vector_data_const(), values.vector_data_const(), keys.count() < values.count() ? keys.count() : values.count());
+    }
+
+    /*! \details Constructs a map from unsorted keys and values stored in var::Array objects. */
+    template<u32 size_value> FlatMap(const Array<K, size_value> & keys, const Array<V, size_value> & values){
+        assign(keys.data(), values.data(), size_value);
+    }
+
+    /*! \details Replaces the contents of the map with unsorted keys and values.
+     *
+     * @return Zero on success or -1 if memory could not be allocated
+     */
+    int assign(const K * keys, const V * values, u32 count){
+        clear();
+        if( count == 0 ){ return 0; }
+
+        Vector<u32> order;
+        order.reserve(count);
+        m_keys.reserve(count);
+        m_values.reserve(count);
+        if( (order.capacity() < count) || (m_keys.capacity() < count) || (m_values.capacity() < count) ){
+            set_error_number(ENOMEM);
+            return -1;
+        }
+
+        for(u32 i=0; i < count; i++){
+            order.push_back(i);
+        }
+
+        sort(keys, order.vector_data(), count);
+
+        for(u32 i=0; i < count; i++){
+            u32 idx = order[i];
+            if( m_keys.count() && (m_keys[m_keys.count()-1] == keys[idx]) ){
+                m_values[m_values.count()-1] = values[idx];
+            } else {
+                m_keys.push_back(keys[idx]);
+                m_values.push_back(values[idx]);
+            }
+        }
+        return 0;
+    }
+
+    /*! \details Returns the number of entries. */
+    u32 count() const { return m_keys.count(); }
+
+    /*! \details Returns true if the map has no entries. */
+    bool is_empty() const { return count() == 0; }
+
+    /*! \details Returns the position of the first key that is not less than \a key. */
+    u32 lower_bound(const K & key) const {
+        u32 low = 0;
+        u32 high = count();
+        while( low < high ){
+            u32 middle = low + (high - low)/2;
+            if( m_keys[middle] < key ){
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+        return low;
+    }
+
+    /*! \details Returns the position of \a key or count() if \a key is not in the map. */
+    u32 find_position(const K & key) const {
+        u32 position = lower_bound(key);
+        if( (position < count()) && (m_keys[position] == key) ){
+            return position;
+        }
+        return count();
+    }
+
+    /*! \details Returns a pointer to the value for \a key or zero if \a key is not in the map. */
+    V * find(const K & key){
+        u32 position = find_position(key);
+        return position < count() ? &m_values[position] : 0;
+    }
+
+    /*! \details Returns a read-only pointer to the value for \a key or zero if \a key is not in the map. */
+    const V * find(const K & key) const {
+        u32 position = find_position(key);
+        return position < count() ? &m_values[position] : 0;
+    }
+
+    /*! \details Returns true if \a key is in the map. */
+    bool contains(const K & key) const { return find_position(key) < count(); }
+
+    /*! \details Inserts or updates an entry.
+     *
+     * @return Zero on success or -1 if memory could not be allocated
+     */
+    int insert(const K & key, const V & value){
+        u32 position = lower_bound(key);
+        if( (position < count()) && (m_keys[position] == key) ){
+            m_values[position] = value;
+            return 0;
+        }
+        if( insert_at(m_keys, position, key) < 0 ){
+            return -1;
+        }
+        if( insert_at(m_values, position, value) < 0 ){
+            erase_at(m_keys, position);
+            return -1;
+        }
+        return 0;
+    }
+
+    /*! \details Removes the entry for \a key.
+     *
+     * @return Zero if the entry was removed or -1 if \a key was not in the map
+     */
+    int remove(const K & key){
+        u32 position = find_position(key);
+        if( position == count() ){
+            return -1;
+        }
+        erase_at(m_keys, position);
+        erase_at(m_values, position);
+        return 0;
+    }
+
+    /*! \details Returns the key at \a position (keys are sorted). */
+    const K & key_at(u32 position) const { return m_keys[position]; }
+
+    /*! \details Returns the value at \a position. */
+    V & value_at(u32 position){ return m_values[position]; }
+
+    /*! \details Returns the value at \a position (read-only). */
+    const V & value_at(u32 position) const { return m_values[position]; }
+
+    /*! \details Returns the sorted keys. */
+    const Vector<K> & keys() const { return m_keys; }
+
+    /*! \details Returns the values in the same order as keys(). */
+    const Vector<V> & values() const { return m_values; }
+
+    /*! \details Removes all entries. */
+    void clear(){
+        while( m_keys.count() ){ m_keys.pop_back(); }
+        while( m_values.count() ){ m_values.pop_back(); }
+    }
+
+    /*! \details Frees memory that is not used by the entries. */
+    void shrink_to_fit(){
+        m_keys.shrink_to_fit();
+        m_values.shrink_to_fit();
+    }
+
+private:
+    Vector<K> m_keys;
+    Vector<V> m_values;
+
+    template<typename T> static int insert_at(Vector<T> & vector, u32 position, const T & value){
+        u32 last = vector.count();
+        if( last == position ){
+            return vector.push_back(value);
+        }
+        //duplicate the last item then shift the others up
+        T back = vector[last-1]; //push_back() may move the data
+        if( vector.push_back(back) < 0 ){
+            return -1;
+        }
+        for(u32 i = last-1; i > position; i--){
+            vector[i] = vector[i-1];
+        }
+        vector[position] = value;
+        return 0;
+    }
+
+    template<typename T> static void erase_at(Vector<T> & vector, u32 position){
+        for(u32 i = position+1; i < vector.count(); i++){
+            vector[i-1] = vector[i];
+        }
+        vector.pop_back();
+    }
+
+    static bool is_less(const K * keys, u32 a, u32 b){
+        //ties are broken by position so the last duplicate key sorts last
+        if( keys[a] < keys[b] ){ return true; }
+        if( keys[b] < keys[a] ){ return false; }
+        return a < b;
+    }
+
+    //heap sort the order of keys -- O(n log n) without recursion
+    static void sort(const K * keys, u32 * order, u32 count){
+        for(u32 i = count/2; i > 0; i--){
+            sift_down(keys, order, i-1, count);
+        }
+        for(u32 end = count-1; end > 0; end--){
+            u32 tmp = order[0];
+            order[0] = order[end];
+            order[end] = tmp;
+            sift_down(keys, order, 0, end);
+        }
+    }
+
+    static void sift_down(const K * keys, u32 * order, u32 root, u32 count){
+        for(;;){
+            u32 child = root*2 + 1;
+            if( child >= count ){
+                return;
+            }
+            if( (child + 1 < count) && is_less(keys, order[child], order[child+1]) ){
+                child++;
+            }
+            if( !is_less(keys, order[root], order[child]) ){
+                return;
+            }
+            u32 tmp = order[root];
+            order[root] = order[child];
+            order[child] = tmp;
+            root = child;
+        }
+    }
+
+};
+
+}
+
+#endif /* VAR_FLATMAP_HPP_ */
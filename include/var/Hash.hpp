@@ -0,0 +1,111 @@
+/*! \file */ //Copyright 2011-2018 Tyler Gilbert; All Rights Reserved
+
+#ifndef VAR_HASH_HPP_
+#define VAR_HASH_HPP_
+
+#include "../api/VarObject.hpp"
+#include "ConstString.hpp"
+#include "String.hpp"
+
+namespace var {
+
+/*! \brief Hash Function Class
+ * \details The HashFunction class calculates 32-bit
+ * hashes (MurmurHash3) of arbitrary data. It is used
+ * by the var::Hash template which provides the default
+ * hash for var::HashMap and var::HashSet.
+ *
+ */
+class HashFunction : public api::VarInfoObject {
+public:
+
+    /*! \details Calculates the hash of \a size bytes at \a data.
+     *
+     * @param data A pointer to the data
+     * @param size The number of bytes to hash
+     * @param seed An initial value (use different seeds to get independent hashes)
+     *
+     * The data is processed a 32-bit word at a time.
+     *
+     */
+    static u32 calculate(const void * data, u32 size, u32 seed = 0);
+
+    /*! \details Calculates the hash of a zero-terminated string. */
+    static u32 calculate(const ConstString & value){
+        return calculate(value.str(), value.length());
+    }
+
+    /*! \details Mixes the bits of a 32-bit value.
+     *
+     * This is a fast hash for integer keys.
+     *
+     */
+    static u32 mix(u32 value){
+        value ^= value >> 16;
+        value *= 0x85ebca6b;
+        value ^= value >> 13;
+        value *= 0xc2b2ae35;
+        value ^= value >> 16;
+        return value;
+    }
+};
+
+/*! \brief Hash Class
+ * \details The Hash template is the default hash
+ * used by var::HashMap and var::HashSet.
+ *
+ * The generic version hashes the bytes of the key so it
+ * is suitable for integers and packed structures. Keys that
+ * contain pointers or padding need a specialization (or
+ * a custom hash class passed as a template argument to
+ * the container).
+ *
+ * \code
+ * #include <sapi/var.hpp>
+ *
+ * class PointHash {
+ * public:
+ *   u32 operator()(const sg_point_t & key) const {
+ *     return HashFunction::mix(key.point);
+ *   }
+ * };
+ *
+ * HashMap<sg_point_t, u32, PointHash> map;
+ * \endcode
+ *
+ */
+template<typename K> class Hash {
+public:
+    u32 operator()(const K & key) const {
+        return HashFunction::calculate(&key, sizeof(K));
+    }
+};
+
+template<> class Hash<u32> {
+public:
+    u32 operator()(u32 key) const { return HashFunction::mix(key); }
+};
+
+template<> class Hash<s32> {
+public:
+    u32 operator()(s32 key) const { return HashFunction::mix(key); }
+};
+
+template<> class Hash<u16> {
+public:
+    u32 operator()(u16 key) const { return HashFunction::mix(key); }
+};
+
+template<> class Hash<ConstString> {
+public:
+    u32 operator()(const ConstString & key) const { return HashFunction::calculate(key); }
+};
+
+template<> class Hash<String> {
+public:
+    u32 operator()(const String & key) const { return HashFunction::calculate(key); }
+};
+
+}
+
+#endif /* VAR_HASH_HPP_ */
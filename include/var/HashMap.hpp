@@ -0,0 +1,206 @@
+/*! \file */ //Copyright 2011-2018 Tyler Gilbert; All Rights Reserved
+
+#ifndef VAR_HASHMAP_HPP_
+#define VAR_HASHMAP_HPP_
+
+#include "HashTable.hpp"
+
+namespace var {
+
+/*! \brief Hash Map Entry Class
+ * \details A key/value pair stored in a var::HashMap.
+ */
+template<typename K, typename V> class HashMapEntry {
+public:
+    HashMapEntry(const K & k, const V & v) : key(k), value(v){}
+
+    /*! \details The key (should not be modified while in a map). */
+    K key;
+    /*! \details The value. */
+    V value;
+};
+
+/*! \brief Hash Map Class
+ * \details The HashMap class is an associative container
+ * similar to std::unordered_map.
+ *
+ * Lookups, insertions and removals take constant time on
+ * average. The entries are kept in a single contiguous
+ * array (see var::HashTable for the details).
+ *
+ * \code
+ * #include <sapi/var.hpp>
+ *
+ * HashMap<ConstString, u32> map;
+ * map.insert("width", 320);
+ * map.insert("height", 240);
+ *
+ * u32 * width = map.find("width");
+ * if( width ){
+ *   printf("Width is %ld\n", *width);
+ * }
+ *
+ * map["depth"] = 16; //inserts a new entry
+ *
+ * for(HashMap<ConstString, u32>::iterator it = map.begin(); it != map.end(); ++it){
+ *   printf("%s is %ld\n", it->key.str(), it->value);
+ * }
+ * \endcode
+ *
+ * The hash is calculated using var::Hash by default. A different
+ * hash class can be passed as the third template argument.
+ *
+ * On the MCU, var::StaticHashMap provides a fixed capacity map
+ * that does not use dynamic memory. A HashMap can also be constructed
+ * with memory provided by the application (see HashMap(void*, u32)).
+ *
+ */
+template<typename K, typename V, typename H = Hash<K> > class HashMap : public HashTable<K, HashMapEntry<K,V>, H> {
+public:
+    typedef HashMapEntry<K,V> Entry;
+    typedef HashTable<K, Entry, H> Table;
+
+    /*! \details Constructs an empty map that allocates memory as needed. */
+    HashMap(){}
+
+    /*! \details Constructs an empty map with a fixed capacity.
+     *
+     * @param mem A pointer to the memory to use (must be aligned for the entries)
+     * @param size The number of bytes available at \a mem
+     *
+     * Use Table::calc_memory_size() to determine how much memory is needed.
+     *
+     */
+    HashMap(void * mem, u32 size) : Table(mem, size){}
+
+    /*! \details Constructs a map as a copy of \a a. */
+    HashMap(const HashMap & a){ Table::copy_entries(a); }
+
+    /*! \details Assigns the entries of \a a to this map. */
+    HashMap & operator=(const HashMap & a){
+        if( this != &a ){
+            Table::copy_entries(a);
+        }
+        return *this;
+    }
+
+    /*! \details Inserts or updates an entry.
+     *
+     * @param key The key
+     * @param value The value to assign to \a key
+     * @return Zero on success or -1 if the entry could not be added
+     *
+     */
+    int insert(const K & key, const V & value){
+        Entry * entry = Table::find_entry(key);
+        if( entry ){
+            entry->value = value;
+            return 0;
+        }
+        alignas(Entry) u8 buffer[sizeof(Entry)];
+        new((void*)buffer) Entry(key, value);
+        return Table::insert_entry((Entry*)buffer) ? 0 : -1;
+    }
+
+    /*! \details Returns a pointer to the value for \a key or zero if \a key is not in the map. */
+    V * find(const K & key){
+        Entry * entry = Table::find_entry(key);
+        return entry ? &entry->value : 0;
+    }
+
+    /*! \details Returns a read-only pointer to the value for \a key or zero if \a key is not in the map. */
+    const V * find(const K & key) const {
+        const Entry * entry = Table::find_entry(key);
+        return entry ? &entry->value : 0;
+    }
+
+    /*! \details Returns true if \a key is in the map. */
+    bool contains(const K & key) const { return Table::find_entry(key) != 0; }
+
+    /*! \details Returns a reference to the value for \a key.
+     *
+     * If \a key is not in the map, ApiObject::exit_fatal() is called.
+     *
+     */
+    V & at(const K & key){
+        V * value = find(key);
+        if( value == 0 ){
+            api::WorkObject::exit_fatal("HashMap::at()");
+        }
+        return *value;
+    }
+
+    /*! \details Returns a read-only reference to the value for \a key. */
+    const V & at(const K & key) const {
+        const V * value = find(key);
+        if( value == 0 ){
+            api::WorkObject::exit_fatal("HashMap::at()");
+        }
+        return *value;
+    }
+
+    /*! \details Returns a reference to the value for \a key.
+     *
+     * If \a key is not in the map, an entry is inserted with
+     * a default constructed value.
+     *
+     */
+    V & operator[](const K & key){
+        V * value = find(key);
+        if( value == 0 ){
+            alignas(Entry) u8 buffer[sizeof(Entry)];
+            new((void*)buffer) Entry(key, V());
+            Entry * entry = Table::insert_entry((Entry*)buffer);
+            if( entry == 0 ){
+                api::WorkObject::exit_fatal("HashMap::operator[]");
+            }
+            value = &entry->value;
+        }
+        return *value;
+    }
+
+    /*! \details Removes the entry for \a key.
+     *
+     * @return Zero if the entry was removed or -1 if \a key was not in the map
+     */
+    int remove(const K & key){ return Table::remove_entry(key); }
+
+};
+
+/*! \brief Static Hash Map Class
+ * \details The StaticHashMap is a var::HashMap that
+ * stores its entries inside the object rather than
+ * allocating them dynamically.
+ *
+ * \a capacity_value is the number of slots and must be a power of two.
+ * The map can hold 7/8 of \a capacity_value entries.
+ *
+ * \code
+ * #include <sapi/var.hpp>
+ *
+ * StaticHashMap<u32, u16, 64> map; //up to 56 entries
+ * \endcode
+ *
+ */
+template<typename K, typename V, u32 capacity_value, typename H = Hash<K> > class StaticHashMap : public HashMap<K, V, H> {
+public:
+    typedef HashMap<K, V, H> Map;
+
+    StaticHashMap() : Map(m_memory, sizeof(m_memory)){}
+
+    StaticHashMap(const StaticHashMap & a) : Map(m_memory, sizeof(m_memory)){
+        Map::Table::copy_entries(a);
+    }
+
+    StaticHashMap & operator=(const StaticHashMap & a){
+        Map::operator=(a);
+        return *this;
+    }
+
+private:
+    alignas(typename Map::Entry) u8 m_memory[capacity_value * (sizeof(typename Map::Entry) + 1)];
+};
+
+}
+
+#endif /* VAR_HASHMAP_HPP_ */
@@ -0,0 +1,114 @@
+/*! \file */ //Copyright 2011-2018 Tyler Gilbert; All Rights Reserved
+
+#ifndef VAR_HASHSET_HPP_
+#define VAR_HASHSET_HPP_
+
+#include "HashTable.hpp"
+
+namespace var {
+
+/*! \brief Hash Set Entry Class
+ * \details A key stored in a var::HashSet.
+ */
+template<typename K> class HashSetEntry {
+public:
+    HashSetEntry(const K & k) : key(k){}
+
+    /*! \details The key (should not be modified while in a set). */
+    K key;
+};
+
+/*! \brief Hash Set Class
+ * \details The HashSet class is a collection of unique keys
+ * similar to std::unordered_set.
+ *
+ * \code
+ * #include <sapi/var.hpp>
+ *
+ * HashSet<u32> set;
+ * set.insert(5);
+ * set.insert(5); //no effect -- already in the set
+ * if( set.contains(5) ){
+ *   printf("Set has %ld key\n", set.count());
+ * }
+ * \endcode
+ *
+ * See var::HashMap for details about memory management.
+ *
+ */
+template<typename K, typename H = Hash<K> > class HashSet : public HashTable<K, HashSetEntry<K>, H> {
+public:
+    typedef HashSetEntry<K> Entry;
+    typedef HashTable<K, Entry, H> Table;
+
+    /*! \details Constructs an empty set that allocates memory as needed. */
+    HashSet(){}
+
+    /*! \details Constructs an empty set with a fixed capacity.
+     *
+     * @param mem A pointer to the memory to use (must be aligned for the keys)
+     * @param size The number of bytes available at \a mem
+     */
+    HashSet(void * mem, u32 size) : Table(mem, size){}
+
+    /*! \details Constructs a set as a copy of \a a. */
+    HashSet(const HashSet & a){ Table::copy_entries(a); }
+
+    /*! \details Assigns the keys of \a a to this set. */
+    HashSet & operator=(const HashSet & a){
+        if( this != &a ){
+            Table::copy_entries(a);
+        }
+        return *this;
+    }
+
+    /*! \details Inserts \a key in the set.
+     *
+     * @return Zero on success (including if \a key is already in the set) or -1 if the key could not be added
+     */
+    int insert(const K & key){
+        if( Table::find_entry(key) ){
+            return 0;
+        }
+        alignas(Entry) u8 buffer[sizeof(Entry)];
+        new((void*)buffer) Entry(key);
+        return Table::insert_entry((Entry*)buffer) ? 0 : -1;
+    }
+
+    /*! \details Returns true if \a key is in the set. */
+    bool contains(const K & key) const { return Table::find_entry(key) != 0; }
+
+    /*! \details Removes \a key from the set.
+     *
+     * @return Zero if \a key was removed or -1 if it was not in the set
+     */
+    int remove(const K & key){ return Table::remove_entry(key); }
+
+};
+
+/*! \brief Static Hash Set Class
+ * \details A var::HashSet with \a capacity_value slots (a power of two)
+ * stored inside the object. The set can hold 7/8 of \a capacity_value keys.
+ */
+template<typename K, u32 capacity_value, typename H = Hash<K> > class StaticHashSet : public HashSet<K, H> {
+public:
+    typedef HashSet<K, H> Set;
+
+    StaticHashSet() : Set(m_memory, sizeof(m_memory)){}
+
+    StaticHashSet(const StaticHashSet & a) : Set(m_memory, sizeof(m_memory)){
+        Set::Table::copy_entries(a);
+    }
+
+    StaticHashSet & operator=(const StaticHashSet & a){
+        Set::operator=(a);
+        return *this;
+    }
+
+private:
+    alignas(typename Set::Entry) u8 m_memory[capacity_value * (sizeof(typename Set::Entry) + 1)];
+};
+
+}
+
+#endif /* VAR_HASHSET_HPP_ */
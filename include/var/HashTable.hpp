@@ -0,0 +1,378 @@
+/*! \file */ //Copyright 2011-2018 Tyler Gilbert; All Rights Reserved
+
+#ifndef VAR_HASHTABLE_HPP_
+#define VAR_HASHTABLE_HPP_
+
+#include <new>
+#include <errno.h>
+#include <cstdlib>
+#include <cstring>
+#include "../api/VarObject.hpp"
+#include "Hash.hpp"
+
+namespace var {
+
+/*! \brief Hash Table Class
+ * \details The HashTable class is the open addressing
+ * table used by var::HashMap and var::HashSet. Applications
+ * should use those classes rather than this one.
+ *
+ * Entries are stored in one contiguous array followed by a
+ * one byte probe distance for each slot (zero marks an empty slot).
+ * Collisions are resolved with robin hood hashing: an entry
+ * being inserted takes the slot of any entry that is closer
+ * to its home slot. This keeps probe sequences short so the
+ * table can be filled to 7/8 of its capacity. Lookups only
+ * compare keys of entries that have the same home slot as the
+ * key being searched.
+ *
+ * A probe distance can't be more than MAX_DISTANCE. If an insert
+ * would need a longer probe sequence, the table grows. If growing doesn't
+ * help (many keys with the same hash) or the table can't grow, the
+ * insert fails with ENOSPC.
+ *
+ * Entries are relocated using memcpy() (like var::Vector) when
+ * the table grows or entries are displaced so they must not hold
+ * pointers to themselves (for example, var::StaticString).
+ *
+ * A table constructed with external memory has a fixed capacity
+ * and never allocates memory.
+ *
+ */
+template<typename K, typename E, typename H> class HashTable : public api::VarWorkObject {
+public:
+
+    enum {
+        MAX_DISTANCE /*! The longest probe distance (the distance is stored in a byte) */ = 255
+    };
+
+    /*! \brief Hash Table Iterator */
+    class iterator {
+    public:
+        iterator(){ m_table = 0; m_position = 0; }
+
+        E & operator*() const { return m_table->m_entries[m_position]; }
+        E * operator->() const { return m_table->m_entries + m_position; }
+
+        iterator & operator++(){ m_position = m_table->next_position(m_position+1); return *this; }
+        iterator operator++(int){ iterator result(*this); ++(*this); return result; }
+
+        bool operator==(const iterator & a) const { return m_position == a.m_position; }
+        bool operator!=(const iterator & a) const { return m_position != a.m_position; }
+
+    private:
+        friend class HashTable;
+        iterator(const HashTable * table, u32 position){ m_table = table; m_position = position; }
+        const HashTable * m_table;
+        u32 m_position;
+    };
+
+    typedef iterator const_iterator;
+
+    /*! \details Returns an iterator to the first entry.
+     *
+     * Entries are not in any particular order.
+     *
+     */
+    iterator begin() const { return iterator(this, next_position(0)); }
+
+    /*! \details Returns an iterator to one past the last entry. */
+    iterator end() const { return iterator(this, m_capacity); }
+
+    /*! \details Returns the number of entries in the table. */
+    u32 count() const { return m_count; }
+
+    /*! \details Returns true if the table has no entries. */
+    bool is_empty() const { return m_count == 0; }
+
+    /*! \details Returns the number of slots in the table. */
+    u32 capacity() const { return m_capacity; }
+
+    /*! \details Returns the number of entries the table can hold
+     * before it needs to grow.
+     */
+    u32 max_count() const { return m_capacity - m_capacity/8; }
+
+    /*! \details Returns true if the table uses external memory and can't grow. */
+    bool is_fixed() const { return m_is_fixed; }
+
+    /*! \details Makes room for at least \a count entries.
+     *
+     * @return Zero on success or -1 if the memory could not be allocated
+     *
+     * Calling this before inserting a known number of entries avoids
+     * rehashing the table as it grows.
+     *
+     */
+    int reserve(u32 count){
+        u32 new_capacity = minimum_capacity();
+        while( new_capacity - new_capacity/8 < count ){
+            if( new_capacity > (u32)-1 / 2 / (sizeof(E) + 1) ){
+                set_error_number(ENOMEM);
+                return -1;
+            }
+            new_capacity <<= 1;
+        }
+        if( new_capacity > m_capacity ){
+            return resize(new_capacity);
+        }
+        return 0;
+    }
+
+    /*! \details Removes all entries.
+     *
+     * Dynamically allocated memory is freed.
+     */
+    void clear(){
+        for(u32 i=0; i < m_capacity; i++){
+            if( m_distance[i] ){
+                m_entries[i].~E();
+                m_distance[i] = 0;
+            }
+        }
+        m_count = 0;
+        if( !m_is_fixed ){
+            ::free(m_entries);
+            m_entries = 0;
+            m_distance = 0;
+            m_capacity = 0;
+        }
+    }
+
+    /*! \details Calculates the number of bytes needed for \a capacity slots. */
+    static u32 calc_memory_size(u32 capacity){ return capacity * (sizeof(E) + 1); }
+
+protected:
+    HashTable(){
+        m_entries = 0;
+        m_distance = 0;
+        m_capacity = 0;
+        m_count = 0;
+        m_is_fixed = false;
+    }
+
+    HashTable(void * mem, u32 size){
+        m_capacity = minimum_capacity();
+        while( calc_memory_size(m_capacity*2) <= size ){
+            m_capacity <<= 1;
+        }
+        if( calc_memory_size(m_capacity) > size ){
+            m_capacity = 0;
+        }
+        m_entries = (E*)mem;
+        m_distance = (u8*)(m_entries + m_capacity);
+        memset(m_distance, 0, m_capacity);
+        m_count = 0;
+        m_is_fixed = true;
+    }
+
+    ~HashTable(){
+        clear();
+    }
+
+    E * find_entry(const K & key) const {
+        if( m_count == 0 ){ return 0; }
+        u32 mask = m_capacity - 1;
+        u32 position = m_hash(key) & mask;
+        u32 distance = 1;
+        for(;;){
+            u32 slot_distance = m_distance[position];
+            if( slot_distance < distance ){
+                //the key would have displaced this entry
+                return 0;
+            }
+            if( (slot_distance == distance) && (m_entries[position].key == key) ){
+                return m_entries + position;
+            }
+            position = (position + 1) & mask;
+            distance++;
+        }
+    }
+
+    //entry must be constructed in raw storage; on success it is owned by the table
+    E * insert_entry(E * entry){
+        u32 hash = m_hash(entry->key);
+        if( m_count >= max_count() ){
+            if( m_is_fixed ){
+                set_error_number(ENOSPC);
+                entry->~E();
+                return 0;
+            }
+            if( resize(m_capacity ? m_capacity*2 : minimum_capacity()) < 0 ){
+                entry->~E();
+                return 0;
+            }
+        }
+
+        while( !is_placeable(hash) ){
+            //growing splits long clusters but doesn't help keys that have the same hash
+            if( m_is_fixed || (m_count < m_capacity/4) ){
+                set_error_number(ENOSPC);
+                entry->~E();
+                return 0;
+            }
+            if( resize(m_capacity*2) < 0 ){
+                entry->~E();
+                return 0;
+            }
+        }
+
+        m_count++;
+        return place(entry, hash);
+    }
+
+    int remove_entry(const K & key){
+        E * entry = find_entry(key);
+        if( entry == 0 ){
+            return -1;
+        }
+        u32 mask = m_capacity - 1;
+        u32 position = entry - m_entries;
+        u32 next = (position + 1) & mask;
+        entry->~E();
+
+        //shift the following entries back towards their home slot
+        while( m_distance[next] > 1 ){
+            memcpy((void*)(m_entries + position), m_entries + next, sizeof(E));
+            m_distance[position] = m_distance[next] - 1;
+            position = next;
+            next = (next + 1) & mask;
+        }
+        m_distance[position] = 0;
+        m_count--;
+        return 0;
+    }
+
+    void copy_entries(const HashTable & a){
+        clear();
+        if( reserve(a.count()) < 0 ){
+            return;
+        }
+        for(iterator it = a.begin(); it != a.end(); ++it){
+            alignas(E) u8 buffer[sizeof(E)];
+            new((void*)buffer) E(*it);
+            insert_entry((E*)buffer);
+        }
+    }
+
+private:
+    friend class iterator;
+
+    E * m_entries;
+    u8 * m_distance;
+    u32 m_capacity;
+    u32 m_count;
+    bool m_is_fixed;
+    H m_hash;
+
+    static u32 minimum_capacity(){ return 8; }
+
+    u32 next_position(u32 position) const {
+        while( (position < m_capacity) && (m_distance[position] == 0) ){
+            position++;
+        }
+        return position;
+    }
+
+    //checks (without moving anything) that place() won't need a distance over MAX_DISTANCE
+    bool is_placeable(u32 hash) const {
+        u32 mask = m_capacity - 1;
+        u32 position = hash & mask;
+        u32 distance = 1;
+        while( m_distance[position] ){
+            if( m_distance[position] < distance ){
+                //place() continues with the displaced entry
+                distance = m_distance[position];
+            }
+            position = (position + 1) & mask;
+            if( ++distance > MAX_DISTANCE ){
+                return false;
+            }
+        }
+        return true;
+    }
+
+    E * place(E * entry, u32 hash){
+        u32 mask = m_capacity - 1;
+        u32 position = hash & mask;
+        u32 distance = 1;
+        E * result = 0;
+        alignas(E) u8 carry[sizeof(E)];
+        alignas(E) u8 swap[sizeof(E)];
+
+        memcpy(carry, (void*)entry, sizeof(E));
+        for(;;){
+            if( m_distance[position] == 0 ){
+                memcpy((void*)(m_entries + position), carry, sizeof(E));
+                m_distance[position] = distance;
+                return result ? result : m_entries + position;
+            }
+
+            if( m_distance[position] < distance ){
+                //take the slot from the entry that is closer to home
+                memcpy(swap, (void*)(m_entries + position), sizeof(E));
+                memcpy((void*)(m_entries + position), carry, sizeof(E));
+                memcpy(carry, swap, sizeof(E));
+                u32 slot_distance = m_distance[position];
+                m_distance[position] = distance;
+                distance = slot_distance;
+                if( result == 0 ){
+                    result = m_entries + position;
+                }
+            }
+
+            position = (position + 1) & mask;
+            distance++;
+        }
+    }
+
+    int resize(u32 new_capacity){
+        if( m_is_fixed ){
+            set_error_number(ENOSPC);
+            return -1;
+        }
+
+        if( new_capacity > (u32)-1 / (sizeof(E) + 1) ){
+            set_error_number(ENOMEM);
+            return -1;
+        }
+
+        E * entries = (E*)set_error_number_if_null(malloc(calc_memory_size(new_capacity)));
+        if( entries == 0 ){
+            return -1;
+        }
+
+        E * old_entries = m_entries;
+        u8 * old_distance = m_distance;
+        u32 old_capacity = m_capacity;
+
+        m_entries = entries;
+        m_distance = (u8*)(entries + new_capacity);
+        m_capacity = new_capacity;
+        memset(m_distance, 0, new_capacity);
+
+        //entries are copied so the old table is intact if the new one doesn't work out
+        for(u32 i=0; i < old_capacity; i++){
+            if( old_distance[i] ){
+                u32 hash = m_hash(old_entries[i].key);
+                if( !is_placeable(hash) ){
+                    ::free(m_entries);
+                    m_entries = old_entries;
+                    m_distance = old_distance;
+                    m_capacity = old_capacity;
+                    set_error_number(ENOSPC);
+                    return -1;
+                }
+                place(old_entries + i, hash);
+            }
+        }
+
+        ::free(old_entries);
+        return 0;
+    }
+
+};
+
+}
+
+#endif /* VAR_HASHTABLE_HPP_ */
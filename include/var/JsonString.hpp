@@ -9,6 +9,13 @@
 
 namespace var {
 
+/*! \brief JSON String Class
+ * \details The JsonString class builds a small JSON document in a String.
+ *
+ * Use fmt::JsonWriter to write large documents directly to a file
+ * or socket (it also escapes strings and writes numbers without quotes).
+ *
+ */
 class JsonString : public String {
 public:
 	JsonString(bool is_object = true);
@@ -1,46 +1,381 @@
 #ifndef LIST_HPP
 #define LIST_HPP
 
-#include "Queue.hpp"
+#include <new>
+#include <cstdlib>
+#include "../api/VarObject.hpp"
 
-#if 0
 namespace var {
 
-//this shouldn't be documented until it is implemented and tested
-template <class T> class List : public Queue {
+/*! \brief List Class
+ * \details The List class is a doubly linked list
+ * similar to std::list.
+ *
+ * Items can be inserted and erased anywhere in the list
+ * in constant time and iterators remain valid until
+ * the item they refer to is erased. Items can be moved
+ * between lists using splice() without any memory allocation.
+ *
+ * \code
+ * #include <sapi/var.hpp>
+ *
+ * List<u32> list;
+ * list.push_back(2);
+ * list.push_back(3);
+ * list.push_front(1);
+ *
+ * for(List<u32>::iterator it = list.begin(); it != list.end(); ++it){
+ *   printf("Item is %ld\n", *it);
+ * }
+ *
+ * //remove even numbers
+ * List<u32>::iterator it = list.begin();
+ * while( it != list.end() ){
+ *   if( (*it & 0x01) == 0 ){
+ *     it = list.erase(it);
+ *   } else {
+ *     ++it;
+ *   }
+ * }
+ * \endcode
+ *
+ * If you need a first-in first-out list, var::Queue stores its
+ * items contiguously and is faster for that purpose.
+ *
+ */
+template<typename T> class List : public api::VarWorkObject {
+private:
+    typedef struct list_link {
+        struct list_link * previous;
+        struct list_link * next;
+    } link_t;
+
+    typedef struct {
+        link_t link;
+        T value;
+    } node_t;
+
 public:
-    List();
-
-    //insert
-    //erase
-    //remove //remove if equal to another value
-    //remove_if (uses Predicates)
-    //sort
-    //unique
-    //resize
-    //clear
-
-    //push_front
-    //push_back -- same as Queue::push
+
+    /*! \brief List Iterator */
+    class iterator {
+    public:
+        iterator(){ m_link = 0; }
+
+        T & operator*() const { return ((node_t*)m_link)->value; }
+        T * operator->() const { return &((node_t*)m_link)->value; }
+
+        iterator & operator++(){ m_link = m_link->next; return *this; }
+        iterator operator++(int){ iterator result(*this); m_link = m_link->next; return result; }
+        iterator & operator--(){ m_link = m_link->previous; return *this; }
+        iterator operator--(int){ iterator result(*this); m_link = m_link->previous; return result; }
+
+        bool operator==(const iterator & a) const { return m_link == a.m_link; }
+        bool operator!=(const iterator & a) const { return m_link != a.m_link; }
+
+    private:
+        friend class List;
+        iterator(link_t * link){ m_link = link; }
+        link_t * m_link;
+    };
+
+    /*! \brief List Read-only Iterator */
+    class const_iterator {
+    public:
+        const_iterator(){ m_link = 0; }
+        const_iterator(const iterator & a){ m_link = a.m_link; }
+
+        const T & operator*() const { return ((const node_t*)m_link)->value; }
+        const T * operator->() const { return &((const node_t*)m_link)->value; }
+
+        const_iterator & operator++(){ m_link = m_link->next; return *this; }
+        const_iterator operator++(int){ const_iterator result(*this); m_link = m_link->next; return result; }
+        const_iterator & operator--(){ m_link = m_link->previous; return *this; }
+        const_iterator operator--(int){ const_iterator result(*this); m_link = m_link->previous; return result; }
+
+        bool operator==(const const_iterator & a) const { return m_link == a.m_link; }
+        bool operator!=(const const_iterator & a) const { return m_link != a.m_link; }
+
+    private:
+        friend class List;
+        const_iterator(const link_t * link){ m_link = link; }
+        const link_t * m_link;
+    };
+
+    /*! \details Constructs an empty list. */
+    List(){
+        set_initial_values();
+    }
+
+    /*! \details Constructs a list as a copy of \a a. */
+    List(const List & a){
+        set_initial_values();
+        assign(a);
+    }
+
+    /*! \details Assigns the contents of \a a to this list. */
+    List & operator=(const List & a){
+        if( this != &a ){
+            assign(a);
+        }
+        return *this;
+    }
+
+    ~List(){
+        clear();
+    }
+
+    /*! \details Returns an iterator to the first item. */
+    iterator begin(){ return iterator(m_sentinel.next); }
+    /*! \details Returns an iterator to one past the last item. */
+    iterator end(){ return iterator(&m_sentinel); }
+
+    /*! \details Returns a read-only iterator to the first item. */
+    const_iterator begin() const { return const_iterator(m_sentinel.next); }
+    /*! \details Returns a read-only iterator to one past the last item. */
+    const_iterator end() const { return const_iterator(&m_sentinel); }
+
+    /*! \details Returns a reference to the first item.
+     *
+     * The list must not be empty.
+     */
+    T & front(){ return *begin(); }
+    /*! \details Returns a read-only reference to the first item. */
+    const T & front() const { return *begin(); }
+
+    /*! \details Returns a reference to the last item.
+     *
+     * The list must not be empty.
+     */
+    T & back(){ return *iterator(m_sentinel.previous); }
+    /*! \details Returns a read-only reference to the last item. */
+    const T & back() const { return *const_iterator(m_sentinel.previous); }
+
+    /*! \details Returns the number of items in the list. */
+    u32 count() const { return m_count; }
+
+    /*! \details Returns true if the list is empty. */
+    bool is_empty() const { return m_count == 0; }
+
+    /*! \details Inserts a copy of \a value before \a pos.
+     *
+     * @param pos The position to insert the item (end() to append)
+     * @param value The item to copy to the list
+     * @return An iterator to the new item or end() if memory could not be allocated
+     *
+     */
+    iterator insert(iterator pos, const T & value){
+        node_t * node = (node_t*)set_error_number_if_null(malloc(sizeof(node_t)));
+        if( node == 0 ){
+            return end();
+        }
+        new((void*)&node->value) T(value);
+        link(pos.m_link, &node->link);
+        m_count++;
+        return iterator(&node->link);
+    }
+
+    /*! \details Erases the item at \a pos.
+     *
+     * @param pos The item to erase (must not be end())
+     * @return An iterator to the item following the erased item
+     *
+     */
+    iterator erase(iterator pos){
+        link_t * next = pos.m_link->next;
+        unlink(pos.m_link);
+        m_count--;
+        destroy(pos.m_link);
+        return iterator(next);
+    }
+
+    /*! \details Erases the items from \a first up to but not including \a last.
+     *
+     * @return \a last
+     */
+    iterator erase(iterator first, iterator last){
+        while( first != last ){
+            first = erase(first);
+        }
+        return last;
+    }
+
     /*! \details Pushes an item on the back of the list.
      *
      * @param value The item to copy to the list
      * @return Zero on success
      */
     int push_back(const T & value){
-        return push(value);
+        return insert(end(), value) == end() ? -1 : 0;
+    }
+
+    /*! \details Pushes an item on the front of the list.
+     *
+     * @param value The item to copy to the list
+     * @return Zero on success
+     */
+    int push_front(const T & value){
+        return insert(begin(), value) == end() ? -1 : 0;
     }
-    //pop_front
 
     /*! \details Pops the first item in the list. */
-    void pop_front(){ pop(); }
+    void pop_front(){
+        if( m_count ){ erase(begin()); }
+    }
+
+    /*! \details Pops the last item in the list. */
+    void pop_back(){
+        if( m_count ){ erase(iterator(m_sentinel.previous)); }
+    }
+
+    /*! \details Finds the first item that is equal to \a value.
+     *
+     * @return An iterator to the item or end() if it was not found
+     */
+    iterator find(const T & value){
+        iterator it = begin();
+        while( (it != end()) && !(*it == value) ){
+            ++it;
+        }
+        return it;
+    }
 
-    //pop_back
+    /*! \details Removes all items that are equal to \a value.
+     *
+     * @return The number of items that were removed
+     */
+    u32 remove(const T & value){
+        u32 result = 0;
+        iterator it = begin();
+        while( it != end() ){
+            if( *it == value ){
+                it = erase(it);
+                result++;
+            } else {
+                ++it;
+            }
+        }
+        return result;
+    }
+
+    /*! \details Moves all items from \a a to this list before \a pos.
+     *
+     * @param pos The position in this list to insert the items
+     * @param a The list to move items from (will be empty after the call)
+     *
+     * No items are copied and no memory is allocated.
+     *
+     */
+    void splice(iterator pos, List & a){
+        splice(pos, a, a.begin(), a.end());
+    }
 
+    /*! \details Moves the item at \a it from \a a to this list before \a pos.
+     *
+     * \a a may be the same list as this one.
+     *
+     */
+    void splice(iterator pos, List & a, iterator it){
+        if( (pos == it) || (pos.m_link == it.m_link->next) ){
+            return;
+        }
+        a.unlink(it.m_link);
+        a.m_count--;
+        link(pos.m_link, it.m_link);
+        m_count++;
+    }
+
+    /*! \details Moves the items from \a first up to but not including \a last
+     * from \a a to this list before \a pos.
+     *
+     * The run time is constant if \a a is this list or if the whole
+     * list is moved, otherwise the moved items are counted.
+     *
+     */
+    void splice(iterator pos, List & a, iterator first, iterator last){
+        if( first == last ){
+            return;
+        }
+
+        if( &a != this ){
+            u32 moved;
+            if( (first == a.begin()) && (last == a.end()) ){
+                moved = a.m_count;
+            } else {
+                moved = 0;
+                for(iterator it = first; it != last; ++it){
+                    moved++;
+                }
+            }
+            a.m_count -= moved;
+            m_count += moved;
+        }
+
+        link_t * first_link = first.m_link;
+        link_t * last_link = last.m_link->previous;
+
+        //detach the range from its list
+        first_link->previous->next = last.m_link;
+        last.m_link->previous = first_link->previous;
+
+        //attach the range before pos
+        first_link->previous = pos.m_link->previous;
+        last_link->next = pos.m_link;
+        pos.m_link->previous->next = first_link;
+        pos.m_link->previous = last_link;
+    }
+
+    /*! \details Removes all items from the list and frees the memory. */
+    void clear(){
+        link_t * current = m_sentinel.next;
+        while( current != &m_sentinel ){
+            link_t * next = current->next;
+            destroy(current);
+            current = next;
+        }
+        set_initial_values();
+    }
+
+private:
+    link_t m_sentinel;
+    u32 m_count;
+
+    void set_initial_values(){
+        m_sentinel.previous = &m_sentinel;
+        m_sentinel.next = &m_sentinel;
+        m_count = 0;
+    }
+
+    //inserts item before pos
+    static void link(link_t * pos, link_t * item){
+        item->next = pos;
+        item->previous = pos->previous;
+        pos->previous->next = item;
+        pos->previous = item;
+    }
+
+    static void unlink(link_t * item){
+        item->previous->next = item->next;
+        item->next->previous = item->previous;
+    }
+
+    static void destroy(link_t * item){
+        node_t * node = (node_t*)item;
+        node->value.~T();
+        ::free(node);
+    }
+
+    void assign(const List & a){
+        clear();
+        for(const_iterator it = a.begin(); it != a.end(); ++it){
+            if( push_back(*it) < 0 ){
+                return;
+            }
+        }
+    }
 
 };
 
 }
-#endif
 
 #endif // LIST_HPP
@@ -2,8 +2,9 @@
 #define QUEUE_HPP
 
 #include <new>
+#include <errno.h>
 #include <cstdio>
-#include "LinkedList.hpp"
+#include <cstdlib>
 #include "../api/VarObject.hpp"
 
 namespace var {
@@ -14,15 +15,56 @@ namespace var {
  * and popped from the front. It is similar to the
  * std::queue container class.
  *
+ * The items are stored in a single contiguous ring
+ * buffer. When the buffer fills up, it is doubled in size
+ * and the items are moved to the new buffer. Popping
+ * items never frees memory so a queue that is
+ * repeatedly drained and refilled does not touch the heap
+ * once it has reached its working size.
+ *
+ * \code
+ * #include <sapi/var.hpp>
+ *
+ * Queue<u32> queue;
+ * queue.reserve(64); //optional -- avoids growing while pushing
+ * queue.push(10);
+ * queue.push(20);
+ * printf("Front is %ld\n", queue.front()); //10
+ * queue.pop();
+ * printf("Front is %ld\n", queue.front()); //20
+ * \endcode
+ *
  */
 template<typename T> class Queue : public api::VarWorkObject {
 public:
 
-    /*! \details Constructs a new Queue. */
-    Queue() : m_linked_list(sizeof(T)*jump_size()) {
+    /*! \details Constructs a new Queue.
+     *
+     * No memory is allocated until the first item
+     * is pushed (or reserve() is called).
+     *
+     */
+    Queue(){
         set_initial_values();
     }
 
+    /*! \details Constructs a Queue as a copy of \a a. */
+    Queue(const Queue & a){
+        set_initial_values();
+        assign(a);
+    }
+
+    /*! \details Assigns the contents of \a a to this Queue. */
+    Queue & operator=(const Queue & a){
+        if( this != &a ){
+            assign(a);
+        }
+        return *this;
+    }
+
+    ~Queue(){
+        clear();
+    }
 
     /*! \details Returns a reference to the back item.
      *
@@ -31,9 +73,7 @@ public:
      *
      */
     T & back(){
-        T * back_item = (T*)m_linked_list.back();
-        //fatal error if back_item is null
-        return back_item[m_back_idx];
+        return m_buffer[index(m_count-1)];
     }
 
     /*! \details Returns a read-only reference to the back item.
@@ -43,9 +83,7 @@ public:
      *
      */
     const T & back() const {
-        const T * back_item = (const T*)m_linked_list.back();
-        //fatal error if back_item is null
-        return back_item[m_back_idx];
+        return m_buffer[index(m_count-1)];
     }
 
     /*! \details Returns a read-only reference to the front item.
@@ -55,12 +93,11 @@ public:
      * on the next call to pop().
      */
     const T & front() const {
-        const T * front_item = (const T*)m_linked_list.front();
-        //fatal error if front_item is null
-        if( front_item == 0 ){
+        //fatal error if the queue is empty
+        if( m_count == 0 ){
             exit_fatal("Queue::front()");
         }
-        return front_item[m_front_idx];
+        return m_buffer[m_front];
     }
 
     /*! \details Returns a reference to the front item.
@@ -70,69 +107,92 @@ public:
      * on the next call to pop().
      */
     T & front(){
-        T * front_item = (T*)m_linked_list.front();
-        //fatal error if front_item is null
-        return front_item[m_front_idx];
+        return m_buffer[m_front];
     }
 
+    /*! \details Returns a reference to the item at \a pos
+     * counting from the front of the queue.
+     *
+     * @param pos The position relative to front() (zero is the front)
+     *
+     * The position is not checked against count().
+     *
+     */
+    T & at(u32 pos){ return m_buffer[index(pos)]; }
+
+    /*! \details Returns a read-only reference to the item at \a pos. */
+    const T & at(u32 pos) const { return m_buffer[index(pos)]; }
+
     /*! \details Pushes an item on the back of the queue.
      *
      * @param value The item to push
+     * @return Zero on success or -1 if memory could not be allocated
      *
      */
     int push(const T & value){
-        m_back_idx++;
-        if( m_back_idx == jump_size() ){
-          if( m_linked_list.push_back() < 0 ){
+        if( m_count == m_capacity ){
+            if( grow(m_capacity ? m_capacity*2 : jump_size()) < 0 ){
                 return -1;
             }
-            m_back_idx = 0;
         }
-        new((void*)&back()) T(value);
+        new((void*)(m_buffer + index(m_count))) T(value);
+        m_count++;
         return 0;
     }
 
-    /*! \details Pops an item from the front fo the queue. */
+    /*! \details Pops an item from the front of the queue.
+     *
+     * The memory used by the item is kept for use
+     * by subsequent calls to push().
+     *
+     */
     void pop(){
-        if( m_linked_list.is_empty() ){
+        if( m_count == 0 ){
             return;
         }
 
-        front().~T();
-
-        //if the last item was popped -- clear the list (ie make empty)
-        if( (m_linked_list.front() == m_linked_list.back())
-                && (m_front_idx == m_back_idx) ){
-            m_linked_list.clear();
-            set_initial_values();
-        } else {
-            m_front_idx++;
+        m_buffer[m_front].~T();
+        m_front = (m_front + 1) & (m_capacity-1);
+        m_count--;
 
-            //if all items in the front array have been popped free it
-            if( m_front_idx == jump_size() ){
-                m_linked_list.pop_front();
-                m_front_idx = 0;
-            }
+        if( m_count == 0 ){
+            //keeps the items contiguous when the queue is refilled
+            m_front = 0;
         }
     }
 
-
     /*! \details Returns true if the queue is empty. */
-    bool is_empty() const { return m_linked_list.is_empty(); }
+    bool is_empty() const { return m_count == 0; }
 
     /*! \details Returns the number of items in the queue. */
-    u32 count() const {
-        int linked_count = m_linked_list.count();
-        if( linked_count ){
+    u32 count() const { return m_count; }
 
-            if( linked_count == 1 ){
-                return m_back_idx - m_front_idx + 1;
-            }
+    /*! \details Returns the number of items the queue can
+     * hold before more memory needs to be allocated.
+     */
+    u32 capacity() const { return m_capacity; }
 
-            return m_back_idx +
-                    jump_size() - m_front_idx +
-                    (linked_count-2)*jump_size() +
-                    1;
+    /*! \details Reserves space for at least \a count items.
+     *
+     * @param count The minimum number of items to make room for
+     * @return Zero on success or -1 if memory could not be allocated
+     * (ENOMEM if \a count items can't fit in the address space)
+     *
+     * The capacity is always a power of two so that
+     * the index can wrap using a mask rather than a division.
+     *
+     */
+    int reserve(u32 count){
+        u32 new_capacity = jump_size();
+        if( count > max_capacity() ){
+            set_error_number(ENOMEM);
+            return -1;
+        }
+        while( new_capacity < count ){
+            new_capacity <<= 1;
+        }
+        if( new_capacity > m_capacity ){
+            return grow(new_capacity);
         }
         return 0;
     }
@@ -144,23 +204,77 @@ public:
      *
      */
     void clear(){
-        m_linked_list.clear();
+        while( m_count ){
+            pop();
+        }
+        ::free(m_buffer);
         set_initial_values();
     }
 
 
 private:
-    u16 m_front_idx;
-    u16 m_back_idx;
+    T * m_buffer;
+    u32 m_capacity;
+    u32 m_front;
+    u32 m_count;
 
     void set_initial_values(){
-        m_front_idx = 0;
-        m_back_idx = jump_size()-1;
+        m_buffer = 0;
+        m_capacity = 0;
+        m_front = 0;
+        m_count = 0;
+    }
+
+    u32 index(u32 pos) const {
+        return (m_front + pos) & (m_capacity-1);
+    }
+
+    int grow(u32 new_capacity){
+        //doubling a large capacity wraps to zero
+        if( (new_capacity <= m_capacity) || (new_capacity > max_capacity()) ){
+            set_error_number(ENOMEM);
+            return -1;
+        }
+
+        T * new_buffer = (T*)set_error_number_if_null(malloc(new_capacity*sizeof(T)));
+        if( new_buffer == 0 ){
+            return -1;
+        }
+
+        //move the items to the new buffer so that the front is at zero
+        for(u32 i=0; i < m_count; i++){
+            T & item = at(i);
+            new((void*)(new_buffer + i)) T(item);
+            item.~T();
+        }
+
+        ::free(m_buffer);
+        m_buffer = new_buffer;
+        m_capacity = new_capacity;
+        m_front = 0;
+        return 0;
     }
 
-    static int jump_size(){ return 16; }
+    void assign(const Queue & a){
+        clear();
+        if( reserve(a.count()) < 0 ){
+            return;
+        }
+        for(u32 i=0; i < a.count(); i++){
+            push(a.at(i));
+        }
+    }
 
-    LinkedList m_linked_list;
+    static u32 jump_size(){ return 16; }
+
+    //the largest power of two number of items whose size in bytes fits in a u32
+    static u32 max_capacity(){
+        u32 result = 0x80000000;
+        while( result > (u32)-1 / sizeof(T) ){
+            result >>= 1;
+        }
+        return result;
+    }
 
 };
 
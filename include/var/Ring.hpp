@@ -14,35 +14,82 @@
 
 namespace var {
 
+/*! \brief Ring Buffer (untyped)
+ * \details RingBuffer manages the indices and the memory of a
+ * single-producer, single-consumer ring buffer of fixed size items.
+ * It is the base of the Ring template class which should be used
+ * by applications.
+ *
+ * The head (write) index is only modified by the producer and the
+ * tail (read) index is only modified by the consumer. The indices
+ * are published using acquire/release memory ordering so one
+ * thread (or interrupt/signal handler) can write while another thread
+ * reads without using a sys::Mutex.
+ *
+ * The number of items is always a power of two so that
+ * the indices can wrap using a mask.
+ *
+ */
 class RingBuffer : public Data {
 public:
 
-    RingBuffer(void * buf, u32 size);
-    RingBuffer(u32 size);
+    /*! \details Constructs a ring buffer using external memory.
+     *
+     * @param buf A pointer to the memory
+     * @param count The number of items that fit in \a buf
+     * @param item_size The size of each item in bytes
+     *
+     * If \a count is not a power of two, only the largest
+     * power of two less than \a count is used.
+     *
+     */
+    RingBuffer(void * buf, u32 count, u32 item_size = 1);
+
+    /*! \details Constructs a ring buffer using dynamically allocated memory.
+     *
+     * @param count The minimum number of items (rounded up to a power of two)
+     * @param item_size The size of each item in bytes
+     *
+     * If the memory can't be allocated (or \a count items don't fit in
+     * the address space), count() is zero and the error number is ENOMEM.
+     *
+     */
+    RingBuffer(u32 count, u32 item_size = 1);
+
+    /*! \details Accesses the number of items the buffer can hold. */
+    u32 count() const { return m_count; }
 
-    /*! \details Accesses the size of the buffer. */
-    u32 size() const { return m_size; }
+    /*! \details Accesses the size of each item in bytes. */
+    u32 item_size() const { return m_item_size; }
 
-    /*! \details Calculates the number of bytes calc_used in the buffer. */
+    /*! \details Calculates the number of items used in the buffer. */
     u32 calc_used() const;
 
-    /*! \details Calculates the number of free bytes in the buffer. */
+    /*! \details Calculates the number of free items in the buffer. */
     u32 calc_free() const;
 
-    /*! \details Flushes the buffer. */
+    /*! \details Flushes the buffer.
+     *
+     * This modifies both indices so it must not be called
+     * while the producer or consumer is active.
+     */
     void flush(void);
 
     /*! \details Accesses whether or not buffer allows overwriting
-     * The default value for overflow allowed is true. Use
-     * set_overflow_allowed(false) to disable overflow.
+     * The default value for overflow allowed is false. Use
+     * set_overflow_allowed(true) to enable overflow.
      */
     bool is_overflow_allowed() const { return m_is_overflow_allowed; }
 
     /*! \details Sets whether or not overflow is allowed in the buffer.
      *
-     * If overflow is allowed, write() will always write and return \a nbytes
-     * as specified. If overflow is not allowed, write() will only write until
-     * the buffer is full.
+     * If overflow is allowed, write() will always write and return \a count
+     * as specified by discarding the oldest items. If overflow is not allowed,
+     * write() will only write until the buffer is full.
+     *
+     * Discarding items moves the read index from the producer so overflow
+     * should only be allowed when the producer and consumer run in the same
+     * context.
      *
      * @param value True to allow overflow or false to disallow it.
      */
@@ -50,13 +97,65 @@ public:
         m_is_overflow_allowed = value;
     }
 
+    /*! \details Writes items to the buffer (producer).
+     *
+     * @param buf A pointer to the source items
+     * @param count The number of items to write
+     * @return The number of items written
+     *
+     * The items are copied using at most two calls to memcpy().
+     *
+     */
+    u32 write(const void * buf, u32 count);
+
+    /*! \details Reads items from the buffer (consumer).
+     *
+     * @param buf A pointer to the destination
+     * @param count The maximum number of items to read
+     * @return The number of items read
+     */
+    u32 read(void * buf, u32 count);
+
+    /*! \details Reserves contiguous space for writing (producer).
+     *
+     * @param count Is assigned the number of contiguous free items
+     * @return A pointer to the first free item
+     *
+     * After the items have been written in place, call commit_write()
+     * to make them visible to the consumer.
+     *
+     */
+    void * reserve_write(u32 & count);
+
+    /*! \details Makes \a count items that were written in place
+     * using reserve_write() available to the consumer.
+     */
+    void commit_write(u32 count);
+
+    /*! \details Reserves contiguous items for reading (consumer).
+     *
+     * @param count Is assigned the number of contiguous items available
+     * @return A pointer to the oldest item in the buffer
+     *
+     * After the items have been processed in place, call
+     * commit_read() to free the space for the producer.
+     *
+     */
+    void * reserve_read(u32 & count);
+
+    /*! \details Frees \a count items that were accessed using
+     * reserve_read().
+     */
+    void commit_read(u32 count);
+
 protected:
+    u8 * item_data(u32 idx) const { return (u8*)data() + (idx & (m_count-1))*m_item_size; }
 
-    void inc_tail();
-    void inc_head();
-    u32 get_free_count(u32 count) const;
+private:
+    static u32 calc_count(u32 count, u32 item_size, bool round_up);
 
-    u32 m_size;
+    u32 m_count;
+    u32 m_item_size;
     u32 m_head;
     u32 m_tail;
     bool m_is_overflow_allowed;
@@ -67,7 +166,14 @@ protected:
  * \details Ring is a ring buffer (or circular buffer)
  * that uses a local memory buffer for the data.
  *
- * The Ring can handle items of any type.
+ * The Ring is a lock-free, single-producer, single-consumer
+ * buffer. One context (such as a hal::Device signal handler
+ * or a sys::Aio completion) can write to the buffer while
+ * another (such as a sys::Thread) reads from it without
+ * any additional locking.
+ *
+ * Items are copied using memcpy() so \a T should be
+ * a plain data type.
  *
  * \code
  *
@@ -76,6 +182,15 @@ protected:
  * ring.write(&next, 1);
  * ring.read(&next, 1); //read into next variable
  *
+ * //zero-copy access
+ * u32 count;
+ * u32 * samples = ring.reserve_write(count);
+ * //up to count samples can be written directly to samples
+ * ring.commit_write(count);
+ *
+ * const u32 * values = ring.reserve_read(count);
+ * //count values can be processed in place
+ * ring.commit_read(count);
  *
  * \endcode
  *
@@ -87,36 +202,26 @@ public:
 	/*! \details Constructs a new ring buffer.
 	 *
 	 * @param buf A pointer to the data
-	 * @param size The number of bytes in the new ring buffer
+     * @param count The number of items in \a buf (should be a power of two)
 	 */
-    Ring(T * buf, u32 count) : RingBuffer(buf, count*sizeof(T)){}
+    Ring(T * buf, u32 count) : RingBuffer(buf, count, sizeof(T)){}
 
 
     /*! \details Constructs a new ring buffer.
      *
-     * @param size The number of bytes to allocate for the new buffer.
+     * @param count The number of items to allocate (rounded up to a power of two)
      *
      */
-    Ring(u32 count) : RingBuffer(count * sizeof(T)){}
+    Ring(u32 count) : RingBuffer(count, sizeof(T)){}
 
 	/*! \details Writes data to the ring buffer.
 	 *
 	 * @param buf Pointer to the data to write
-     * @param count The number of bytes to write
-	 * @return The number of bytes written
+     * @param count The number of items to write
+     * @return The number of items written
 	 */
     int write(const T * buf, u32 count){
-        u32 i;
-        u32 free_items;
-
-        count = get_free_count(count);
-
-        for(i=0; i < count; i++){
-            type_data()[m_head] = buf[i];
-            inc_head();
-
-        }
-        return count;
+        return RingBuffer::write(buf, count);
     }
 
     /*! \details Pushes a value on the Ring buffer.
@@ -143,31 +248,18 @@ public:
 	/*! \details Reads data from the ring buffer.
 	 *
 	 * @param buf A pointer to the destination data buffer
-     * @param count The number of bytes to read
-	 * @return
+     * @param count The number of items to read
+     * @return The number of items read
 	 */
     int read(T * buf, u32 count){
-        u32 i;
-
-        for(i=0; i < count; i++){
-            if( m_tail != m_head ){
-                if( m_tail == m_size ){
-                    m_tail = m_head;
-                }
-                buf[i] = type_data()[m_tail];
-                inc_tail();
-            } else {
-                return i;
-            }
-        }
-
-        return i;
+        return RingBuffer::read(buf, count);
     }
 
-private:
-
+    /*! \details Reserves contiguous items for writing in place. \sa RingBuffer::reserve_write() */
+    T * reserve_write(u32 & count){ return (T*)RingBuffer::reserve_write(count); }
 
-    T * type_data(){ return (T*)data(); }
+    /*! \details Reserves contiguous items for reading in place. \sa RingBuffer::reserve_read() */
+    T * reserve_read(u32 & count){ return (T*)RingBuffer::reserve_read(count); }
 
 };
 
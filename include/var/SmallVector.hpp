@@ -0,0 +1,312 @@
+/*! \file */ //Copyright 2011-2018 Tyler Gilbert; All Rights Reserved
+
+#ifndef VAR_SMALLVECTOR_HPP_
+#define VAR_SMALLVECTOR_HPP_
+
+#include <new>
+#include <errno.h>
+#include <cstdlib>
+#include "Vector.hpp"
+#include "Array.hpp"
+
+namespace var {
+
+/*! \brief Small Vector Class
+ * \details The SmallVector class is a dynamically sized
+ * array that stores up to \a N items inside the object.
+ * Memory is only allocated when more than \a N items are
+ * added (the items are then moved to the heap).
+ *
+ * This is a good fit for lists that are usually short (menu
+ * entries, command line arguments, points in a path) because
+ * the common case never touches the heap.
+ *
+ * \code
+ * #include <sapi/var.hpp>
+ *
+ * SmallVector<u16, 8> items; //no allocation for the first 8 items
+ * for(u32 i=0; i < 10; i++){
+ *   items.push_back(i); //moves to the heap on the ninth item
+ * }
+ *
+ * Vector<u16> vector = items.to_vector();
+ * \endcode
+ *
+ * ### Memory Footprint
+ *
+ * Up to \a N items are stored inside the object (N*sizeof(T) bytes),
+ * so a SmallVector that stays within \a N items never allocates. A
+ * var::Vector allocates one heap block as soon as it holds an item,
+ * and a var::List allocates one block per item.
+ *
+ * Unlike var::Vector, items are moved using their copy constructor
+ * when the storage changes.
+ *
+ */
+template<typename T, u32 N> class SmallVector : public api::VarWorkObject {
+public:
+
+    /*! \details Constructs an empty vector. */
+    SmallVector(){
+        m_data = inline_data();
+        m_count = 0;
+        m_capacity = N;
+    }
+
+    /*! \details Constructs a copy of \a a. */
+    SmallVector(const SmallVector & a){
+        m_data = inline_data();
+        m_count = 0;
+        m_capacity = N;
+        assign(a.data(), a.count());
+    }
+
+    /*! \details Constructs a copy of the items in \a a. */
+    SmallVector(const Vector<T> & a){
+        m_data = inline_data();
+        m_count = 0;
+        m_capacity = N;
+        assign(a.vector_data_const(), a.count());
+    }
+
+    /*! \details Constructs a copy of the items in \a a. */
+    template<u32 size_value> SmallVector(const Array<T, size_value> & a){
+        m_data = inline_data();
+        m_count = 0;
+        m_capacity = N;
+        assign(a.data(), size_value);
+    }
+
+    ~SmallVector(){
+        clear();
+    }
+
+    /*! \details Assigns the items of \a a to this vector. */
+    SmallVector & operator=(const SmallVector & a){
+        if( this != &a ){
+            assign(a.data(), a.count());
+        }
+        return *this;
+    }
+
+    /*! \details Replaces the contents with \a count items copied from \a items.
+     *
+     * @return Zero on success or -1 if memory could not be allocated
+     */
+    int assign(const T * items, u32 count){
+        while( m_count ){ pop_back(); }
+        if( reserve(count) < 0 ){
+            return -1;
+        }
+        for(u32 i=0; i < count; i++){
+            new((void*)(m_data + i)) T(items[i]);
+        }
+        m_count = count;
+        return 0;
+    }
+
+    /*! \details Returns the number of items. */
+    u32 count() const { return m_count; }
+
+    /*! \details Returns true if there are no items. */
+    bool is_empty() const { return m_count == 0; }
+
+    /*! \details Returns the number of items that can be stored without allocating memory. */
+    u32 capacity() const { return m_capacity; }
+
+    /*! \details Returns true if the items are stored inside the object. */
+    bool is_inline() const { return m_data == inline_data(); }
+
+    /*! \details Returns the number of items stored inside the object. */
+    static u32 inline_capacity(){ return N; }
+
+    /*! \details Returns a pointer to the items. */
+    T * data(){ return m_data; }
+    /*! \details Returns a read-only pointer to the items. */
+    const T * data() const { return m_data; }
+
+    /*! \details Returns a reference to the item at \a pos.
+     *
+     * If \a pos is out of range, ApiObject::exit_fatal() is called.
+     *
+     */
+    T & at(u32 pos){
+        if( pos >= m_count ){ api::WorkObject::exit_fatal("SmallVector::at()"); }
+        return m_data[pos];
+    }
+
+    /*! \details Returns a read-only reference to the item at \a pos. */
+    const T & at(u32 pos) const {
+        if( pos >= m_count ){ api::WorkObject::exit_fatal("SmallVector::at()"); }
+        return m_data[pos];
+    }
+
+    /*! \details Accesses the item at \a idx without checking the bounds. */
+    T & operator[](u32 idx){ return m_data[idx]; }
+    /*! \details Accesses the item at \a idx without checking the bounds (read-only). */
+    const T & operator[](u32 idx) const { return m_data[idx]; }
+
+    /*! \details Returns a reference to the first item. */
+    T & front(){ return at(0); }
+    /*! \details Returns a read-only reference to the first item. */
+    const T & front() const { return at(0); }
+
+    /*! \details Returns a reference to the last item. */
+    T & back(){ return at(m_count-1); }
+    /*! \details Returns a read-only reference to the last item. */
+    const T & back() const { return at(m_count-1); }
+
+    /*! \details Returns the position of \a a or count() if \a a is not found. */
+    u32 find(const T & a) const {
+        for(u32 i=0; i < m_count; i++){
+            if( m_data[i] == a ){
+                return i;
+            }
+        }
+        return m_count;
+    }
+
+    /*! \details Makes room for at least \a count items.
+     *
+     * @return Zero on success or -1 if memory could not be allocated
+     */
+    int reserve(u32 count){
+        if( count <= m_capacity ){
+            return 0;
+        }
+        return grow(count);
+    }
+
+    /*! \details Adds an item to the end of the vector.
+     *
+     * @return Zero on success or -1 if memory could not be allocated
+     */
+    int push_back(const T & value){
+        if( m_count == m_capacity ){
+            //value may refer to an item that is about to be moved
+            T copy(value);
+            if( grow(m_capacity*2) < 0 ){
+                return -1;
+            }
+            new((void*)(m_data + m_count++)) T(copy);
+            return 0;
+        }
+        new((void*)(m_data + m_count++)) T(value);
+        return 0;
+    }
+
+    /*! \details Removes the last item. */
+    void pop_back(){
+        if( m_count ){
+            m_count--;
+            m_data[m_count].~T();
+        }
+    }
+
+    /*! \details Inserts \a value before the item at \a pos.
+     *
+     * @return Zero on success or -1 if memory could not be allocated
+     */
+    int insert(u32 pos, const T & value){
+        if( pos >= m_count ){
+            return push_back(value);
+        }
+        T copy(value);
+        if( push_back(m_data[m_count-1]) < 0 ){
+            return -1;
+        }
+        for(u32 i = m_count-2; i > pos; i--){
+            m_data[i] = m_data[i-1];
+        }
+        m_data[pos] = copy;
+        return 0;
+    }
+
+    /*! \details Removes the item at \a pos.
+     *
+     * @return Zero on success or -1 if \a pos is out of range
+     */
+    int erase(u32 pos){
+        if( pos >= m_count ){
+            set_error_number(EINVAL);
+            return -1;
+        }
+        for(u32 i = pos+1; i < m_count; i++){
+            m_data[i-1] = m_data[i];
+        }
+        pop_back();
+        return 0;
+    }
+
+    /*! \details Removes all items and frees any dynamically allocated memory. */
+    void clear(){
+        while( m_count ){ pop_back(); }
+        if( !is_inline() ){
+            ::free(m_data);
+            m_data = inline_data();
+            m_capacity = N;
+        }
+    }
+
+    /*! \details Moves the items back inside the object if they fit
+     * and frees the memory that is no longer needed.
+     */
+    void shrink_to_fit(){
+        if( !is_inline() && (m_count <= N) ){
+            T * data = m_data;
+            move_items(inline_data(), data, m_count);
+            ::free(data);
+            m_data = inline_data();
+            m_capacity = N;
+        }
+    }
+
+    /*! \details Returns a var::Vector with a copy of the items. */
+    Vector<T> to_vector() const {
+        Vector<T> result;
+        result.reserve(m_count);
+        for(u32 i=0; i < m_count; i++){
+            result.push_back(m_data[i]);
+        }
+        return result;
+    }
+
+private:
+    T * m_data;
+    u32 m_count;
+    u32 m_capacity;
+    alignas(T) u8 m_inline[N*sizeof(T)];
+
+    T * inline_data(){ return (T*)m_inline; }
+    const T * inline_data() const { return (const T*)m_inline; }
+
+    int grow(u32 count){
+        u32 new_capacity = m_capacity ? m_capacity : 1;
+        while( new_capacity < count ){
+            new_capacity *= 2;
+        }
+        T * data = (T*)set_error_number_if_null(malloc(new_capacity*sizeof(T)));
+        if( data == 0 ){
+            return -1;
+        }
+        move_items(data, m_data, m_count);
+        if( !is_inline() ){
+            ::free(m_data);
+        }
+        m_data = data;
+        m_capacity = new_capacity;
+        return 0;
+    }
+
+    static void move_items(T * dest, T * src, u32 count){
+        for(u32 i=0; i < count; i++){
+            new((void*)(dest + i)) T(src[i]);
+            src[i].~T();
+        }
+    }
+
+};
+
+}
+
+#endif /* VAR_SMALLVECTOR_HPP_ */
@@ -11,11 +11,14 @@
 #include <cstdio>
 
 #include "Data.hpp"
+#include "Vector.hpp"
 #include "StringUtil.hpp"
 #include "ConstString.hpp"
 
 namespace var {
 
+class Token;
+
 /*! \brief String class
  * \details This is an embedded friendly string class.  It is similar
  * to the C++ string type but is built on var::Data and
@@ -55,6 +58,22 @@ namespace var {
  *
  *
  *
+ * The String keeps track of its length so appending
+ * takes constant time (amortized). When the string needs more
+ * memory, the capacity is (at least) doubled. Use reserve() when the final
+ * length is known ahead of time.
+ *
+ * \code
+ * #include <sapi/var.hpp>
+ *
+ * String csv;
+ * csv.reserve(256);
+ * for(u32 i=0; i < 32; i++){
+ *   csv << String().format("%ld", i) << ","; //no rescanning of csv
+ * }
+ * csv.replace_all(",", ";");
+ * \endcode
+ *
  * \note
  *
  * A note about copy initialization:
@@ -97,6 +116,7 @@ public:
      */
     String(const String & a) : Data(a){
         set_string_pointer(cdata_const());
+        m_length = npos;
     }
 
     /*! \details Declares a string and initialize to \a s. */
@@ -123,6 +143,7 @@ public:
     String& operator=(const String & a){
         Data::copy_object(a);
         set_string_pointer(cdata_const());
+        m_length = npos;
         return *this;
     }
 
@@ -220,6 +241,44 @@ public:
     int set_size(u32 s);
     int set_capacity(u32 s){ return set_size(s); }
 
+    /*! \details Reserves memory for a string of \a s characters.
+     *
+     * This is the same as set_capacity(). Calling it before
+     * building a long string avoids reallocating memory
+     * as the string grows.
+     *
+     */
+    int reserve(u32 s){ return set_size(s); }
+
+    /*! \details Returns the length of the string.
+     *
+     * The length is tracked as the string is modified using
+     * the methods of this class so this is usually a constant
+     * time operation. If the string is modified using a pointer
+     * from cdata() or data() (including through a var::Data reference,
+     * for example with sys::File::read()), the length is recalculated
+     * the next time it is needed. The pointer should not be used after
+     * calling other methods that modify the String
+     * (including length(), which caches the length again).
+     *
+     */
+    u32 length() const {
+        if( is_modified() || (m_length >= Data::capacity()) || (str()[m_length] != 0) ){
+            clear_modified();
+            m_length = strlen(str());
+        }
+        return m_length;
+    }
+    //compatible with std::string
+    u32 len() const { return length(); }
+
+    /*! \details Sets the string to zero length. */
+    void clear(){
+        Data::clear();
+        clear_modified();
+        m_length = 0;
+    }
+
 
     /*! \details Gets a sub string of the string.
      *
@@ -249,6 +308,78 @@ public:
      */
     String& erase(u32 pos, u32 len = -1);
 
+    /*! \details Replaces all occurrences of \a old_string with \a new_string.
+     *
+     * @param old_string The string to replace
+     * @param new_string The replacement
+     * @return A reference to this string
+     *
+     * Occurrences are found from left to right and don't overlap.
+     * The string is reallocated at most once.
+     *
+     * \code
+     * #include <sapi/var.hpp>
+     * String path("/home//data//log.txt");
+     * path.replace_all("//", "/"); // /home/data/log.txt
+     * \endcode
+     *
+     */
+    String& replace_all(const ConstString & old_string, const ConstString & new_string);
+
+    /*! \details Splits the string into tokens.
+     *
+     * @param delimiters The characters that separate the tokens
+     * @param count_empty True to include empty tokens (for example, between two delimiters in a row)
+     * @return A var::Token
+     *
+     * This is the same as constructing a var::Token. The tokens are
+     * ConstString objects that point to a single copy of this string.
+     *
+     * \code
+     * #include <sapi/var.hpp>
+     * Token fields = String("a,b,,c").split(",", true); //4 tokens
+     * \endcode
+     *
+     */
+    Token split(const ConstString & delimiters, bool count_empty = false) const;
+
+    /*! \details Joins a list of strings.
+     *
+     * @param list The strings to join (var::String or var::ConstString)
+     * @param separator The string placed between items in \a list
+     * @return A new string
+     *
+     * The memory for the new string is allocated once.
+     *
+     * \code
+     * #include <sapi/var.hpp>
+     * Vector<ConstString> list;
+     * list.push_back("a");
+     * list.push_back("b");
+     * String joined = String::join(list, ", "); //"a, b"
+     * \endcode
+     *
+     */
+    template<typename T> static String join(const Vector<T> & list, const ConstString & separator){
+        String result;
+        u32 separator_length = separator.length();
+        u32 total = 0;
+        for(u32 i=0; i < list.count(); i++){
+            total += list[i].length();
+        }
+        if( list.count() ){
+            total += separator_length * (list.count() - 1);
+        }
+        if( result.set_capacity(total) == 0 ){
+            for(u32 i=0; i < list.count(); i++){
+                if( i ){ result.append(separator.str(), separator_length); }
+                result.append(list[i].str(), list[i].length());
+            }
+        }
+        result.set_transfer_ownership();
+        return result;
+    }
+
 
 
     /*! \details Prints a formatted string to this String.
@@ -304,6 +435,42 @@ public:
     int append(const ConstString & a);
     /*! \details Appends \a c to this String.  */
     int append(char c);
+    /*! \details Appends \a n characters from \a s to this String. */
+    int append(const char * s, u32 n);
+
+    /*! \details Appends \a value in decimal.
+     *
+     * @return Zero on success or -1 if memory could not be allocated
+     *
+     * The digits are written directly into the memory of
+     * the String (see StringUtil for the conversion). This is
+     * much faster than using format().
+     *
+     * \code
+     * #include <sapi/var.hpp>
+     * String s("x=");
+     * s.append_number(-25); //"x=-25"
+     * s.append(", y=");
+     * s.append_number(0.1f); //"x=-25, y=0.1"
+     * \endcode
+     *
+     */
+    int append_number(int value){ return append_signed(value); }
+    /*! \details Appends \a value in decimal (see append_number(int)). */
+    int append_number(unsigned int value){ return append_unsigned(value); }
+    /*! \details Appends \a value in decimal (see append_number(int)). */
+    int append_number(long value){ return sizeof(long) == 4 ? append_signed(value) : append_signed64(value); }
+    /*! \details Appends \a value in decimal (see append_number(int)). */
+    int append_number(unsigned long value){ return sizeof(long) == 4 ? append_unsigned(value) : append_unsigned64(value); }
+    /*! \details Appends \a value in decimal (see append_number(int)). */
+    int append_number(long long value){ return append_signed64(value); }
+    /*! \details Appends \a value in decimal (see append_number(int)). */
+    int append_number(unsigned long long value){ return append_unsigned64(value); }
+
+    /*! \details Appends \a value using the fewest digits that
+     * convert back to the same float (see StringUtil::ftoa()).
+     */
+    int append_number(float value);
 
     /*! \details Appends \a c to this String
      */
@@ -357,6 +524,14 @@ private:
     int vformat(const char * fmt, va_list list);
 
     int update_capacity(u32 size);
+    int grow(u32 length);
+    char * reserve_append(u32 max_length);
+    int append_signed(s32 value);
+    int append_unsigned(u32 value);
+    int append_signed64(s64 value);
+    int append_unsigned64(u64 value);
+
+    mutable u32 m_length;
 
 };
 
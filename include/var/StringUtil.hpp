@@ -7,6 +7,30 @@
 
 namespace var {
 
+/*! \brief String Utility Class
+ * \details The StringUtil class has static methods for
+ * converting numbers to and from strings without using
+ * printf() or scanf().
+ *
+ * Decimal integers are written two digits at a time using a
+ * lookup table. Floats are written using the fewest digits
+ * that convert back to exactly the same float (using the Ryu
+ * algorithm with integer-only math).
+ *
+ * \code
+ * #include <sapi/var.hpp>
+ *
+ * char buffer[StringUtil::BUF_SIZE];
+ * StringUtil::itoa(buffer, -42); //"-42"
+ * StringUtil::ftoa(buffer, 0.1f); //"0.1"
+ *
+ * s32 value;
+ * if( StringUtil::parse_int("123x", value) < 0 ){
+ *   //errno is EINVAL because of the trailing 'x'
+ * }
+ * \endcode
+ *
+ */
 class StringUtil {
 public:
 
@@ -30,9 +54,71 @@ public:
 	static int itoa(char dest[BUF_SIZE], int32_t num, int width = 0);
 	/*! \brief Converts an unsigned integer to a string (any base--most useful are of course 2, 8, 10 and 16) */
 	static int utoa(char dest[BUF_SIZE], uint32_t num, int base = 10, bool upper = true, int width = 0);
-#ifdef USE_FLOAT
+	/*! \brief Converts a signed 64-bit integer to a string (base 10 only) */
+	static int lltoa(char dest[BUF_SIZE], int64_t num, int width = 0);
+	/*! \brief Converts an unsigned 64-bit integer to a string (base 10 only) */
+	static int ulltoa(char dest[BUF_SIZE], uint64_t num, int width = 0);
+
+	/*! \details Converts a float to a string.
+	 *
+	 * @param dest The destination
+	 * @param num The number to convert
+	 * @param width The minimum number of digits before the decimal point
+	 * @return The number of characters written (not including the zero terminator)
+	 *
+	 * The shortest string that converts back to \a num is written.
+	 * Numbers from 1e-5 up to 1e9 use a decimal point (for example, "0.1" or "100.0").
+	 * Other numbers use an exponent (for example, "1.5e+20").
+	 *
+	 */
 	static int ftoa(char dest[BUF_SIZE], float num, int width = 0);
-#endif
+
+	/*! \details Parses a signed decimal integer.
+	 *
+	 * @param str The string to parse (leading whitespace is skipped)
+	 * @param value Assigned the parsed value
+	 * @param end If not null, assigned a pointer to the first character that was not parsed
+	 * @return Zero on success or -1 with errno set to EINVAL (no digits) or ERANGE (overflow)
+	 *
+	 * If \a end is null, characters other than whitespace after the number are an error (EINVAL).
+	 * On overflow \a value is assigned the largest (or smallest) value.
+	 *
+	 */
+	static int parse_int(const char * str, int32_t & value, const char ** end = 0);
+
+	/*! \details Parses an unsigned integer.
+	 *
+	 * @param str The string to parse
+	 * @param value Assigned the parsed value
+	 * @param base The base (2 to 16); base 16 numbers may start with "0x"
+	 * @param end See parse_int()
+	 * @return Zero on success or -1 with errno set (see parse_int())
+	 */
+	static int parse_uint(const char * str, uint32_t & value, int base = 10, const char ** end = 0);
+
+	/*! \details Parses a floating point number.
+	 *
+	 * @param str The string to parse (for example, "-1.25", "3e8", "inf" or "nan")
+	 * @param value Assigned the parsed value
+	 * @param end See parse_int()
+	 * @return Zero on success or -1 with errno set (see parse_int())
+	 *
+	 * Numbers with up to 7 significant digits and a small exponent are
+	 * converted exactly using a single float operation. Other numbers are
+	 * passed to strtof().
+	 *
+	 */
+	static int parse_float(const char * str, float & value, const char ** end = 0);
+
+	/*! \details Returns the number of decimal digits in \a num. */
+	static int calc_decimal_length(uint32_t num);
+
+	/*! \details Writes \a num in decimal to \a dest using exactly \a length characters.
+	 *
+	 * \a length must be calc_decimal_length() (or larger to zero pad). No terminator is written.
+	 *
+	 */
+	static void write_decimal(char * dest, uint32_t num, int length);
 
 private:
 	static char htoc(int nibble);
@@ -4,6 +4,11 @@
 #define TOKEN_HPP_
 
 #include "String.hpp"
+#include "Vector.hpp"
+
+namespace sys {
+class File;
+}
 
 namespace var {
 
@@ -11,10 +16,56 @@ namespace var {
  * \details The Token Class can convert any String into a list of tokens.  The
  * class is similar to STDC strtok().
  *
+ * The source is copied once and parsed in a single pass. Each delimiter
+ * in the copy is replaced with a zero and the position of each token is
+ * stored in an index. at() returns a ConstString that points
+ * into the copy (the token itself is never copied), so accessing
+ * any token takes constant time.
+ *
+ * \code
+ * #include <sapi/var.hpp>
+ *
+ * Token tokens("gamma,alpha,beta", ",");
+ * tokens.sort(Token::SORT_AZ);
+ * for(u32 i=0; i < tokens.count(); i++){
+ *   printf("%s\n", tokens.at(i).str()); //alpha, beta, gamma
+ * }
+ * \endcode
+ *
+ * Files can be processed one line at a time using parse_line().
+ *
+ * \code
+ * #include <sapi/var.hpp>
+ * #include <sapi/sys.hpp>
+ *
+ * File f;
+ * Token line;
+ * f.open("/home/data.csv", File::RDONLY);
+ * while( line.parse_line(f, ",") >= 0 ){
+ *   printf("%ld fields starting with %s\n", line.count(), line.at(0).str());
+ * }
+ * f.close();
+ * \endcode
+ *
  */
 class Token : public var::String {
 public:
     Token();
+
+    /*! \details Constructs and parses a new Token using \a mem instead of dynamic memory.
+     *
+     * @param mem The memory to use for the copy of \a src and the index of tokens
+     * @param s The number of bytes in \a mem
+     * @param src The Source string
+     * @param delim Delimiter string
+     * @param ignore Ignore string
+     * @param count_empty Create empty tokens
+     *
+     * The copy of \a src uses the start of \a mem and the index of tokens
+     * uses the rest (4 bytes per token). Tokens that don't fit in the index
+     * are not counted.
+     *
+     */
     Token(char * mem, u32 s, const ConstString & src, const ConstString & delim, const ConstString & ignore = "", bool count_empty = false);
 
     /*! \details Constructs and parses a new Token.
@@ -54,18 +105,61 @@ public:
      */
     void parse(const ConstString & delim, const ConstString & ignore = "");
 
+    /*! \details Reads the next line from \a file and parses it.
+     *
+     * @param file The file to read from
+     * @param delim Delimiter string
+     * @param ignore Ignore string
+     * @param term The character that terminates a line
+     * @return The number of tokens or -1 when there are no more lines
+     *
+     * The line terminator (and a carriage return before it) is not
+     * included in the last token. The memory used by the Token is
+     * reused for each line so large files can be processed
+     * without loading them.
+     *
+     * The file is read in blocks and the location is moved back to the
+     * start of the next line. Files that can't seek() are read
+     * one byte at a time.
+     *
+     */
+    int parse_line(const sys::File & file, const ConstString & delim, const ConstString & ignore = "", char term = '\n');
 
-    /*! \details Sorts the tokens as specified. */
+
+    /*! \details Sorts the tokens as specified.
+     *
+     * The full strings are compared (using strcmp()). Only the
+     * index is reordered so the tokens are not copied.
+     *
+     */
     void sort(enum sort_options sort_option = SORT_NONE);
 
 
-    u32 size() const { return m_num_tokens; }
+    u32 size() const { return m_offsets.count(); }
 
     /*! \details Returns the total number of tokens. */
-    u32 count() const { return m_num_tokens; }
+    u32 count() const { return m_offsets.count(); }
 
     /*! \details Returns a pointer to the token specified by offset. */
-    const ConstString at(u32 n) const;
+    const ConstString at(u32 n) const {
+        if( n >= count() ){
+            return ConstString();
+        }
+        return cdata_const() + m_offsets[n];
+    }
+
+    /*! \details Returns the position of the token \a n in the source string.
+     *
+     * This can be used to find the token in the original string. If \a n
+     * is not a valid token, npos is returned.
+     *
+     */
+    u32 offset_at(u32 n) const {
+        if( n >= count() ){
+            return npos;
+        }
+        return m_offsets[n];
+    }
 
     static bool belongs_to(const char c, const ConstString & str, unsigned int len);
     static bool belongs_to(const char c, const ConstString & str){
@@ -85,11 +179,17 @@ public:
 protected:
 
 private:
-    void init_members();
-    unsigned int m_num_tokens;
-    unsigned int m_string_size;
+    enum {
+        LINE_BUFFER_SIZE = 128
+    };
+
+    Vector<u32> m_offsets;
     bool m_is_count_empty_tokens;
 
+    static u32 string_size(char * mem, u32 s, u32 length);
+
+    bool is_less(u32 a, u32 b, enum sort_options sort_option) const;
+    void sift_down(u32 root, u32 count, enum sort_options sort_option);
 
 };
 
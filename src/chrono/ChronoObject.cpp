@@ -25,7 +25,9 @@ void ChronoInfoObject::wait(const chrono::MicroTime & micro_time){
     wait_microseconds(micro_time.microseconds());
 }
 
+#if !defined __link
 void ChronoInfoObject::wait(const chrono::Time & time){
     wait_seconds(time.hour() * 3600UL + time.minute()*60UL + time.second());
 }
+#endif
 
@@ -1,7 +1,15 @@
 #include "chrono/Clock.hpp"
 
+#if defined __link && defined __x86_64__
+#include <cpuid.h>
+#endif
+
 using namespace chrono;
 
+u64 Clock::m_fast_multiplier = 0;
+u64 Clock::m_fast_base_ticks = 0;
+u64 Clock::m_fast_base_nanoseconds = 0;
+
 ClockTime Clock::get_time(int clock_id){
     ClockTime clock_time;
     if( clock_gettime(clock_id, clock_time) < 0 ){
@@ -18,3 +26,46 @@ ClockTime Clock::get_resolution(int clock_id){
     }
     return resolution;
 }
+
+
+u64 Clock::get_nanoseconds(int clock_id){
+    struct timespec now;
+    if( clock_gettime(clock_id, &now) < 0 ){
+        return 0;
+    }
+    return (u64)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+int Clock::calibrate_fast_clock(const MicroTime & duration){
+#if defined __link && defined __x86_64__
+    unsigned int eax, ebx, ecx, edx;
+    u64 start_ticks;
+    u64 start_nanoseconds;
+    u64 stop_ticks;
+    u64 stop_nanoseconds;
+
+    //the counter must run at a constant rate in all power states (invariant TSC)
+    if( (__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) == 0) || ((edx & (1<<8)) == 0) ){
+        return -1;
+    }
+
+    start_nanoseconds = get_nanoseconds(MONOTONIC);
+    start_ticks = __rdtsc();
+    do {
+        stop_nanoseconds = get_nanoseconds(MONOTONIC);
+        stop_ticks = __rdtsc();
+    } while( stop_nanoseconds - start_nanoseconds < duration.microseconds()*1000ULL );
+
+    if( stop_ticks <= start_ticks ){
+        return -1;
+    }
+
+    m_fast_base_ticks = stop_ticks;
+    m_fast_base_nanoseconds = stop_nanoseconds;
+    m_fast_multiplier = (u64)(((unsigned __int128)(stop_nanoseconds - start_nanoseconds) << 32) / (stop_ticks - start_ticks));
+    return 0;
+#else
+    (void)duration;
+    return -1;
+#endif
+}
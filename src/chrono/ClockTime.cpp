@@ -7,7 +7,7 @@ using namespace chrono;
 ClockTime::ClockTime(const MicroTime & micro_time){
     m_value.tv_sec = micro_time.seconds();
     u32 microseconds = micro_time.microseconds() - m_value.tv_sec*1000000;
-    m_value.tv_nsec = microseconds;
+    m_value.tv_nsec = microseconds*1000;
 }
 
 bool ClockTime::operator > (const ClockTime & a) const {
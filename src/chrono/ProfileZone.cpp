@@ -0,0 +1,152 @@
+//Copyright 2011-2018 Tyler Gilbert; All Rights Reserved
+
+#include "chrono/ProfileZone.hpp"
+#include "sys/Printer.hpp"
+#include "fmt/JsonWriter.hpp"
+
+using namespace chrono;
+
+ProfileZone * ProfileZone::m_first = 0;
+
+ProfileZone::ProfileZone(const char * name){
+    m_name = name;
+    reset();
+
+    //push the zone on the list (zones can be constructed on different threads)
+    m_next = __atomic_load_n(&m_first, __ATOMIC_RELAXED);
+    while( !__atomic_compare_exchange_n(&m_first, &m_next, this, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED) ){
+        ;
+    }
+}
+
+void ProfileZone::record(u32 nanoseconds){
+    u32 idx = nanoseconds ? 32 - __builtin_clz(nanoseconds) : 0;
+    u32 value;
+
+    if( idx >= BUCKET_COUNT ){
+        idx = BUCKET_COUNT-1;
+    }
+
+    __atomic_add_fetch(&m_count, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(m_buckets + idx, 1, __ATOMIC_RELAXED);
+
+    //64-bit atomics aren't available on all targets: carry into the high word
+    if( __atomic_add_fetch(&m_total_low, nanoseconds, __ATOMIC_RELAXED) < nanoseconds ){
+        __atomic_add_fetch(&m_total_high, 1, __ATOMIC_RELAXED);
+    }
+
+    value = __atomic_load_n(&m_min, __ATOMIC_RELAXED);
+    while( (nanoseconds < value) &&
+           !__atomic_compare_exchange_n(&m_min, &value, nanoseconds, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED) ){
+        ;
+    }
+
+    value = __atomic_load_n(&m_max, __ATOMIC_RELAXED);
+    while( (nanoseconds > value) &&
+           !__atomic_compare_exchange_n(&m_max, &value, nanoseconds, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED) ){
+        ;
+    }
+}
+
+u64 ProfileZone::total() const {
+    u32 high;
+    u32 low;
+    do {
+        high = __atomic_load_n(&m_total_high, __ATOMIC_RELAXED);
+        low = __atomic_load_n(&m_total_low, __ATOMIC_RELAXED);
+    } while( high != __atomic_load_n(&m_total_high, __ATOMIC_RELAXED) );
+    return ((u64)high << 32) | low;
+}
+
+u32 ProfileZone::percentile(u32 percent) const {
+    u32 total_count = 0;
+    u32 target;
+    u32 sum = 0;
+
+    for(u32 i=0; i < BUCKET_COUNT; i++){
+        total_count += bucket(i);
+    }
+
+    if( total_count == 0 ){
+        return 0;
+    }
+
+    if( percent > 100 ){
+        percent = 100;
+    }
+
+    //the number of samples at or below the percentile (rounded up)
+    target = ((u64)total_count * percent + 99) / 100;
+    if( target == 0 ){
+        target = 1;
+    }
+
+    for(u32 i=0; i < BUCKET_COUNT; i++){
+        sum += bucket(i);
+        if( sum >= target ){
+            u32 limit = i == 0 ? 0 : (u32)((1ULL << i) - 1);
+            if( (i == BUCKET_COUNT-1) || (limit > max()) ){
+                return max();
+            }
+            return limit;
+        }
+    }
+
+    return max();
+}
+
+void ProfileZone::reset(){
+    __atomic_store_n(&m_count, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&m_total_low, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&m_total_high, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&m_min, 0xffffffff, __ATOMIC_RELAXED);
+    __atomic_store_n(&m_max, 0, __ATOMIC_RELAXED);
+    for(u32 i=0; i < BUCKET_COUNT; i++){
+        __atomic_store_n(m_buckets + i, 0, __ATOMIC_RELAXED);
+    }
+}
+
+void ProfileZone::reset_all(){
+    for(ProfileZone * zone = first(); zone != 0; zone = zone->next()){
+        zone->reset();
+    }
+}
+
+void ProfileZone::print_all(sys::Printer & printer){
+    for(ProfileZone * zone = first(); zone != 0; zone = zone->next()){
+        if( zone->count() ){
+            printer << *zone;
+        }
+    }
+}
+
+int ProfileZone::save_all(fmt::JsonWriter & json){
+    json.open_object();
+    for(ProfileZone * zone = first(); zone != 0; zone = zone->next()){
+        u32 last = 0;
+
+        json.open_object(zone->name());
+        json.write_number("count", zone->count());
+        json.write_number("total_ns", (unsigned long long)zone->total());
+        json.write_number("min_ns", zone->min());
+        json.write_number("max_ns", zone->max());
+        json.write_number("mean_ns", zone->mean());
+        json.write_number("p50_ns", zone->percentile(50));
+        json.write_number("p90_ns", zone->percentile(90));
+        json.write_number("p99_ns", zone->percentile(99));
+
+        //the histogram up to the last bucket that was used
+        for(u32 i=0; i < BUCKET_COUNT; i++){
+            if( zone->bucket(i) ){
+                last = i+1;
+            }
+        }
+        json.open_array("histogram");
+        for(u32 i=0; i < last; i++){
+            json.write_number(zone->bucket(i));
+        }
+        json.close_array();
+        json.close_object();
+    }
+    return json.close_object();
+}
@@ -8,8 +8,6 @@
 #include "chrono/Clock.hpp"
 using namespace chrono;
 
-#if !defined __link
-
 Timer::Timer() { reset(); }
 
 void Timer::reset(){
@@ -20,7 +18,7 @@ void Timer::reset(){
 }
 
 void Timer::restart(){
-    m_start = Clock::get_time();
+    m_start = Clock::get_time(Clock::MONOTONIC);
     m_stop.set(-1, 0);
 }
 
@@ -42,7 +40,7 @@ void Timer::resume(){
     //if timer has been stopped, then resume counting
     if( m_start.seconds() + m_start.nanoseconds() ){ //start is non-zero
         new_start = m_stop - m_start;
-        now = Clock::get_time();
+        now = Clock::get_time(Clock::MONOTONIC);
         m_start = now - new_start;
         m_stop.set(-1, 0);
     } else {
@@ -54,7 +52,7 @@ void Timer::resume(){
 ClockTime Timer::clock_time() const {
     ClockTime now;
     if( m_stop.seconds() < 0 ){
-        now = Clock::get_time();
+        now = Clock::get_time(Clock::MONOTONIC);
     } else {
         now = m_stop;
     }
@@ -69,8 +67,6 @@ MicroTime Timer::calc_value() const {
 
 void Timer::stop(){
     if( is_running() ){
-        m_stop = Clock::get_time();
+        m_stop = Clock::get_time(Clock::MONOTONIC);
     }
 }
-
-#endif
@@ -17,10 +17,30 @@ EventLoopAttr::EventLoopAttr(){
 }
 
 
-EventLoop::EventLoop(EventHandler & start_event_handler){
+EventLoop::EventLoop(EventHandler & start_event_handler) : m_posted(POST_COUNT){
     m_current_event_handler = &start_event_handler;
 }
 
+int EventLoop::post(function_t function, void * args){
+    event_loop_post_t item;
+    item.function = function;
+    item.args = args;
+    if( m_posted.try_push(item) < 0 ){
+        set_error_number(m_posted.error_number());
+        return -1;
+    }
+    return 0;
+}
+
+void EventLoop::process_posted(){
+    event_loop_post_t item;
+    while( m_posted.try_pop(item) == 0 ){
+        SAPI_TRACE_BEGIN(TraceRing::EVENT_EVENT_LOOP_POSTED, 0);
+        item.function(item.args);
+        SAPI_TRACE_END(TraceRing::EVENT_EVENT_LOOP_POSTED, 0);
+    }
+}
+
 
 EventHandler * EventLoop::handle_event(EventHandler * current_event_handler, const Event & event, EventLoop * event_loop){
     EventHandler * next_event_handler = current_event_handler;
@@ -52,7 +72,9 @@ void EventLoop::handle_transition(EventHandler * current_event_handler, EventHan
 
 bool EventLoop::handle_event(const Event & event){
     EventHandler * tmp = m_current_event_handler;
+    SAPI_TRACE_BEGIN(TraceRing::EVENT_EVENT_LOOP_HANDLE, event.type());
     tmp = handle_event(m_current_event_handler, event, this);
+    SAPI_TRACE_END(TraceRing::EVENT_EVENT_LOOP_HANDLE, 0);
     if( tmp != m_current_event_handler ){
         if( tmp == 0 ){
             tmp = catch_null_handler(m_current_event_handler);
@@ -86,7 +108,10 @@ void EventLoop::start(){
 void EventLoop::loop(){
     while( current_event_handler() != 0 ){
         m_loop_timer.restart();
+        SAPI_TRACE_BEGIN(TraceRing::EVENT_EVENT_LOOP_PROCESS, 0);
         process_events(); //process all events
+        SAPI_TRACE_END(TraceRing::EVENT_EVENT_LOOP_PROCESS, 0);
+        process_posted();
         check_loop_for_update();
         check_loop_for_hibernate();
     }
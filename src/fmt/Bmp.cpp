@@ -2,17 +2,39 @@
 
 #include <cstdlib>
 #include <cstring>
+#include <errno.h>
 #include "fmt/Bmp.hpp"
 #include "sys/Appfs.hpp"
+#include "var/Data.hpp"
 using namespace fmt;
 using namespace sys;
 
+//4x4 ordered dither thresholds
+static const u8 bayer_matrix[4][4] = {
+		{ 0, 8, 2, 10 },
+		{ 12, 4, 14, 6 },
+		{ 3, 11, 1, 9 },
+		{ 15, 7, 13, 5 }
+};
+
+static u32 divide_by_255(u32 x){
+	//exact for x <= 65534 (no division on cores without a divide instruction)
+	return (x + 1 + (x >> 8)) >> 8;
+}
+
+static u32 calc_row_size(s32 width, u16 bits_per_pixel){
+	//rows are padded to 4 bytes
+	return ((width * bits_per_pixel + 31) / 32) * 4;
+}
 
 Bmp::Bmp(){
 	m_offset = 0;
+	m_buffer_size = DEFAULT_BUFFER_SIZE;
 }
 
 Bmp::Bmp(const char * name){
+	m_offset = 0;
+	m_buffer_size = DEFAULT_BUFFER_SIZE;
 	open_readonly(name);
 }
 
@@ -66,7 +88,7 @@ int Bmp::create(const char * name, s32 width, s32 height, u16 planes, u16 bits_p
 		return -1;
 	}
 
-	hdr.size = sizeof(hdr) + sizeof(m_dib) + (width*height*bits_per_pixel + 7) / 8;
+	hdr.size = sizeof(hdr) + sizeof(m_dib) + ::calc_row_size(width, bits_per_pixel) * (height < 0 ? -height : height);
 	hdr.offset = sizeof(hdr) + sizeof(m_dib);
 	hdr.signature = SIGNATURE;
 	hdr.resd1 = 0;
@@ -86,6 +108,7 @@ int Bmp::create(const char * name, s32 width, s32 height, u16 planes, u16 bits_p
 		return -1;
 	}
 
+	m_offset = hdr.offset;
 	return 0;
 }
 
@@ -93,7 +116,7 @@ int Bmp::create_appfs(const char * name, s32 width, s32 height, u16 planes, u16
 	bmp_header_t hdr;
 	bmp_dib_t dib;
 
-	hdr.size = sizeof(hdr) + sizeof(dib) + (width*height*bits_per_pixel + 7) / 8;
+	hdr.size = sizeof(hdr) + sizeof(dib) + ::calc_row_size(width, bits_per_pixel) * (height < 0 ? -height : height);
 	hdr.offset = sizeof(hdr) + sizeof(dib);
 	hdr.signature = SIGNATURE;
 	hdr.resd1 = 0;
@@ -117,7 +140,7 @@ int Bmp::create_appfs(const char * name, s32 width, s32 height, u16 planes, u16
 }
 
 unsigned int Bmp::calc_row_size() const{
-	return (((m_dib.bits_per_pixel/8)*m_dib.width + 3) / 4) * 4;
+	return ::calc_row_size(m_dib.width, m_dib.bits_per_pixel);
 }
 
 int Bmp::seek_row(s32 y){
@@ -137,12 +160,12 @@ int Bmp::read_pixel(uint8_t * pixel, u32 pixel_size, bool mono, uint8_t thres){
 		return -1;
 	}
 
-	if( mono ){
+	if( mono && pixel_size ){
 		avg = 0;
 		for(i=0; i < pixel_size; i++){
 			avg += pixel[i];
 		}
-		avg = avg / 8;
+		avg = avg / pixel_size;
 		if( avg > thres ){
 			return 1;
 		} else {
@@ -155,3 +178,177 @@ int Bmp::read_pixel(uint8_t * pixel, u32 pixel_size, bool mono, uint8_t thres){
 
 
 
+
+void Bmp::convert_row(u8 * levels, const u8 * row, u32 width, u16 row_bits_per_pixel, u8 bits_per_pixel, s32 y, u32 o_flags, u8 threshold){
+	u32 pixel_size = row_bits_per_pixel / 8;
+	u32 max = (1 << bits_per_pixel) - 1;
+	const u8 * dither = bayer_matrix[y & 0x03];
+	u32 luma;
+	u32 x;
+
+	if( o_flags & FLAG_DITHER ){
+		for(x=0; x < width; x++){
+			//pixels are blue, green, red -- luma uses the BT.601 weights (out of 256)
+			luma = (row[0]*29 + row[1]*150 + row[2]*77) >> 8;
+			//add an offset (0 to 254) that repeats every 4x4 pixels before truncating
+			levels[x] = divide_by_255(luma * max + (dither[x & 0x03]*2 + 1)*255/32);
+			row += pixel_size;
+		}
+	} else if( max == 1 ){
+		for(x=0; x < width; x++){
+			luma = (row[0]*29 + row[1]*150 + row[2]*77) >> 8;
+			levels[x] = luma > threshold;
+			row += pixel_size;
+		}
+	} else {
+		for(x=0; x < width; x++){
+			luma = (row[0]*29 + row[1]*150 + row[2]*77) >> 8;
+			levels[x] = divide_by_255(luma * max + 127);
+			row += pixel_size;
+		}
+	}
+}
+
+int Bmp::read_levels(row_callback_t callback, void * context, u8 bits_per_pixel, u32 o_flags, u8 threshold){
+	u32 row_size = calc_row_size();
+	u32 height = m_dib.height < 0 ? -m_dib.height : m_dib.height;
+	u32 rows_per_read;
+	u32 count;
+	u32 i;
+	u32 j;
+	var::Data buffer;
+
+	if( ((m_dib.bits_per_pixel != 24) && (m_dib.bits_per_pixel != 32)) ||
+			(m_dib.width <= 0) ||
+			((bits_per_pixel != 1) && (bits_per_pixel != 2) && (bits_per_pixel != 4) && (bits_per_pixel != 8)) ){
+		set_error_number(EINVAL);
+		return -1;
+	}
+
+	//read as many rows as fit in the buffer at a time
+	rows_per_read = m_buffer_size / row_size;
+	if( rows_per_read == 0 ){
+		rows_per_read = 1;
+	}
+	if( rows_per_read > height ){
+		rows_per_read = height;
+	}
+
+	if( buffer.set_size(rows_per_read*row_size + m_dib.width) < 0 ){
+		return -1;
+	}
+
+	u8 * rows = (u8*)buffer.data();
+	u8 * levels = rows + rows_per_read*row_size;
+
+	if( seek(m_offset) != (int)m_offset ){
+		return -1;
+	}
+
+	for(i=0; i < height; i += count){
+		count = height - i;
+		if( count > rows_per_read ){
+			count = rows_per_read;
+		}
+
+		if( read(rows, count*row_size) != (int)(count*row_size) ){
+			return -1;
+		}
+
+		for(j=0; j < count; j++){
+			//the rows are stored from the bottom up unless the height is negative
+			s32 y = m_dib.height > 0 ? height - 1 - (i + j) : i + j;
+			convert_row(levels, rows + j*row_size, m_dib.width, m_dib.bits_per_pixel, bits_per_pixel, y, o_flags, threshold);
+			if( callback(context, y, levels) < 0 ){
+				return 0;
+			}
+		}
+	}
+
+	return 0;
+}
+
+#if !defined __link
+static int draw_row(void * context, s32 y, const u8 * levels){
+	sgfx::Bitmap * bitmap = (sgfx::Bitmap*)context;
+	sg_cursor_t cursor;
+	sg_size_t x;
+
+	sg_api()->cursor_set(&cursor, bitmap->bmap_const(), sg_point(0,y));
+	for(x=0; x < bitmap->width(); x++){
+		//the bitmap is cleared so only pixels that are on are drawn
+		if( levels[x] ){
+			bitmap->set_pen_color(levels[x]);
+			sg_api()->cursor_draw_pixel(&cursor);
+		} else {
+			sg_api()->cursor_inc_x(&cursor);
+		}
+	}
+	return 0;
+}
+
+int Bmp::load(sgfx::Bitmap & bitmap, u32 o_flags, u8 threshold){
+	sg_size_t width = m_dib.width;
+	sg_size_t height = m_dib.height < 0 ? -m_dib.height : m_dib.height;
+	int result;
+
+	if( (bitmap.width() != width) || (bitmap.height() != height) ){
+		if( (bitmap.set_size(width, height) == false) && (bitmap.alloc(width, height) < 0) ){
+			return -1;
+		}
+	}
+
+	bitmap.clear();
+	bitmap.store_pen();
+	bitmap.set_pen_flags(0);
+	result = read_levels(draw_row, &bitmap, sgfx::Bitmap::bits_per_pixel(), o_flags, threshold);
+	bitmap.restore_pen();
+	return result;
+}
+
+int Bmp::save(const char * name, const sgfx::Bitmap & bitmap){
+	u8 bits_per_pixel = sgfx::Bitmap::bits_per_pixel();
+	u32 max = (1 << bits_per_pixel) - 1;
+	var::Data row;
+	sg_cursor_t cursor;
+	u32 row_size;
+	sg_size_t x;
+	sg_size_t y;
+	u8 * pixel;
+
+	if( bits_per_pixel > 8 ){
+		set_error_number(EINVAL);
+		return -1;
+	}
+
+	if( create(name, bitmap.width(), bitmap.height(), 1, 24) < 0 ){
+		return -1;
+	}
+
+	row_size = calc_row_size();
+	if( row.set_size(row_size) < 0 ){
+		close();
+		return -1;
+	}
+	row.clear();
+
+	//rows are written from the bottom up, one write per row
+	for(y=bitmap.height(); y > 0; y--){
+		sg_api()->cursor_set(&cursor, bitmap.bmap_const(), sg_point(0, y-1));
+		pixel = (u8*)row.data();
+		for(x=0; x < bitmap.width(); x++){
+			u8 gray = sg_api()->cursor_get_pixel(&cursor) * 255 / max;
+			pixel[0] = gray;
+			pixel[1] = gray;
+			pixel[2] = gray;
+			pixel += 3;
+		}
+		if( write(row.data_const(), row_size) != (int)row_size ){
+			close();
+			return -1;
+		}
+	}
+
+	return close();
+}
+#endif
@@ -0,0 +1,495 @@
+//Copyright 2011-2018 Tyler Gilbert; All Rights Reserved
+
+#include <errno.h>
+#include <cstring>
+#include <math.h>
+#include "fmt/CborReader.hpp"
+#include "fmt/CborWriter.hpp"
+#include "fmt/Json.hpp"
+#include "calc/Base64.hpp"
+
+using namespace fmt;
+using namespace var;
+
+#define CBOR_INDEFINITE 31
+#define CBOR_BREAK 0xff
+
+static double half_to_double(u16 half){
+    s32 exponent = (half >> 10) & 0x1f;
+    double mantissa = half & 0x3ff;
+    double value;
+
+    if( exponent == 0 ){
+        value = mantissa / (1 << 24);
+    } else if( exponent == 0x1f ){
+        value = (half & 0x3ff) ? NAN : INFINITY;
+    } else {
+        value = (mantissa + 1024);
+        if( exponent >= 25 ){
+            value *= (1 << (exponent - 25));
+        } else {
+            value /= (1 << (25 - exponent));
+        }
+    }
+
+    return (half & 0x8000) ? -value : value;
+}
+
+CborReader::CborReader(const Data & data){
+    init(data.cdata_const(), data.size());
+}
+
+CborReader::CborReader(const void * buffer, u32 size){
+    init(buffer, size);
+}
+
+void CborReader::init(const void * buffer, u32 size){
+    m_input = (const u8*)buffer;
+    m_input_size = buffer ? size : 0;
+    m_input_position = 0;
+    m_value = 0;
+    m_value_length = 0;
+    m_argument = 0;
+    m_tag = 0;
+    m_real = 0.0;
+    m_count = 0;
+    m_is_object = 0;
+    m_is_definite = 0;
+    m_index[0] = 0;
+    m_position = 0;
+    m_depth = 0;
+    m_chunk_major = 0;
+    m_event = END;
+    m_is_negative = false;
+    m_is_key = false;
+    m_is_chunk = false;
+    m_is_chunk_key = false;
+    m_is_tagged = false;
+}
+
+int CborReader::fail(){
+    set_error_number(EINVAL);
+    m_event = ERROR;
+    return ERROR;
+}
+
+int CborReader::next(){
+    if( m_event == ERROR ){ return ERROR; }
+
+    m_value = 0;
+    m_value_length = 0;
+    m_is_negative = false;
+    m_is_key = false;
+    m_is_chunk = false;
+    m_is_tagged = false;
+
+    if( m_chunk_major ){
+        int result = next_chunk();
+        if( result < 0 ){ return fail(); }
+        if( result > 0 ){
+            m_is_chunk = true;
+            m_is_key = m_is_chunk_key;
+            if( m_chunk_major == CborWriter::MAJOR_STRING ){
+                m_event = m_is_key ? KEY : STRING;
+            } else {
+                m_event = BYTES;
+            }
+            return m_event;
+        }
+        //the break at the end of the string was read
+    }
+
+    for(;;){
+        m_position = m_input_position;
+
+        if( m_depth && is_definite() && (m_index[m_depth] == m_end[m_depth]) ){
+            if( m_is_tagged ){ return fail(); }
+            return close_container();
+        }
+
+        if( m_input_position == m_input_size ){
+            if( m_depth || m_is_tagged ){ return fail(); }
+            m_event = END;
+            return END;
+        }
+
+        u8 initial = m_input[m_input_position++];
+        u8 major = initial >> 5;
+        u8 info = initial & 0x1f;
+
+        if( initial == CBOR_BREAK ){
+            //only valid at the end of an indefinite object (after a value) or array
+            if( (m_depth == 0) || is_definite() || m_is_tagged ||
+                    (is_in_object() && (m_index[m_depth] & 1)) ){
+                return fail();
+            }
+            return close_container();
+        }
+
+        if( major == CborWriter::MAJOR_SIMPLE ){
+            switch(info){
+            case 20: return value_event(FALSE);
+            case 21: return value_event(TRUE);
+            case 22: return value_event(ZERO);
+            case 23: return value_event(UNDEFINED);
+            case 24:
+                if( (read_argument(info, m_argument) < 0) || (m_argument < 32) ){ return fail(); }
+                return value_event(SIMPLE);
+            case 25:
+                if( read_argument(info, m_argument) < 0 ){ return fail(); }
+                m_real = half_to_double(m_argument);
+                return value_event(FLOAT);
+            case 26: {
+                if( read_argument(info, m_argument) < 0 ){ return fail(); }
+                u32 bits = m_argument;
+                float value;
+                memcpy(&value, &bits, sizeof(value));
+                m_real = value;
+                return value_event(FLOAT);
+            }
+            case 27:
+                if( read_argument(info, m_argument) < 0 ){ return fail(); }
+                memcpy(&m_real, &m_argument, sizeof(m_real));
+                return value_event(FLOAT);
+            default:
+                if( info < 20 ){
+                    m_argument = info;
+                    return value_event(SIMPLE);
+                }
+                return fail();
+            }
+        }
+
+        if( info == CBOR_INDEFINITE ){
+            switch(major){
+            case CborWriter::MAJOR_BYTES:
+            case CborWriter::MAJOR_STRING:
+                //the chunks are returned by the following calls
+                m_is_key = is_key_position();
+                m_is_chunk_key = m_is_key;
+                m_chunk_major = major;
+                m_value = m_input + m_input_position;
+                if( major == CborWriter::MAJOR_STRING ){
+                    m_event = m_is_key ? KEY : STRING;
+                } else {
+                    m_event = BYTES;
+                }
+                return m_event;
+            case CborWriter::MAJOR_ARRAY:
+                return open_container(ARRAY, info, 0);
+            case CborWriter::MAJOR_OBJECT:
+                return open_container(OBJECT, info, 0);
+            }
+            return fail();
+        }
+
+        if( read_argument(info, m_argument) < 0 ){ return fail(); }
+
+        switch(major){
+        case CborWriter::MAJOR_UNSIGNED:
+            return value_event(INTEGER);
+        case CborWriter::MAJOR_NEGATIVE:
+            m_is_negative = true;
+            return value_event(INTEGER);
+        case CborWriter::MAJOR_BYTES:
+        case CborWriter::MAJOR_STRING:
+            if( m_argument > m_input_size - m_input_position ){ return fail(); }
+            m_value = m_input + m_input_position;
+            m_value_length = m_argument;
+            m_input_position += m_value_length;
+            return value_event(major == CborWriter::MAJOR_STRING ? STRING : BYTES);
+        case CborWriter::MAJOR_ARRAY:
+            return open_container(ARRAY, info, m_argument);
+        case CborWriter::MAJOR_OBJECT:
+            return open_container(OBJECT, info, m_argument);
+        case CborWriter::MAJOR_TAG:
+            //a tag applies to the value that follows it
+            m_tag = m_argument;
+            m_is_tagged = true;
+            break;
+        }
+    }
+}
+
+int CborReader::skip(){
+    if( (m_event != OBJECT) && (m_event != ARRAY) ){ return 0; }
+    u8 depth = m_depth;
+    while( m_depth >= depth ){
+        if( next() <= END ){ return -1; }
+    }
+    return 0;
+}
+
+bool CborReader::is_value(const ConstString & value) const {
+    if( (m_value == 0) || (value.length() != m_value_length) ){
+        return false;
+    }
+    return memcmp(m_value, value.str(), m_value_length) == 0;
+}
+
+s64 CborReader::to_s64() const {
+    switch(m_event){
+    case INTEGER:
+        //clamp values that need 65 bits
+        if( m_argument > 0x7fffffffffffffffULL ){
+            return m_is_negative ? (-0x7fffffffffffffffLL - 1) : 0x7fffffffffffffffLL;
+        }
+        return m_is_negative ? -1 - (s64)m_argument : (s64)m_argument;
+    case FLOAT:
+        if( !((m_real > -9223372036854775808.0) && (m_real < 9223372036854775808.0)) ){
+            return m_real > 0 ? 0x7fffffffffffffffLL : (-0x7fffffffffffffffLL - 1);
+        }
+        return (s64)m_real;
+    case SIMPLE:
+        return m_argument;
+    }
+    return 0;
+}
+
+double CborReader::to_double() const {
+    switch(m_event){
+    case INTEGER:
+        return m_is_negative ? -1.0 - (double)m_argument : (double)m_argument;
+    case FLOAT:
+        return m_real;
+    }
+    return 0.0;
+}
+
+int CborReader::read_argument(u8 info, u64 & argument){
+    if( info < 24 ){
+        argument = info;
+        return 0;
+    }
+
+    if( info > 27 ){
+        return -1;
+    }
+
+    u32 size = 1 << (info - 24);
+    if( size > m_input_size - m_input_position ){
+        return -1;
+    }
+
+    argument = 0;
+    for(u32 i=0; i < size; i++){
+        argument = (argument << 8) | m_input[m_input_position++];
+    }
+    return 0;
+}
+
+//returns 1 with the next chunk of a string, 0 after the break or -1 on error
+int CborReader::next_chunk(){
+    if( m_input_position == m_input_size ){ return -1; }
+
+    m_position = m_input_position;
+    u8 initial = m_input[m_input_position++];
+    if( initial == CBOR_BREAK ){
+        m_chunk_major = 0;
+        m_index[m_depth]++;
+        return 0;
+    }
+
+    //chunks must be definite strings of the same type
+    if( ((initial >> 5) != m_chunk_major) ||
+            ((initial & 0x1f) == CBOR_INDEFINITE) ||
+            (read_argument(initial & 0x1f, m_argument) < 0) ||
+            (m_argument > m_input_size - m_input_position) ){
+        return -1;
+    }
+
+    m_value = m_input + m_input_position;
+    m_value_length = m_argument;
+    m_input_position += m_value_length;
+    return 1;
+}
+
+int CborReader::value_event(int event){
+    m_is_key = is_key_position();
+    if( m_is_key && (event == STRING) ){
+        event = KEY;
+    }
+    m_index[m_depth]++;
+    m_event = event;
+    return event;
+}
+
+int CborReader::open_container(int event, u8 info, u64 count){
+    bool is_key = is_key_position();
+    bool is_definite = info != CBOR_INDEFINITE;
+
+    if( m_depth == MAX_DEPTH ){ return fail(); }
+
+    //each item is at least one byte so a count larger than the input is not valid
+    u32 remaining = m_input_size - m_input_position;
+    if( is_definite && ((count > remaining) || ((event == OBJECT) && (count*2 > remaining))) ){
+        return fail();
+    }
+
+    m_depth++;
+    u32 level = (u32)1 << m_depth;
+    if( event == OBJECT ){
+        m_is_object |= level;
+    } else {
+        m_is_object &= ~level;
+    }
+
+    if( is_definite ){
+        m_is_definite |= level;
+        m_end[m_depth] = event == OBJECT ? count*2 : count;
+        m_count = count;
+    } else {
+        m_is_definite &= ~level;
+        m_count = -1;
+    }
+    m_index[m_depth] = 0;
+
+    m_is_key = is_key;
+    m_event = event;
+    return event;
+}
+
+int CborReader::close_container(){
+    int event = is_in_object() ? END_OBJECT : END_ARRAY;
+    m_depth--;
+    m_index[m_depth]++;
+    m_event = event;
+    return event;
+}
+
+int CborReader::read_chunks(Data & chunks){
+    if( m_chunk_major == 0 ){
+        return 0;
+    }
+
+    //join the chunks of an indefinite length string
+    u32 size = 0;
+    int result;
+    while( (result = next_chunk()) > 0 ){
+        if( m_value_length == 0 ){ continue; }
+        if( chunks.reserve(size + m_value_length) < 0 ){ return -1; }
+        memcpy((u8*)chunks.data() + size, m_value, m_value_length);
+        size += m_value_length;
+    }
+
+    if( result < 0 ){
+        fail();
+        return -1;
+    }
+
+    m_value = size ? (const u8*)chunks.data_const() : (const u8*)"";
+    m_value_length = size;
+    return 0;
+}
+
+json_t * CborReader::read_json_value(int event, Data & chunks){
+    json_t * result;
+    json_t * item;
+
+    switch(event){
+    case OBJECT:
+        result = json_object();
+        while( (event = next()) != END_OBJECT ){
+            if( (event != KEY) || (read_chunks(chunks) < 0) ){
+                break;
+            }
+
+            //jansson needs a zero terminated key
+            item = json_stringn(value(), value_length());
+            if( item == 0 ){ break; }
+            json_t * member = read_json_value(next(), chunks);
+            if( (member == 0) || (json_object_set_new(result, json_string_value(item), member) < 0) ){
+                json_decref(item);
+                break;
+            }
+            json_decref(item);
+        }
+        if( event != END_OBJECT ){
+            json_decref(result);
+            return 0;
+        }
+        return result;
+
+    case ARRAY:
+        result = json_array();
+        while( (event = next()) != END_ARRAY ){
+            item = read_json_value(event, chunks);
+            if( (item == 0) || (json_array_append_new(result, item) < 0) ){
+                break;
+            }
+        }
+        if( event != END_ARRAY ){
+            json_decref(result);
+            return 0;
+        }
+        return result;
+
+    case STRING:
+        if( read_chunks(chunks) < 0 ){ return 0; }
+        return json_stringn(value(), value_length());
+
+    case BYTES: {
+        if( read_chunks(chunks) < 0 ){ return 0; }
+        //Base64::encode() reads up to two bytes past the input
+        Data bytes;
+        Data text;
+        if( (bytes.set_size(value_length() + 2) < 0) ||
+                (text.set_size(calc::Base64::calc_encoded_size(value_length()) + 1) < 0) ){
+            return 0;
+        }
+        bytes.clear();
+        if( value_length() ){
+            memcpy(bytes.data(), value(), value_length());
+        }
+        calc::Base64::encode(text.cdata(), bytes.data_const(), value_length());
+        return json_string(text.cdata_const());
+    }
+
+    case INTEGER:
+        if( (m_argument >> 63) == 0 ){
+            s64 integer = to_s64();
+            if( (s64)(json_int_t)integer == integer ){
+                return json_integer(integer);
+            }
+        }
+        return json_real(to_double());
+
+    case FLOAT:
+        //json can't represent NaN or infinity
+        if( (m_real != m_real) || (m_real - m_real != 0.0) ){
+            return json_null();
+        }
+        return json_real(m_real);
+
+    case TRUE:
+        return json_true();
+    case FALSE:
+        return json_false();
+    case ZERO:
+    case UNDEFINED:
+    case SIMPLE:
+        return json_null();
+    }
+
+    return 0;
+}
+
+int CborReader::read_json(Json & json){
+    Data chunks;
+    int event = next();
+    if( event <= END ){
+        if( event == END ){ set_error_number(EINVAL); }
+        return -1;
+    }
+
+    json_t * value = read_json_value(event, chunks);
+    if( value == 0 ){
+        if( m_event != ERROR ){ set_error_number(EINVAL); }
+        return -1;
+    }
+
+    if( json.was_created() ){ json_decref(json.m_value); }
+    json.m_value = value;
+    json.m_is_observer = false;
+    return 0;
+}
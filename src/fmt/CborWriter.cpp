@@ -0,0 +1,452 @@
+//Copyright 2011-2018 Tyler Gilbert; All Rights Reserved
+
+#include <errno.h>
+#include <cstring>
+#include "fmt/CborWriter.hpp"
+#include "fmt/Json.hpp"
+#include "sys/File.hpp"
+
+using namespace fmt;
+using namespace var;
+
+#define CBOR_INDEFINITE 31
+#define CBOR_FALSE 0xf4
+#define CBOR_TRUE 0xf5
+#define CBOR_NULL 0xf6
+#define CBOR_HALF 0xf9
+#define CBOR_FLOAT 0xfa
+#define CBOR_DOUBLE 0xfb
+#define CBOR_BREAK 0xff
+
+//returns true if value is exactly representable as a half precision float
+static bool float_to_half(float value, u16 & half){
+    u32 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    u16 sign = (bits >> 16) & 0x8000;
+    s32 exponent = (bits >> 23) & 0xff;
+    u32 mantissa = bits & 0x7fffff;
+
+    if( exponent == 0xff ){
+        //infinity or NaN (the payload of a NaN isn't kept)
+        half = mantissa ? 0x7e00 : (sign | 0x7c00);
+        return true;
+    }
+
+    if( (exponent == 0) && (mantissa == 0) ){
+        half = sign;
+        return true;
+    }
+
+    exponent -= 127;
+    if( (exponent >= -14) && (exponent <= 15) ){
+        if( mantissa & 0x1fff ){ return false; }
+        half = sign | ((exponent + 15) << 10) | (mantissa >> 13);
+        return true;
+    }
+
+    if( (exponent >= -24) && (exponent < -14) ){
+        //subnormal half
+        u32 shift = -exponent - 1;
+        mantissa |= 0x800000;
+        if( mantissa & ((1 << shift) - 1) ){ return false; }
+        half = sign | (mantissa >> shift);
+        return true;
+    }
+
+    return false;
+}
+
+CborWriter::CborWriter(const sys::File & file){
+    init();
+    m_file = &file;
+}
+
+CborWriter::CborWriter(Data & data){
+    init();
+    m_data = &data;
+    m_data->set_size(0);
+}
+
+CborWriter::~CborWriter(){
+    flush();
+}
+
+void CborWriter::init(){
+    m_file = 0;
+    m_data = 0;
+    m_flushed_size = 0;
+    m_buffer_size = 0;
+    m_is_object = 0;
+    m_is_definite = 0;
+    m_depth = 0;
+    m_is_key_written = false;
+    m_is_failed = false;
+}
+
+int CborWriter::open_object(){
+    return open_container(MAJOR_OBJECT, true, false, 0);
+}
+
+int CborWriter::open_object(u32 count){
+    return open_container(MAJOR_OBJECT, true, true, count);
+}
+
+int CborWriter::close_object(){
+    return close_container(true);
+}
+
+int CborWriter::open_array(){
+    return open_container(MAJOR_ARRAY, false, false, 0);
+}
+
+int CborWriter::open_array(u32 count){
+    return open_container(MAJOR_ARRAY, false, true, count);
+}
+
+int CborWriter::close_array(){
+    return close_container(false);
+}
+
+int CborWriter::write_key(const ConstString & key){
+    if( m_is_failed ){ return -1; }
+    if( !is_in_object() || m_is_key_written ){
+        set_error_number(EINVAL);
+        return -1;
+    }
+    if( is_definite() && (m_remaining[m_depth] == 0) ){
+        set_error_number(EINVAL);
+        return -1;
+    }
+    if( write_text(MAJOR_STRING, key.str(), key.length()) < 0 ){ return -1; }
+    m_is_key_written = true;
+    return 0;
+}
+
+int CborWriter::write_string(const ConstString & value){
+    if( start_value() < 0 ){ return -1; }
+    return write_text(MAJOR_STRING, value.str(), value.length());
+}
+
+int CborWriter::write_bytes(const void * buffer, u32 size){
+    if( start_value() < 0 ){ return -1; }
+    return write_text(MAJOR_BYTES, buffer, size);
+}
+
+int CborWriter::write_float(float value){
+    if( start_value() < 0 ){ return -1; }
+    u16 half;
+    u8 * p;
+    if( float_to_half(value, half) ){
+        p = reserve(3);
+        if( p == 0 ){ return -1; }
+        p[0] = CBOR_HALF;
+        p[1] = half >> 8;
+        p[2] = half;
+        m_buffer_size += 3;
+        return 0;
+    }
+
+    u32 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    p = reserve(5);
+    if( p == 0 ){ return -1; }
+    p[0] = CBOR_FLOAT;
+    p[1] = bits >> 24;
+    p[2] = bits >> 16;
+    p[3] = bits >> 8;
+    p[4] = bits;
+    m_buffer_size += 5;
+    return 0;
+}
+
+int CborWriter::write_double(double value){
+    if( (value != value) || ((double)(float)value == value) ){
+        //NaN or a value that doesn't need 64 bits
+        return write_float(value);
+    }
+
+    if( start_value() < 0 ){ return -1; }
+    u64 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    u8 * p = reserve(9);
+    if( p == 0 ){ return -1; }
+    p[0] = CBOR_DOUBLE;
+    for(u32 i=0; i < 8; i++){
+        p[8-i] = bits >> (i*8);
+    }
+    m_buffer_size += 9;
+    return 0;
+}
+
+int CborWriter::write_bool(bool value){
+    if( start_value() < 0 ){ return -1; }
+    u8 c = value ? CBOR_TRUE : CBOR_FALSE;
+    return write_raw(&c, 1);
+}
+
+int CborWriter::write_null(){
+    if( start_value() < 0 ){ return -1; }
+    u8 c = CBOR_NULL;
+    return write_raw(&c, 1);
+}
+
+int CborWriter::write_tag(u32 tag){
+    if( m_is_failed ){ return -1; }
+    if( is_in_object() && !m_is_key_written ){
+        set_error_number(EINVAL);
+        return -1;
+    }
+    return write_head(MAJOR_TAG, tag);
+}
+
+//uses the public interface so jansson stays out of CborWriter.hpp
+static int write_json_value(CborWriter & cbor, json_t * value){
+    switch( json_typeof(value) ){
+    case JSON_OBJECT: {
+        const char * key;
+        json_t * item;
+        if( cbor.open_object(json_object_size(value)) < 0 ){ return -1; }
+        json_object_foreach(value, key, item){
+            if( cbor.write_key(key) < 0 ){ return -1; }
+            if( write_json_value(cbor, item) < 0 ){ return -1; }
+        }
+        return cbor.close_object();
+    }
+    case JSON_ARRAY: {
+        u32 count = json_array_size(value);
+        if( cbor.open_array(count) < 0 ){ return -1; }
+        for(u32 i=0; i < count; i++){
+            if( write_json_value(cbor, json_array_get(value, i)) < 0 ){ return -1; }
+        }
+        return cbor.close_array();
+    }
+    case JSON_STRING:
+        return cbor.write_string(ConstString(json_string_value(value)));
+    case JSON_INTEGER:
+        return cbor.write_number((long long)json_integer_value(value));
+    case JSON_REAL:
+        return cbor.write_double(json_real_value(value));
+    case JSON_TRUE:
+        return cbor.write_bool(true);
+    case JSON_FALSE:
+        return cbor.write_bool(false);
+    case JSON_NULL:
+        return cbor.write_null();
+    }
+    return -1;
+}
+
+int CborWriter::write_json(const JsonValue & value){
+    if( value.is_valid() == false ){
+        set_error_number(EINVAL);
+        return -1;
+    }
+    return write_json_value(*this, value.m_value);
+}
+
+int CborWriter::flush(){
+    if( m_is_failed ){ return -1; }
+    if( m_buffer_size ){
+        u32 size = m_buffer_size;
+        m_buffer_size = 0;
+        return write_destination(m_buffer, size);
+    }
+    return 0;
+}
+
+int CborWriter::close(){
+    while( m_depth ){
+        int result = is_in_object() ? close_object() : close_array();
+        if( result < 0 ){ return -1; }
+    }
+    return flush();
+}
+
+int CborWriter::start_value(){
+    if( m_is_failed ){ return -1; }
+    if( is_in_object() ){
+        //the key already counted against the remaining pairs
+        if( !m_is_key_written ){
+            set_error_number(EINVAL);
+            return -1;
+        }
+        m_is_key_written = false;
+    } else if( is_definite() && (m_remaining[m_depth] == 0) ){
+        set_error_number(EINVAL);
+        return -1;
+    }
+    if( is_definite() ){
+        m_remaining[m_depth]--;
+    }
+    return 0;
+}
+
+int CborWriter::open_container(u8 major, bool is_object, bool is_definite, u32 count){
+    if( m_depth == MAX_DEPTH ){
+        set_error_number(EINVAL);
+        return -1;
+    }
+    if( start_value() < 0 ){ return -1; }
+
+    if( is_definite ){
+        if( write_head(major, count) < 0 ){ return -1; }
+    } else {
+        u8 c = (major << 5) | CBOR_INDEFINITE;
+        if( write_raw(&c, 1) < 0 ){ return -1; }
+    }
+
+    m_depth++;
+    u32 level = (u32)1 << m_depth;
+    if( is_object ){
+        m_is_object |= level;
+    } else {
+        m_is_object &= ~level;
+    }
+    if( is_definite ){
+        m_is_definite |= level;
+        m_remaining[m_depth] = count;
+    } else {
+        m_is_definite &= ~level;
+    }
+    return 0;
+}
+
+int CborWriter::close_container(bool is_object){
+    if( m_is_failed ){ return -1; }
+    if( (m_depth == 0) || (is_in_object() != is_object) || m_is_key_written ||
+            (is_definite() && m_remaining[m_depth]) ){
+        set_error_number(EINVAL);
+        return -1;
+    }
+
+    bool is_break = !is_definite();
+    m_depth--;
+    if( is_break ){
+        u8 c = CBOR_BREAK;
+        return write_raw(&c, 1);
+    }
+    return 0;
+}
+
+int CborWriter::write_head(u8 major, u64 value){
+    u8 * p = reserve(9);
+    if( p == 0 ){ return -1; }
+
+    major <<= 5;
+    if( value < 24 ){
+        p[0] = major | value;
+        m_buffer_size += 1;
+    } else if( value <= 0xff ){
+        p[0] = major | 24;
+        p[1] = value;
+        m_buffer_size += 2;
+    } else if( value <= 0xffff ){
+        p[0] = major | 25;
+        p[1] = value >> 8;
+        p[2] = value;
+        m_buffer_size += 3;
+    } else if( value <= 0xffffffff ){
+        p[0] = major | 26;
+        p[1] = value >> 24;
+        p[2] = value >> 16;
+        p[3] = value >> 8;
+        p[4] = value;
+        m_buffer_size += 5;
+    } else {
+        p[0] = major | 27;
+        for(u32 i=0; i < 8; i++){
+            p[8-i] = value >> (i*8);
+        }
+        m_buffer_size += 9;
+    }
+    return 0;
+}
+
+int CborWriter::write_signed64(s64 value){
+    if( start_value() < 0 ){ return -1; }
+    if( value < 0 ){
+        //-1 - n without overflowing on the most negative value
+        return write_head(MAJOR_NEGATIVE, ~(u64)value);
+    }
+    return write_head(MAJOR_UNSIGNED, value);
+}
+
+int CborWriter::write_unsigned64(u64 value){
+    if( start_value() < 0 ){ return -1; }
+    return write_head(MAJOR_UNSIGNED, value);
+}
+
+int CborWriter::write_text(u8 major, const void * buffer, u32 length){
+    if( write_head(major, length) < 0 ){ return -1; }
+    return write_raw(buffer, length);
+}
+
+int CborWriter::write_raw(const void * buffer, u32 length){
+    if( m_is_failed ){ return -1; }
+
+    if( m_buffer_size + length <= BUFFER_SIZE ){
+        memcpy(m_buffer + m_buffer_size, buffer, length);
+        m_buffer_size += length;
+        return 0;
+    }
+
+    if( flush() < 0 ){ return -1; }
+
+    if( length >= BUFFER_SIZE ){
+        //large strings bypass the buffer
+        return write_destination((const u8*)buffer, length);
+    }
+
+    memcpy(m_buffer, buffer, length);
+    m_buffer_size = length;
+    return 0;
+}
+
+u8 * CborWriter::reserve(u32 length){
+    if( m_is_failed ){ return 0; }
+    if( m_buffer_size + length > BUFFER_SIZE ){
+        if( flush() < 0 ){ return 0; }
+    }
+    return m_buffer + m_buffer_size;
+}
+
+int CborWriter::write_destination(const u8 * buffer, u32 length){
+    if( m_file ){
+        while( length ){
+            int result = m_file->write(buffer, length);
+            if( result <= 0 ){
+                m_is_failed = true;
+                if( result == 0 ){ set_error_number(EIO); }
+                else { set_error_number(m_file->error_number()); }
+                return -1;
+            }
+            buffer += result;
+            length -= result;
+            m_flushed_size += result;
+        }
+        return 0;
+    }
+
+    if( m_data ){
+        u32 size = m_flushed_size + length;
+        if( m_data->reserve(size) < 0 ){
+            m_is_failed = true;
+            set_error_number(ENOSPC);
+            return -1;
+        }
+        m_data->set_size(size);
+        if( m_data->data() == 0 ){
+            //read-only memory
+            m_is_failed = true;
+            set_error_number(ENOSPC);
+            return -1;
+        }
+        memcpy((u8*)m_data->data() + m_flushed_size, buffer, length);
+        m_flushed_size = size;
+        return 0;
+    }
+
+    m_is_failed = true;
+    set_error_number(EINVAL);
+    return -1;
+}
@@ -0,0 +1,169 @@
+//Copyright 2011-2018 Tyler Gilbert; All Rights Reserved
+
+#include <errno.h>
+#include <cstring>
+#include "fmt/ChromeTrace.hpp"
+#include "var/StringUtil.hpp"
+
+using namespace fmt;
+using namespace var;
+using namespace sys;
+
+static const char * const library_event_names[] = {
+    "EventLoop::process_events",
+    "EventLoop::posted",
+    "EventLoop::handle_event",
+    "File::read",
+    "File::write",
+    "Link::read",
+    "Link::write"
+};
+
+ChromeTrace::ChromeTrace(const sys::File & file) : m_json(file){
+    init();
+}
+
+ChromeTrace::ChromeTrace(Data & data) : m_json(data){
+    init();
+}
+
+ChromeTrace::~ChromeTrace(){
+    if( !m_is_closed ){
+        close();
+    }
+}
+
+void ChromeTrace::init(){
+    m_names = 0;
+    m_name_count = 0;
+    m_dropped = 0;
+    m_is_started = false;
+    m_is_closed = false;
+}
+
+const char * ChromeTrace::library_event_name(u16 event){
+    if( (event >= TraceRing::EVENT_LIBRARY) && (event <= TraceRing::EVENT_LIBRARY_LAST) ){
+        return library_event_names[event - TraceRing::EVENT_LIBRARY];
+    }
+    return 0;
+}
+
+int ChromeTrace::start(){
+    if( m_is_started ){
+        return 0;
+    }
+    m_is_started = true;
+    if( (m_json.open_object() < 0) || (m_json.open_array("traceEvents") < 0) ){
+        set_error_number(m_json.error_number());
+        return -1;
+    }
+    return 0;
+}
+
+int ChromeTrace::write(const Data & dump){
+    trace_dump_header_t header;
+    trace_record_t record;
+    const u8 * records;
+
+    if( dump.size() < sizeof(header) ){
+        set_error_number(EINVAL);
+        return -1;
+    }
+
+    memcpy(&header, dump.data_const(), sizeof(header));
+    if( (header.magic != TraceRing::MAGIC) ||
+            (header.version != TraceRing::VERSION) ||
+            (header.record_size != sizeof(trace_record_t)) ||
+            ((dump.size() - sizeof(header)) / sizeof(trace_record_t) < header.count) ){
+        set_error_number(EINVAL);
+        return -1;
+    }
+
+    if( m_is_closed || (start() < 0) ){
+        if( m_is_closed ){ set_error_number(EINVAL); }
+        return -1;
+    }
+
+    records = (const u8*)dump.data_const() + sizeof(header);
+    for(u32 i=0; i < header.count; i++){
+        memcpy(&record, records + i*sizeof(trace_record_t), sizeof(trace_record_t));
+        if( write_record(record) < 0 ){
+            set_error_number(m_json.error_number());
+            return -1;
+        }
+    }
+
+    m_dropped += header.dropped;
+    return header.count;
+}
+
+int ChromeTrace::write_record(const trace_record_t & record){
+    const char * name = 0;
+    char phase[2] = { 'i', 0 };
+    u64 timestamp = ((u64)record.timestamp_high << 32) | record.timestamp_low;
+    char buffer[StringUtil::BUF_SIZE + 8];
+
+    if( record.event < m_name_count ){
+        name = m_names[record.event];
+    }
+    if( name == 0 ){
+        name = library_event_name(record.event);
+    }
+    if( name == 0 ){
+        strcpy(buffer, "event ");
+        StringUtil::utoa(buffer + 6, record.event);
+        name = buffer;
+    }
+
+    switch(record.type){
+        case TraceRing::BEGIN: phase[0] = 'B'; break;
+        case TraceRing::END: phase[0] = 'E'; break;
+        case TraceRing::COUNTER: phase[0] = 'C'; break;
+    }
+
+    m_json.open_object();
+    m_json.write_string("name", name);
+    m_json.write_string("cat", record.event >= TraceRing::EVENT_LIBRARY ? "sapi" : "app");
+    m_json.write_string("ph", phase);
+    //timestamps are in microseconds: keep the nanoseconds as the fraction
+    m_json.write_fixed("ts", timestamp, 3);
+    m_json.write_number("pid", 0);
+    m_json.write_number("tid", record.thread_id);
+    if( record.type == TraceRing::INSTANT ){
+        m_json.write_string("s", "t");
+    }
+
+    m_json.open_object("args");
+    if( record.type == TraceRing::COUNTER ){
+        m_json.write_number("value", record.args[0]);
+    } else {
+        m_json.write_number("arg0", record.args[0]);
+        if( record.type != TraceRing::END ){
+            m_json.write_number("arg1", record.args[1]);
+        }
+    }
+    m_json.close_object();
+    return m_json.close_object();
+}
+
+int ChromeTrace::close(){
+    if( m_is_closed ){
+        return 0;
+    }
+
+    if( start() < 0 ){
+        m_is_closed = true;
+        return -1;
+    }
+    m_is_closed = true;
+
+    m_json.close_array();
+    m_json.write_string("displayTimeUnit", "ns");
+    m_json.open_object("otherData");
+    m_json.write_number("dropped", m_dropped);
+    if( m_json.close() < 0 ){
+        set_error_number(m_json.error_number());
+        return -1;
+    }
+    return 0;
+}
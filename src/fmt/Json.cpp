@@ -12,7 +12,7 @@ JsonValue::JsonValue(const JsonValue & value){
 }
 
 JsonValue & JsonValue::operator=(const JsonValue & value){
-    if( is_valid() ){ json_decref(m_value); }
+    if( was_created() ){ json_decref(m_value); }
     set_observer(value.m_value);
     return *this;
 }
@@ -0,0 +1,596 @@
+//Copyright 2011-2018 Tyler Gilbert; All Rights Reserved
+
+#include <errno.h>
+#include <cstring>
+#include "fmt/JsonDocument.hpp"
+#include "fmt/ReaderInput.hpp"
+#include "var/StringUtil.hpp"
+#include "sys/File.hpp"
+
+using namespace fmt;
+using namespace var;
+
+typedef json_document_node_t node_t;
+
+static bool is_whitespace(char c){
+    return (c == ' ') || (c == '\n') || (c == '\r') || (c == '\t');
+}
+
+static bool is_digit(char c){ return (c >= '0') && (c <= '9'); }
+
+static char * skip_whitespace(char * p, const char * end){
+    while( (p < end) && is_whitespace(*p) ){ p++; }
+    return p;
+}
+
+static int hex_value(char c){
+    if( is_digit(c) ){ return c - '0'; }
+    if( (c >= 'a') && (c <= 'f') ){ return c - 'a' + 10; }
+    if( (c >= 'A') && (c <= 'F') ){ return c - 'A' + 10; }
+    return -1;
+}
+
+//counts the values and keys so the nodes can be allocated at once
+static u32 count_nodes(const char * text, u32 length){
+    u32 count = 1;
+    u32 is_array = 0;
+    u32 depth = 0;
+    bool is_opened = false;
+
+    for(u32 i=0; i < length; i++){
+        char c = text[i];
+        if( is_whitespace(c) ){ continue; }
+        if( is_opened ){
+            //an array that isn't empty has one more item than commas
+            is_opened = false;
+            if( c != ']' ){ count++; }
+        }
+        u32 level = depth < 32 ? ((u32)1 << depth) : 0;
+        switch(c){
+        case '"':
+            for(i++; (i < length) && (text[i] != '"'); i++){
+                if( text[i] == '\\' ){ i++; }
+            }
+            break;
+        case '[':
+            depth++;
+            if( depth < 32 ){ is_array |= (u32)1 << depth; }
+            is_opened = true;
+            break;
+        case '{':
+            depth++;
+            if( depth < 32 ){ is_array &= ~((u32)1 << depth); }
+            break;
+        case ']':
+        case '}':
+            if( depth ){ depth--; }
+            break;
+        case ',':
+            if( is_array & level ){ count++; }
+            break;
+        case ':':
+            count += 2;
+            break;
+        }
+    }
+    return count;
+}
+
+static int parse_hex4(const char * p, const char * end, u32 & code){
+    if( end - p < 4 ){ return -1; }
+    code = 0;
+    for(u32 i=0; i < 4; i++){
+        int h = hex_value(p[i]);
+        if( h < 0 ){ return -1; }
+        code = (code << 4) | h;
+    }
+    return 0;
+}
+
+//unescapes the string in place -- p points after the opening quote
+static char * parse_string(char * p, const char * end, u32 & length){
+    char * start = p;
+    char * dest = p;
+    u32 code;
+
+    while( p < end ){
+        char c = *p;
+        if( c == '"' ){
+            *dest = 0;
+            length = dest - start;
+            return p+1;
+        }
+        if( (u8)c < 0x20 ){
+            return 0;
+        }
+        if( c != '\\' ){
+            *dest++ = *p++;
+            continue;
+        }
+
+        p++;
+        if( p == end ){ return 0; }
+        switch(*p++){
+        case '"': *dest++ = '"'; break;
+        case '\\': *dest++ = '\\'; break;
+        case '/': *dest++ = '/'; break;
+        case 'b': *dest++ = '\b'; break;
+        case 'f': *dest++ = '\f'; break;
+        case 'n': *dest++ = '\n'; break;
+        case 'r': *dest++ = '\r'; break;
+        case 't': *dest++ = '\t'; break;
+        case 'u':
+            if( parse_hex4(p, end, code) < 0 ){ return 0; }
+            p += 4;
+            if( (code >= 0xdc00) && (code <= 0xdfff) ){ return 0; }
+            if( (code >= 0xd800) && (code <= 0xdbff) ){
+                u32 low;
+                if( (end - p < 6) || (p[0] != '\\') || (p[1] != 'u') || (parse_hex4(p+2, end, low) < 0) ){
+                    return 0;
+                }
+                if( (low < 0xdc00) || (low > 0xdfff) ){ return 0; }
+                p += 6;
+                code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+            }
+            //the UTF-8 encoding is always shorter than the escape sequence
+            dest += ReaderInput::encode_utf8(dest, code);
+            break;
+        default:
+            return 0;
+        }
+    }
+    return 0;
+}
+
+static char * parse_number(char * p, const char * end, node_t & node){
+    char * start = p;
+    bool is_integer = true;
+    char buffer[64];
+
+    if( (p < end) && (*p == '-') ){ p++; }
+    if( p == end ){ return 0; }
+    if( *p == '0' ){
+        p++;
+    } else if( is_digit(*p) ){
+        while( (p < end) && is_digit(*p) ){ p++; }
+    } else {
+        return 0;
+    }
+    if( (p < end) && (*p == '.') ){
+        is_integer = false;
+        p++;
+        if( (p == end) || !is_digit(*p) ){ return 0; }
+        while( (p < end) && is_digit(*p) ){ p++; }
+    }
+    if( (p < end) && ((*p == 'e') || (*p == 'E')) ){
+        is_integer = false;
+        p++;
+        if( (p < end) && ((*p == '+') || (*p == '-')) ){ p++; }
+        if( (p == end) || !is_digit(*p) ){ return 0; }
+        while( (p < end) && is_digit(*p) ){ p++; }
+    }
+
+    u32 length = p - start;
+    if( length >= sizeof(buffer) ){ return 0; }
+    memcpy(buffer, start, length);
+    buffer[length] = 0;
+
+    if( is_integer ){
+        s32 value;
+        if( StringUtil::parse_int(buffer, value) == 0 ){
+            node.info = JsonView::INTEGER;
+            node.value = value;
+            return p;
+        }
+        //too big for an integer
+    }
+
+    float value;
+    if( StringUtil::parse_float(buffer, value) < 0 ){
+        return 0;
+    }
+    node.info = JsonView::REAL;
+    memcpy(&node.value, &value, sizeof(value));
+    return p;
+}
+
+static int compare_key(const char * text, const node_t & key, const char * str, u32 length){
+    u32 key_length = key.info >> 4;
+    int result = memcmp(text + key.value, str, key_length < length ? key_length : length);
+    if( result == 0 ){
+        if( key_length < length ){ return -1; }
+        if( key_length > length ){ return 1; }
+    }
+    return result;
+}
+
+static bool is_pair_less(const char * text, const node_t * a, const node_t * b){
+    int result = compare_key(text, a[0], text + b[0].value, b[0].info >> 4);
+    if( result == 0 ){
+        //duplicate keys stay in the order they appear in the text
+        return a[0].value < b[0].value;
+    }
+    return result < 0;
+}
+
+static void swap_pair(node_t * a, node_t * b){
+    node_t tmp[2];
+    memcpy(tmp, a, sizeof(tmp));
+    memcpy(a, b, sizeof(tmp));
+    memcpy(b, tmp, sizeof(tmp));
+}
+
+static void sift_down(const char * text, node_t * pairs, u32 root, u32 count){
+    for(;;){
+        u32 child = root*2 + 1;
+        if( child >= count ){ return; }
+        if( (child + 1 < count) && is_pair_less(text, pairs + child*2, pairs + (child+1)*2) ){
+            child++;
+        }
+        if( !is_pair_less(text, pairs + root*2, pairs + child*2) ){ return; }
+        swap_pair(pairs + root*2, pairs + child*2);
+        root = child;
+    }
+}
+
+//sorts key/value pairs by key and removes duplicate keys (the last one is kept)
+static u32 sort_pairs(const char * text, node_t * pairs, u32 count){
+    if( count < 2 ){ return count; }
+
+    for(u32 i = count/2; i > 0; i--){
+        sift_down(text, pairs, i-1, count);
+    }
+    for(u32 end = count-1; end > 0; end--){
+        swap_pair(pairs, pairs + end*2);
+        sift_down(text, pairs, 0, end);
+    }
+
+    u32 result = 0;
+    for(u32 i=0; i < count; i++){
+        if( (i + 1 < count) && (compare_key(text, pairs[i*2], text + pairs[(i+1)*2].value, pairs[(i+1)*2].info >> 4) == 0) ){
+            continue;
+        }
+        if( result != i ){
+            memcpy(pairs + result*2, pairs + i*2, 2*sizeof(node_t));
+        }
+        result++;
+    }
+    return result;
+}
+
+JsonDocument::JsonDocument(){
+    m_text = 0;
+    m_count = 0;
+    m_error_position = 0;
+}
+
+int JsonDocument::parse(Data & data){
+    if( data.cdata() == 0 ){
+        set_error_number(EINVAL);
+        return -1;
+    }
+    return parse_text(data.cdata(), data.size());
+}
+
+int JsonDocument::parse(const ConstString & json){
+    u32 length = json.length();
+    if( m_text_buffer.set_size(length+1) < 0 ){
+        return -1;
+    }
+    memcpy(m_text_buffer.data(), json.str(), length+1);
+    return parse_text(m_text_buffer.cdata(), length);
+}
+
+void JsonDocument::clear(){
+    m_nodes.free();
+    m_text_buffer.free();
+    m_text = 0;
+    m_count = 0;
+    m_error_position = 0;
+}
+
+int JsonDocument::load(const ConstString & path){
+    sys::File file;
+    if( file.open(path, sys::File::RDONLY) < 0 ){
+        set_error_number(file.error_number());
+        return -1;
+    }
+    int result = load(file);
+    file.close();
+    return result;
+}
+
+int JsonDocument::load(const sys::File & file){
+    u32 length = 0;
+    int result;
+
+    do {
+        if( m_text_buffer.reserve(length + 257) < 0 ){
+            return -1;
+        }
+        result = file.read(m_text_buffer.cdata() + length, m_text_buffer.capacity() - length - 1);
+        if( result < 0 ){
+            set_error_number(file.error_number());
+            return -1;
+        }
+        length += result;
+    } while( result > 0 );
+
+    return parse_text(m_text_buffer.cdata(), length);
+}
+
+int JsonDocument::fail(const char * text, const char * position){
+    m_count = 0;
+    m_error_position = position - text;
+    set_error_number(EINVAL);
+    return -1;
+}
+
+int JsonDocument::parse_text(char * text, u32 length){
+    const char * end = text + length;
+    u32 frame[MAX_DEPTH+1];
+    u32 is_object = 0;
+    u32 depth = 0;
+    bool is_key_next = false;
+    char * p = text;
+    node_t node;
+    u32 string_length;
+
+    m_text = text;
+    m_count = 0;
+    m_error_position = 0;
+
+    //the items of finished objects and arrays are stored from the bottom (after the root)
+    //and the items that are still being parsed are pushed down from the top
+    u32 capacity = count_nodes(text, length) + 1;
+    if( m_nodes.set_size(capacity * sizeof(node_t)) < 0 ){
+        return -1;
+    }
+    node_t * nodes = (node_t*)m_nodes.data();
+    u32 bottom = 1;
+    u32 top = capacity;
+
+    for(;;){
+        p = skip_whitespace(p, end);
+        if( p == end ){ return fail(text, p); }
+
+        if( is_key_next ){
+            if( *p != '"' ){ return fail(text, p); }
+            char * start = p + 1;
+            p = parse_string(start, end, string_length);
+            if( p == 0 ){ return fail(text, start); }
+            if( top <= bottom ){ return fail(text, start); }
+            node.info = JsonView::STRING | (string_length << 4);
+            node.value = start - text;
+            nodes[--top] = node;
+
+            p = skip_whitespace(p, end);
+            if( (p == end) || (*p != ':') ){ return fail(text, p); }
+            p++;
+            is_key_next = false;
+            continue;
+        }
+
+        char * start = p;
+        switch(*p){
+        case '{':
+        case '[':
+            if( depth == MAX_DEPTH ){ return fail(text, p); }
+            depth++;
+            frame[depth] = top;
+            if( *p == '{' ){
+                is_object |= (u32)1 << depth;
+            } else {
+                is_object &= ~((u32)1 << depth);
+            }
+            p = skip_whitespace(p+1, end);
+            if( (p < end) && (*p == (*start == '{' ? '}' : ']')) ){
+                //an empty object or array is pushed like any other value
+                p++;
+                node.info = *start == '{' ? JsonView::OBJECT : JsonView::ARRAY;
+                node.value = bottom;
+                depth--;
+                break;
+            }
+            is_key_next = *start == '{';
+            continue;
+
+        case '"':
+            p = parse_string(p+1, end, string_length);
+            if( p == 0 ){ return fail(text, start); }
+            node.info = JsonView::STRING | (string_length << 4);
+            node.value = start + 1 - text;
+            break;
+
+        case 't':
+            if( (end - p < 4) || memcmp(p, "true", 4) ){ return fail(text, p); }
+            p += 4;
+            node.info = JsonView::TRUE;
+            node.value = 0;
+            break;
+
+        case 'f':
+            if( (end - p < 5) || memcmp(p, "false", 5) ){ return fail(text, p); }
+            p += 5;
+            node.info = JsonView::FALSE;
+            node.value = 0;
+            break;
+
+        case 'n':
+            if( (end - p < 4) || memcmp(p, "null", 4) ){ return fail(text, p); }
+            p += 4;
+            node.info = JsonView::ZERO;
+            node.value = 0;
+            break;
+
+        default:
+            p = parse_number(p, end, node);
+            if( p == 0 ){ return fail(text, start); }
+            break;
+        }
+
+        if( top <= bottom ){ return fail(text, start); }
+        nodes[--top] = node;
+
+        //close objects and arrays until there is a comma or the end
+        for(;;){
+            if( depth == 0 ){
+                p = skip_whitespace(p, end);
+                if( p != end ){ return fail(text, p); }
+                nodes[0] = nodes[top];
+                m_count = bottom;
+                return 0;
+            }
+
+            p = skip_whitespace(p, end);
+            if( p == end ){ return fail(text, p); }
+
+            bool is_in_object = (is_object & ((u32)1 << depth)) != 0;
+            if( *p == ',' ){
+                p++;
+                is_key_next = is_in_object;
+                break;
+            }
+
+            if( *p != (is_in_object ? '}' : ']') ){
+                return fail(text, p);
+            }
+            p++;
+
+            //move the items to the bottom (they were pushed in reverse order)
+            u32 count = frame[depth] - top;
+            memmove(nodes + bottom, nodes + top, count*sizeof(node_t));
+            for(u32 i=0; i < count/2; i++){
+                node_t tmp = nodes[bottom + i];
+                nodes[bottom + i] = nodes[bottom + count - 1 - i];
+                nodes[bottom + count - 1 - i] = tmp;
+            }
+
+            u32 items = count;
+            if( is_in_object ){
+                items = sort_pairs(text, nodes + bottom, count/2);
+                count = items*2;
+            }
+
+            node.info = (is_in_object ? JsonView::OBJECT : JsonView::ARRAY) | (items << 4);
+            node.value = bottom;
+            bottom += count;
+            top = frame[depth];
+            depth--;
+            if( top <= bottom ){ return fail(text, p); }
+            nodes[--top] = node;
+        }
+    }
+}
+
+String JsonView::to_string() const {
+    String result;
+    switch(type()){
+    case STRING: result.assign(to_const_string()); break;
+    case REAL: result.format("%f", to_real()); break;
+    case INTEGER: result.format("%d", to_integer()); break;
+    case TRUE: result = "true"; break;
+    case FALSE: result = "false"; break;
+    case ZERO: result = "null"; break;
+    case OBJECT: result = "{object}"; break;
+    case ARRAY: result = "[array]"; break;
+    default: result = "invalid"; break;
+    }
+    result.set_transfer_ownership();
+    return result;
+}
+
+ConstString JsonView::to_const_string() const {
+    if( is_string() ){
+        return ConstString(m_document->m_text + m_node->value);
+    }
+    return ConstString();
+}
+
+float JsonView::to_real() const {
+    float value;
+    switch(type()){
+    case REAL:
+        memcpy(&value, &m_node->value, sizeof(value));
+        return value;
+    case INTEGER:
+        return (s32)m_node->value;
+    case STRING:
+        if( StringUtil::parse_float(to_const_string().str(), value) == 0 ){
+            return value;
+        }
+        return 0.0f;
+    default:
+        return 0.0f;
+    }
+}
+
+int JsonView::to_integer() const {
+    s32 value;
+    switch(type()){
+    case INTEGER:
+        return (s32)m_node->value;
+    case REAL:
+        return (int)to_real();
+    case STRING:
+        if( StringUtil::parse_int(to_const_string().str(), value) == 0 ){
+            return value;
+        }
+        return 0;
+    default:
+        return 0;
+    }
+}
+
+JsonView JsonView::at(const ConstString & key) const {
+    if( !is_object() ){
+        return JsonView();
+    }
+    const char * text = m_document->m_text;
+    const node_t * pairs = m_document->nodes() + m_node->value;
+    u32 length = key.length();
+    u32 low = 0;
+    u32 high = count();
+    while( low < high ){
+        u32 middle = low + (high - low)/2;
+        int result = compare_key(text, pairs[middle*2], key.str(), length);
+        if( result == 0 ){
+            return JsonView(m_document, pairs + middle*2 + 1);
+        }
+        if( result < 0 ){
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return JsonView();
+}
+
+JsonView JsonView::at(u32 idx) const {
+    if( idx >= count() ){
+        return JsonView();
+    }
+    const node_t * items = m_document->nodes() + m_node->value;
+    if( is_object() ){
+        return JsonView(m_document, items + idx*2 + 1);
+    }
+    return JsonView(m_document, items + idx);
+}
+
+ConstString JsonView::key_at(u32 idx) const {
+    if( !is_object() || (idx >= count()) ){
+        return ConstString();
+    }
+    const node_t * key = m_document->nodes() + m_node->value + idx*2;
+    return ConstString(m_document->m_text + key->value);
+}
+
+Vector<String> JsonView::keys() const {
+    Vector<String> result;
+    for(u32 i=0; i < count(); i++){
+        String key(key_at(i));
+        key.set_transfer_ownership();
+        result.push_back(key);
+    }
+    return result;
+}
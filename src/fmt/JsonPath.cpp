@@ -0,0 +1,540 @@
+//Copyright 2011-2018 Tyler Gilbert; All Rights Reserved
+
+#include <errno.h>
+#include <cstring>
+#include "fmt/JsonPath.hpp"
+
+using namespace fmt;
+using namespace var;
+
+namespace {
+
+enum {
+    FLAG_KEY = 0x01,
+    FLAG_INDEX = 0x02,
+    FLAG_WILDCARD = 0x04,
+    MAX_INDEX = 0x7fffffff
+};
+
+typedef json_path_segment_t segment_t;
+
+//accesses jansson values
+class JanssonAccess {
+public:
+    typedef json_t * node_t;
+    typedef JsonValue result_t;
+    typedef struct {
+        void * iter;
+        u32 index;
+    } iterator_t;
+
+    static bool is_valid(node_t node){ return node != 0; }
+    static result_t to_result(node_t node){ return JsonValue(node); }
+    static bool is_result(const result_t & result){ return result.is_valid(); }
+
+    static node_t at(node_t node, const segment_t & segment, const char * keys){
+        if( json_is_object(node) ){
+            return (segment.flags & FLAG_KEY) ? json_object_get(node, keys + segment.key) : 0;
+        }
+        if( json_is_array(node) && (segment.flags & FLAG_INDEX) ){
+            return json_array_get(node, segment.index);
+        }
+        return 0;
+    }
+
+    static node_t first(node_t node, iterator_t & iterator){
+        iterator.iter = 0;
+        iterator.index = 0;
+        if( json_is_object(node) ){
+            iterator.iter = json_object_iter(node);
+            return iterator.iter ? json_object_iter_value(iterator.iter) : 0;
+        }
+        return json_is_array(node) ? json_array_get(node, 0) : 0;
+    }
+
+    static node_t next(node_t node, iterator_t & iterator){
+        if( iterator.iter ){
+            iterator.iter = json_object_iter_next(node, iterator.iter);
+            return iterator.iter ? json_object_iter_value(iterator.iter) : 0;
+        }
+        return json_array_get(node, ++iterator.index);
+    }
+};
+
+//accesses JsonDocument values
+class ViewAccess {
+public:
+    typedef JsonView node_t;
+    typedef JsonView result_t;
+    typedef u32 iterator_t;
+
+    static bool is_valid(const node_t & node){ return node.is_valid(); }
+    static result_t to_result(const node_t & node){ return node; }
+    static bool is_result(const result_t & result){ return result.is_valid(); }
+
+    static node_t at(const node_t & node, const segment_t & segment, const char * keys){
+        if( node.is_object() ){
+            return (segment.flags & FLAG_KEY) ? node.at(ConstString(keys + segment.key)) : JsonView();
+        }
+        if( node.is_array() && (segment.flags & FLAG_INDEX) ){
+            return node.at(segment.index);
+        }
+        return JsonView();
+    }
+
+    static node_t first(const node_t & node, iterator_t & iterator){
+        iterator = 0;
+        return node.at(iterator);
+    }
+
+    static node_t next(const node_t & node, iterator_t & iterator){
+        return node.at(++iterator);
+    }
+};
+
+template<class A> bool find_first(typename A::node_t node, const segment_t * segment, u32 count, const char * keys, typename A::node_t & result){
+    for(u32 i=0; i < count; i++){
+        if( segment[i].flags & FLAG_WILDCARD ){
+            typename A::iterator_t iterator;
+            for(typename A::node_t child = A::first(node, iterator); A::is_valid(child); child = A::next(node, iterator)){
+                if( find_first<A>(child, segment + i + 1, count - i - 1, keys, result) ){
+                    return true;
+                }
+            }
+            return false;
+        }
+        node = A::at(node, segment[i], keys);
+        if( !A::is_valid(node) ){
+            return false;
+        }
+    }
+    result = node;
+    return true;
+}
+
+template<class A> int find_all(typename A::node_t node, const segment_t * segment, u32 count, const char * keys, Vector<typename A::result_t> & results){
+    for(u32 i=0; i < count; i++){
+        if( segment[i].flags & FLAG_WILDCARD ){
+            int total = 0;
+            typename A::iterator_t iterator;
+            for(typename A::node_t child = A::first(node, iterator); A::is_valid(child); child = A::next(node, iterator)){
+                total += find_all<A>(child, segment + i + 1, count - i - 1, keys, results);
+            }
+            return total;
+        }
+        node = A::at(node, segment[i], keys);
+        if( !A::is_valid(node) ){
+            return 0;
+        }
+    }
+    results.push_back(A::to_result(node));
+    return 1;
+}
+
+int compare_segment(const segment_t & a, const segment_t & b, const char * keys){
+    if( a.flags != b.flags ){
+        return (int)a.flags - (int)b.flags;
+    }
+    if( a.flags & FLAG_KEY ){
+        return strcmp(keys + a.key, keys + b.key);
+    }
+    if( a.flags & FLAG_INDEX ){
+        return (a.index < b.index) ? -1 : (a.index > b.index);
+    }
+    return 0;
+}
+
+//the compiled paths of a JsonQuery
+typedef struct {
+    const segment_t * segments;
+    const char * keys;
+    const u32 * start;
+    const u32 * order;
+    const u32 * prefix;
+} query_t;
+
+/*
+ * Paths order[begin..end) have the same first depth segments. They are
+ * sorted so the paths that end at depth are first and prefix[i] is the
+ * number of segments path order[i] has in common with path order[i-1].
+ * Each distinct segment is looked up once for the whole group.
+ */
+template<class A> int find_batch(const query_t & query, typename A::node_t node, u32 depth, u32 begin, u32 end, typename A::result_t * results){
+    int total = 0;
+    u32 i = begin;
+
+    while( (i < end) && (query.start[query.order[i]+1] - query.start[query.order[i]] == depth) ){
+        if( !A::is_result(results[query.order[i]]) ){
+            results[query.order[i]] = A::to_result(node);
+            total++;
+        }
+        i++;
+    }
+
+    while( i < end ){
+        const segment_t & segment = query.segments[query.start[query.order[i]] + depth];
+        u32 j = i+1;
+        while( (j < end) && (query.prefix[j] > depth) ){
+            j++;
+        }
+
+        if( segment.flags & FLAG_WILDCARD ){
+            typename A::iterator_t iterator;
+            for(typename A::node_t child = A::first(node, iterator); A::is_valid(child); child = A::next(node, iterator)){
+                total += find_batch<A>(query, child, depth+1, i, j, results);
+            }
+        } else {
+            typename A::node_t child = A::at(node, segment, query.keys);
+            if( A::is_valid(child) ){
+                total += find_batch<A>(query, child, depth+1, i, j, results);
+            }
+        }
+
+        i = j;
+    }
+
+    return total;
+}
+
+bool parse_index(const char * str, u32 length, u32 & index){
+    if( (length == 0) || ((length > 1) && (str[0] == '0')) ){
+        return false;
+    }
+    u32 value = 0;
+    for(u32 i=0; i < length; i++){
+        u32 digit = (u32)(str[i] - '0');
+        if( (digit > 9) || (value > (MAX_INDEX - digit)/10) ){
+            return false;
+        }
+        value = value*10 + digit;
+    }
+    index = value;
+    return true;
+}
+
+}
+
+JsonPath::JsonPath(){
+    m_count = 0;
+    m_is_valid = true;
+}
+
+JsonPath::JsonPath(const ConstString & path){
+    compile(path);
+}
+
+int JsonPath::compile(const ConstString & path){
+    u32 key_size = 0;
+    m_count = 0;
+    m_is_valid = false;
+    if( compile(path, m_segments, m_count, m_keys, key_size) < 0 ){
+        m_count = 0;
+        set_error_number(EINVAL);
+        return -1;
+    }
+    m_is_valid = true;
+    return 0;
+}
+
+bool JsonPath::is_wildcard() const {
+    const segment_t * segment = (const segment_t*)m_segments.data_const();
+    for(u32 i=0; i < m_count; i++){
+        if( segment[i].flags & FLAG_WILDCARD ){
+            return true;
+        }
+    }
+    return false;
+}
+
+JsonValue JsonPath::find(const JsonValue & root) const {
+    json_t * result;
+    if( m_is_valid &&
+            (root.m_value != 0) &&
+            find_first<JanssonAccess>(root.m_value, (const segment_t*)m_segments.data_const(), m_count, m_keys.cdata_const(), result) ){
+        return JsonValue(result);
+    }
+    return JsonValue();
+}
+
+JsonView JsonPath::find(const JsonView & root) const {
+    JsonView result;
+    if( m_is_valid &&
+            root.is_valid() &&
+            find_first<ViewAccess>(root, (const segment_t*)m_segments.data_const(), m_count, m_keys.cdata_const(), result) ){
+        return result;
+    }
+    return JsonView();
+}
+
+int JsonPath::find_all(const JsonValue & root, Vector<JsonValue> & results) const {
+    if( !m_is_valid || (root.m_value == 0) ){
+        return 0;
+    }
+    return ::find_all<JanssonAccess>(root.m_value, (const segment_t*)m_segments.data_const(), m_count, m_keys.cdata_const(), results);
+}
+
+int JsonPath::find_all(const JsonView & root, Vector<JsonView> & results) const {
+    if( !m_is_valid || !root.is_valid() ){
+        return 0;
+    }
+    return ::find_all<ViewAccess>(root, (const segment_t*)m_segments.data_const(), m_count, m_keys.cdata_const(), results);
+}
+
+int JsonPath::compile(const ConstString & path, Data & segments, u32 & count, Data & keys, u32 & key_size){
+    const char * p = path.str();
+    u32 length = path.length();
+    u32 segment_count = count;
+    u32 key_offset = key_size;
+
+    //reserve enough space for the worst case
+    u32 max_count = 1;
+    for(u32 i=0; i < length; i++){
+        if( (p[i] == '/') || (p[i] == '.') || (p[i] == '[') ){
+            max_count++;
+        }
+    }
+    if( (segments.reserve((count + max_count)*sizeof(segment_t)) < 0) ||
+            (keys.reserve(key_size + length + max_count) < 0) ||
+            (segments.data() == 0) ||
+            (keys.data() == 0) ){
+        return -1;
+    }
+
+    segment_t * segment = (segment_t*)segments.data();
+    char * key = keys.cdata();
+
+    if( (length == 0) || ((length == 1) && (p[0] == '$')) ){
+        //the top level value
+    } else if( p[0] == '/' ){
+        //JSON pointer
+        u32 i = 1;
+        while( 1 ){
+            u32 end = i;
+            while( (end < length) && (p[end] != '/') ){
+                end++;
+            }
+
+            segment_t & s = segment[segment_count++];
+            memset(&s, 0, sizeof(s));
+            s.key = key_offset;
+            if( (end - i == 1) && (p[i] == '*') ){
+                s.flags = FLAG_WILDCARD;
+            } else {
+                s.flags = FLAG_KEY;
+                if( parse_index(p + i, end - i, s.index) ){
+                    s.flags |= FLAG_INDEX;
+                }
+                for(u32 j=i; j < end; j++){
+                    char c = p[j];
+                    if( c == '~' ){
+                        if( (j+1 < end) && (p[j+1] == '0') ){
+                            c = '~';
+                        } else if( (j+1 < end) && (p[j+1] == '1') ){
+                            c = '/';
+                        } else {
+                            return -1;
+                        }
+                        j++;
+                    }
+                    key[key_offset++] = c;
+                }
+            }
+            key[key_offset++] = 0;
+
+            if( end == length ){
+                break;
+            }
+            i = end+1;
+        }
+    } else if( p[0] == '$' ){
+        //JSONPath subset
+        u32 i = 1;
+        while( i < length ){
+            segment_t & s = segment[segment_count++];
+            memset(&s, 0, sizeof(s));
+            s.key = key_offset;
+
+            if( p[i] == '.' ){
+                i++;
+                if( (i < length) && (p[i] == '*') ){
+                    s.flags = FLAG_WILDCARD;
+                    i++;
+                } else {
+                    u32 start = i;
+                    while( (i < length) && (p[i] != '.') && (p[i] != '[') ){
+                        key[key_offset++] = p[i++];
+                    }
+                    if( i == start ){
+                        return -1;
+                    }
+                    s.flags = FLAG_KEY;
+                }
+            } else if( p[i] == '[' ){
+                i++;
+                if( i == length ){
+                    return -1;
+                }
+                char quote = p[i];
+                if( (quote == '\'') || (quote == '"') ){
+                    i++;
+                    while( (i < length) && (p[i] != quote) ){
+                        if( (p[i] == '\\') && (i+1 < length) ){
+                            i++;
+                        }
+                        key[key_offset++] = p[i++];
+                    }
+                    if( i == length ){
+                        return -1;
+                    }
+                    i++;
+                    s.flags = FLAG_KEY;
+                } else if( quote == '*' ){
+                    i++;
+                    s.flags = FLAG_WILDCARD;
+                } else {
+                    u32 start = i;
+                    while( (i < length) && (p[i] != ']') ){
+                        i++;
+                    }
+                    if( !parse_index(p + start, i - start, s.index) ){
+                        return -1;
+                    }
+                    s.flags = FLAG_INDEX;
+                }
+                if( (i == length) || (p[i] != ']') ){
+                    return -1;
+                }
+                i++;
+            } else {
+                return -1;
+            }
+
+            key[key_offset++] = 0;
+        }
+    } else {
+        return -1;
+    }
+
+    segments.set_size(segment_count*sizeof(segment_t));
+    keys.set_size(key_offset);
+    count = segment_count;
+    key_size = key_offset;
+    return 0;
+}
+
+JsonQuery::JsonQuery(){
+    m_segment_count = 0;
+    m_key_size = 0;
+}
+
+void JsonQuery::clear(){
+    m_segments.set_size(0);
+    m_keys.set_size(0);
+    m_segment_count = 0;
+    m_key_size = 0;
+    m_start.clear();
+    m_order.clear();
+    m_prefix.clear();
+}
+
+int JsonQuery::add(const ConstString & path){
+    u32 segment_count = m_segment_count;
+    u32 key_size = m_key_size;
+
+    if( (m_start.count() == 0) && (m_start.push_back(0) < 0) ){
+        return -1;
+    }
+
+    if( JsonPath::compile(path, m_segments, segment_count, m_keys, key_size) < 0 ){
+        set_error_number(EINVAL);
+        return -1;
+    }
+
+    if( m_start.push_back(segment_count) < 0 ){
+        set_error_number(ENOMEM);
+        return -1;
+    }
+
+    if( (m_order.push_back(0) < 0) || (m_prefix.push_back(0) < 0) ){
+        if( m_order.count() > m_prefix.count() ){ m_order.pop_back(); }
+        m_start.pop_back();
+        set_error_number(ENOMEM);
+        return -1;
+    }
+
+    m_segment_count = segment_count;
+    m_key_size = key_size;
+
+    //insert the new path in sorted order
+    u32 index = count() - 1;
+    u32 i = index;
+    u32 common;
+    while( (i > 0) && (compare(m_order[i-1], index, common) > 0) ){
+        m_order[i] = m_order[i-1];
+        m_prefix[i] = m_prefix[i-1];
+        i--;
+    }
+    m_order[i] = index;
+
+    //update the common prefix lengths of the new path and the one after it
+    for(u32 k = i; (k <= i+1) && (k < count()); k++){
+        if( k == 0 ){
+            m_prefix[k] = 0;
+        } else {
+            compare(m_order[k-1], m_order[k], common);
+            m_prefix[k] = common;
+        }
+    }
+
+    return index;
+}
+
+int JsonQuery::compare(u32 a, u32 b, u32 & common) const {
+    const segment_t * segments = (const segment_t*)m_segments.data_const();
+    const char * keys = m_keys.cdata_const();
+    u32 a_count = m_start[a+1] - m_start[a];
+    u32 b_count = m_start[b+1] - m_start[b];
+    u32 count = a_count < b_count ? a_count : b_count;
+
+    for(common=0; common < count; common++){
+        int result = compare_segment(segments[m_start[a] + common], segments[m_start[b] + common], keys);
+        if( result ){
+            return result;
+        }
+    }
+
+    //shorter paths go first
+    return (int)a_count - (int)b_count;
+}
+
+int JsonQuery::find(const JsonValue & root, JsonValue * results) const {
+    for(u32 i=0; i < count(); i++){
+        results[i] = JsonValue();
+    }
+    if( (root.m_value == 0) || (count() == 0) ){
+        return 0;
+    }
+    query_t query;
+    query.segments = (const segment_t*)m_segments.data_const();
+    query.keys = m_keys.cdata_const();
+    query.start = m_start.vector_data_const();
+    query.order = m_order.vector_data_const();
+    query.prefix = m_prefix.vector_data_const();
+    return find_batch<JanssonAccess>(query, root.m_value, 0, 0, count(), results);
+}
+
+int JsonQuery::find(const JsonView & root, JsonView * results) const {
+    for(u32 i=0; i < count(); i++){
+        results[i] = JsonView();
+    }
+    if( !root.is_valid() || (count() == 0) ){
+        return 0;
+    }
+    query_t query;
+    query.segments = (const segment_t*)m_segments.data_const();
+    query.keys = m_keys.cdata_const();
+    query.start = m_start.vector_data_const();
+    query.order = m_order.vector_data_const();
+    query.prefix = m_prefix.vector_data_const();
+    return find_batch<ViewAccess>(query, root, 0, 0, count(), results);
+}
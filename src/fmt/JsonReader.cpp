@@ -0,0 +1,528 @@
+//Copyright 2011-2018 Tyler Gilbert; All Rights Reserved
+
+#include <errno.h>
+#include <cstring>
+#include "fmt/JsonReader.hpp"
+#include "var/StringUtil.hpp"
+
+using namespace fmt;
+using namespace var;
+
+static bool is_digit(int c){ return (c >= '0') && (c <= '9'); }
+
+static bool is_number(const char * s){
+    //-?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+    if( *s == '-' ){ s++; }
+    if( *s == '0' ){
+        s++;
+    } else if( is_digit(*s) ){
+        while( is_digit(*s) ){ s++; }
+    } else {
+        return false;
+    }
+    if( *s == '.' ){
+        s++;
+        if( !is_digit(*s) ){ return false; }
+        while( is_digit(*s) ){ s++; }
+    }
+    if( (*s == 'e') || (*s == 'E') ){
+        s++;
+        if( (*s == '+') || (*s == '-') ){ s++; }
+        if( !is_digit(*s) ){ return false; }
+        while( is_digit(*s) ){ s++; }
+    }
+    return *s == 0;
+}
+
+static int hex_value(int c){
+    if( is_digit(c) ){ return c - '0'; }
+    if( (c >= 'a') && (c <= 'f') ){ return c - 'a' + 10; }
+    if( (c >= 'A') && (c <= 'F') ){ return c - 'A' + 10; }
+    return -1;
+}
+
+JsonReader::JsonReader(const sys::File & file, u32 max_token_size){
+    init(max_token_size);
+    m_input.set_file(file, BUFFER_SIZE);
+}
+
+JsonReader::JsonReader(const Data & data, u32 max_token_size){
+    init(max_token_size);
+    m_input.set_data(data);
+}
+
+JsonReader::JsonReader(reader_load_t callback, void * context, u32 max_token_size){
+    init(max_token_size);
+    m_input.set_callback(callback, context, BUFFER_SIZE);
+}
+
+void JsonReader::init(u32 max_token_size){
+    m_token_size = 0;
+    if( m_token.set_size(max_token_size+1) == 0 ){
+        m_token.cdata()[0] = 0;
+    }
+    m_path_length = 0;
+    if( m_path.set_size(MAX_PATH_SIZE+1) == 0 ){
+        m_path.cdata()[0] = 0;
+    }
+
+    m_is_object = 0;
+    m_index[0] = 0;
+    m_path_offset[0] = 0;
+    m_depth = 0;
+    m_state = STATE_VALUE;
+    m_match_depth = 0;
+    m_event = END;
+    m_filter = 0;
+    m_filter_count = 0;
+}
+
+int JsonReader::next(){
+    if( m_event == ERROR ){ return ERROR; }
+
+    if( m_filter_count == 0 ){
+        m_event = next_event();
+        return m_event;
+    }
+
+    for(;;){
+        int event = next_event();
+        if( event <= END ){
+            m_event = event;
+            return event;
+        }
+
+        if( m_match_depth ){
+            //all events inside a matching object or array are returned
+            if( ((event == END_OBJECT) || (event == END_ARRAY)) && (m_depth < m_match_depth) ){
+                m_match_depth = 0;
+            }
+            m_event = event;
+            return event;
+        }
+
+        switch(event){
+        case KEY:
+        case END_OBJECT:
+        case END_ARRAY:
+            break;
+        case OBJECT:
+        case ARRAY:
+            if( is_filter_match(false) ){
+                m_match_depth = m_depth;
+                m_event = event;
+                return event;
+            }
+            if( !is_filter_match(true) && (skip() < 0) ){
+                return ERROR;
+            }
+            break;
+        default:
+            if( is_filter_match(false) ){
+                m_event = event;
+                return event;
+            }
+            break;
+        }
+    }
+}
+
+int JsonReader::skip(){
+    u32 level = 1;
+    int c;
+
+    if( m_depth == 0 ){
+        return 0;
+    }
+
+    while( level ){
+        c = m_input.read();
+        if( c < 0 ){ return fail(EINVAL); }
+        switch(c){
+        case '"':
+            do {
+                c = m_input.read();
+                if( c == '\\' ){ c = m_input.read(); if( c >= 0 ){ c = 0; } }
+            } while( (c >= 0) && (c != '"') );
+            if( c < 0 ){ return fail(EINVAL); }
+            break;
+        case '{':
+        case '[':
+            level++;
+            break;
+        case '}':
+        case ']':
+            level--;
+            break;
+        }
+    }
+
+    m_depth--;
+    m_path_length = m_path_offset[m_depth+1];
+    m_path.cdata()[m_path_length] = 0;
+    return after_value();
+}
+
+s32 JsonReader::to_integer() const {
+    s32 value;
+    if( StringUtil::parse_int(m_token.cdata_const(), value) < 0 ){
+        return 0;
+    }
+    return value;
+}
+
+float JsonReader::to_float() const {
+    float value;
+    if( StringUtil::parse_float(m_token.cdata_const(), value) < 0 ){
+        return 0.0f;
+    }
+    return value;
+}
+
+bool JsonReader::is_path_match(const char * filter, const char * path, bool is_prefix){
+    for(;;){
+        if( *path == 0 ){
+            return is_prefix || (*filter == 0);
+        }
+        if( (*filter != '/') || (*path != '/') ){
+            return false;
+        }
+        filter++;
+        path++;
+
+        u32 filter_length = 0;
+        u32 path_length = 0;
+        while( filter[filter_length] && (filter[filter_length] != '/') ){ filter_length++; }
+        while( path[path_length] && (path[path_length] != '/') ){ path_length++; }
+
+        bool is_wildcard = (filter_length == 1) && (filter[0] == '*');
+        if( !is_wildcard && ((filter_length != path_length) || memcmp(filter, path, path_length)) ){
+            return false;
+        }
+        filter += filter_length;
+        path += path_length;
+    }
+}
+
+bool JsonReader::is_filter_match(bool is_prefix) const {
+    for(u32 i=0; i < m_filter_count; i++){
+        if( is_path_match(m_filter[i].str(), m_path.cdata_const(), is_prefix) ){
+            return true;
+        }
+    }
+    return false;
+}
+
+int JsonReader::next_event(){
+    int c;
+
+    if( (m_token.cdata() == 0) || (m_path.cdata() == 0) ){
+        return fail(ENOMEM);
+    }
+
+    for(;;){
+        c = skip_whitespace();
+
+        switch(m_state){
+        case STATE_VALUE_OR_END:
+            if( c == ']' ){
+                m_input.read();
+                return close_container(END_ARRAY);
+            }
+            //fall through
+        case STATE_VALUE:
+            if( m_depth == 0 ){
+                if( c < 0 ){
+                    //end of the input between top level values
+                    m_token_size = 0;
+                    m_token.cdata()[0] = 0;
+                    return m_input.load_error() ? fail(m_input.load_error()) : END;
+                }
+                m_path_length = 0;
+                m_path.cdata()[0] = 0;
+            } else if( !is_in_object() && (set_path_index() < 0) ){
+                return ERROR;
+            }
+            return parse_value(c);
+
+        case STATE_KEY_OR_END:
+            if( c == '}' ){
+                m_input.read();
+                return close_container(END_OBJECT);
+            }
+            //fall through
+        case STATE_KEY:
+            if( c != '"' ){ return fail(EINVAL); }
+            m_input.read();
+            if( (parse_string() < 0) || (set_path_key() < 0) ){
+                return ERROR;
+            }
+            m_state = STATE_COLON;
+            return KEY;
+
+        case STATE_COLON:
+            if( c != ':' ){ return fail(EINVAL); }
+            m_input.read();
+            m_state = STATE_VALUE;
+            break;
+
+        case STATE_COMMA_OR_END:
+            if( c == ',' ){
+                m_input.read();
+                m_state = is_in_object() ? STATE_KEY : STATE_VALUE;
+                break;
+            }
+            if( is_in_object() ){
+                if( c == '}' ){
+                    m_input.read();
+                    return close_container(END_OBJECT);
+                }
+            } else if( c == ']' ){
+                m_input.read();
+                return close_container(END_ARRAY);
+            }
+            return fail(EINVAL);
+
+        default:
+            return fail(EINVAL);
+        }
+    }
+}
+
+int JsonReader::fail(int error_number){
+    m_event = ERROR;
+    set_error_number(m_input.load_error() ? m_input.load_error() : error_number);
+    return ERROR;
+}
+
+int JsonReader::skip_whitespace(){
+    int c;
+    while( ((c = m_input.peek()) == ' ') || (c == '\n') || (c == '\r') || (c == '\t') ){
+        m_input.read();
+    }
+    return c;
+}
+
+int JsonReader::parse_value(int c){
+    switch(c){
+    case '{':
+        m_input.read();
+        return open_container(OBJECT);
+    case '[':
+        m_input.read();
+        return open_container(ARRAY);
+    case '"':
+        m_input.read();
+        if( parse_string() < 0 ){ return ERROR; }
+        after_value();
+        return STRING;
+    case 't':
+        return parse_literal("true", TRUE);
+    case 'f':
+        return parse_literal("false", FALSE);
+    case 'n':
+        return parse_literal("null", ZERO);
+    }
+    if( (c == '-') || is_digit(c) ){
+        return parse_number(c);
+    }
+    return fail(EINVAL);
+}
+
+int JsonReader::parse_string(){
+    char * token = m_token.cdata();
+    u32 max_size = m_token.size() - 1;
+    int c;
+
+    m_token_size = 0;
+
+    for(;;){
+        u32 count = m_input.available();
+        if( count == 0 ){
+            return fail(EINVAL);
+        }
+
+        //copy the characters that don't need any processing in one chunk
+        const char * start = m_input.data();
+        u32 i;
+        for(i=0; i < count; i++){
+            u8 value = start[i];
+            if( (value == '"') || (value == '\\') || (value < 0x20) ){
+                break;
+            }
+        }
+        if( m_token_size + i > max_size ){
+            return fail(ENOSPC);
+        }
+        memcpy(token + m_token_size, start, i);
+        m_token_size += i;
+        m_input.consume(i);
+
+        if( i == count ){
+            continue;
+        }
+
+        c = m_input.read();
+        if( c == '"' ){
+            token[m_token_size] = 0;
+            return 0;
+        }
+
+        if( c != '\\' ){
+            //control characters must be escaped
+            return fail(EINVAL);
+        }
+
+        c = m_input.read();
+        switch(c){
+        case '"':
+        case '\\':
+        case '/':
+            break;
+        case 'b': c = '\b'; break;
+        case 'f': c = '\f'; break;
+        case 'n': c = '\n'; break;
+        case 'r': c = '\r'; break;
+        case 't': c = '\t'; break;
+        case 'u': {
+            u32 code = 0;
+            for(u32 j=0; j < 4; j++){
+                int h = hex_value(m_input.read());
+                if( h < 0 ){ return fail(EINVAL); }
+                code = (code << 4) | h;
+            }
+            if( (code >= 0xdc00) && (code <= 0xdfff) ){
+                return fail(EINVAL);
+            }
+            if( (code >= 0xd800) && (code <= 0xdbff) ){
+                //a surrogate pair is needed for code points above 0xffff
+                u32 low = 0;
+                if( (m_input.read() != '\\') || (m_input.read() != 'u') ){ return fail(EINVAL); }
+                for(u32 j=0; j < 4; j++){
+                    int h = hex_value(m_input.read());
+                    if( h < 0 ){ return fail(EINVAL); }
+                    low = (low << 4) | h;
+                }
+                if( (low < 0xdc00) || (low > 0xdfff) ){ return fail(EINVAL); }
+                code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+            }
+            if( push_utf8(code) < 0 ){ return ERROR; }
+            continue;
+        }
+        default:
+            return fail(EINVAL);
+        }
+
+        if( push_token(c) < 0 ){ return ERROR; }
+    }
+}
+
+int JsonReader::parse_number(int c){
+    m_token_size = 0;
+    while( is_digit(c) || (c == '-') || (c == '+') || (c == '.') || (c == 'e') || (c == 'E') ){
+        if( push_token(c) < 0 ){ return ERROR; }
+        m_input.read();
+        c = m_input.peek();
+    }
+    m_token.cdata()[m_token_size] = 0;
+    if( !is_number(m_token.cdata_const()) ){
+        return fail(EINVAL);
+    }
+    after_value();
+    return NUMBER;
+}
+
+int JsonReader::parse_literal(const char * literal, int event){
+    u32 length = strlen(literal);
+    for(u32 i=0; i < length; i++){
+        if( m_input.read() != literal[i] ){
+            return fail(EINVAL);
+        }
+    }
+    if( length > m_token.size() - 1 ){
+        return fail(ENOSPC);
+    }
+    memcpy(m_token.cdata(), literal, length+1);
+    m_token_size = length;
+    after_value();
+    return event;
+}
+
+int JsonReader::push_token(char c){
+    if( m_token_size == m_token.size() - 1 ){
+        return fail(ENOSPC);
+    }
+    m_token.cdata()[m_token_size++] = c;
+    return 0;
+}
+
+int JsonReader::push_utf8(u32 code){
+    char utf8[4];
+    u32 length = ReaderInput::encode_utf8(utf8, code);
+    if( m_token_size + length > m_token.size() - 1 ){
+        return fail(ENOSPC);
+    }
+    memcpy(m_token.cdata() + m_token_size, utf8, length);
+    m_token_size += length;
+    return 0;
+}
+
+int JsonReader::open_container(int event){
+    if( m_depth == MAX_DEPTH ){
+        return fail(EINVAL);
+    }
+    m_depth++;
+    u32 level = (u32)1 << m_depth;
+    if( event == OBJECT ){
+        m_is_object |= level;
+        m_state = STATE_KEY_OR_END;
+    } else {
+        m_is_object &= ~level;
+        m_state = STATE_VALUE_OR_END;
+    }
+    m_index[m_depth] = 0;
+    m_path_offset[m_depth] = m_path_length;
+    m_token_size = 0;
+    m_token.cdata()[0] = 0;
+    return event;
+}
+
+int JsonReader::close_container(int event){
+    m_depth--;
+    //the path goes back to the path of the object or array
+    m_path_length = m_path_offset[m_depth+1];
+    m_path.cdata()[m_path_length] = 0;
+    m_token_size = 0;
+    m_token.cdata()[0] = 0;
+    after_value();
+    return event;
+}
+
+int JsonReader::after_value(){
+    m_state = m_depth ? STATE_COMMA_OR_END : STATE_VALUE;
+    return 0;
+}
+
+int JsonReader::set_path_key(){
+    m_path_length = m_path_offset[m_depth];
+    return append_path(m_token.cdata_const(), m_token_size);
+}
+
+int JsonReader::set_path_index(){
+    char index[StringUtil::BUF_SIZE];
+    u32 length = StringUtil::utoa(index, m_index[m_depth]++);
+    m_path_length = m_path_offset[m_depth];
+    return append_path(index, length);
+}
+
+int JsonReader::append_path(const char * segment, u32 length){
+    if( m_path_length + 1 + length > MAX_PATH_SIZE ){
+        return fail(ENOSPC);
+    }
+    char * path = m_path.cdata();
+    path[m_path_length] = '/';
+    memcpy(path + m_path_length + 1, segment, length);
+    m_path_length += length + 1;
+    path[m_path_length] = 0;
+    return 0;
+}
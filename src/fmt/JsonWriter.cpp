@@ -0,0 +1,341 @@
+//Copyright 2011-2018 Tyler Gilbert; All Rights Reserved
+
+#include <errno.h>
+#include <cstring>
+#include "fmt/JsonWriter.hpp"
+#include "var/StringUtil.hpp"
+#include "sys/File.hpp"
+
+using namespace fmt;
+using namespace var;
+
+JsonWriter::JsonWriter(const sys::File & file){
+    init();
+    m_file = &file;
+}
+
+JsonWriter::JsonWriter(Data & data){
+    init();
+    m_data = &data;
+    m_data->set_size(0);
+}
+
+JsonWriter::~JsonWriter(){
+    flush();
+}
+
+void JsonWriter::init(){
+    m_file = 0;
+    m_data = 0;
+    m_flushed_size = 0;
+    m_buffer_size = 0;
+    m_is_object = 0;
+    m_is_empty = 1;
+    m_depth = 0;
+    m_is_key_written = false;
+    m_is_failed = false;
+}
+
+int JsonWriter::open_object(){
+    return open_container('{', true);
+}
+
+int JsonWriter::close_object(){
+    return close_container('}', true);
+}
+
+int JsonWriter::open_array(){
+    return open_container('[', false);
+}
+
+int JsonWriter::close_array(){
+    return close_container(']', false);
+}
+
+int JsonWriter::write_key(const ConstString & key){
+    if( m_is_failed ){ return -1; }
+    if( !is_in_object() || m_is_key_written ){
+        set_error_number(EINVAL);
+        return -1;
+    }
+    if( write_separator() < 0 ){ return -1; }
+    if( write_quoted(key.str(), key.length()) < 0 ){ return -1; }
+    if( write_raw(":", 1) < 0 ){ return -1; }
+    m_is_key_written = true;
+    return 0;
+}
+
+int JsonWriter::write_string(const ConstString & value){
+    if( start_value() < 0 ){ return -1; }
+    return write_quoted(value.str(), value.length());
+}
+
+int JsonWriter::write_float(float value){
+    if( (value != value) || (value - value != 0.0f) ){
+        //NaN or infinity
+        return write_null();
+    }
+    if( start_value() < 0 ){ return -1; }
+    char * p = reserve(StringUtil::BUF_SIZE);
+    if( p == 0 ){ return -1; }
+    m_buffer_size += StringUtil::ftoa(p, value);
+    return 0;
+}
+
+int JsonWriter::write_fixed(s64 value, u32 decimal_places){
+    u64 magnitude = value < 0 ? -(u64)value : (u64)value;
+    u64 scale = 1;
+    u64 fraction;
+    u32 length = 0;
+
+    if( decimal_places > 18 ){
+        decimal_places = 18;
+    }
+    for(u32 i=0; i < decimal_places; i++){
+        scale *= 10;
+    }
+
+    if( start_value() < 0 ){ return -1; }
+    char * p = reserve(StringUtil::BUF_SIZE + 20);
+    if( p == 0 ){ return -1; }
+
+    if( value < 0 ){
+        p[length++] = '-';
+    }
+    length += StringUtil::ulltoa(p + length, magnitude / scale);
+    if( decimal_places ){
+        fraction = magnitude % scale;
+        p[length++] = '.';
+        for(u32 i=decimal_places; i > 0; i--){
+            p[length + i - 1] = '0' + fraction % 10;
+            fraction /= 10;
+        }
+        length += decimal_places;
+    }
+    m_buffer_size += length;
+    return 0;
+}
+
+int JsonWriter::write_bool(bool value){
+    if( start_value() < 0 ){ return -1; }
+    return value ? write_raw("true", 4) : write_raw("false", 5);
+}
+
+int JsonWriter::write_null(){
+    if( start_value() < 0 ){ return -1; }
+    return write_raw("null", 4);
+}
+
+int JsonWriter::flush(){
+    if( m_is_failed ){ return -1; }
+    if( m_buffer_size ){
+        u32 size = m_buffer_size;
+        m_buffer_size = 0;
+        return write_destination(m_buffer, size);
+    }
+    return 0;
+}
+
+int JsonWriter::close(){
+    while( m_depth ){
+        int result = is_in_object() ? close_object() : close_array();
+        if( result < 0 ){ return -1; }
+    }
+    return flush();
+}
+
+int JsonWriter::start_value(){
+    if( m_is_failed ){ return -1; }
+    if( is_in_object() ){
+        //the key already wrote the separator
+        if( !m_is_key_written ){
+            set_error_number(EINVAL);
+            return -1;
+        }
+        m_is_key_written = false;
+        return 0;
+    }
+    return write_separator();
+}
+
+int JsonWriter::write_separator(){
+    u32 level = (u32)1 << m_depth;
+    if( m_is_empty & level ){
+        m_is_empty &= ~level;
+        return 0;
+    }
+    //values at the top level go on separate lines
+    return m_depth ? write_raw(",", 1) : write_raw("\n", 1);
+}
+
+int JsonWriter::open_container(char c, bool is_object){
+    if( m_depth == MAX_DEPTH ){
+        set_error_number(EINVAL);
+        return -1;
+    }
+    if( start_value() < 0 ){ return -1; }
+    if( write_raw(&c, 1) < 0 ){ return -1; }
+    m_depth++;
+    u32 level = (u32)1 << m_depth;
+    m_is_empty |= level;
+    if( is_object ){
+        m_is_object |= level;
+    } else {
+        m_is_object &= ~level;
+    }
+    return 0;
+}
+
+int JsonWriter::close_container(char c, bool is_object){
+    if( m_is_failed ){ return -1; }
+    if( (m_depth == 0) || (is_in_object() != is_object) || m_is_key_written ){
+        set_error_number(EINVAL);
+        return -1;
+    }
+    m_depth--;
+    return write_raw(&c, 1);
+}
+
+int JsonWriter::write_signed(s32 value){
+    if( start_value() < 0 ){ return -1; }
+    char * p = reserve(StringUtil::BUF_SIZE);
+    if( p == 0 ){ return -1; }
+    m_buffer_size += StringUtil::itoa(p, value);
+    return 0;
+}
+
+int JsonWriter::write_unsigned(u32 value){
+    if( start_value() < 0 ){ return -1; }
+    char * p = reserve(StringUtil::BUF_SIZE);
+    if( p == 0 ){ return -1; }
+    m_buffer_size += StringUtil::utoa(p, value);
+    return 0;
+}
+
+int JsonWriter::write_signed64(s64 value){
+    if( start_value() < 0 ){ return -1; }
+    char * p = reserve(StringUtil::BUF_SIZE);
+    if( p == 0 ){ return -1; }
+    m_buffer_size += StringUtil::lltoa(p, value);
+    return 0;
+}
+
+int JsonWriter::write_unsigned64(u64 value){
+    if( start_value() < 0 ){ return -1; }
+    char * p = reserve(StringUtil::BUF_SIZE);
+    if( p == 0 ){ return -1; }
+    m_buffer_size += StringUtil::ulltoa(p, value);
+    return 0;
+}
+
+int JsonWriter::write_quoted(const char * str, u32 length){
+    static const char hex[] = "0123456789abcdef";
+    u32 start = 0;
+
+    if( write_raw("\"", 1) < 0 ){ return -1; }
+
+    for(u32 i=0; i < length; i++){
+        u8 c = str[i];
+        if( (c >= 0x20) && (c != '"') && (c != '\\') ){
+            continue;
+        }
+
+        //write the characters that don't need escaping in one chunk
+        if( write_raw(str + start, i - start) < 0 ){ return -1; }
+        start = i+1;
+
+        char * p = reserve(6);
+        if( p == 0 ){ return -1; }
+        p[0] = '\\';
+        switch(c){
+        case '"': p[1] = '"'; break;
+        case '\\': p[1] = '\\'; break;
+        case '\b': p[1] = 'b'; break;
+        case '\f': p[1] = 'f'; break;
+        case '\n': p[1] = 'n'; break;
+        case '\r': p[1] = 'r'; break;
+        case '\t': p[1] = 't'; break;
+        default:
+            p[1] = 'u';
+            p[2] = '0';
+            p[3] = '0';
+            p[4] = hex[c >> 4];
+            p[5] = hex[c & 0x0f];
+            m_buffer_size += 6;
+            continue;
+        }
+        m_buffer_size += 2;
+    }
+
+    if( write_raw(str + start, length - start) < 0 ){ return -1; }
+    return write_raw("\"", 1);
+}
+
+int JsonWriter::write_raw(const char * str, u32 length){
+    if( m_is_failed ){ return -1; }
+
+    if( m_buffer_size + length <= BUFFER_SIZE ){
+        memcpy(m_buffer + m_buffer_size, str, length);
+        m_buffer_size += length;
+        return 0;
+    }
+
+    if( flush() < 0 ){ return -1; }
+
+    if( length >= BUFFER_SIZE ){
+        //large chunks bypass the buffer
+        return write_destination(str, length);
+    }
+
+    memcpy(m_buffer, str, length);
+    m_buffer_size = length;
+    return 0;
+}
+
+char * JsonWriter::reserve(u32 length){
+    if( m_buffer_size + length > BUFFER_SIZE ){
+        if( flush() < 0 ){ return 0; }
+    }
+    return m_buffer + m_buffer_size;
+}
+
+int JsonWriter::write_destination(const char * buffer, u32 length){
+    if( m_file ){
+        while( length ){
+            int result = m_file->write(buffer, length);
+            if( result <= 0 ){
+                m_is_failed = true;
+                if( result == 0 ){ set_error_number(EIO); }
+                else { set_error_number(m_file->error_number()); }
+                return -1;
+            }
+            buffer += result;
+            length -= result;
+            m_flushed_size += result;
+        }
+        return 0;
+    }
+
+    if( m_data ){
+        u32 size = m_flushed_size + length;
+        if( m_data->reserve(size) < 0 ){
+            m_is_failed = true;
+            set_error_number(ENOSPC);
+            return -1;
+        }
+        m_data->set_size(size);
+        if( m_data->data() == 0 ){
+            //read-only memory
+            m_is_failed = true;
+            set_error_number(ENOSPC);
+            return -1;
+        }
+        memcpy((char*)m_data->data() + m_flushed_size, buffer, length);
+        m_flushed_size = size;
+        return 0;
+    }
+
+    m_is_failed = true;
+    set_error_number(EINVAL);
+    return -1;
+}
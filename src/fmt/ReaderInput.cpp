@@ -0,0 +1,128 @@
+//Copyright 2011-2018 Tyler Gilbert; All Rights Reserved
+
+#include <errno.h>
+#include "fmt/ReaderInput.hpp"
+#include "sys/File.hpp"
+
+using namespace fmt;
+
+ReaderInput::ReaderInput(){
+    m_file = 0;
+    m_callback = 0;
+    m_context = 0;
+    m_input = 0;
+    m_input_size = 0;
+    m_input_position = 0;
+    m_is_input_end = false;
+    m_load_error = 0;
+    m_line = 1;
+    m_column = 1;
+    m_position = 0;
+}
+
+void ReaderInput::set_file(const sys::File & file, u32 buffer_size){
+    m_file = &file;
+    m_buffer.set_size(buffer_size);
+}
+
+void ReaderInput::set_data(const var::Data & data){
+    m_input = data.cdata_const();
+    m_input_size = data.size();
+    m_is_input_end = true;
+}
+
+void ReaderInput::set_callback(reader_load_t callback, void * context, u32 buffer_size){
+    m_callback = callback;
+    m_context = context;
+    m_buffer.set_size(buffer_size);
+}
+
+int ReaderInput::read(){
+    int c = peek();
+    if( c >= 0 ){
+        m_input_position++;
+        m_position++;
+        if( c == '\n' ){
+            m_line++;
+            m_column = 1;
+        } else {
+            m_column++;
+        }
+    }
+    return c;
+}
+
+void ReaderInput::consume(u32 count){
+    const char * start = m_input + m_input_position;
+    for(u32 i=0; i < count; i++){
+        if( start[i] == '\n' ){
+            m_line++;
+            m_column = 1;
+        } else {
+            m_column++;
+        }
+    }
+    m_input_position += count;
+    m_position += count;
+}
+
+int ReaderInput::load(){
+    size_t result;
+    char * buffer = m_buffer.cdata();
+
+    if( m_is_input_end ){ return 0; }
+
+    if( buffer == 0 ){
+        m_load_error = ENOMEM;
+        m_is_input_end = true;
+        return -1;
+    }
+
+    if( m_file ){
+        int bytes = m_file->read(buffer, m_buffer.size());
+        result = bytes < 0 ? (size_t)-1 : (size_t)bytes;
+    } else if( m_callback ){
+        result = m_callback(buffer, m_buffer.size(), m_context);
+    } else {
+        result = 0;
+    }
+
+    if( result == (size_t)-1 ){
+        m_load_error = (m_file && m_file->error_number()) ? m_file->error_number() : EIO;
+        m_is_input_end = true;
+        return -1;
+    }
+
+    if( result == 0 ){
+        m_is_input_end = true;
+        return 0;
+    }
+
+    m_input = buffer;
+    m_input_size = result;
+    m_input_position = 0;
+    return result;
+}
+
+u32 ReaderInput::encode_utf8(char * dest, u32 code){
+    if( code < 0x80 ){
+        dest[0] = code;
+        return 1;
+    }
+    if( code < 0x800 ){
+        dest[0] = 0xc0 | (code >> 6);
+        dest[1] = 0x80 | (code & 0x3f);
+        return 2;
+    }
+    if( code < 0x10000 ){
+        dest[0] = 0xe0 | (code >> 12);
+        dest[1] = 0x80 | ((code >> 6) & 0x3f);
+        dest[2] = 0x80 | (code & 0x3f);
+        return 3;
+    }
+    dest[0] = 0xf0 | (code >> 18);
+    dest[1] = 0x80 | ((code >> 12) & 0x3f);
+    dest[2] = 0x80 | ((code >> 6) & 0x3f);
+    dest[3] = 0x80 | (code & 0x3f);
+    return 4;
+}
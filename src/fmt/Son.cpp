@@ -6,6 +6,9 @@
 
 using namespace fmt;
 
+//m_index_size is set to this if the index text can't be stored
+#define INDEX_FAILED 0xffffffff
+
 Son::Son(u16 max_depth, son_stack_t * stack){
 	memset(&m_son, 0, sizeof(m_son));
 	m_stack_size = max_depth;
@@ -16,7 +19,9 @@ Son::Son(u16 max_depth, son_stack_t * stack){
 		m_is_stack_needs_free = false;
 		m_stack = stack;
 	}
-
+	m_is_indexed = false;
+	m_is_index_stale = false;
+	m_index_size = 0;
 }
 
 
@@ -26,3 +31,158 @@ Son::~Son(){
 	}
 }
 
+int Son::create_index(){
+	m_is_indexed = false;
+	m_is_index_stale = false;
+	m_index_size = 0;
+
+	//the JSON text is collected in one buffer and parsed in place
+	if( (to_json(append_index_text, this) < 0) ||
+			(m_index_size == INDEX_FAILED) ||
+			(m_index_text.set_size(m_index_size) < 0) ||
+			(m_index.parse(m_index_text) < 0) ){
+		m_index.clear();
+		m_index_text.free();
+		return -1;
+	}
+
+	m_is_indexed = true;
+	return 0;
+}
+
+int Son::append_index_text(void * context, const char * entry){
+	Son * son = (Son*)context;
+	if( son->m_index_size == INDEX_FAILED ){
+		return -1;
+	}
+
+	u32 length = strlen(entry);
+	u32 size = son->m_index_size + length;
+	if( son->m_index_text.reserve(size) < 0 ){
+		son->m_index_size = INDEX_FAILED;
+		return -1;
+	}
+
+	memcpy(son->m_index_text.cdata() + son->m_index_size, entry, length);
+	son->m_index_size = size;
+	return 0;
+}
+
+JsonView Son::find_index(const char * access){
+	if( !m_is_indexed ){
+		return JsonView();
+	}
+
+	if( m_is_index_stale && (create_index() < 0) ){
+		return JsonView();
+	}
+
+	//access is key.key[index].key -- keys are truncated the same way as in the file
+	JsonView value = m_index.root();
+	char key[SON_KEY_NAME_CAPACITY];
+	const char * p = access;
+	while( *p ){
+		u32 length = 0;
+		while( *p && (*p != '.') && (*p != '[') ){
+			if( length < SON_KEY_NAME_CAPACITY-1 ){
+				key[length++] = *p;
+			}
+			p++;
+		}
+		key[length] = 0;
+
+		if( length ){
+			value = value.at(var::ConstString(key));
+		}
+
+		while( *p == '[' ){
+			u32 index = 0;
+			p++;
+			if( (*p < '0') || (*p > '9') ){
+				return JsonView();
+			}
+			while( (*p >= '0') && (*p <= '9') ){
+				index = index*10 + (*p - '0');
+				p++;
+			}
+			if( *p != ']' ){
+				return JsonView();
+			}
+			p++;
+			value = value.is_array() ? value.at(index) : JsonView();
+		}
+
+		if( !value.is_valid() ){
+			return JsonView();
+		}
+
+		if( *p == '.' ){
+			p++;
+		}
+	}
+
+	return value;
+}
+
+int Son::read_str(const char * access, char * str, son_size_t capacity){
+	JsonView value = find_index(access);
+	if( value.is_string() && capacity ){
+		u32 length = value.string_length();
+		if( length > capacity-1 ){
+			length = capacity-1;
+		}
+		memcpy(str, value.to_const_string().str(), length);
+		str[length] = 0;
+		return length;
+	}
+	return son_api()->read_str(&m_son, access, str, capacity);
+}
+
+int Son::read_str(const char * access, var::String & str){
+	JsonView value = find_index(access);
+	if( value.is_string() ){
+		str.assign(value.to_const_string());
+		return str.length();
+	}
+
+	//first seek and get the size
+	son_size_t size;
+	if( seek(access, size) >= 0 ){
+		str.set_capacity(size+1);
+		return son_api()->read_str(&m_son, access, str.cdata(), str.capacity());
+	}
+	return -1;
+}
+
+s32 Son::read_num(const char * access){
+	JsonView value = find_index(access);
+	if( value.is_integer() ){
+		return value.to_integer();
+	}
+	return son_api()->read_num(&m_son, access);
+}
+
+u32 Son::read_unum(const char * access){
+	JsonView value = find_index(access);
+	if( value.is_integer() && (value.to_integer() >= 0) ){
+		return value.to_integer();
+	}
+	return son_api()->read_unum(&m_son, access);
+}
+
+float Son::read_float(const char * access){
+	//to_json() rounds floats so only integers are read from the index
+	JsonView value = find_index(access);
+	if( value.is_integer() ){
+		return value.to_integer();
+	}
+	return son_api()->read_float(&m_son, access);
+}
+
+bool Son::read_bool(const char * access){
+	JsonView value = find_index(access);
+	if( value.is_true() || value.is_false() ){
+		return value.is_true();
+	}
+	return son_api()->read_bool(&m_son, access);
+}
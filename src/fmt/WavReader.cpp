@@ -0,0 +1,317 @@
+//Copyright 2011-2018 Tyler Gilbert; All Rights Reserved
+
+#include <errno.h>
+#include <cstring>
+#include "fmt/WavReader.hpp"
+
+using namespace fmt;
+using namespace sys;
+
+static u16 load_u16(const u8 * p){ return p[0] | (p[1] << 8); }
+static u32 load_u32(const u8 * p){ return p[0] | (p[1] << 8) | (p[2] << 16) | ((u32)p[3] << 24); }
+
+//each sample is converted to q1.31 (or float) and then to the output type
+static inline void store(s16 & dest, s32 value){ dest = value >> 16; }
+static inline void store(s32 & dest, s32 value){ dest = value; }
+static inline void store(float & dest, s32 value){ dest = value * (1.0f / 2147483648.0f); }
+
+static inline void store_float(s16 & dest, float value){
+    value *= 32768.0f;
+    if( value >= 32767.0f ){
+        dest = 32767;
+    } else if( value <= -32768.0f ){
+        dest = -32768;
+    } else {
+        dest = (s16)value;
+    }
+}
+
+static inline void store_float(s32 & dest, float value){
+    value *= 2147483648.0f;
+    if( value >= 2147483647.0f ){
+        dest = 2147483647;
+    } else if( value <= -2147483648.0f ){
+        dest = -2147483647 - 1;
+    } else {
+        dest = (s32)value;
+    }
+}
+
+static inline void store_float(float & dest, float value){ dest = value; }
+
+template<typename T> static void convert_frames(T * const * channels, u32 offset, const u8 * src, u32 frames, u16 channel_count, u16 bits_per_sample, u16 format){
+    u32 i;
+    u16 j;
+
+    //the format is checked once per block rather than once per sample
+    switch(bits_per_sample){
+    case 8:
+        for(i=offset; i < offset + frames; i++){
+            for(j=0; j < channel_count; j++){
+                store(channels[j][i], (s32)((u32)(src[0] ^ 0x80) << 24));
+                src++;
+            }
+        }
+        break;
+    case 16:
+        for(i=offset; i < offset + frames; i++){
+            for(j=0; j < channel_count; j++){
+                store(channels[j][i], (s32)((u32)load_u16(src) << 16));
+                src += 2;
+            }
+        }
+        break;
+    case 24:
+        for(i=offset; i < offset + frames; i++){
+            for(j=0; j < channel_count; j++){
+                store(channels[j][i], (s32)(((u32)src[0] << 8) | ((u32)src[1] << 16) | ((u32)src[2] << 24)));
+                src += 3;
+            }
+        }
+        break;
+    case 32:
+        if( format == WavReader::FORMAT_FLOAT ){
+            for(i=offset; i < offset + frames; i++){
+                for(j=0; j < channel_count; j++){
+                    u32 bits = load_u32(src);
+                    float value;
+                    memcpy(&value, &bits, sizeof(value));
+                    store_float(channels[j][i], value);
+                    src += 4;
+                }
+            }
+        } else {
+            for(i=offset; i < offset + frames; i++){
+                for(j=0; j < channel_count; j++){
+                    store(channels[j][i], (s32)load_u32(src));
+                    src += 4;
+                }
+            }
+        }
+        break;
+    }
+}
+
+WavReader::WavReader(){
+    m_sample_rate = 0;
+    m_data_offset = 0;
+    m_frame_count = 0;
+    m_frame = 0;
+    m_format = 0;
+    m_channels = 0;
+    m_bits_per_sample = 0;
+    m_block_align = 0;
+}
+
+WavReader::~WavReader(){
+    close();
+}
+
+int WavReader::open(const var::ConstString & path){
+    close();
+    if( m_file.open(path, File::READONLY) < 0 ){
+        set_error_number(m_file.error_number());
+        return -1;
+    }
+    if( parse_header() < 0 ){
+        m_file.close();
+        return -1;
+    }
+    return 0;
+}
+
+int WavReader::close(){
+    m_frame_count = 0;
+    m_frame = 0;
+    return m_file.close();
+}
+
+int WavReader::parse_header(){
+    u8 header[40];
+    u32 location;
+    u32 size;
+    u32 data_size = 0;
+    bool is_format = false;
+    int end;
+
+    end = m_file.seek(0, File::END);
+    if( (end < 0) || (m_file.seek(0) < 0) ){
+        set_error_number(m_file.error_number());
+        return -1;
+    }
+
+    if( (m_file.read(header, 12) != 12) ||
+            memcmp(header, "RIFF", 4) ||
+            memcmp(header + 8, "WAVE", 4) ){
+        set_error_number(EINVAL);
+        return -1;
+    }
+
+    //chunks other than "fmt " and "data" are skipped
+    location = 12;
+    for(;;){
+        if( m_file.read(header, 8) != 8 ){
+            set_error_number(EINVAL);
+            return -1;
+        }
+        size = load_u32(header + 4);
+
+        if( memcmp(header, "fmt ", 4) == 0 ){
+            u32 length = size < sizeof(header) ? size : sizeof(header);
+            if( (size < 16) || (m_file.read(header, length) != (int)length) ){
+                set_error_number(EINVAL);
+                return -1;
+            }
+            m_format = load_u16(header);
+            m_channels = load_u16(header + 2);
+            m_sample_rate = load_u32(header + 4);
+            m_block_align = load_u16(header + 12);
+            m_bits_per_sample = load_u16(header + 14);
+            if( (m_format == FORMAT_EXTENSIBLE) && (length >= 26) ){
+                //the format is the first two bytes of the sub format GUID
+                m_format = load_u16(header + 24);
+            }
+            is_format = true;
+        } else if( memcmp(header, "data", 4) == 0 ){
+            if( is_format == false ){
+                set_error_number(EINVAL);
+                return -1;
+            }
+            m_data_offset = location + 8;
+            data_size = size;
+            break;
+        }
+
+        location += 8 + size + (size & 1);
+        if( m_file.seek(location) != (int)location ){
+            set_error_number(EINVAL);
+            return -1;
+        }
+    }
+
+    if( (m_channels == 0) ||
+            (m_block_align != m_channels * m_bits_per_sample / 8) ||
+            !(((m_format == FORMAT_PCM) &&
+               ((m_bits_per_sample == 8) || (m_bits_per_sample == 16) || (m_bits_per_sample == 24) || (m_bits_per_sample == 32))) ||
+              ((m_format == FORMAT_FLOAT) && (m_bits_per_sample == 32))) ){
+        set_error_number(EINVAL);
+        return -1;
+    }
+
+    //a recording that wasn't closed has a size of zero (or a size that is too big)
+    if( (data_size == 0) || (data_size > (u32)end - m_data_offset) ){
+        data_size = (u32)end - m_data_offset;
+    }
+
+    m_frame_count = data_size / m_block_align;
+    m_frame = 0;
+
+    if( m_buffer.set_size(m_block_align > BUFFER_SIZE ? m_block_align : (u32)BUFFER_SIZE) < 0 ){
+        return -1;
+    }
+
+    return 0;
+}
+
+int WavReader::seek(u32 frame){
+    if( frame > m_frame_count ){
+        set_error_number(EINVAL);
+        return -1;
+    }
+    u32 location = m_data_offset + frame * m_block_align;
+    if( m_file.seek(location) != (int)location ){
+        set_error_number(m_file.error_number());
+        return -1;
+    }
+    m_frame = frame;
+    return 0;
+}
+
+int WavReader::read(void * buffer, u32 frames){
+    if( frames > m_frame_count - m_frame ){
+        frames = m_frame_count - m_frame;
+    }
+    if( frames == 0 ){
+        return 0;
+    }
+
+    int bytes = m_file.read(buffer, frames * m_block_align);
+    if( bytes < 0 ){
+        set_error_number(m_file.error_number());
+        return -1;
+    }
+
+    frames = bytes / m_block_align;
+    m_frame += frames;
+    return frames;
+}
+
+int WavReader::read(s16 * const * channels, u32 frames){ return read_frames(channels, frames); }
+int WavReader::read(s32 * const * channels, u32 frames){ return read_frames(channels, frames); }
+int WavReader::read(float * const * channels, u32 frames){ return read_frames(channels, frames); }
+
+template<typename T> int WavReader::read_frames(T * const * channels, u32 frames){
+    u32 block_frames = m_buffer.size() / m_block_align;
+    u32 total = 0;
+    u8 * buffer = (u8*)m_buffer.data();
+
+    if( buffer == 0 ){
+        set_error_number(EINVAL);
+        return -1;
+    }
+
+    //read one buffer at a time and separate the channels while converting
+    while( total < frames ){
+        u32 count = frames - total;
+        if( count > block_frames ){
+            count = block_frames;
+        }
+
+        int result = read(buffer, count);
+        if( result < 0 ){
+            return -1;
+        }
+        if( result == 0 ){
+            break;
+        }
+
+        convert_frames(channels, total, buffer, result, m_channels, m_bits_per_sample, m_format);
+        total += result;
+    }
+
+    return total;
+}
+
+#if !defined __link
+template<typename T, typename S> int WavReader::read_signals(S * signals, u32 frames){
+    T * channels[MAX_CHANNELS];
+    u16 i;
+    int result;
+
+    if( m_channels > MAX_CHANNELS ){
+        set_error_number(EINVAL);
+        return -1;
+    }
+
+    for(i=0; i < m_channels; i++){
+        if( (signals[i].count() != frames) && (signals[i].resize(frames) < 0) ){
+            return -1;
+        }
+        channels[i] = (T*)signals[i].vector_data();
+    }
+
+    result = read_frames(channels, frames);
+
+    if( (result >= 0) && ((u32)result < frames) ){
+        for(i=0; i < m_channels; i++){
+            signals[i].resize(result);
+        }
+    }
+
+    return result;
+}
+
+int WavReader::read(dsp::SignalQ15 * signals, u32 frames){ return read_signals<s16>(signals, frames); }
+int WavReader::read(dsp::SignalQ31 * signals, u32 frames){ return read_signals<s32>(signals, frames); }
+int WavReader::read(dsp::SignalF32 * signals, u32 frames){ return read_signals<float>(signals, frames); }
+#endif
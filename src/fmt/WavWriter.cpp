@@ -0,0 +1,285 @@
+//Copyright 2011-2018 Tyler Gilbert; All Rights Reserved
+
+#include <errno.h>
+#include <cstring>
+#include "fmt/WavWriter.hpp"
+
+using namespace fmt;
+using namespace sys;
+
+//the RIFF size can't be more than 32 bits
+#define WAV_MAX_DATA_SIZE (0xffffffff - (WavWriter::HEADER_SIZE - 8))
+
+static void save_u16(u8 * p, u16 value){
+    p[0] = value;
+    p[1] = value >> 8;
+}
+
+static void save_u32(u8 * p, u32 value){
+    p[0] = value;
+    p[1] = value >> 8;
+    p[2] = value >> 16;
+    p[3] = value >> 24;
+}
+
+//each sample is converted to q1.31 (or float) and then to the format of the file
+static inline s32 load(s16 value){ return (s32)((u32)value << 16); }
+static inline s32 load(s32 value){ return value; }
+
+static inline s32 load(float value){
+    value *= 2147483648.0f;
+    if( value >= 2147483647.0f ){
+        return 2147483647;
+    } else if( value <= -2147483648.0f ){
+        return -2147483647 - 1;
+    }
+    return (s32)value;
+}
+
+static inline float load_float(s16 value){ return value * (1.0f / 32768.0f); }
+static inline float load_float(s32 value){ return value * (1.0f / 2147483648.0f); }
+static inline float load_float(float value){ return value; }
+
+template<typename T> static void convert_frames(u8 * dest, const T * const * channels, u32 offset, u32 frames, u16 channel_count, u16 bits_per_sample, u16 format){
+    u32 i;
+    u16 j;
+    u32 value;
+
+    switch(bits_per_sample){
+    case 8:
+        for(i=offset; i < offset + frames; i++){
+            for(j=0; j < channel_count; j++){
+                *dest++ = ((u32)load(channels[j][i]) >> 24) ^ 0x80;
+            }
+        }
+        break;
+    case 16:
+        for(i=offset; i < offset + frames; i++){
+            for(j=0; j < channel_count; j++){
+                save_u16(dest, (u32)load(channels[j][i]) >> 16);
+                dest += 2;
+            }
+        }
+        break;
+    case 24:
+        for(i=offset; i < offset + frames; i++){
+            for(j=0; j < channel_count; j++){
+                value = load(channels[j][i]);
+                dest[0] = value >> 8;
+                dest[1] = value >> 16;
+                dest[2] = value >> 24;
+                dest += 3;
+            }
+        }
+        break;
+    case 32:
+        if( format == WavReader::FORMAT_FLOAT ){
+            for(i=offset; i < offset + frames; i++){
+                for(j=0; j < channel_count; j++){
+                    float sample = load_float(channels[j][i]);
+                    memcpy(&value, &sample, sizeof(value));
+                    save_u32(dest, value);
+                    dest += 4;
+                }
+            }
+        } else {
+            for(i=offset; i < offset + frames; i++){
+                for(j=0; j < channel_count; j++){
+                    save_u32(dest, load(channels[j][i]));
+                    dest += 4;
+                }
+            }
+        }
+        break;
+    }
+}
+
+WavWriter::WavWriter(){
+    m_frame_count = 0;
+    m_format = 0;
+    m_channels = 0;
+    m_bits_per_sample = 0;
+    m_block_align = 0;
+}
+
+WavWriter::~WavWriter(){
+    close();
+}
+
+int WavWriter::create(const var::ConstString & path, u32 sample_rate, u16 channels, u16 bits_per_sample, u16 format){
+    u8 header[HEADER_SIZE];
+
+    close();
+
+    if( (channels == 0) ||
+            !(((format == WavReader::FORMAT_PCM) &&
+               ((bits_per_sample == 8) || (bits_per_sample == 16) || (bits_per_sample == 24) || (bits_per_sample == 32))) ||
+              ((format == WavReader::FORMAT_FLOAT) && (bits_per_sample == 32))) ){
+        set_error_number(EINVAL);
+        return -1;
+    }
+
+    m_format = format;
+    m_channels = channels;
+    m_bits_per_sample = bits_per_sample;
+    m_block_align = channels * bits_per_sample / 8;
+    m_frame_count = 0;
+
+    if( m_buffer.set_size(m_block_align > BUFFER_SIZE ? m_block_align : (u32)BUFFER_SIZE) < 0 ){
+        return -1;
+    }
+
+    //the sizes are zero until update_header() is called
+    memcpy(header, "RIFF", 4);
+    save_u32(header + 4, HEADER_SIZE - 8);
+    memcpy(header + 8, "WAVEfmt ", 8);
+    save_u32(header + 16, 16);
+    save_u16(header + 20, format);
+    save_u16(header + 22, channels);
+    save_u32(header + 24, sample_rate);
+    save_u32(header + 28, sample_rate * m_block_align);
+    save_u16(header + 32, m_block_align);
+    save_u16(header + 34, bits_per_sample);
+    memcpy(header + 36, "data", 4);
+    save_u32(header + 40, 0);
+
+    if( m_file.create(path) < 0 ){
+        set_error_number(m_file.error_number());
+        return -1;
+    }
+
+    if( m_file.write(header, HEADER_SIZE) != HEADER_SIZE ){
+        set_error_number(m_file.error_number());
+        m_file.close();
+        return -1;
+    }
+
+    return 0;
+}
+
+int WavWriter::close(){
+    int result = 0;
+    if( m_file.fileno() >= 0 ){
+        result = update_header();
+        if( m_file.close() < 0 ){
+            result = -1;
+        }
+    }
+    return result;
+}
+
+int WavWriter::update_header(){
+    u8 size[4];
+    u32 data_size = m_frame_count * m_block_align;
+    int result = 0;
+
+    save_u32(size, data_size + HEADER_SIZE - 8);
+    if( (m_file.seek(4) != 4) || (m_file.write(size, 4) != 4) ){
+        result = -1;
+    }
+
+    save_u32(size, data_size);
+    if( (m_file.seek(HEADER_SIZE - 4) != HEADER_SIZE - 4) || (m_file.write(size, 4) != 4) ){
+        result = -1;
+    }
+
+    //continue writing at the end of the data
+    if( m_file.seek(HEADER_SIZE + data_size) != (int)(HEADER_SIZE + data_size) ){
+        result = -1;
+    }
+
+    if( result < 0 ){
+        set_error_number(m_file.error_number());
+    }
+    return result;
+}
+
+int WavWriter::write(const void * buffer, u32 frames){
+    if( m_block_align == 0 ){
+        set_error_number(EINVAL);
+        return -1;
+    }
+
+    if( frames > (WAV_MAX_DATA_SIZE - m_frame_count * m_block_align) / m_block_align ){
+        set_error_number(EFBIG);
+        return -1;
+    }
+
+    if( frames == 0 ){
+        return 0;
+    }
+
+    int bytes = m_file.write(buffer, frames * m_block_align);
+    if( bytes < 0 ){
+        set_error_number(m_file.error_number());
+        return -1;
+    }
+
+    frames = bytes / m_block_align;
+    m_frame_count += frames;
+    return frames;
+}
+
+int WavWriter::write(const s16 * const * channels, u32 frames){ return write_frames(channels, frames); }
+int WavWriter::write(const s32 * const * channels, u32 frames){ return write_frames(channels, frames); }
+int WavWriter::write(const float * const * channels, u32 frames){ return write_frames(channels, frames); }
+
+template<typename T> int WavWriter::write_frames(const T * const * channels, u32 frames){
+    u32 block_frames = m_buffer.size() / (m_block_align ? m_block_align : 1);
+    u32 total = 0;
+    u8 * buffer = (u8*)m_buffer.data();
+
+    if( buffer == 0 ){
+        set_error_number(EINVAL);
+        return -1;
+    }
+
+    //convert one buffer at a time so there is one write per block
+    while( total < frames ){
+        u32 count = frames - total;
+        if( count > block_frames ){
+            count = block_frames;
+        }
+
+        convert_frames(buffer, channels, total, count, m_channels, m_bits_per_sample, m_format);
+
+        int result = write(buffer, count);
+        if( result < 0 ){
+            return -1;
+        }
+        total += result;
+        if( (u32)result < count ){
+            break;
+        }
+    }
+
+    return total;
+}
+
+#if !defined __link
+template<typename T, typename S> int WavWriter::write_signals(const S * signals){
+    const T * channels[WavReader::MAX_CHANNELS];
+    u32 frames;
+    u16 i;
+
+    if( (m_channels == 0) || (m_channels > WavReader::MAX_CHANNELS) ){
+        set_error_number(EINVAL);
+        return -1;
+    }
+
+    frames = signals[0].count();
+    for(i=0; i < m_channels; i++){
+        if( signals[i].count() != frames ){
+            set_error_number(EINVAL);
+            return -1;
+        }
+        channels[i] = (const T*)signals[i].vector_data_const();
+    }
+
+    return write_frames(channels, frames);
+}
+
+int WavWriter::write(const dsp::SignalQ15 * signals){ return write_signals<s16>(signals); }
+int WavWriter::write(const dsp::SignalQ31 * signals){ return write_signals<s32>(signals); }
+int WavWriter::write(const dsp::SignalF32 * signals){ return write_signals<float>(signals); }
+#endif
@@ -0,0 +1,538 @@
+//Copyright 2011-2018 Tyler Gilbert; All Rights Reserved
+
+#include <errno.h>
+#include <cstring>
+#include "fmt/XmlIndex.hpp"
+#include "sys/File.hpp"
+
+using namespace fmt;
+using namespace var;
+
+static const u32 NONE = 0xffffffff;
+
+XmlIndex::XmlIndex(){
+    m_count = 0;
+    m_string_size = 0;
+    m_name_count = 0;
+    m_root_count = 0;
+    m_error_position = 0;
+}
+
+int XmlIndex::load(const ConstString & path){
+    sys::File file;
+    if( file.open(path, sys::File::RDONLY) < 0 ){
+        set_error_number(file.error_number());
+        return -1;
+    }
+    int result = load(file);
+    file.close();
+    return result;
+}
+
+int XmlIndex::load(const sys::File & file){
+    XmlReader reader(file);
+    return parse(reader);
+}
+
+int XmlIndex::parse(const ConstString & xml){
+    Data data((void*)xml.str(), xml.length(), true);
+    XmlReader reader(data);
+    return parse(reader);
+}
+
+void XmlIndex::clear(){
+    m_elements.free();
+    m_children.free();
+    m_strings.free();
+    m_names.free();
+    m_name_table.free();
+    m_count = 0;
+    m_string_size = 0;
+    m_name_count = 0;
+    m_root_count = 0;
+}
+
+int XmlIndex::parse(XmlReader & reader){
+    u32 open[XmlReader::MAX_DEPTH+1]; //the open element at each depth
+    u32 last[XmlReader::MAX_DEPTH+2]; //the last child started at each depth
+    u32 last_text = NONE; //the element whose text is at the end of the string pool
+    int event;
+    s32 name;
+
+    clear();
+    m_error_position = 0;
+    last[1] = NONE;
+
+    while( (event = reader.next()) > XmlReader::END ){
+        u32 depth = reader.depth();
+        xml_index_element_t * element;
+
+        switch(event){
+        case XmlReader::START_ELEMENT:
+            name = add_name(reader.name().str(), reader.name().length());
+            if( (name < 0) || (append_element() < 0) ){
+                clear();
+                return -1;
+            }
+            element = elements() + m_count - 1;
+            element->name = name;
+            element->text = NONE;
+            element->parent = depth > 1 ? open[depth-1] : NONE;
+            element->offset = reader.tag_position();
+            if( last[depth] != NONE ){
+                elements()[last[depth]].next_sibling = m_count - 1;
+            } else if( depth > 1 ){
+                elements()[open[depth-1]].first_child = m_count - 1;
+            }
+            open[depth] = m_count - 1;
+            last[depth] = m_count - 1;
+            last[depth+1] = NONE;
+            last_text = NONE;
+            break;
+
+        case XmlReader::ATTRIBUTE:
+            element = elements() + open[depth];
+            if( element->attribute_count == 0 ){
+                element->attributes = m_string_size;
+            }
+            //attributes are added before anything else so they are next to each other
+            if( (append_string(reader.name().str(), reader.name().length()) < 0) ||
+                    (append_string(reader.value().str(), reader.value_length()) < 0) ){
+                clear();
+                return -1;
+            }
+            elements()[open[depth]].attribute_count++;
+            break;
+
+        case XmlReader::TEXT:
+            element = elements() + open[depth];
+            if( element->text == NONE ){
+                element->text = m_string_size;
+            } else if( last_text == open[depth] ){
+                //join the text to the text before it
+                m_string_size--;
+            } else {
+                //text after a child element: move the text to the end of the pool
+                u32 length = strlen(string(element->text));
+                if( reserve_strings(length) < 0 ){
+                    clear();
+                    return -1;
+                }
+                element = elements() + open[depth];
+                memcpy(m_strings.cdata() + m_string_size, string(element->text), length);
+                element->text = m_string_size;
+                m_string_size += length;
+            }
+            if( append_string(reader.value().str(), reader.value_length()) < 0 ){
+                clear();
+                return -1;
+            }
+            last_text = open[depth];
+            break;
+
+        case XmlReader::END_ELEMENT:
+            element = elements() + open[depth];
+            element->size = reader.position() - element->offset;
+            break;
+        }
+    }
+
+    if( event == XmlReader::ERROR ){
+        clear();
+        m_error_position = reader.position();
+        set_error_number(reader.error_number());
+        return -1;
+    }
+
+    if( build_children() < 0 ){
+        clear();
+        return -1;
+    }
+
+    return 0;
+}
+
+s32 XmlIndex::find(const ConstString & key, s32 element) const {
+    const char * attribute;
+    return find_element(key.str(), element, &attribute);
+}
+
+int XmlIndex::get_value(String & dest, const ConstString & key, s32 element) const {
+    const char * attribute;
+    s32 result = find_element(key.str(), element, &attribute);
+
+    if( result < 0 ){
+        return -1;
+    }
+
+    if( attribute ){
+        const char * end = strchr(attribute, ')');
+        u32 length = end ? end - attribute : strlen(attribute);
+        const xml_index_element_t * e = elements() + result;
+        const char * name = string(e->attributes);
+        for(u32 i=0; i < e->attribute_count; i++){
+            const char * value = name + strlen(name) + 1;
+            if( (strncmp(name, attribute, length) == 0) && (name[length] == 0) ){
+                dest.assign(value);
+                return 0;
+            }
+            name = value + strlen(value) + 1;
+        }
+        set_error_number(ENOENT);
+        return -1;
+    }
+
+    dest.assign(text(result));
+    return 0;
+}
+
+ConstString XmlIndex::name(u32 element) const {
+    if( element >= m_count ){
+        return ConstString();
+    }
+    u32 offset = ((const u32*)m_names.data_const())[elements()[element].name];
+    return ConstString(string(offset));
+}
+
+ConstString XmlIndex::text(u32 element) const {
+    if( (element >= m_count) || (elements()[element].text == NONE) ){
+        return ConstString();
+    }
+    return ConstString(string(elements()[element].text));
+}
+
+u32 XmlIndex::attribute_count(u32 element) const {
+    if( element >= m_count ){
+        return 0;
+    }
+    return elements()[element].attribute_count;
+}
+
+ConstString XmlIndex::attribute(u32 element, const ConstString & name) const {
+    if( element >= m_count ){
+        return ConstString();
+    }
+    const xml_index_element_t * e = elements() + element;
+    const char * attribute = string(e->attributes);
+    for(u32 i=0; i < e->attribute_count; i++){
+        const char * value = attribute + strlen(attribute) + 1;
+        if( strcmp(attribute, name.str()) == 0 ){
+            return ConstString(value);
+        }
+        attribute = value + strlen(value) + 1;
+    }
+    return ConstString();
+}
+
+s32 XmlIndex::parent(u32 element) const {
+    if( element >= m_count ){
+        return -1;
+    }
+    return (s32)elements()[element].parent;
+}
+
+s32 XmlIndex::first_child(s32 element) const {
+    if( element < 0 ){
+        return m_count ? 0 : -1;
+    }
+    if( (u32)element >= m_count ){
+        return -1;
+    }
+    return (s32)elements()[element].first_child;
+}
+
+s32 XmlIndex::next_sibling(u32 element) const {
+    if( element >= m_count ){
+        return -1;
+    }
+    return (s32)elements()[element].next_sibling;
+}
+
+u32 XmlIndex::child_count(s32 element) const {
+    if( element < 0 ){
+        return m_root_count;
+    }
+    if( (u32)element >= m_count ){
+        return 0;
+    }
+    return elements()[element].child_count;
+}
+
+u32 XmlIndex::offset(u32 element) const {
+    if( element >= m_count ){
+        return 0;
+    }
+    return elements()[element].offset;
+}
+
+u32 XmlIndex::size(u32 element) const {
+    if( element >= m_count ){
+        return 0;
+    }
+    return elements()[element].size;
+}
+
+int XmlIndex::append_element(){
+    if( m_elements.reserve((m_count+1)*sizeof(xml_index_element_t)) < 0 ){
+        set_error_number(ENOMEM);
+        return -1;
+    }
+    xml_index_element_t * element = elements() + m_count;
+    memset(element, 0, sizeof(xml_index_element_t));
+    element->first_child = NONE;
+    element->next_sibling = NONE;
+    m_count++;
+    return 0;
+}
+
+int XmlIndex::reserve_strings(u32 length){
+    if( m_strings.reserve(m_string_size + length) < 0 ){
+        set_error_number(ENOMEM);
+        return -1;
+    }
+    return 0;
+}
+
+int XmlIndex::append_string(const char * value, u32 length){
+    if( reserve_strings(length+1) < 0 ){
+        return -1;
+    }
+    char * strings = m_strings.cdata();
+    memcpy(strings + m_string_size, value, length);
+    strings[m_string_size + length] = 0;
+    m_string_size += length + 1;
+    return 0;
+}
+
+u32 XmlIndex::hash(const char * name, u32 length){
+    //FNV-1a
+    u32 value = 2166136261UL;
+    for(u32 i=0; i < length; i++){
+        value = (value ^ (u8)name[i]) * 16777619UL;
+    }
+    return value;
+}
+
+s32 XmlIndex::find_name(const char * name, u32 length) const {
+    u32 size = m_name_table.size() / sizeof(u32);
+    if( size == 0 ){
+        return -1;
+    }
+    const u32 * table = (const u32*)m_name_table.data_const();
+    const u32 * names = (const u32*)m_names.data_const();
+    u32 slot = hash(name, length) & (size - 1);
+
+    //the table is never full (empty slots are zero, otherwise name id + 1)
+    while( table[slot] ){
+        const char * value = string(names[table[slot]-1]);
+        if( (strncmp(value, name, length) == 0) && (value[length] == 0) ){
+            return table[slot] - 1;
+        }
+        slot = (slot + 1) & (size - 1);
+    }
+    return -1;
+}
+
+s32 XmlIndex::add_name(const char * name, u32 length){
+    s32 id = find_name(name, length);
+    if( id >= 0 ){
+        return id;
+    }
+
+    u32 size = m_name_table.size() / sizeof(u32);
+    if( (m_name_count + 1)*2 > size ){
+        //keep the table at most half full
+        u32 new_size = size ? size*2 : 32;
+        if( (m_name_table.set_size(new_size*sizeof(u32)) < 0) ){
+            set_error_number(ENOMEM);
+            return -1;
+        }
+        u32 * table = (u32*)m_name_table.data();
+        const u32 * names = (const u32*)m_names.data_const();
+        memset(table, 0, new_size*sizeof(u32));
+        for(u32 i=0; i < m_name_count; i++){
+            const char * value = string(names[i]);
+            u32 slot = hash(value, strlen(value)) & (new_size - 1);
+            while( table[slot] ){
+                slot = (slot + 1) & (new_size - 1);
+            }
+            table[slot] = i + 1;
+        }
+        size = new_size;
+    }
+
+    if( m_names.reserve((m_name_count+1)*sizeof(u32)) < 0 ){
+        set_error_number(ENOMEM);
+        return -1;
+    }
+    ((u32*)m_names.data())[m_name_count] = m_string_size;
+    if( append_string(name, length) < 0 ){
+        return -1;
+    }
+
+    u32 * table = (u32*)m_name_table.data();
+    u32 slot = hash(name, length) & (size - 1);
+    while( table[slot] ){
+        slot = (slot + 1) & (size - 1);
+    }
+    table[slot] = m_name_count + 1;
+    return m_name_count++;
+}
+
+int XmlIndex::build_children(){
+    //two stable counting sorts: by name, then by parent -- the children of each
+    //element end up next to each other, sorted by name and then by document order
+    u32 count_size = m_name_count > m_count + 1 ? m_name_count : m_count + 1;
+    Data order_data;
+    Data count_data;
+    u32 i;
+
+    if( m_count == 0 ){
+        return 0;
+    }
+
+    if( (order_data.set_size(m_count*sizeof(u32)) < 0) ||
+            (count_data.set_size(count_size*sizeof(u32)) < 0) ||
+            (m_children.set_size(m_count*sizeof(u32)) < 0) ){
+        set_error_number(ENOMEM);
+        return -1;
+    }
+
+    xml_index_element_t * element = elements();
+    u32 * order = (u32*)order_data.data();
+    u32 * position = (u32*)count_data.data();
+    u32 * children = (u32*)m_children.data();
+    u32 total;
+
+    memset(position, 0, m_name_count*sizeof(u32));
+    for(i=0; i < m_count; i++){
+        position[element[i].name]++;
+    }
+    for(i=0, total=0; i < m_name_count; i++){
+        u32 count = position[i];
+        position[i] = total;
+        total += count;
+    }
+    for(i=0; i < m_count; i++){
+        order[position[element[i].name]++] = i;
+    }
+
+    //the top level elements use slot zero
+    memset(position, 0, (m_count+1)*sizeof(u32));
+    for(i=0; i < m_count; i++){
+        position[element[i].parent + 1]++;
+    }
+    m_root_count = position[0];
+    for(i=0, total=0; i <= m_count; i++){
+        u32 count = position[i];
+        if( i ){
+            element[i-1].child_count = count;
+            element[i-1].children = total;
+        }
+        position[i] = total;
+        total += count;
+    }
+    for(i=0; i < m_count; i++){
+        u32 item = order[i];
+        children[position[element[item].parent + 1]++] = item;
+    }
+
+    return 0;
+}
+
+s32 XmlIndex::find_child(s32 element, u32 name, u32 index) const {
+    const xml_index_element_t * e = elements();
+    const u32 * children = (const u32*)m_children.data_const();
+    u32 start;
+    u32 end;
+
+    if( element < 0 ){
+        start = 0;
+        end = m_root_count;
+    } else {
+        start = e[element].children;
+        end = start + e[element].child_count;
+    }
+
+    //find the first child called name
+    u32 low = start;
+    u32 high = end;
+    while( low < high ){
+        u32 middle = (low + high) / 2;
+        if( e[children[middle]].name < name ){
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    low += index;
+    if( (low < end) && (e[children[low]].name == name) ){
+        return children[low];
+    }
+    return -1;
+}
+
+s32 XmlIndex::find_element(const char * key, s32 element, const char ** attribute) const {
+    *attribute = 0;
+
+    if( key == 0 ){
+        return element;
+    }
+
+    while( *key && (*key != '(') ){
+        u32 length = strcspn(key, ".[(");
+        u32 index = 0;
+        s32 name;
+
+        if( length == 0 ){
+            set_error_number(EINVAL);
+            return -1;
+        }
+
+        name = find_name(key, length);
+        key += length;
+
+        if( *key == '[' ){
+            key++;
+            if( (*key < '0') || (*key > '9') ){
+                set_error_number(EINVAL);
+                return -1;
+            }
+            while( (*key >= '0') && (*key <= '9') ){
+                index = index*10 + (*key - '0');
+                key++;
+            }
+            if( *key != ']' ){
+                set_error_number(EINVAL);
+                return -1;
+            }
+            key++;
+        }
+
+        if( name < 0 ){
+            set_error_number(ENOENT);
+            return -1;
+        }
+
+        element = find_child(element, name, index);
+        if( element < 0 ){
+            set_error_number(ENOENT);
+            return -1;
+        }
+
+        if( *key == '.' ){
+            key++;
+        }
+    }
+
+    if( *key == '(' ){
+        if( element < 0 ){
+            set_error_number(EINVAL);
+            return -1;
+        }
+        *attribute = key + 1;
+    }
+
+    return element;
+}
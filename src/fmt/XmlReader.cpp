@@ -0,0 +1,536 @@
+//Copyright 2011-2018 Tyler Gilbert; All Rights Reserved
+
+#include <errno.h>
+#include <cstring>
+#include "fmt/XmlReader.hpp"
+
+using namespace fmt;
+using namespace var;
+
+static bool is_whitespace(int c){
+    return (c == ' ') || (c == '\n') || (c == '\r') || (c == '\t');
+}
+
+static bool is_name_start(int c){
+    return ((c >= 'a') && (c <= 'z')) ||
+            ((c >= 'A') && (c <= 'Z')) ||
+            (c == '_') || (c == ':') || (c >= 0x80);
+}
+
+static bool is_name(int c){
+    return is_name_start(c) ||
+            ((c >= '0') && (c <= '9')) ||
+            (c == '-') || (c == '.');
+}
+
+XmlReader::XmlReader(const sys::File & file, u32 max_token_size){
+    init(max_token_size);
+    m_input.set_file(file, BUFFER_SIZE);
+}
+
+XmlReader::XmlReader(const Data & data, u32 max_token_size){
+    init(max_token_size);
+    m_input.set_data(data);
+}
+
+XmlReader::XmlReader(reader_load_t callback, void * context, u32 max_token_size){
+    init(max_token_size);
+    m_input.set_callback(callback, context, BUFFER_SIZE);
+}
+
+void XmlReader::init(u32 max_token_size){
+    if( m_name.set_size(MAX_NAME_SIZE+1) == 0 ){
+        m_name.cdata()[0] = 0;
+    }
+    //at least one character and one entity fit in a TEXT event
+    if( max_token_size < 8 ){
+        max_token_size = 8;
+    }
+    m_token_size = 0;
+    if( m_token.set_size(max_token_size+1) == 0 ){
+        m_token.cdata()[0] = 0;
+    }
+    m_path_length = 0;
+    if( m_path.set_size(MAX_PATH_SIZE+1) == 0 ){
+        m_path.cdata()[0] = 0;
+    }
+
+    m_path_offset[0] = 0;
+    m_depth = 0;
+    m_state = STATE_CONTENT;
+    m_bracket_count = 0;
+    m_event = END;
+    m_tag_position = 0;
+}
+
+int XmlReader::next(){
+    if( m_event == ERROR ){ return ERROR; }
+    m_event = next_event();
+    return m_event;
+}
+
+int XmlReader::skip(){
+    u32 depth = m_depth;
+    int event;
+
+    if( (depth == 0) || (m_state == STATE_END_ELEMENT) ){
+        return 0;
+    }
+
+    do {
+        event = next();
+        if( event <= END ){
+            return event == END ? fail(EINVAL) : -1;
+        }
+    } while( (event != END_ELEMENT) || (m_depth != depth) );
+
+    return 0;
+}
+
+int XmlReader::next_event(){
+    int c;
+    int result;
+
+    if( (m_name.cdata() == 0) || (m_token.cdata() == 0) || (m_path.cdata() == 0) ){
+        return fail(ENOMEM);
+    }
+
+    m_token_size = 0;
+    m_token.cdata()[0] = 0;
+
+    switch(m_state){
+    case STATE_END_ELEMENT:
+        //the path stays the same until the event after END_ELEMENT
+        close_element();
+        m_state = STATE_CONTENT;
+        break;
+    case STATE_CDATA:
+        result = parse_cdata();
+        if( result != 0 ){
+            return result;
+        }
+        break;
+    case STATE_ATTRIBUTES:
+        c = skip_whitespace();
+        if( c == '/' ){
+            m_input.read();
+            if( m_input.read() != '>' ){ return fail(EINVAL); }
+            set_element_name();
+            m_state = STATE_END_ELEMENT;
+            return END_ELEMENT;
+        }
+        if( c == '>' ){
+            m_input.read();
+            m_state = STATE_CONTENT;
+            break;
+        }
+        return parse_attribute(c);
+    }
+
+    for(;;){
+        c = m_input.peek();
+        if( c < 0 ){
+            if( m_input.load_error() ){ return fail(m_input.load_error()); }
+            if( m_depth ){ return fail(EINVAL); }
+            return END;
+        }
+
+        if( (c == '<') && (m_state == STATE_CONTENT) ){
+            m_tag_position = m_input.position();
+            m_input.read();
+            result = parse_markup();
+        } else {
+            result = parse_text();
+        }
+
+        if( result != 0 ){
+            return result;
+        }
+    }
+}
+
+int XmlReader::fail(int error_number){
+    m_event = ERROR;
+    set_error_number(m_input.load_error() ? m_input.load_error() : error_number);
+    return ERROR;
+}
+
+int XmlReader::skip_whitespace(){
+    int c;
+    while( is_whitespace(c = m_input.peek()) ){
+        m_input.read();
+    }
+    return c;
+}
+
+int XmlReader::skip_until(const char * terminator){
+    //terminator is at most 3 characters ("?>" or "-->")
+    u32 length = strlen(terminator);
+    char last[4] = {0};
+    int c;
+
+    for(;;){
+        c = m_input.read();
+        if( c < 0 ){ return fail(EINVAL); }
+        memmove(last, last + 1, 2);
+        last[2] = c;
+        if( memcmp(last + 3 - length, terminator, length) == 0 ){
+            return 0;
+        }
+    }
+}
+
+int XmlReader::skip_declaration(){
+    //<!DOCTYPE ...> may have an internal subset in brackets
+    u32 level = 0;
+    int quote = 0;
+    int c;
+
+    for(;;){
+        c = m_input.read();
+        if( c < 0 ){ return fail(EINVAL); }
+        if( quote ){
+            if( c == quote ){ quote = 0; }
+        } else if( (c == '"') || (c == '\'') ){
+            quote = c;
+        } else if( c == '[' ){
+            level++;
+        } else if( (c == ']') && level ){
+            level--;
+        } else if( (c == '>') && (level == 0) ){
+            return 0;
+        }
+    }
+}
+
+int XmlReader::match(const char * text){
+    while( *text ){
+        if( m_input.read() != *text++ ){
+            return fail(EINVAL);
+        }
+    }
+    return 0;
+}
+
+int XmlReader::parse_markup(){
+    int c = m_input.peek();
+
+    switch(c){
+    case '?':
+        return skip_until("?>");
+    case '!':
+        m_input.read();
+        c = m_input.peek();
+        if( c == '-' ){
+            if( match("--") < 0 ){ return ERROR; }
+            return skip_until("-->");
+        }
+        if( c == '[' ){
+            if( match("[CDATA[") < 0 ){ return ERROR; }
+            if( m_depth == 0 ){ return fail(EINVAL); }
+            m_state = STATE_CDATA;
+            m_bracket_count = 0;
+            return parse_cdata();
+        }
+        return skip_declaration();
+    case '/':
+        m_input.read();
+        return parse_end_tag();
+    }
+
+    return parse_start_tag();
+}
+
+int XmlReader::parse_start_tag(){
+    int length = parse_name(m_input.peek());
+    if( length < 0 ){ return ERROR; }
+    if( open_element(length) < 0 ){ return ERROR; }
+    m_state = STATE_ATTRIBUTES;
+    return START_ELEMENT;
+}
+
+int XmlReader::parse_end_tag(){
+    int length = parse_name(m_input.peek());
+    if( length < 0 ){ return ERROR; }
+    if( skip_whitespace() != '>' ){ return fail(EINVAL); }
+    m_input.read();
+
+    //the name must match the element that is open
+    u32 offset = m_path_offset[m_depth] + 1;
+    if( (m_depth == 0) ||
+            ((u32)length != m_path_length - offset) ||
+            memcmp(m_path.cdata_const() + offset, m_name.cdata_const(), length) ){
+        return fail(EINVAL);
+    }
+
+    m_state = STATE_END_ELEMENT;
+    return END_ELEMENT;
+}
+
+int XmlReader::parse_attribute(int c){
+    int quote;
+
+    if( parse_name(c) < 0 ){ return ERROR; }
+    if( skip_whitespace() != '=' ){ return fail(EINVAL); }
+    m_input.read();
+    quote = skip_whitespace();
+    if( (quote != '"') && (quote != '\'') ){ return fail(EINVAL); }
+    m_input.read();
+
+    for(;;){
+        c = m_input.read();
+        if( (c < 0) || (c == '<') ){ return fail(EINVAL); }
+        if( c == quote ){ break; }
+        if( c == '&' ){
+            if( parse_reference() < 0 ){ return ERROR; }
+        } else {
+            //attribute values are normalized (whitespace characters become spaces)
+            if( push_token(is_whitespace(c) ? ' ' : c) < 0 ){
+                return fail(ENOSPC);
+            }
+        }
+    }
+
+    m_token.cdata()[m_token_size] = 0;
+    return ATTRIBUTE;
+}
+
+int XmlReader::parse_text(){
+    char * token = m_token.cdata();
+    u32 max_size = m_token.size() - 1;
+    bool is_continued = m_state == STATE_TEXT;
+    bool is_blank = true;
+    int c;
+
+    m_state = STATE_CONTENT;
+
+    for(;;){
+        //leave room for an entity (up to 4 bytes of UTF-8)
+        if( m_token_size + 4 >= max_size ){
+            if( is_blank && !is_continued && (m_depth == 0) ){
+                //whitespace outside the root element is skipped however long it is
+                m_token_size = 0;
+            } else {
+                m_state = STATE_TEXT;
+                break;
+            }
+        }
+
+        u32 count = m_input.available();
+        if( count == 0 ){
+            break;
+        }
+
+        //copy the characters that don't need any processing in one chunk
+        const char * start = m_input.data();
+        u32 room = max_size - 4 - m_token_size;
+        u32 i;
+        if( count > room ){
+            count = room;
+        }
+        for(i=0; i < count; i++){
+            u8 value = start[i];
+            if( (value == '<') || (value == '&') ){
+                break;
+            }
+            if( is_blank && !is_whitespace(value) ){
+                is_blank = false;
+            }
+        }
+        memcpy(token + m_token_size, start, i);
+        m_token_size += i;
+        m_input.consume(i);
+
+        if( i == count ){
+            continue;
+        }
+
+        c = start[i];
+        if( c == '<' ){
+            break;
+        }
+
+        m_input.read();
+        if( parse_reference() < 0 ){ return ERROR; }
+        is_blank = false;
+    }
+
+    token[m_token_size] = 0;
+
+    if( (m_token_size == 0) || (is_blank && !is_continued && (m_state == STATE_CONTENT)) ){
+        //whitespace between elements is skipped
+        m_token_size = 0;
+        token[0] = 0;
+        return 0;
+    }
+
+    if( m_depth == 0 ){
+        return fail(EINVAL);
+    }
+
+    return TEXT;
+}
+
+int XmlReader::parse_cdata(){
+    u32 max_size = m_token.size() - 1;
+    int c;
+
+    //the text ends at "]]>" -- up to two ']' are held back until the next character is known
+    while( m_token_size + 3 <= max_size ){
+        c = m_input.read();
+        if( c < 0 ){ return fail(EINVAL); }
+        if( c == ']' ){
+            if( m_bracket_count < 2 ){
+                m_bracket_count++;
+            } else {
+                push_token(']');
+            }
+        } else if( (c == '>') && (m_bracket_count == 2) ){
+            m_bracket_count = 0;
+            m_state = STATE_CONTENT;
+            break;
+        } else {
+            while( m_bracket_count ){
+                push_token(']');
+                m_bracket_count--;
+            }
+            push_token(c);
+        }
+    }
+
+    m_token.cdata()[m_token_size] = 0;
+    if( m_token_size == 0 ){
+        //an empty CDATA section
+        return 0;
+    }
+    return TEXT;
+}
+
+int XmlReader::parse_name(int c){
+    char * name = m_name.cdata();
+    u32 length = 0;
+
+    if( !is_name_start(c) ){
+        return fail(EINVAL);
+    }
+
+    do {
+        if( length == MAX_NAME_SIZE ){
+            return fail(ENOSPC);
+        }
+        name[length++] = c;
+        m_input.read();
+        c = m_input.peek();
+    } while( is_name(c) );
+
+    name[length] = 0;
+    return length;
+}
+
+int XmlReader::parse_reference(){
+    char name[12];
+    u32 length = 0;
+    u32 code = 0;
+    int c;
+
+    for(;;){
+        c = m_input.read();
+        if( c < 0 ){ return fail(EINVAL); }
+        if( c == ';' ){ break; }
+        if( length == sizeof(name) - 1 ){ return fail(EINVAL); }
+        name[length++] = c;
+    }
+    name[length] = 0;
+
+    if( name[0] == '#' ){
+        const char * digits = name + 1;
+        u32 base = 10;
+        if( *digits == 'x' ){
+            base = 16;
+            digits++;
+        }
+        if( *digits == 0 ){ return fail(EINVAL); }
+        while( *digits ){
+            int value;
+            c = *digits++;
+            if( (c >= '0') && (c <= '9') ){
+                value = c - '0';
+            } else if( (base == 16) && (c >= 'a') && (c <= 'f') ){
+                value = c - 'a' + 10;
+            } else if( (base == 16) && (c >= 'A') && (c <= 'F') ){
+                value = c - 'A' + 10;
+            } else {
+                return fail(EINVAL);
+            }
+            code = code * base + value;
+            if( code > 0x10ffff ){ return fail(EINVAL); }
+        }
+        if( code == 0 ){ return fail(EINVAL); }
+    } else if( strcmp(name, "lt") == 0 ){
+        code = '<';
+    } else if( strcmp(name, "gt") == 0 ){
+        code = '>';
+    } else if( strcmp(name, "amp") == 0 ){
+        code = '&';
+    } else if( strcmp(name, "quot") == 0 ){
+        code = '"';
+    } else if( strcmp(name, "apos") == 0 ){
+        code = '\'';
+    } else {
+        return fail(EINVAL);
+    }
+
+    if( push_utf8(code) < 0 ){
+        return fail(ENOSPC);
+    }
+    return 0;
+}
+
+int XmlReader::push_token(char c){
+    if( m_token_size == m_token.size() - 1 ){
+        return -1;
+    }
+    m_token.cdata()[m_token_size++] = c;
+    return 0;
+}
+
+int XmlReader::push_utf8(u32 code){
+    char utf8[4];
+    u32 length = ReaderInput::encode_utf8(utf8, code);
+    if( m_token_size + length > m_token.size() - 1 ){
+        return -1;
+    }
+    memcpy(m_token.cdata() + m_token_size, utf8, length);
+    m_token_size += length;
+    return 0;
+}
+
+int XmlReader::open_element(u32 length){
+    if( m_depth == MAX_DEPTH ){
+        return fail(EINVAL);
+    }
+    if( m_path_length + 1 + length > MAX_PATH_SIZE ){
+        return fail(ENOSPC);
+    }
+    m_depth++;
+    m_path_offset[m_depth] = m_path_length;
+    char * path = m_path.cdata();
+    path[m_path_length] = '/';
+    memcpy(path + m_path_length + 1, m_name.cdata_const(), length);
+    m_path_length += length + 1;
+    path[m_path_length] = 0;
+    return 0;
+}
+
+void XmlReader::close_element(){
+    m_path_length = m_path_offset[m_depth];
+    m_path.cdata()[m_path_length] = 0;
+    m_depth--;
+}
+
+void XmlReader::set_element_name(){
+    u32 offset = m_path_offset[m_depth] + 1;
+    u32 length = m_path_length - offset;
+    memcpy(m_name.cdata(), m_path.cdata_const() + offset, length);
+    m_name.cdata()[length] = 0;
+}
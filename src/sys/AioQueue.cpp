@@ -0,0 +1,276 @@
+//Copyright 2011-2018 Tyler Gilbert; All Rights Reserved
+
+#if !defined __win32
+
+#include <cstdlib>
+#include "sys/AioQueue.hpp"
+#if !defined __link
+#include "sys/File.hpp"
+#endif
+
+using namespace sys;
+
+namespace {
+
+enum {
+    ENTRY_FREE,
+    ENTRY_BUSY, //the operation is in progress
+    ENTRY_POSTED //the callback is waiting on the executor
+};
+
+}
+
+#if !defined __link
+int AioBatch::add_read(const File & file, Aio & aio){
+    return add(file.fileno(), aio, LIO_READ);
+}
+
+int AioBatch::add_write(const File & file, Aio & aio){
+    return add(file.fileno(), aio, LIO_WRITE);
+}
+#endif
+
+int AioBatch::add(int fd, Aio & aio, int opcode){
+    if( m_count == MAX_COUNT ){
+        set_error_number(ENOSPC);
+        return -1;
+    }
+    aio.m_aio_var.aio_fildes = fd;
+    aio.m_aio_var.aio_lio_opcode = opcode;
+    m_aios[m_count] = &aio;
+    m_list[m_count] = &aio.m_aio_var;
+    m_count++;
+    return 0;
+}
+
+int AioBatch::submit(){
+    if( m_count == 0 ){
+        return 0;
+    }
+    //link_errno is for the link protocol: lio_listio() uses errno on the desktop
+    if( lio_listio(LIO_NOWAIT, m_list, m_count, 0) < 0 ){
+        set_error_number(errno);
+        return -1;
+    }
+    return 0;
+}
+
+int AioBatch::execute(){
+    if( m_count == 0 ){
+        return 0;
+    }
+    if( lio_listio(LIO_WAIT, m_list, m_count, 0) < 0 ){
+        set_error_number(errno);
+        return -1;
+    }
+    return 0;
+}
+
+bool AioBatch::is_done() const {
+    for(u32 i=0; i < m_count; i++){
+        if( m_aios[i]->is_busy() ){
+            return false;
+        }
+    }
+    return true;
+}
+
+int AioBatch::suspend(int timeout_usec){
+    struct aiocb * list[MAX_COUNT];
+    u32 count;
+
+    do {
+        count = 0;
+        for(u32 i=0; i < m_count; i++){
+            if( m_aios[i]->is_busy() ){
+                list[count++] = m_list[i];
+            }
+        }
+
+        if( count && (Aio::suspend(list, count, timeout_usec) < 0) && (errno != EINTR) ){
+            set_error_number(errno);
+            return -1;
+        }
+    } while( count );
+
+    return 0;
+}
+
+AioQueue::AioQueue(u32 count){
+    m_count = count;
+    m_pending = 0;
+    m_executor = 0;
+    m_entries = (entry_t*)malloc(sizeof(entry_t) * count);
+    m_list = (struct aiocb**)malloc(sizeof(struct aiocb*) * count);
+    if( (m_entries == 0) || (m_list == 0) ){
+        ::free(m_entries);
+        ::free(m_list);
+        m_entries = 0;
+        m_list = 0;
+        m_count = 0;
+        set_error_number(ENOMEM);
+        return;
+    }
+
+    for(u32 i=0; i < count; i++){
+        m_entries[i].queue = this;
+        m_entries[i].state = ENTRY_FREE;
+    }
+}
+
+AioQueue::~AioQueue(){
+    ::free(m_entries);
+    ::free(m_list);
+}
+
+AioQueue::entry_t * AioQueue::add(Aio & aio, callback_t callback, void * context){
+    for(u32 i=0; i < m_count; i++){
+        entry_t * entry = m_entries + i;
+        if( __atomic_load_n(&entry->state, __ATOMIC_ACQUIRE) == ENTRY_FREE ){
+            entry->aio = &aio;
+            entry->callback = callback;
+            entry->context = context;
+            entry->state = ENTRY_BUSY;
+            __atomic_add_fetch(&m_pending, 1, __ATOMIC_RELAXED);
+            return entry;
+        }
+    }
+    return 0;
+}
+
+void AioQueue::complete(entry_t * entry){
+    entry->state = ENTRY_POSTED;
+    if( m_executor && (m_executor->post(execute_callback, entry) == 0) ){
+        return;
+    }
+    //no executor or it is full
+    execute_callback(entry);
+}
+
+void * AioQueue::execute_callback(void * args){
+    entry_t * entry = (entry_t*)args;
+    AioQueue * queue = entry->queue;
+
+    if( entry->callback ){
+        entry->callback(entry->context, *entry->aio);
+    }
+
+    __atomic_store_n(&entry->state, (u32)ENTRY_FREE, __ATOMIC_RELEASE);
+    __atomic_sub_fetch(&queue->m_pending, 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+int AioQueue::start(int fd, Aio & aio, int opcode, callback_t callback, void * context){
+    entry_t * entry = add(aio, callback, context);
+    int result;
+
+    if( entry == 0 ){
+        set_error_number(EAGAIN);
+        return -1;
+    }
+
+    aio.m_aio_var.aio_fildes = fd;
+    if( opcode == LIO_READ ){
+        result = aio_read(&aio.m_aio_var);
+    } else {
+        result = aio_write(&aio.m_aio_var);
+    }
+
+    if( result < 0 ){
+        set_error_number(errno);
+        __atomic_store_n(&entry->state, (u32)ENTRY_FREE, __ATOMIC_RELEASE);
+        __atomic_sub_fetch(&m_pending, 1, __ATOMIC_RELEASE);
+        return -1;
+    }
+    return 0;
+}
+
+#if !defined __link
+int AioQueue::read(const File & file, Aio & aio, callback_t callback, void * context){
+    return start(file.fileno(), aio, LIO_READ, callback, context);
+}
+
+int AioQueue::write(const File & file, Aio & aio, callback_t callback, void * context){
+    return start(file.fileno(), aio, LIO_WRITE, callback, context);
+}
+#endif
+
+int AioQueue::submit(AioBatch & batch, callback_t callback, void * context){
+    entry_t * entries[AioBatch::MAX_COUNT];
+    u32 i;
+
+    if( batch.count() == 0 ){
+        return 0;
+    }
+
+    for(i=0; i < batch.count(); i++){
+        entries[i] = add(batch.at(i), callback, context);
+        if( entries[i] == 0 ){
+            break;
+        }
+    }
+
+    if( (i < batch.count()) || (batch.submit() < 0) ){
+        int error = i < batch.count() ? EAGAIN : batch.error_number();
+        if( error == EIO ){
+            //some of the operations started: the ones that didn't have an error that is passed to the callback
+            set_error_number(error);
+            return -1;
+        }
+        //none of the operations were started
+        while( i > 0 ){
+            i--;
+            __atomic_store_n(&entries[i]->state, (u32)ENTRY_FREE, __ATOMIC_RELEASE);
+            __atomic_sub_fetch(&m_pending, 1, __ATOMIC_RELEASE);
+        }
+        set_error_number(error);
+        return -1;
+    }
+
+    return 0;
+}
+
+int AioQueue::process_completed(){
+    int result = 0;
+    for(u32 i=0; i < m_count; i++){
+        entry_t * entry = m_entries + i;
+        if( (__atomic_load_n(&entry->state, __ATOMIC_ACQUIRE) == ENTRY_BUSY) && entry->aio->is_done() ){
+            complete(entry);
+            result++;
+        }
+    }
+    return result;
+}
+
+int AioQueue::process(int timeout_usec){
+    //read before the entries: the executor can finish the last callback while they are checked
+    u32 pending_count = pending();
+    u32 count = 0;
+
+    for(u32 i=0; i < m_count; i++){
+        if( __atomic_load_n(&m_entries[i].state, __ATOMIC_ACQUIRE) == ENTRY_BUSY ){
+            m_list[count++] = &m_entries[i].aio->m_aio_var;
+        }
+    }
+
+    if( count == 0 ){
+        if( pending_count == 0 ){
+            set_error_number(EINVAL);
+            return -1;
+        }
+        //only callbacks waiting on the executor
+        return 0;
+    }
+
+    if( Aio::suspend(m_list, count, timeout_usec) < 0 ){
+        if( (errno == EAGAIN) || (errno == EINTR) ){
+            return 0;
+        }
+        set_error_number(errno);
+        return -1;
+    }
+
+    return process_completed();
+}
+
+#endif
@@ -0,0 +1,181 @@
+//Copyright 2011-2018 Tyler Gilbert; All Rights Reserved
+
+#if !defined __win32
+
+#include "sys/AioStream.hpp"
+#if !defined __link
+#include "sys/File.hpp"
+#endif
+
+using namespace sys;
+
+AioStream::AioStream(u32 buffer_size, u32 buffer_count){
+    if( buffer_count < 2 ){
+        buffer_count = 2;
+    } else if( buffer_count > MAX_BUFFER_COUNT ){
+        buffer_count = MAX_BUFFER_COUNT;
+    }
+    m_buffer_size = buffer_size;
+    m_buffer_count = buffer_count;
+    m_current = 0;
+    m_active_count = 0;
+    m_fd = -1;
+    m_direction = READ;
+    m_offset = 0;
+    m_is_sequential = false;
+    m_is_stopping = false;
+    m_callback = 0;
+    m_context = 0;
+    if( m_data.alloc(buffer_size * buffer_count) < 0 ){
+        set_error_number(ENOMEM);
+    }
+}
+
+AioStream::~AioStream(){
+    stop();
+}
+
+int AioStream::submit(u32 idx, u32 nbytes){
+    struct aiocb * aiocb = &m_aio[idx].m_aio_var;
+    int result;
+
+    aiocb->aio_fildes = m_fd;
+    aiocb->aio_buf = buffer(idx);
+    aiocb->aio_nbytes = nbytes;
+    aiocb->aio_offset = m_offset;
+
+    if( m_direction == READ ){
+        result = aio_read(aiocb);
+    } else {
+        result = aio_write(aiocb);
+    }
+
+    if( result < 0 ){
+        set_error_number(errno);
+        return -1;
+    }
+
+    if( m_is_sequential ){
+        m_offset += nbytes;
+    }
+    return 0;
+}
+
+#if !defined __link
+int AioStream::start(const File & file, int direction, callback_t callback, void * context, int offset, bool is_sequential){
+    return start(file.fileno(), direction, callback, context, offset, is_sequential);
+}
+#endif
+
+int AioStream::start(int fd, int direction, callback_t callback, void * context, int offset, bool is_sequential){
+    u32 i;
+
+    if( is_running() ){
+        set_error_number(EBUSY);
+        return -1;
+    }
+
+    if( !is_valid() || (callback == 0) ){
+        set_error_number(EINVAL);
+        return -1;
+    }
+
+    m_fd = fd;
+    m_direction = direction;
+    m_callback = callback;
+    m_context = context;
+    m_offset = offset;
+    m_is_sequential = is_sequential;
+    m_is_stopping = false;
+    m_current = 0;
+    clear_error_number();
+
+    for(i=0; i < m_buffer_count; i++){
+        u32 nbytes = m_buffer_size;
+        if( m_direction == WRITE ){
+            int size = m_callback(m_context, buffer(i), m_buffer_size);
+            if( size <= 0 ){
+                m_is_stopping = true;
+                break;
+            }
+            nbytes = (u32)size < m_buffer_size ? size : m_buffer_size;
+        }
+
+        if( submit(i, nbytes) < 0 ){
+            m_is_stopping = true;
+            break;
+        }
+        m_active_count++;
+    }
+
+    if( (m_active_count == 0) && (error_number() != 0) ){
+        return -1;
+    }
+
+    return 0;
+}
+
+int AioStream::update(int timeout_usec){
+    Aio & aio = m_aio[m_current];
+    int result;
+
+    if( !is_running() ){
+        return -1;
+    }
+
+    if( aio.suspend(timeout_usec) < 0 ){
+        if( aio.is_busy() ){
+            //timeout or interrupted
+            return 0;
+        }
+    }
+
+    m_active_count--;
+    result = aio.ret();
+    if( result < 0 ){
+        set_error_number(aio.error());
+        m_is_stopping = true;
+    }
+
+    if( !m_is_stopping ){
+        int nbytes = m_buffer_size;
+
+        if( m_direction == READ ){
+            if( (result == 0) || (m_callback(m_context, buffer(m_current), result) < 0) ){
+                //end of the file or the callback is done
+                m_is_stopping = true;
+            }
+        } else {
+            nbytes = m_callback(m_context, buffer(m_current), m_buffer_size);
+            if( nbytes <= 0 ){
+                m_is_stopping = true;
+            } else if( (u32)nbytes > m_buffer_size ){
+                nbytes = m_buffer_size;
+            }
+        }
+
+        if( !m_is_stopping ){
+            if( submit(m_current, nbytes) < 0 ){
+                m_is_stopping = true;
+            } else {
+                m_active_count++;
+            }
+        }
+    }
+
+    m_current++;
+    if( m_current == m_buffer_count ){
+        m_current = 0;
+    }
+
+    return result;
+}
+
+void AioStream::stop(){
+    m_is_stopping = true;
+    while( is_running() ){
+        update();
+    }
+}
+
+#endif
@@ -0,0 +1,88 @@
+//Copyright 2011-2018 Tyler Gilbert; All Rights Reserved
+
+#if !defined __win32
+
+#include <errno.h>
+#include <sched.h>
+#include "sys/Channel.hpp"
+#include "chrono/Clock.hpp"
+
+using namespace sys;
+
+ChannelObject::ChannelObject(u32 count, u32 cell_size){
+    u32 max_count = 0x80000000;
+
+    //the largest power of two number of cells whose size in bytes fits in a u32
+    while( max_count > (u32)-1 / cell_size ){
+        max_count >>= 1;
+    }
+
+    if( count > max_count ){
+        set_error_number(ENOMEM);
+        m_count = 0;
+    } else {
+        m_count = 1;
+        while( m_count < count ){
+            m_count <<= 1;
+        }
+    }
+    m_enqueue_position = 0;
+    m_dequeue_position = 0;
+    sem_init(&m_free, 0, m_count);
+    sem_init(&m_used, 0, 0);
+}
+
+ChannelObject::~ChannelObject(){
+    sem_destroy(&m_free);
+    sem_destroy(&m_used);
+}
+
+u32 ChannelObject::calc_used() const {
+    u32 dequeue_position = __atomic_load_n(&m_dequeue_position, __ATOMIC_RELAXED);
+    u32 enqueue_position = __atomic_load_n(&m_enqueue_position, __ATOMIC_RELAXED);
+    u32 result = enqueue_position - dequeue_position;
+    if( result > m_count ){
+        //positions were read while another thread was moving them
+        return 0;
+    }
+    return result;
+}
+
+void ChannelObject::yield(){
+    sched_yield();
+}
+
+int ChannelObject::wait(sem_t * sem, int type, const chrono::ClockTime & timeout){
+    int result;
+    if( m_count == 0 ){
+        set_error_number(ENOMEM);
+        return -1;
+    }
+
+    switch(type){
+    case WAIT_TRY:
+        result = sem_trywait(sem);
+        break;
+    case WAIT_TIMED:
+    {
+        //sem_timedwait() uses an absolute time
+        chrono::ClockTime abs_timeout = chrono::Clock::get_time() + timeout;
+        do {
+            result = sem_timedwait(sem, abs_timeout);
+        } while( (result < 0) && (errno == EINTR) );
+    }
+        break;
+    default:
+        do {
+            result = sem_wait(sem);
+        } while( (result < 0) && (errno == EINTR) );
+        break;
+    }
+
+    if( result < 0 ){
+        set_error_number(errno);
+    }
+    return result;
+}
+
+#endif
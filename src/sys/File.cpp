@@ -4,6 +4,7 @@
 #include <cstdio>
 #include <cstring>
 #include "sys/File.hpp"
+#include "sys/TraceRing.hpp"
 #include "chrono/Timer.hpp"
 using namespace sys;
 
@@ -218,21 +219,33 @@ int File::close(){
 }
 
 int File::read(void * buf, int nbyte) const {
+    int result;
 #if defined __link
     if( check_driver() < 0 ){ return -1; }
-    return set_error_number_if_error( link_read(driver(), m_fd, buf, nbyte) );
+#endif
+    SAPI_TRACE_BEGIN(TraceRing::EVENT_FILE_READ, nbyte);
+#if defined __link
+    result = set_error_number_if_error( link_read(driver(), m_fd, buf, nbyte) );
 #else
-    return set_error_number_if_error( ::read(m_fd, buf, nbyte) );
+    result = set_error_number_if_error( ::read(m_fd, buf, nbyte) );
 #endif
+    SAPI_TRACE_END(TraceRing::EVENT_FILE_READ, result);
+    return result;
 }
 
 int File::write(const void * buf, int nbyte) const {
+    int result;
 #if defined __link
     if( check_driver() < 0 ){ return -1; }
-    return set_error_number_if_error( link_write(driver(), m_fd, buf, nbyte) );
+#endif
+    SAPI_TRACE_BEGIN(TraceRing::EVENT_FILE_WRITE, nbyte);
+#if defined __link
+    result = set_error_number_if_error( link_write(driver(), m_fd, buf, nbyte) );
 #else
-    return set_error_number_if_error( ::write(m_fd, buf, nbyte) );
+    result = set_error_number_if_error( ::write(m_fd, buf, nbyte) );
 #endif
+    SAPI_TRACE_END(TraceRing::EVENT_FILE_WRITE, result);
+    return result;
 }
 
 int File::seek(int loc, int whence) const {
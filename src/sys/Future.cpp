@@ -0,0 +1,329 @@
+//Copyright 2011-2018 Tyler Gilbert; All Rights Reserved
+
+#if !defined __win32
+
+#include "sys/Future.hpp"
+#include "chrono/Clock.hpp"
+
+using namespace sys;
+
+namespace {
+
+typedef struct {
+    FutureValue<u32> * target;
+    u32 count;
+    u32 remaining;
+    int error;
+    u32 is_done;
+    bool is_any;
+} future_group_t;
+
+}
+
+FutureState::FutureState(){
+    m_reference_count = 1;
+    m_state = PENDING;
+    m_error = 0;
+    m_continuations = 0;
+    pthread_mutex_init(&m_mutex, 0);
+    pthread_cond_init(&m_cond, 0);
+}
+
+FutureState::~FutureState(){
+    pthread_mutex_destroy(&m_mutex);
+    pthread_cond_destroy(&m_cond);
+}
+
+void FutureState::complete(int error){
+    FutureContinuation * continuation = m_continuations;
+    FutureContinuation * list = 0;
+
+    m_error = error;
+    m_continuations = 0;
+    __atomic_store_n(&m_state, error ? (u32)FAILED : (u32)READY, __ATOMIC_RELEASE);
+    pthread_cond_broadcast(&m_cond);
+    unlock();
+
+    //continuations are added to the front: run them in the order they were added
+    while( continuation ){
+        FutureContinuation * next = continuation->m_next;
+        continuation->m_next = list;
+        list = continuation;
+        continuation = next;
+    }
+
+    while( list ){
+        FutureContinuation * next = list->m_next;
+        list->dispatch();
+        list = next;
+    }
+}
+
+int FutureState::fail(int error){
+    lock();
+    if( !is_pending() ){
+        unlock();
+        return -1;
+    }
+    complete(error ? error : EINVAL);
+    return 0;
+}
+
+int FutureState::wait(const chrono::ClockTime * timeout){
+    chrono::ClockTime abs_timeout;
+    int result = 0;
+
+    if( !is_pending() ){
+        return 0;
+    }
+
+    if( timeout ){
+        //pthread_cond_timedwait() uses an absolute time
+        abs_timeout = chrono::Clock::get_time() + *timeout;
+    }
+
+    lock();
+    while( is_pending() && (result == 0) ){
+        if( timeout ){
+            result = pthread_cond_timedwait(&m_cond, &m_mutex, abs_timeout);
+        } else {
+            result = pthread_cond_wait(&m_cond, &m_mutex);
+        }
+    }
+    unlock();
+
+    if( is_pending() ){
+        errno = result;
+        return -1;
+    }
+    return 0;
+}
+
+void FutureState::add_continuation(FutureContinuation * continuation){
+    lock();
+    if( is_pending() ){
+        continuation->m_next = m_continuations;
+        m_continuations = continuation;
+        unlock();
+        return;
+    }
+    unlock();
+    continuation->dispatch();
+}
+
+FutureContinuation::FutureContinuation(FutureState * source, FutureState * target, invoke_t invoke, callback_t function, void * context, Executor * executor){
+    m_source = source;
+    m_target = target;
+    m_invoke = invoke;
+    m_function = function;
+    m_context = context;
+    m_executor = executor;
+    m_index = 0;
+    m_next = 0;
+    m_source->reference();
+}
+
+FutureContinuation::~FutureContinuation(){
+    m_source->release();
+    if( m_target ){
+        m_target->release();
+    }
+}
+
+void FutureContinuation::dispatch(){
+    if( m_executor && (m_executor->post(execute, this) == 0) ){
+        return;
+    }
+    //no executor or it is full
+    execute(this);
+}
+
+void * FutureContinuation::execute(void * args){
+    FutureContinuation * continuation = (FutureContinuation*)args;
+    continuation->m_invoke(continuation);
+    delete continuation;
+    return 0;
+}
+
+FutureObject::FutureObject(FutureState * shared){
+    m_shared = shared;
+    if( m_shared ){
+        m_shared->reference();
+    }
+}
+
+FutureObject::FutureObject(const FutureObject & a){
+    m_shared = a.m_shared;
+    if( m_shared ){
+        m_shared->reference();
+    }
+}
+
+FutureObject::~FutureObject(){
+    if( m_shared ){
+        m_shared->release();
+    }
+}
+
+FutureObject & FutureObject::operator = (const FutureObject & a){
+    if( a.m_shared ){
+        a.m_shared->reference();
+    }
+    if( m_shared ){
+        m_shared->release();
+    }
+    m_shared = a.m_shared;
+    return *this;
+}
+
+int FutureObject::wait(const chrono::ClockTime * timeout) const {
+    if( m_shared == 0 ){
+        set_error_number(EINVAL);
+        return -1;
+    }
+
+    if( m_shared->wait(timeout) < 0 ){
+        set_error_number(errno);
+        return -1;
+    }
+    return 0;
+}
+
+int FutureObject::get_state() const {
+    if( m_shared == 0 ){
+        set_error_number(EINVAL);
+        return -1;
+    }
+
+    if( m_shared->is_failed() ){
+        set_error_number(m_shared->error());
+        return -1;
+    }
+    return 0;
+}
+
+void FutureObject::add_continuation(FutureState * target, FutureContinuation::invoke_t invoke, FutureContinuation::callback_t function, void * context, Executor * executor) const {
+    FutureContinuation * continuation;
+
+    if( m_shared == 0 ){
+        set_error_number(EINVAL);
+        target->fail(EINVAL);
+        target->release();
+        return;
+    }
+
+    continuation = new (std::nothrow) FutureContinuation(m_shared, target, invoke, function, context, executor);
+    if( continuation == 0 ){
+        set_error_number(ENOMEM);
+        target->fail(ENOMEM);
+        target->release();
+        return;
+    }
+
+    m_shared->add_continuation(continuation);
+}
+
+Future<u32> FutureObject::when_all(const FutureObject * const * futures, u32 count){
+    return when(futures, count, false);
+}
+
+Future<u32> FutureObject::when_any(const FutureObject * const * futures, u32 count){
+    return when(futures, count, true);
+}
+
+static void release_group(future_group_t * group, u32 count){
+    //the last one cleans up
+    if( __atomic_sub_fetch(&group->remaining, count, __ATOMIC_ACQ_REL) == 0 ){
+        if( !group->is_any && (group->is_done == 0) ){
+            if( group->error ){
+                group->target->fail(group->error);
+            } else {
+                group->target->set_value(group->count);
+            }
+        }
+        group->target->release();
+        delete group;
+    }
+}
+
+static void complete_group(future_group_t * group, u32 index, int error){
+    int no_error = 0;
+
+    if( group->is_any ){
+        if( __atomic_exchange_n(&group->is_done, 1, __ATOMIC_ACQ_REL) == 0 ){
+            group->target->set_value(index);
+        }
+    } else if( error ){
+        __atomic_compare_exchange_n(&group->error, &no_error, error, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+    }
+
+    release_group(group, 1);
+}
+
+void FutureObject::invoke_group(FutureContinuation * continuation){
+    complete_group((future_group_t*)continuation->m_context,
+                   continuation->m_index,
+                   continuation->m_source->is_failed() ? continuation->m_source->error() : 0);
+}
+
+Future<u32> FutureObject::when(const FutureObject * const * futures, u32 count, bool is_any){
+    FutureValue<u32> * target = new (std::nothrow) FutureValue<u32>();
+    Future<u32> result(target);
+    future_group_t * group;
+    u32 i;
+
+    if( target == 0 ){
+        return result;
+    }
+
+    for(i=0; i < count; i++){
+        if( futures[i]->m_shared == 0 ){
+            break;
+        }
+    }
+
+    if( (i < count) || (is_any && (count == 0)) ){
+        target->fail(EINVAL);
+        target->release();
+        return result;
+    }
+
+    if( count == 0 ){
+        target->set_value(0);
+        target->release();
+        return result;
+    }
+
+    group = new (std::nothrow) future_group_t;
+    if( group == 0 ){
+        target->fail(ENOMEM);
+        target->release();
+        return result;
+    }
+
+    group->target = target;
+    group->count = count;
+    group->remaining = count;
+    group->error = 0;
+    group->is_done = 0;
+    group->is_any = is_any;
+
+    for(i=0; i < count; i++){
+        FutureContinuation * continuation = new (std::nothrow) FutureContinuation(futures[i]->m_shared, 0, invoke_group, 0, group, 0);
+        if( continuation == 0 ){
+            //fail now (unless when_any already has a result) -- the futures
+            //that aren't attached will never complete the group
+            if( __atomic_exchange_n(&group->is_done, 1, __ATOMIC_ACQ_REL) == 0 ){
+                target->fail(ENOMEM);
+            }
+            release_group(group, count - i);
+            break;
+        }
+        continuation->m_index = i;
+        futures[i]->m_shared->add_continuation(continuation);
+    }
+
+    return result;
+}
+
+#endif
@@ -12,6 +12,7 @@
 
 #include "sys/File.hpp"
 #include "sys/Link.hpp"
+#include "sys/TraceRing.hpp"
 
 using namespace sys;
 
@@ -247,12 +248,14 @@ int Link::read(int fd, void * buf, int nbyte){
     if ( m_is_bootloader ){
         return -1;
     }
+    SAPI_TRACE_BEGIN(TraceRing::EVENT_LINK_READ, nbyte);
     lock_device();
     for(int tries = 0; tries < MAX_TRIES; tries++){
         err =  link_read(m_driver, fd, buf, nbyte);
         if(err != LINK_PROT_ERROR) break;
     }
     unlock_device();
+    SAPI_TRACE_END(TraceRing::EVENT_LINK_READ, err);
     if ( err < 0 ){
         m_error_message.sprintf("Failed to read", link_errno);
     }
@@ -264,6 +267,7 @@ int Link::write(int fd, const void * buf, int nbyte){
     if ( m_is_bootloader ){
         return -1;
     }
+    SAPI_TRACE_BEGIN(TraceRing::EVENT_LINK_WRITE, nbyte);
     lock_device();
     for(int tries = 0; tries < MAX_TRIES; tries++){
         err =  link_write(m_driver, fd, buf, nbyte);
@@ -273,6 +277,7 @@ int Link::write(int fd, const void * buf, int nbyte){
         m_error_message.sprintf("Failed to write", link_errno);
     }
     unlock_device();
+    SAPI_TRACE_END(TraceRing::EVENT_LINK_WRITE, err);
     return check_error(err);
 
 }
@@ -1,6 +1,8 @@
 /* Copyright 2017 tgil All Rights Reserved */
 
+#include <cstring>
 #include "var/String.hpp"
+#include "var/Vector.hpp"
 #include "sys/Timer.hpp"
 #include "sys/Messenger.hpp"
 
@@ -11,21 +13,27 @@ Messenger::Messenger(int stack_size) : m_listener(stack_size){
 	m_write_channel = CHANNEL_DISABLED;
 	m_stop = true;
 	m_is_stopped = true;
+	m_is_message_ready = false;
+	m_buffer_count = 1;
 	m_max_message_size = 512;
 	m_timeout_ms = 50;
+	m_signo = 0;
 }
 
 int Messenger::start(const char * device, int read_channel, int write_channel){
 	MutexAttr attr;
 	int ret;
 
-	if( m_message_data.alloc(m_max_message_size)  < 0 ){
+	if( m_message_data.alloc(m_max_message_size * m_buffer_count)  < 0 ){
 		m_read_channel = CHANNEL_DISABLED;
 		m_write_channel = CHANNEL_DISABLED;
 		return -2;
 	}
 
-	if( m_device.open(device, File::RDWR | File::NONBLOCK) < 0 ){
+	//reading and writing use separate descriptors so they don't share a channel location
+	if( (m_device.open(device, File::RDWR | File::NONBLOCK) < 0) ||
+			(m_write_device.open(device, File::RDWR | File::NONBLOCK) < 0) ){
+		m_device.close();
 		m_read_channel = CHANNEL_DISABLED;
 		m_write_channel = CHANNEL_DISABLED;
 		return -3;
@@ -57,46 +65,99 @@ void *  Messenger::listener_work(void * args){
 	return 0;
 }
 
+#if !defined __link
+void Messenger::handle_signal(int signo, siginfo_t * info, void * context){
+	Messenger * me = (Messenger*)info->si_value.sival_ptr;
+	if( me ){
+		me->m_is_message_ready = true;
+	}
+}
+#endif
+
 void Messenger::listener(){
 	int ret;
-	fmt::Son son;
+	u8 slot = 0;
+	var::Vector<fmt::Son*> messages;
 
 	m_is_stopped = false;
 
+	for(u8 i=0; i < m_buffer_count; i++){
+		messages.push_back(new fmt::Son());
+	}
+
+#if !defined __link
+	//the signal is sent to this thread so it must be created here
+	hal::DeviceSignal signal(true, m_signo, 0, (void*)this);
+	if( m_signo ){
+		signal.set_handler(SignalHandler(handle_signal));
+		m_device.set_signal_action(signal, MCU_EVENT_FLAG_DATA_READY, m_read_channel);
+	}
+#endif
+
 	while( m_stop == false ){
+		fmt::Son & message = *messages.at(slot);
 
-		m_mutex.lock();
-		if( son.open_read_message(m_message_data) < 0 ){
+		m_is_message_ready = false;
+		if( message.open_read_message(m_message_data.cdata() + slot*m_max_message_size, m_max_message_size) < 0 ){
 			ret = -1;
 		} else {
 			m_device.seek(m_read_channel);
-			ret = son.recv_message(m_device.fileno(), m_timeout_ms);
+			ret = message.recv_message(m_device.fileno(), m_timeout_ms);
 		}
-		m_mutex.unlock();
 
 		if( ret >= 0 ){
-			handle_message(son);
-		} else {
+			handle_message(message);
+			slot++;
+			if( slot == m_buffer_count ){
+				slot = 0;
+			}
+		} else if( m_is_message_ready == false ){
+			//a signal from the device interrupts the wait
 			Timer::wait_msec(m_timeout_ms);
 		}
 	}
 
+#if !defined __link
+	if( m_signo ){
+		//stop the device from using signal (it is about to go out of scope)
+		mcu_action_t action;
+		memset(&action, 0, sizeof(action));
+		action.channel = m_read_channel;
+		action.o_events = MCU_EVENT_FLAG_DATA_READY;
+		m_device.ioctl(I_MCU_SETACTION, &action);
+	}
+#endif
+
+	for(u32 i=0; i < messages.count(); i++){
+		delete messages.at(i);
+	}
+
 	m_device.close();
+	m_write_device.close();
 	m_is_stopped = true;
 	m_message_data.free();
 }
 
 
 int Messenger::send_message(fmt::Son & message){
-	int ret = -1;
+	fmt::Son * messages[1] = { &message };
+	return send_messages(messages, 1) == 1 ? 0 : -1;
+}
+
+int Messenger::send_messages(fmt::Son * const * messages, u32 count){
+	u32 sent = 0;
 	if( m_write_channel != CHANNEL_DISABLED ){
 		m_mutex.lock();
-		m_device.seek(m_write_channel);
-		ret = message.send_message(m_device.fileno(), m_timeout_ms);
+		for(sent=0; sent < count; sent++){
+			m_write_device.seek(m_write_channel);
+			if( messages[sent]->send_message(m_write_device.fileno(), m_timeout_ms) < 0 ){
+				break;
+			}
+		}
 		m_mutex.unlock();
 	}
-	return ret;
+	if( (sent == 0) && count ){
+		return -1;
+	}
+	return sent;
 }
-
-
-
@@ -5,6 +5,7 @@
 #include "sys/Sys.hpp"
 #include "sys/Task.hpp"
 #include "sys/Cli.hpp"
+#include "chrono/ProfileZone.hpp"
 #include "var/Data.hpp"
 #include "var/Vector.hpp"
 #include "var/String.hpp"
@@ -177,6 +178,21 @@ Printer & Printer::operator << (const sys::TaskInfo & a){
     return *this;
 }
 
+Printer & Printer::operator << (const chrono::ProfileZone & a){
+    u64 total = a.total();
+    open_object(a.name());
+    print_indented("count", F32U, a.count());
+    print_indented("total (us)", F32U, (u32)(total / 1000));
+    print_indented("min (ns)", F32U, a.min());
+    print_indented("max (ns)", F32U, a.max());
+    print_indented("mean (ns)", F32U, a.mean());
+    print_indented("p50 (ns)", F32U, a.percentile(50));
+    print_indented("p90 (ns)", F32U, a.percentile(90));
+    print_indented("p99 (ns)", F32U, a.percentile(99));
+    close_object();
+    return *this;
+}
+
 Printer & Printer::operator << (const sys::SysInfo & a ){
     print_indented("Name", "%s", a.name().str());
     print_indented("Serial Number", F3208X F3208X F3208X F3208X,
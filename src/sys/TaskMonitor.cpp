@@ -0,0 +1,319 @@
+//Copyright 2011-2018 Tyler Gilbert; All Rights Reserved
+
+#include <cstdlib>
+#include <cstring>
+#include <errno.h>
+#include "sys/TaskMonitor.hpp"
+#include "chrono/Clock.hpp"
+#include "chrono/Timer.hpp"
+#include "fmt/JsonWriter.hpp"
+
+using namespace sys;
+
+TaskMonitor::TaskMonitor(u32 sample_count, u32 task_count, int stack_size) : m_thread(stack_size, false){
+    m_samples = (task_sample_t*)set_error_number_if_null(malloc(sample_count*sizeof(task_sample_t)));
+    m_sample_count = m_samples ? sample_count : 0;
+    m_states = 0;
+    m_task_count = task_count;
+    m_period = chrono::MicroTime::from_milliseconds(100);
+    m_is_running = false;
+    m_is_stopping = false;
+    m_head = 0;
+    m_count = 0;
+    m_dropped = 0;
+    m_start = 0;
+}
+
+TaskMonitor::~TaskMonitor(){
+    stop();
+    free(m_samples);
+    free(m_states);
+}
+
+int TaskMonitor::initialize(){
+    if( m_states != 0 ){
+        return 0;
+    }
+
+    if( m_sample_count == 0 ){
+        set_error_number(m_samples ? EINVAL : ENOMEM);
+        return -1;
+    }
+
+    if( m_task_count == 0 ){
+        m_task.set_id(0);
+        m_task_count = m_task.count_total();
+        if( m_task_count == 0 ){
+            set_error_number(m_task.error_number());
+            return -1;
+        }
+    }
+
+    m_states = (task_state_t*)set_error_number_if_null(calloc(m_task_count, sizeof(task_state_t)));
+    if( m_states == 0 ){
+        return -1;
+    }
+    m_start = chrono::Clock::get_nanoseconds();
+    return 0;
+}
+
+void TaskMonitor::push(const task_sample_t & sample){
+    m_samples[m_head] = sample;
+    m_head = (m_head + 1) % m_sample_count;
+    if( m_count < m_sample_count ){
+        m_count++;
+    } else {
+        m_dropped++;
+    }
+}
+
+int TaskMonitor::sample(){
+    TaskInfo info;
+    task_sample_t sample;
+    u64 total = 0;
+    int count = 0;
+    u32 slot_count = 0;
+
+    m_mutex.lock();
+    if( initialize() < 0 ){
+        m_mutex.unlock();
+        return -1;
+    }
+
+    sample.timestamp = (chrono::Clock::get_nanoseconds() - m_start) / 1000000ULL;
+
+    //read every task first: the CPU share needs the total of the timer changes
+    //(get_next() returns zero for a free slot and less than zero after the last one)
+    m_task.set_id(0);
+    while( m_task.get_next(info) >= 0 ){
+        task_state_t * state;
+
+        slot_count++;
+        if( info.id() >= m_task_count ){
+            continue;
+        }
+
+        state = m_states + info.id();
+        if( !info.is_enabled() ){
+            state->is_enabled = false;
+            continue;
+        }
+
+        if( !state->is_enabled || (state->stats.pid != info.pid()) || (info.timer() < state->timer) ){
+            //a new task is using the slot
+            memset(state, 0, sizeof(task_state_t));
+            strncpy(state->stats.name, info.name(), sizeof(state->stats.name)-1);
+            state->stats.pid = info.pid();
+            state->stats.tid = info.id();
+            state->is_enabled = true;
+        } else {
+            state->delta = info.timer() - state->timer;
+            total += state->delta;
+        }
+
+        state->timer = info.timer();
+        state->stats.heap_size = info.is_thread() ? 0 : info.heap_size();
+        state->stats.stack_size = info.stack_size();
+        if( state->stats.heap_size > state->stats.heap_max ){
+            state->stats.heap_max = state->stats.heap_size;
+        }
+        if( state->stats.stack_size > state->stats.stack_max ){
+            state->stats.stack_max = state->stats.stack_size;
+        }
+    }
+
+    for(u32 i=0; i < m_task_count; i++){
+        task_state_t * state = m_states + i;
+        if( !state->is_enabled ){
+            continue;
+        }
+
+        state->stats.cpu = total ? (u16)(state->delta * 10000 / total) : 0;
+        if( state->stats.sample_count ){
+            state->cpu_total += state->stats.cpu;
+        }
+        state->stats.sample_count++;
+        state->delta = 0;
+        if( state->stats.cpu > state->stats.cpu_max ){
+            state->stats.cpu_max = state->stats.cpu;
+        }
+        if( state->stats.sample_count > 1 ){
+            state->stats.cpu_mean = state->cpu_total / (state->stats.sample_count - 1);
+        }
+
+        sample.pid = state->stats.pid;
+        sample.tid = i;
+        sample.cpu = state->stats.cpu;
+        sample.heap_size = state->stats.heap_size;
+        sample.stack_size = state->stats.stack_size;
+        push(sample);
+        count++;
+    }
+    m_mutex.unlock();
+
+    if( count == 0 ){
+        set_error_number(slot_count ? ENOENT : m_task.error_number());
+        return -1;
+    }
+    return count;
+}
+
+int TaskMonitor::start(const chrono::MicroTime & period, int prio, enum Sched::policy policy){
+    if( is_running() ){
+        set_error_number(EBUSY);
+        return -1;
+    }
+
+    m_period = period;
+    __atomic_store_n(&m_is_stopping, false, __ATOMIC_RELAXED);
+    __atomic_store_n(&m_is_running, true, __ATOMIC_RELEASE);
+    if( m_thread.create(sample_thread, this, prio, policy) < 0 ){
+        __atomic_store_n(&m_is_running, false, __ATOMIC_RELEASE);
+        set_error_number(m_thread.error_number());
+        return -1;
+    }
+    return 0;
+}
+
+int TaskMonitor::stop(){
+    if( !is_running() ){
+        return 0;
+    }
+    __atomic_store_n(&m_is_stopping, true, __ATOMIC_RELEASE);
+    m_thread.join();
+    __atomic_store_n(&m_is_running, false, __ATOMIC_RELEASE);
+    return 0;
+}
+
+void * TaskMonitor::sample_thread(void * args){
+    TaskMonitor * monitor = (TaskMonitor*)args;
+    chrono::Timer timer;
+
+    while( !__atomic_load_n(&monitor->m_is_stopping, __ATOMIC_ACQUIRE) ){
+        timer.restart();
+        monitor->sample();
+
+        //sleep in short steps so stop() doesn't wait for a long period
+        while( (timer.microseconds() < monitor->m_period.microseconds()) &&
+               !__atomic_load_n(&monitor->m_is_stopping, __ATOMIC_ACQUIRE) ){
+            u32 remaining = monitor->m_period.microseconds() - timer.microseconds();
+            chrono::Timer::wait_microseconds(remaining > 10000 ? 10000 : remaining);
+        }
+    }
+    return 0;
+}
+
+void TaskMonitor::calculate_trends(task_stats_t & stats) const {
+    const task_sample_t * first = 0;
+    const task_sample_t * last = 0;
+
+    stats.heap_trend = 0;
+    stats.stack_trend = 0;
+
+    for(u32 i=0; i < m_count; i++){
+        const task_sample_t & sample = at(i);
+        if( (sample.tid == stats.tid) && (sample.pid == stats.pid) ){
+            if( first == 0 ){
+                first = &sample;
+            }
+            last = &sample;
+        }
+    }
+
+    if( first && (last->timestamp > first->timestamp) ){
+        s64 elapsed = last->timestamp - first->timestamp;
+        stats.heap_trend = ((s64)last->heap_size - first->heap_size) * 1000 / elapsed;
+        stats.stack_trend = ((s64)last->stack_size - first->stack_size) * 1000 / elapsed;
+    }
+}
+
+int TaskMonitor::get_stats(u32 tid, task_stats_t & stats){
+    m_mutex.lock();
+    if( (m_states == 0) || (tid >= m_task_count) || !m_states[tid].is_enabled ){
+        m_mutex.unlock();
+        set_error_number(EINVAL);
+        return -1;
+    }
+    stats = m_states[tid].stats;
+    calculate_trends(stats);
+    m_mutex.unlock();
+    return 0;
+}
+
+int TaskMonitor::get_sample(u32 idx, task_sample_t & sample){
+    m_mutex.lock();
+    if( idx >= m_count ){
+        m_mutex.unlock();
+        set_error_number(EINVAL);
+        return -1;
+    }
+    sample = at(idx);
+    m_mutex.unlock();
+    return 0;
+}
+
+void TaskMonitor::clear(){
+    m_mutex.lock();
+    m_head = 0;
+    m_count = 0;
+    m_dropped = 0;
+    if( m_states ){
+        memset(m_states, 0, m_task_count*sizeof(task_state_t));
+    }
+    m_start = chrono::Clock::get_nanoseconds();
+    m_mutex.unlock();
+}
+
+int TaskMonitor::save(fmt::JsonWriter & json){
+    m_mutex.lock();
+    json.open_object();
+    json.write_number("period_us", m_period.microseconds());
+    json.write_number("dropped", m_dropped);
+    json.open_array("tasks");
+    for(u32 i=0; (m_states != 0) && (i < m_task_count); i++){
+        task_stats_t stats;
+
+        if( !m_states[i].is_enabled ){
+            continue;
+        }
+
+        stats = m_states[i].stats;
+        calculate_trends(stats);
+        json.open_object();
+        json.write_string("name", stats.name);
+        json.write_number("pid", stats.pid);
+        json.write_number("tid", stats.tid);
+        json.write_fixed("cpu", stats.cpu, 2);
+        json.write_fixed("cpu_max", stats.cpu_max, 2);
+        json.write_fixed("cpu_mean", stats.cpu_mean, 2);
+        json.write_number("heap", stats.heap_size);
+        json.write_number("heap_max", stats.heap_max);
+        json.write_number("heap_trend", stats.heap_trend);
+        json.write_number("stack", stats.stack_size);
+        json.write_number("stack_max", stats.stack_max);
+        json.write_number("stack_trend", stats.stack_trend);
+
+        json.open_array("samples");
+        for(u32 j=0; j < m_count; j++){
+            const task_sample_t & sample = at(j);
+            if( (sample.tid == stats.tid) && (sample.pid == stats.pid) ){
+                json.open_array();
+                json.write_number(sample.timestamp);
+                json.write_fixed(sample.cpu, 2);
+                json.write_number(sample.heap_size);
+                json.write_number(sample.stack_size);
+                json.close_array();
+            }
+        }
+        json.close_array();
+        json.close_object();
+    }
+    json.close_array();
+    m_mutex.unlock();
+
+    if( json.close_object() < 0 ){
+        set_error_number(json.error_number());
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,549 @@
+//Copyright 2011-2018 Tyler Gilbert; All Rights Reserved
+
+#if !defined __win32
+
+#include <new>
+#include <cstdlib>
+#include <errno.h>
+#if defined __link
+#include <unistd.h>
+#endif
+#include "sys/ThreadPool.hpp"
+
+using namespace sys;
+
+/*
+ * Each worker has a queue that is protected by its own mutex. The
+ * owner pushes and pops at the bottom and other threads steal from
+ * the top. The positions are also read without the lock to skip
+ * empty queues quickly when looking for work.
+ *
+ */
+class ThreadPool::Worker {
+public:
+    Worker(ThreadPool * pool, int stack_size) : m_thread(stack_size, false){
+        m_pool = pool;
+        m_top = 0;
+        m_bottom = 0;
+        m_is_started = false;
+    }
+
+    bool is_empty() const {
+        return __atomic_load_n(&m_top, __ATOMIC_RELAXED) == __atomic_load_n(&m_bottom, __ATOMIC_RELAXED);
+    }
+
+    int push(ThreadTask * task){
+        int result = -1;
+        m_mutex.lock();
+        if( m_bottom - m_top < QUEUE_SIZE ){
+            m_queue[m_bottom & (QUEUE_SIZE-1)] = task;
+            __atomic_store_n(&m_bottom, m_bottom+1, __ATOMIC_RELAXED);
+            result = 0;
+        }
+        m_mutex.unlock();
+        return result;
+    }
+
+    ThreadTask * pop(){
+        ThreadTask * task = 0;
+        if( is_empty() ){
+            return 0;
+        }
+        m_mutex.lock();
+        if( m_bottom != m_top ){
+            __atomic_store_n(&m_bottom, m_bottom-1, __ATOMIC_RELAXED);
+            task = m_queue[m_bottom & (QUEUE_SIZE-1)];
+        }
+        m_mutex.unlock();
+        return task;
+    }
+
+    ThreadTask * steal(){
+        ThreadTask * task = 0;
+        if( is_empty() ){
+            return 0;
+        }
+        m_mutex.lock();
+        if( m_bottom != m_top ){
+            task = m_queue[m_top & (QUEUE_SIZE-1)];
+            __atomic_store_n(&m_top, m_top+1, __ATOMIC_RELAXED);
+        }
+        m_mutex.unlock();
+        return task;
+    }
+
+    bool is_current() const {
+        return __atomic_load_n(&m_is_started, __ATOMIC_ACQUIRE) && pthread_equal(m_id, pthread_self());
+    }
+
+    ThreadPool * m_pool;
+    Thread m_thread;
+    pthread_t m_id;
+    bool m_is_started;
+    Mutex m_mutex;
+    u32 m_top;
+    u32 m_bottom;
+    ThreadTask * m_queue[QUEUE_SIZE];
+};
+
+ThreadTask::ThreadTask(task_function_t function, void * args){
+    m_function = function;
+    m_args = args;
+    m_result = 0;
+    m_dependent_count = 0;
+    m_dependency_count = 0;
+    m_remaining = 1;
+    m_state = IDLE;
+    m_is_posted = false;
+}
+
+bool ThreadTask::is_busy() const {
+    int value = state();
+    return (value != IDLE) && (value != DONE);
+}
+
+int ThreadTask::set_function(task_function_t function, void * args){
+    if( is_busy() ){
+        set_error_number(EBUSY);
+        return -1;
+    }
+    m_function = function;
+    m_args = args;
+    return 0;
+}
+
+int ThreadTask::add_dependency(ThreadTask & task){
+    if( &task == this ){
+        set_error_number(EINVAL);
+        return -1;
+    }
+
+    if( is_busy() || task.is_busy() ){
+        set_error_number(EBUSY);
+        return -1;
+    }
+
+    if( task.m_dependent_count == MAX_DEPENDENTS ){
+        set_error_number(ENOSPC);
+        return -1;
+    }
+
+    task.m_dependents[task.m_dependent_count++] = this;
+    m_dependency_count++;
+    m_remaining++;
+    return 0;
+}
+
+ThreadPool::ThreadPool(u32 worker_count, int stack_size){
+    if( worker_count == 0 ){
+#if defined __link
+        long processors = sysconf(_SC_NPROCESSORS_ONLN);
+        worker_count = processors > 0 ? processors : (long)DEFAULT_WORKER_COUNT;
+#else
+        worker_count = DEFAULT_WORKER_COUNT;
+#endif
+    }
+
+    if( worker_count > MAX_WORKER_COUNT ){
+        worker_count = MAX_WORKER_COUNT;
+    }
+
+    m_workers = 0;
+    m_worker_count = worker_count;
+    m_stack_size = stack_size;
+    m_next_worker = 0;
+    m_queued_count = 0;
+    m_waiter_count = 0;
+    m_sleeping_count = 0;
+    m_is_stopping = false;
+    sem_init(&m_work, 0, 0);
+    pthread_mutex_init(&m_done_mutex, 0);
+    pthread_cond_init(&m_done_cond, 0);
+}
+
+ThreadPool::~ThreadPool(){
+    destroy();
+    sem_destroy(&m_work);
+    pthread_mutex_destroy(&m_done_mutex);
+    pthread_cond_destroy(&m_done_cond);
+}
+
+int ThreadPool::create(int prio, enum Sched::policy policy){
+    u32 i;
+
+    if( m_workers != 0 ){
+        set_error_number(EBUSY);
+        return -1;
+    }
+
+    Worker * workers = (Worker*)set_error_number_if_null(malloc(m_worker_count*sizeof(Worker)));
+    if( workers == 0 ){
+        return -1;
+    }
+
+    for(i=0; i < m_worker_count; i++){
+        new (workers + i) Worker(this, m_stack_size);
+    }
+
+    m_is_stopping = false;
+    m_workers = workers;
+
+    for(i=0; i < m_worker_count; i++){
+        if( m_workers[i].m_thread.create(worker_thread, m_workers + i, prio, policy) < 0 ){
+            set_error_number(m_workers[i].m_thread.error_number());
+            stop(i);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int ThreadPool::destroy(){
+    if( m_workers != 0 ){
+        stop(m_worker_count);
+    }
+    return 0;
+}
+
+void ThreadPool::stop(u32 started_count){
+    ThreadTask * task;
+    u32 i;
+
+    __atomic_store_n(&m_is_stopping, true, __ATOMIC_SEQ_CST);
+    for(i=0; i < started_count; i++){
+        sem_post(&m_work);
+    }
+
+    for(i=0; i < started_count; i++){
+        m_workers[i].m_thread.join();
+        m_workers[i].m_is_started = false;
+    }
+
+    //anything submitted while the workers were stopping
+    while( (task = take_task(0)) != 0 ){
+        execute(task);
+    }
+
+    for(i=0; i < m_worker_count; i++){
+        m_workers[i].~Worker();
+    }
+    free(m_workers);
+    m_workers = 0;
+
+    while( sem_trywait(&m_work) == 0 ){
+        ;
+    }
+    m_sleeping_count = 0;
+    m_is_stopping = false;
+}
+
+int ThreadPool::set_priority(int prio, enum Sched::policy policy){
+    struct sched_param param;
+    int result = 0;
+
+    if( m_workers == 0 ){
+        set_error_number(EINVAL);
+        return -1;
+    }
+
+    //Thread::set_priority() can't be used on the desktop where Thread::is_valid() stays false
+    param.sched_priority = prio;
+    for(u32 i=0; i < m_worker_count; i++){
+        int error = pthread_setschedparam(m_workers[i].m_thread.id(), policy, &param);
+        if( error != 0 ){
+            set_error_number(error);
+            result = -1;
+        }
+    }
+    return result;
+}
+
+int ThreadPool::submit(ThreadTask & task){
+    u32 state;
+
+    if( task.m_function == 0 ){
+        set_error_number(EINVAL);
+        return -1;
+    }
+
+    state = __atomic_load_n(&task.m_state, __ATOMIC_ACQUIRE);
+    do {
+        if( (state != ThreadTask::IDLE) && (state != ThreadTask::DONE) ){
+            set_error_number(EBUSY);
+            return -1;
+        }
+    } while( !__atomic_compare_exchange_n(&task.m_state, &state, (u32)ThreadTask::WAITING, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE) );
+
+    //the last of the submission and the dependencies queues the task
+    if( __atomic_sub_fetch(&task.m_remaining, 1, __ATOMIC_ACQ_REL) == 0 ){
+        queue(&task);
+    }
+
+    return 0;
+}
+
+int ThreadPool::post(function_t function, void * args){
+    ThreadTask * task;
+
+    if( function == 0 ){
+        set_error_number(EINVAL);
+        return -1;
+    }
+
+    task = new (std::nothrow) ThreadTask(function, args);
+    if( task == 0 ){
+        set_error_number(ENOMEM);
+        return -1;
+    }
+
+    task->m_is_posted = true;
+    return submit(*task);
+}
+
+int ThreadPool::wait(ThreadTask & task){
+    ThreadTask * next;
+    Worker * worker;
+
+    if( task.state() == ThreadTask::IDLE ){
+        set_error_number(EINVAL);
+        return -1;
+    }
+
+    worker = current_worker();
+    while( !task.is_done() ){
+        //help out rather than blocking a worker that may be needed
+        if( (next = take_task(worker)) != 0 ){
+            execute(next);
+            continue;
+        }
+
+        __atomic_add_fetch(&m_waiter_count, 1, __ATOMIC_SEQ_CST);
+        pthread_mutex_lock(&m_done_mutex);
+        while( !task.is_done() && (__atomic_load_n(&m_queued_count, __ATOMIC_SEQ_CST) == 0) ){
+            pthread_cond_wait(&m_done_cond, &m_done_mutex);
+        }
+        pthread_mutex_unlock(&m_done_mutex);
+        __atomic_sub_fetch(&m_waiter_count, 1, __ATOMIC_SEQ_CST);
+    }
+
+    return 0;
+}
+
+typedef struct {
+    ThreadPool::range_function_t function;
+    void * context;
+    u32 begin;
+    u32 end;
+    u32 grain;
+    u32 block_count;
+    u32 next_block;
+} range_t;
+
+static void * execute_range(void * args){
+    range_t * range = (range_t*)args;
+    u32 block;
+
+    while( (block = __atomic_fetch_add(&range->next_block, 1, __ATOMIC_RELAXED)) < range->block_count ){
+        u32 begin = range->begin + block * range->grain;
+        u32 end = (range->end - begin > range->grain) ? begin + range->grain : range->end;
+        range->function(range->context, begin, end);
+    }
+
+    return 0;
+}
+
+int ThreadPool::parallel_for(u32 begin, u32 end, u32 grain, range_function_t function, void * context){
+    ThreadTask tasks[MAX_WORKER_COUNT];
+    range_t range;
+    u32 helper_count;
+    u32 i;
+
+    if( (grain == 0) || (function == 0) ){
+        set_error_number(EINVAL);
+        return -1;
+    }
+
+    if( end <= begin ){
+        return 0;
+    }
+
+    range.function = function;
+    range.context = context;
+    range.begin = begin;
+    range.end = end;
+    range.grain = grain;
+    range.block_count = (end - begin) / grain + (((end - begin) % grain) ? 1 : 0);
+    range.next_block = 0;
+
+    //each helper takes blocks until there are none left
+    helper_count = m_workers ? m_worker_count : 0;
+    if( helper_count > range.block_count - 1 ){
+        helper_count = range.block_count - 1;
+    }
+
+    for(i=0; i < helper_count; i++){
+        tasks[i].set_function(execute_range, &range);
+        submit(tasks[i]);
+    }
+
+    execute_range(&range);
+
+    for(i=0; i < helper_count; i++){
+        wait(tasks[i]);
+    }
+
+    return 0;
+}
+
+void * ThreadPool::worker_thread(void * args){
+    Worker * worker = (Worker*)args;
+    ThreadPool * pool = worker->m_pool;
+    ThreadTask * task;
+
+    worker->m_id = pthread_self();
+    __atomic_store_n(&worker->m_is_started, true, __ATOMIC_RELEASE);
+
+    while( 1 ){
+        if( (task = pool->take_task(worker)) != 0 ){
+            pool->execute(task);
+        } else if( __atomic_load_n(&pool->m_is_stopping, __ATOMIC_SEQ_CST) ){
+            break;
+        } else {
+            pool->sleep();
+        }
+    }
+
+    return 0;
+}
+
+ThreadPool::Worker * ThreadPool::current_worker() const {
+    for(u32 i=0; (m_workers != 0) && (i < m_worker_count); i++){
+        if( m_workers[i].is_current() ){
+            return m_workers + i;
+        }
+    }
+    return 0;
+}
+
+void ThreadPool::queue(ThreadTask * task){
+    Worker * worker;
+
+    __atomic_store_n(&task->m_state, (u32)ThreadTask::QUEUED, __ATOMIC_RELAXED);
+
+    if( m_workers == 0 ){
+        execute(task);
+        return;
+    }
+
+    //workers keep their own tasks, other threads spread them out
+    if( (worker = current_worker()) == 0 ){
+        worker = m_workers + (__atomic_fetch_add(&m_next_worker, 1, __ATOMIC_RELAXED) % m_worker_count);
+    }
+
+    __atomic_add_fetch(&m_queued_count, 1, __ATOMIC_SEQ_CST);
+    if( worker->push(task) < 0 ){
+        //the queue is full
+        __atomic_sub_fetch(&m_queued_count, 1, __ATOMIC_SEQ_CST);
+        execute(task);
+        return;
+    }
+
+    wake_worker();
+    if( __atomic_load_n(&m_waiter_count, __ATOMIC_SEQ_CST) ){
+        notify_waiters();
+    }
+}
+
+ThreadTask * ThreadPool::take_task(Worker * worker){
+    ThreadTask * task = 0;
+    u32 start = 0;
+    u32 i;
+
+    if( m_workers == 0 ){
+        return 0;
+    }
+
+    if( worker ){
+        task = worker->pop();
+        start = worker - m_workers + 1;
+    }
+
+    for(i=0; (task == 0) && (i < m_worker_count); i++){
+        Worker * victim = m_workers + ((start + i) % m_worker_count);
+        if( victim != worker ){
+            task = victim->steal();
+        }
+    }
+
+    if( task ){
+        __atomic_sub_fetch(&m_queued_count, 1, __ATOMIC_SEQ_CST);
+    }
+    return task;
+}
+
+void ThreadPool::execute(ThreadTask * task){
+    __atomic_store_n(&task->m_state, (u32)ThreadTask::RUNNING, __ATOMIC_RELAXED);
+
+    task->m_result = task->m_function(task->m_args);
+
+    for(u32 i=0; i < task->m_dependent_count; i++){
+        ThreadTask * dependent = task->m_dependents[i];
+        if( __atomic_sub_fetch(&dependent->m_remaining, 1, __ATOMIC_ACQ_REL) == 0 ){
+            queue(dependent);
+        }
+    }
+
+    if( task->m_is_posted ){
+        //nobody can wait on a posted task
+        delete task;
+        return;
+    }
+
+    //ready to be submitted again; the task isn't touched after it is done
+    task->m_remaining = task->m_dependency_count + 1;
+    __atomic_store_n(&task->m_state, (u32)ThreadTask::DONE, __ATOMIC_SEQ_CST);
+
+    if( __atomic_load_n(&m_waiter_count, __ATOMIC_SEQ_CST) ){
+        notify_waiters();
+    }
+}
+
+void ThreadPool::sleep(){
+    u32 count;
+    int result;
+
+    __atomic_add_fetch(&m_sleeping_count, 1, __ATOMIC_SEQ_CST);
+
+    if( __atomic_load_n(&m_queued_count, __ATOMIC_SEQ_CST) || __atomic_load_n(&m_is_stopping, __ATOMIC_SEQ_CST) ){
+        //work arrived: don't sleep unless wake_worker() has already posted for this worker
+        count = __atomic_load_n(&m_sleeping_count, __ATOMIC_SEQ_CST);
+        while( count ){
+            if( __atomic_compare_exchange_n(&m_sleeping_count, &count, count-1, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST) ){
+                return;
+            }
+        }
+    }
+
+    do {
+        result = sem_wait(&m_work);
+    } while( (result < 0) && (errno == EINTR) );
+}
+
+void ThreadPool::wake_worker(){
+    u32 count = __atomic_load_n(&m_sleeping_count, __ATOMIC_SEQ_CST);
+    while( count ){
+        if( __atomic_compare_exchange_n(&m_sleeping_count, &count, count-1, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST) ){
+            sem_post(&m_work);
+            return;
+        }
+    }
+}
+
+void ThreadPool::notify_waiters(){
+    pthread_mutex_lock(&m_done_mutex);
+    pthread_cond_broadcast(&m_done_cond);
+    pthread_mutex_unlock(&m_done_mutex);
+}
+
+#endif
@@ -0,0 +1,179 @@
+//Copyright 2011-2018 Tyler Gilbert; All Rights Reserved
+
+#include <cstdlib>
+#include <errno.h>
+#if !defined __win32
+#include <pthread.h>
+#endif
+#include "sys/TraceRing.hpp"
+#include "var/Data.hpp"
+#include "chrono/Clock.hpp"
+
+using namespace sys;
+
+TraceRing * TraceRing::m_default = 0;
+
+TraceRing::TraceRing(u32 count){
+    u32 size = 1;
+    m_mask = 0;
+    m_position = 0;
+    m_is_full = 0;
+    m_wrap_count = 0;
+    m_slots = 0;
+    if( count > max_count() ){
+        set_error_number(ENOMEM);
+        return;
+    }
+    while( size < count ){
+        size <<= 1;
+    }
+    m_slots = (slot_t*)set_error_number_if_null(malloc(sizeof(slot_t) * size));
+    if( m_slots == 0 ){
+        return;
+    }
+    m_mask = size - 1;
+    clear();
+}
+
+u32 TraceRing::max_count(){
+    //the largest power of two number of slots whose size in bytes fits in a u32
+    u32 result = 0x80000000;
+    while( result > (u32)-1 / sizeof(slot_t) ){
+        result >>= 1;
+    }
+    return result;
+}
+
+u32 TraceRing::sequence(u32 position){
+    //zero means the record is being written so position 0xffffffff uses 1 (like position 0)
+    u32 result = position + 1;
+    return result ? result : 1;
+}
+
+TraceRing::~TraceRing(){
+    if( get_default() == this ){
+        set_default(0);
+    }
+    free(m_slots);
+}
+
+void TraceRing::clear(){
+    if( m_slots == 0 ){
+        return;
+    }
+    for(u32 i=0; i <= m_mask; i++){
+        m_slots[i].sequence = 0;
+    }
+    __atomic_store_n(&m_is_full, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&m_wrap_count, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&m_position, 0, __ATOMIC_RELEASE);
+}
+
+u64 TraceRing::timestamp(){
+    return chrono::Clock::get_fast_nanoseconds();
+}
+
+void TraceRing::record(u16 event, u8 type, u32 arg0, u32 arg1){
+    u64 now;
+    u32 thread_id;
+    u32 position;
+    slot_t * slot;
+    u32 words[RECORD_WORDS];
+    trace_record_t * record = (trace_record_t*)words;
+
+    if( m_slots == 0 ){
+        return;
+    }
+
+    now = timestamp();
+#if !defined __win32
+    thread_id = (u32)(size_t)pthread_self();
+#else
+    thread_id = 0;
+#endif
+
+    record->timestamp_low = (u32)now;
+    record->timestamp_high = (u32)(now >> 32);
+    record->thread_id = thread_id;
+    record->event = event;
+    record->type = type;
+    record->resd = 0;
+    record->args[0] = arg0;
+    record->args[1] = arg1;
+
+    position = __atomic_fetch_add(&m_position, 1, __ATOMIC_RELAXED);
+    slot = m_slots + (position & m_mask);
+    if( position == m_mask ){
+        __atomic_store_n(&m_is_full, 1, __ATOMIC_RELAXED);
+    } else if( position == (u32)-1 ){
+        __atomic_fetch_add(&m_wrap_count, 1, __ATOMIC_RELAXED);
+    }
+
+    //the sequence is zero while the words are written so save() can skip the record
+    __atomic_store_n(&slot->sequence, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    for(u32 i=0; i < RECORD_WORDS; i++){
+        __atomic_store_n(slot->words + i, words[i], __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&slot->sequence, sequence(position), __ATOMIC_RELEASE);
+}
+
+int TraceRing::save(var::Data & dump) const {
+    trace_dump_header_t * header;
+    u32 * words;
+    u32 wrap_count;
+    u32 end;
+    u32 start;
+    u32 count = 0;
+    u64 written;
+
+    wrap_count = __atomic_load_n(&m_wrap_count, __ATOMIC_RELAXED);
+    end = __atomic_load_n(&m_position, __ATOMIC_ACQUIRE);
+    //the ring is full once position m_mask has been written (even after the position wraps)
+    if( (end > m_mask) || __atomic_load_n(&m_is_full, __ATOMIC_RELAXED) ){
+        start = end - m_mask - 1;
+    } else {
+        start = 0;
+    }
+
+    if( dump.alloc(sizeof(trace_dump_header_t) + (end - start)*sizeof(trace_record_t)) < 0 ){
+        set_error_number(ENOMEM);
+        return -1;
+    }
+
+    header = (trace_dump_header_t*)dump.data();
+    words = (u32*)(header + 1);
+
+    for(u32 position = start; position != end; position++){
+        const slot_t * slot = m_slots + (position & m_mask);
+        u32 sequence = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+        if( sequence != TraceRing::sequence(position) ){
+            continue;
+        }
+
+        for(u32 i=0; i < RECORD_WORDS; i++){
+            words[i] = __atomic_load_n(slot->words + i, __ATOMIC_RELAXED);
+        }
+
+        //check that the record was not overwritten while it was copied
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if( __atomic_load_n(&slot->sequence, __ATOMIC_RELAXED) == sequence ){
+            words += RECORD_WORDS;
+            count++;
+        }
+    }
+
+    header->magic = MAGIC;
+    header->version = VERSION;
+    header->record_size = sizeof(trace_record_t);
+    header->count = count;
+    written = ((u64)wrap_count << 32) + end;
+    if( written < count ){
+        //the position wrapped after m_wrap_count was loaded
+        written += (u64)1 << 32;
+    }
+    written -= count;
+    header->dropped = written > (u32)-1 ? (u32)-1 : (u32)written;
+    dump.set_size(sizeof(trace_dump_header_t) + count*sizeof(trace_record_t));
+    return count;
+}
@@ -29,36 +29,73 @@ float ConstString::atoff() const {
 }
 
 char ConstString::at(u32 pos) const {
-    if (pos < length()){
+    //strnlen() stops at pos rather than scanning the whole string
+    if( strnlen(str(), pos+1) > pos ){
         return str()[pos];
     }
     return 0;
 }
 
+u32 ConstString::find_bytes(const char * s, u32 len, const char * a, u32 n, u32 pos){
+    if( (n == 0) || (pos > len) || (n > len - pos) ){
+        return npos;
+    }
+
+    const u8 * haystack = (const u8*)s;
+    const u8 * needle = (const u8*)a;
+    u32 last = n - 1;
+    u32 i;
+
+    if( (n < 4) || (len - pos < 64) ){
+        //memchr() is fast for finding the first character
+        const u8 * end = haystack + len - last;
+        const u8 * p = haystack + pos;
+        while( (p = (const u8*)memchr(p, needle[0], end - p)) != 0 ){
+            if( memcmp(p + 1, needle + 1, last) == 0 ){
+                return p - haystack;
+            }
+            p++;
+        }
+        return npos;
+    }
+
+    //Boyer-Moore-Horspool: skip based on the last character of the window
+    u8 skip[256];
+    u32 max_skip = n < 255 ? n : 255;
+    memset(skip, max_skip, sizeof(skip));
+    for(i = (n > 255 ? n - 255 : 0); i < last; i++){
+        skip[needle[i]] = last - i;
+    }
+
+    u8 last_char = needle[last];
+    for(i = pos; i <= len - n; i += skip[haystack[i + last]]){
+        if( (haystack[i + last] == last_char) && (memcmp(haystack + i, needle, last) == 0) ){
+            return i;
+        }
+    }
+    return npos;
+}
+
 
 u32 ConstString::find(const ConstString & str, u32 pos) const {
     return find(str, pos, str.length());
 }
 
 u32 ConstString::find(const char c, u32 pos) const{
-    char str[2];
-    str[0] = c;
-    str[1] = 0;
-    return find(str, pos);
+    u32 len = length();
+    if( pos >= len ){
+        return npos;
+    }
+    const char * p = (const char*)memchr(str() + pos, c, len - pos);
+    if( p == 0 ){
+        return npos;
+    }
+    return p - str();
 }
 
 u32 ConstString::find(const ConstString & s, u32 pos, u32 n) const {
     //find s (length n) starting at pos
-
-    if( !s.is_empty() ){
-        u32 len = length();
-        for(u32 i=pos; i < len; i++){
-            if( strncmp(str() + i, s.str(), n) == 0 ){
-                return i;
-            }
-        }
-    }
-    return npos;
+    return find_bytes(str(), length(), s.str(), strnlen(s.str(), n), pos);
 }
 
 u32 ConstString::rfind(const ConstString & str, u32 pos) const {
@@ -66,23 +103,28 @@ u32 ConstString::rfind(const ConstString & str, u32 pos) const {
 }
 
 u32 ConstString::rfind(const char c, u32 pos) const{
-    char str[2];
-    str[0] = c;
-    str[1] = 0;
-    return rfind(str, pos);
+    const char * p = str();
+    for(u32 i = length(); i > pos; i--){
+        if( p[i-1] == c ){
+            return i-1;
+        }
+    }
+    return npos;
 }
 
 u32 ConstString::rfind(const ConstString & s, u32 pos, u32 n) const {
     //find s (length n) starting at pos
     if( s != 0 ){
-        u32 len = s.length();
-        if( n > len ){
-            n = len;
-        }
+        n = strnlen(s.str(), n);
         u32 this_len = length();
-        for(s32 i=this_len-n; i >= (s32)pos; i--){
-            if( strncmp(str() + i, s.str(), n) == 0 ){
-                return i;
+        if( n > this_len ){
+            return npos;
+        }
+        const char * p = str();
+        const char * a = s.str();
+        for(u32 i = this_len - n + 1; i > pos; i--){
+            if( (p[i-1] == a[0]) && (memcmp(p + i - 1, a, n) == 0) ){
+                return i-1;
             }
         }
     }
@@ -194,10 +194,30 @@ int Data::set_size(u32 s){
     return alloc(s, true);
 }
 
+int Data::reserve(u32 s){
+    u32 size = m_size;
+    u32 new_capacity;
+
+    if( s <= capacity() ){
+        return 0;
+    }
+
+    //if doubling overflows or the memory isn't available, try the exact size
+    new_capacity = capacity()*2;
+    if( (new_capacity < s) || (alloc(new_capacity, true) < 0) ){
+        if( alloc(s, true) < 0 ){
+            return -1;
+        }
+    }
+    m_size = size;
+    return 0;
+}
+
 void Data::clear(){ fill(0); }
 
 void Data::fill(unsigned char d){
     if( m_mem_write ){
+        set_modified();
         memset(m_mem_write, d, capacity());
     }
 }
@@ -0,0 +1,47 @@
+//Copyright 2011-2018 Tyler Gilbert; All Rights Reserved
+
+#include <cstring>
+#include "var/Hash.hpp"
+
+using namespace var;
+
+static u32 rotate_left(u32 value, int bits){
+    return (value << bits) | (value >> (32 - bits));
+}
+
+u32 HashFunction::calculate(const void * data, u32 size, u32 seed){
+    const u8 * bytes = (const u8*)data;
+    const u32 c1 = 0xcc9e2d51;
+    const u32 c2 = 0x1b873593;
+    u32 hash = seed;
+    u32 block;
+    u32 i;
+
+    for(i=0; i + 4 <= size; i += 4){
+        //memcpy() allows unaligned data and compiles to a single load
+        memcpy(&block, bytes + i, sizeof(block));
+        block *= c1;
+        block = rotate_left(block, 15);
+        block *= c2;
+        hash ^= block;
+        hash = rotate_left(hash, 13);
+        hash = hash*5 + 0xe6546b64;
+    }
+
+    block = 0;
+    switch(size & 3){
+    case 3: block ^= bytes[i+2] << 16;
+        /* no break */
+    case 2: block ^= bytes[i+1] << 8;
+        /* no break */
+    case 1: block ^= bytes[i];
+        block *= c1;
+        block = rotate_left(block, 15);
+        block *= c2;
+        hash ^= block;
+        break;
+    }
+
+    hash ^= size;
+    return mix(hash);
+}
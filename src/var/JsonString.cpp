@@ -67,17 +67,21 @@ void JsonString::append_string(const ConstString & key, const ConstString & valu
 }
 
 void JsonString::append_number(const ConstString & key, int number){
-	String str;
-    str.sprintf("\"%s\": \"%d\"", key.str(), number);
 	append_separator();
-    append(str.str());
+	append("\"");
+	append(key);
+	append("\": \"");
+	String::append_number(number);
+	append("\"");
 }
 
 void JsonString::append_float(const ConstString & key, float number){
-	String str;
-    str.sprintf("\"%s\": \"%f\"", key.str(), number);
 	append_separator();
-    append(str.str());
+	append("\"");
+	append(key);
+	append("\": \"");
+	String::append_number(number);
+	append("\"");
 }
 
 
@@ -122,17 +126,17 @@ void JsonString::append_string(const ConstString & value){
 }
 
 void JsonString::append_number(int number){
-	String str;
-	str.sprintf("\"%d\"", number);
 	append_separator();
-    append(str.str());
+	append("\"");
+	String::append_number(number);
+	append("\"");
 }
 
 void JsonString::append_float(float number){
-	String str;
-	str.sprintf("\"%f\"", number);
 	append_separator();
-    append(str.str());
+	append("\"");
+	String::append_number(number);
+	append("\"");
 }
 
 
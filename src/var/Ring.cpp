@@ -1,69 +1,153 @@
 //Copyright 2011-2018 Tyler Gilbert; All Rights Reserved
 
+#include <errno.h>
 #include "var/Ring.hpp"
 
 namespace var {
 
-RingBuffer::RingBuffer(void * buf, u32 size) : Data(buf, size){
-	m_size = size;
-	m_head = 0;
-	m_tail = 0;
-	m_is_overflow_allowed = true;
+RingBuffer::RingBuffer(void * buf, u32 count, u32 item_size) : Data(buf, calc_count(count, item_size, false)*item_size){
+    m_count = calc_count(count, item_size, false);
+    m_item_size = item_size;
+    m_head = 0;
+    m_tail = 0;
+    m_is_overflow_allowed = false;
 }
 
-RingBuffer::RingBuffer(u32 size) : Data(size){
-    m_size = size;
+RingBuffer::RingBuffer(u32 count, u32 item_size) : Data(calc_count(count, item_size, true)*item_size){
+    m_count = data() ? calc_count(count, item_size, true) : 0;
+    m_item_size = item_size;
     m_head = 0;
     m_tail = 0;
-    m_is_overflow_allowed = true;
+    m_is_overflow_allowed = false;
+    if( (m_count == 0) && (count != 0) ){
+        set_error_number(ENOMEM);
+    }
 }
 
-u32 RingBuffer::calc_used() const {
-    if( m_tail == m_size ){
-        return m_size;
-    } else if( m_head >= m_tail ){
-        return m_head - m_tail;
-    } else {
-        return m_size - ( m_tail - m_head );
+u32 RingBuffer::calc_count(u32 count, u32 item_size, bool round_up){
+    u32 result = 1;
+    u32 max_count = 0x80000000;
+    if( (count == 0) || (item_size == 0) ){ return 0; }
+
+    //the largest power of two number of items whose size in bytes fits in a u32
+    while( max_count > (u32)-1 / item_size ){
+        max_count >>= 1;
+    }
+    if( count > max_count ){
+        //external memory can't be bigger than the address space
+        return round_up ? 0 : max_count;
+    }
+
+    while( result < count ){
+        result <<= 1;
     }
+    if( (result != count) && !round_up ){
+        result >>= 1;
+    }
+    return result;
+}
+
+u32 RingBuffer::calc_used() const {
+    u32 tail = __atomic_load_n(&m_tail, __ATOMIC_ACQUIRE);
+    u32 head = __atomic_load_n(&m_head, __ATOMIC_ACQUIRE);
+    return head - tail;
 }
 
 u32 RingBuffer::calc_free() const {
-    return m_size - calc_used();
+    return m_count - calc_used();
 }
 
 void RingBuffer::flush(void){
-	m_head = 0;
-	m_tail = 0;
+    __atomic_store_n(&m_head, 0, __ATOMIC_RELEASE);
+    __atomic_store_n(&m_tail, 0, __ATOMIC_RELEASE);
 }
 
-void RingBuffer::inc_tail(){
-    m_tail++;
-    if( m_tail == m_size ){
-        m_tail = 0;
+u32 RingBuffer::write(const void * buf, u32 count){
+    const u8 * src = (const u8*)buf;
+    //the producer owns the head
+    u32 head = __atomic_load_n(&m_head, __ATOMIC_RELAXED);
+    u32 tail = __atomic_load_n(&m_tail, __ATOMIC_ACQUIRE);
+    u32 free_count = m_count - (head - tail);
+
+    if( count > free_count ){
+        if( m_is_overflow_allowed ){
+            if( count > m_count ){
+                //only the newest items will fit
+                src += (count - m_count)*m_item_size;
+                count = m_count;
+            }
+            //discard the oldest items
+            __atomic_store_n(&m_tail, tail + (count - free_count), __ATOMIC_RELEASE);
+        } else {
+            count = free_count;
+        }
+    }
+
+    if( count ){
+        u32 offset = head & (m_count-1);
+        u32 first = m_count - offset;
+        if( first > count ){ first = count; }
+        memcpy(item_data(head), src, first*m_item_size);
+        memcpy(item_data(0), src + first*m_item_size, (count - first)*m_item_size);
+        __atomic_store_n(&m_head, head + count, __ATOMIC_RELEASE);
     }
+
+    return count;
 }
 
-void RingBuffer::inc_head(){
-    m_head++;
-    if( m_head == m_size ){
-        m_head = 0;
+u32 RingBuffer::read(void * buf, u32 count){
+    u8 * dest = (u8*)buf;
+    //the consumer owns the tail
+    u32 tail = __atomic_load_n(&m_tail, __ATOMIC_RELAXED);
+    u32 head = __atomic_load_n(&m_head, __ATOMIC_ACQUIRE);
+    u32 used = head - tail;
+
+    if( count > used ){
+        count = used;
     }
 
-    if( m_head == m_tail ){
-        m_tail = m_size; //buffer is full
+    if( count ){
+        u32 offset = tail & (m_count-1);
+        u32 first = m_count - offset;
+        if( first > count ){ first = count; }
+        memcpy(dest, item_data(tail), first*m_item_size);
+        memcpy(dest + first*m_item_size, item_data(0), (count - first)*m_item_size);
+        __atomic_store_n(&m_tail, tail + count, __ATOMIC_RELEASE);
     }
+
+    return count;
 }
 
-u32 RingBuffer::get_free_count(u32 count) const {
-    if( !m_is_overflow_allowed ){
-        u32 free_count;
-        free_count = calc_free();
-        if( count > free_count ){
-            count = free_count;
-        }
+void * RingBuffer::reserve_write(u32 & count){
+    u32 head = __atomic_load_n(&m_head, __ATOMIC_RELAXED);
+    u32 tail = __atomic_load_n(&m_tail, __ATOMIC_ACQUIRE);
+    u32 contiguous = m_count - (head & (m_count-1));
+    count = m_count - (head - tail);
+    if( count > contiguous ){
+        count = contiguous;
     }
-    return count;
+    return item_data(head);
+}
+
+void RingBuffer::commit_write(u32 count){
+    u32 head = __atomic_load_n(&m_head, __ATOMIC_RELAXED);
+    __atomic_store_n(&m_head, head + count, __ATOMIC_RELEASE);
+}
+
+void * RingBuffer::reserve_read(u32 & count){
+    u32 tail = __atomic_load_n(&m_tail, __ATOMIC_RELAXED);
+    u32 head = __atomic_load_n(&m_head, __ATOMIC_ACQUIRE);
+    u32 contiguous = m_count - (tail & (m_count-1));
+    count = head - tail;
+    if( count > contiguous ){
+        count = contiguous;
+    }
+    return item_data(tail);
+}
+
+void RingBuffer::commit_read(u32 count){
+    u32 tail = __atomic_load_n(&m_tail, __ATOMIC_RELAXED);
+    __atomic_store_n(&m_tail, tail + count, __ATOMIC_RELEASE);
 }
 
 
@@ -7,25 +7,32 @@
 #include <cstdarg>
 #include <cstring>
 #include "var/String.hpp"
+#include "var/StringUtil.hpp"
+#include "var/Token.hpp"
 #include "sys.hpp"
 
 using namespace var;
 
 String::String(){
     //creates an empty string -- Data class and ConstString class will point to a zero value variable
+    m_length = 0;
 }
 
 String::String(const ConstString & s){
+    m_length = 0;
     assign(s);
 }
 
 
 String::String(const ConstString & s, u32 len){
+    m_length = 0;
     assign(s, len);
 }
 
 
 String::String(char * mem, u32 capacity, bool readonly) : Data((void*)mem, capacity, readonly){
+    m_length = npos;
+    set_string_pointer(cdata_const());
     if( !readonly ){
         clear();
     }
@@ -57,65 +64,151 @@ int String::sprintf(const char * format, ...){
 
 int String::vformat(const char * fmt, va_list list){
     int result;
+    va_list list_copy;
     if( capacity() == 0 ){
         set_size(minimum_size());
     }
-    result = vsnprintf(cdata(), capacity(), fmt, list);
-    if( result > (int)capacity() ){ //if the data did not fit, make the buffer bigger
-        if( set_capacity(result+1) >= 0 ){
-            vsnprintf(cdata(), capacity(), fmt, list);
+    if( cdata_untracked() == 0 ){
+        return -1;
+    }
+    va_copy(list_copy, list);
+    result = vsnprintf(cdata_untracked(), Data::capacity(), fmt, list);
+    if( result > (int)capacity() ){
+        //the output was truncated -- the second pass only happens when the string grows
+        if( set_capacity(result) >= 0 ){
+            vsnprintf(cdata_untracked(), Data::capacity(), fmt, list_copy);
         }
     }
+    va_end(list_copy);
+    m_length = npos;
     return result;
 }
 
 int String::set_size(u32 s){
+    bool is_new = Data::capacity() == 0;
     int result = Data::set_size(s+1);
     set_string_pointer(cdata_const());
+    if( is_new && (result == 0) ){
+        cdata_untracked()[0] = 0;
+        m_length = 0;
+    }
     return result;
 }
 
+int String::grow(u32 length){
+    bool is_new = Data::capacity() == 0;
+    if( length <= capacity() ){
+        return 0;
+    }
+    //Data::reserve() at least doubles the capacity so appending is constant time on average
+    if( Data::reserve(length+1) < 0 ){
+        return -1;
+    }
+    set_string_pointer(cdata_const());
+    if( is_new ){
+        cdata_untracked()[0] = 0;
+        m_length = 0;
+    }
+    return 0;
+}
+
 int String::assign(const ConstString & a){
-    return assign(a, a.length());
+    return assign(a, npos);
 }
 
 int String::assign(const ConstString & a, u32 n){
     //check for null
     if( a.str() != str() ){ //check for assignment to self - no action needed
-        if( n == (u32)npos ){ n = a.length(); }
-        if( set_capacity(n) < 0 ){ return -1; }
-        clear();
-        strncpy(cdata(), a.str(), n);
+        const char * source = a.str();
+        u32 len = (n == (u32)npos) ? strlen(source) : strnlen(source, n);
+        if( (len > capacity()) || (cdata_untracked() == 0) ){
+            //a can't be part of this string if it doesn't fit
+            if( set_capacity(len) < 0 ){ return -1; }
+        }
+        char * p = cdata_untracked();
+        if( p == 0 ){ return -1; }
+        ::memmove(p, source, len);
+        p[len] = 0;
+        m_length = len;
     }
     return 0;
 }
 
 int String::append(const ConstString & a){
     if( a == 0 ){ return 0; }
+    return append(a.str(), a.length());
+}
+
+int String::append(char c){
+    return append(&c, 1);
+}
+
+int String::append(const char * s, u32 n){
     u32 len = length();
-    u32 alen = a.length();
-    set_capacity(len + alen); //try to make min capacity
-    if( len == 0 ){
-        clear(); //previous length was zero -- ensure string is valid
+    const char * begin = cdata_const();
+    if( len + n > capacity() ){
+        //s may point into this string which is about to move
+        bool is_inside = (s >= begin) && (s < begin + Data::capacity());
+        u32 offset = is_inside ? s - begin : 0;
+        if( grow(len + n) < 0 ){ return -1; }
+        if( is_inside ){
+            s = cdata_const() + offset;
+        }
     }
-    if( cdata() == 0 ){ return -1; }
-    strncat(cdata(), a.str(), capacity() - len);
+    char * p = cdata_untracked();
+    if( p == 0 ){ return -1; }
+    ::memmove(p + len, s, n);
+    p[len + n] = 0;
+    m_length = len + n;
     return 0;
 }
 
-int String::append(char c){
+char * String::reserve_append(u32 max_length){
     u32 len = length();
-    u32 alen = 1;
-    set_capacity(len + alen + 1); //try to make min capacity
-    if( cdata() == 0 ){ return -1; }
-    strncat(cdata(),&c,1);
+    if( grow(len + max_length) < 0 ){
+        return 0;
+    }
+    return cdata_untracked() + len;
+}
+
+int String::append_signed(s32 value){
+    char * p = reserve_append(StringUtil::BUF_SIZE);
+    if( p == 0 ){ return -1; }
+    m_length += StringUtil::itoa(p, value);
+    return 0;
+}
+
+int String::append_unsigned(u32 value){
+    char * p = reserve_append(StringUtil::BUF_SIZE);
+    if( p == 0 ){ return -1; }
+    m_length += StringUtil::utoa(p, value);
+    return 0;
+}
+
+int String::append_signed64(s64 value){
+    char * p = reserve_append(StringUtil::BUF_SIZE);
+    if( p == 0 ){ return -1; }
+    m_length += StringUtil::lltoa(p, value);
+    return 0;
+}
+
+int String::append_unsigned64(u64 value){
+    char * p = reserve_append(StringUtil::BUF_SIZE);
+    if( p == 0 ){ return -1; }
+    m_length += StringUtil::ulltoa(p, value);
     return 0;
 }
 
+int String::append_number(float value){
+    char * p = reserve_append(StringUtil::BUF_SIZE);
+    if( p == 0 ){ return -1; }
+    m_length += StringUtil::ftoa(p, value);
+    return 0;
+}
 
 String& String::insert(u32 pos, const ConstString & str){
 
-    if( cdata() == 0 ){
+    if( cdata_untracked() == 0 ){
         assign(str);
         return *this;
     }
@@ -129,44 +222,115 @@ String& String::insert(u32 pos, const ConstString & str){
     } else if( pos == len ){
         append(str);
     } else {
+        const char * begin = cdata_const();
+        if( (str.str() >= begin) && (str.str() < begin + Data::capacity()) ){
+            //inserting part of this string -- use a copy
+            String copy(str);
+            return insert(pos, copy);
+        }
 
-        //this needs a limit
         s = str.length();
-
-        char buffer[len+1];
-
-        if( set_capacity( len + s ) < 0 ){
+        if( grow( len + s ) < 0 ){
             exit_fatal("failed to alloc for insert");
             return *this;
         }
 
-        strncpy(buffer, cdata()+pos, len+1); //copy the existing string to buffer
-        strncpy(cdata()+pos, str.str(), capacity() - pos);
-        strncat(cdata(), buffer, capacity());
+        char * p = cdata_untracked();
+        ::memmove(p + pos + s, p + pos, len - pos + 1); //includes the terminator
+        ::memcpy(p + pos, str.str(), s);
+        m_length = len + s;
     }
 
     return *this;
 }
 
 String& String::erase(u32 pos, u32 len){
-    char * p = cdata();
+    char * p = cdata_untracked();
     u32 s = length();
     if( p == 0 ){ return *this; }
     if( (len != npos) && (pos + len < s) ){
         int remaining;
         remaining = s - pos - len;
         if( remaining > 0 ){
-            ::memcpy(p + pos, p + pos + len, remaining);
+            ::memmove(p + pos, p + pos + len, remaining);
             p[pos+remaining] = 0;
+            m_length = pos + remaining;
         } else {
             p[pos] = 0;
+            m_length = pos;
         }
     } else if (pos < s ){
         p[pos] = 0;
+        m_length = pos;
     }
     return *this;
 }
 
+String& String::replace_all(const ConstString & old_string, const ConstString & new_string){
+    const char * begin = cdata_const();
+    const char * end = begin + Data::capacity();
+    if( ((old_string.str() >= begin) && (old_string.str() < end)) ||
+            ((new_string.str() >= begin) && (new_string.str() < end)) ){
+        //the arguments point into this string -- use copies
+        String old_copy(old_string);
+        String new_copy(new_string);
+        return replace_all(old_copy, new_copy);
+    }
+
+    u32 old_length = old_string.length();
+    u32 new_length = new_string.length();
+    u32 len = length();
+    u32 count = 0;
+    u32 pos;
+
+    if( (old_length == 0) || (cdata_untracked() == 0) ){
+        return *this;
+    }
+
+    pos = 0;
+    while( (pos = find_bytes(begin, len, old_string.str(), old_length, pos)) != npos ){
+        count++;
+        pos += old_length;
+    }
+
+    if( count == 0 ){
+        return *this;
+    }
+
+    u32 result_length = len - count*old_length + count*new_length;
+    u32 offset = 0;
+    if( result_length > len ){
+        if( grow(result_length) < 0 ){
+            return *this;
+        }
+        //move the string to the end so the result can be written from the front
+        offset = result_length - len;
+        ::memmove(cdata_untracked() + offset, cdata_untracked(), len);
+    }
+
+    //the write position never passes the read position
+    char * p = cdata_untracked();
+    const char * source = p + offset;
+    u32 read = 0;
+    u32 write = 0;
+    while( (pos = find_bytes(source, len, old_string.str(), old_length, read)) != npos ){
+        ::memmove(p + write, source + read, pos - read);
+        write += pos - read;
+        ::memcpy(p + write, new_string.str(), new_length);
+        write += new_length;
+        read = pos + old_length;
+    }
+    ::memmove(p + write, source + read, len - read);
+    write += len - read;
+    p[write] = 0;
+    m_length = write;
+    return *this;
+}
+
+Token String::split(const ConstString & delimiters, bool count_empty) const {
+    return Token(*this, delimiters, "", count_empty);
+}
+
 String String::substr(u32 pos, u32 len) const {
     if( pos >= length() ){
         return String();
@@ -181,7 +345,7 @@ String String::substr(u32 pos, u32 len) const {
 
 String & String::to_upper(){
     u32 s = length();
-    char * p = cdata();
+    char * p = cdata_untracked();
     for(u32 i = 0; i < s; i++){
         p[i] = ::toupper(p[i]);
     }
@@ -190,7 +354,7 @@ String & String::to_upper(){
 
 String & String::to_lower(){
     u32 s = length();
-    char * p = cdata();
+    char * p = cdata_untracked();
     for(u32 i = 0; i < s; i++){
         p[i] = ::tolower(p[i]);
     }
@@ -201,7 +365,7 @@ void PathString::strip_suffix(){
     u32 dot;
     dot = rfind('.');
     if( dot != npos ){
-        cdata()[dot] = 0;
+        erase(dot);
     }
 }
 
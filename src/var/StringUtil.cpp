@@ -2,6 +2,8 @@
 
 
 #include <limits.h>
+#include <errno.h>
+#include <math.h>
 #include <cstdio>
 #include <cstring>
 #include <cstdlib>
@@ -13,6 +15,25 @@ static const int bases[StringUtil::MODE_TOTAL] = {
 		2, 8, 16, 16, 10
 };
 
+//"00" to "99" so two digits can be written with one division
+static const char digit_pairs[201] =
+		"00010203040506070809"
+		"10111213141516171819"
+		"20212223242526272829"
+		"30313233343536373839"
+		"40414243444546474849"
+		"50515253545556575859"
+		"60616263646566676869"
+		"70717273747576777879"
+		"80818283848586878889"
+		"90919293949596979899";
+
+//leave room for a sign, the terminator and (for floats) the fraction
+static int clamp_width(int width){
+	if( width < 0 ){ return 0; }
+	if( width > StringUtil::BUF_SIZE - 16 ){ return StringUtil::BUF_SIZE - 16; }
+	return width;
+}
 
 #if !defined USE_SPRINTF
 
@@ -34,6 +55,48 @@ char StringUtil::htoc(int nibble){
 }
 #endif
 
+int StringUtil::calc_decimal_length(uint32_t num){
+	if( num < 10 ){ return 1; }
+	if( num < 100 ){ return 2; }
+	if( num < 1000 ){ return 3; }
+	if( num < 10000 ){ return 4; }
+	if( num < 100000 ){ return 5; }
+	if( num < 1000000 ){ return 6; }
+	if( num < 10000000 ){ return 7; }
+	if( num < 100000000 ){ return 8; }
+	if( num < 1000000000 ){ return 9; }
+	return 10;
+}
+
+void StringUtil::write_decimal(char * dest, uint32_t num, int length){
+	char * p = dest + length;
+	while( num >= 100 ){
+		uint32_t pair = (num % 100) * 2;
+		num /= 100;
+		*--p = digit_pairs[pair + 1];
+		*--p = digit_pairs[pair];
+	}
+	if( num >= 10 ){
+		*--p = digit_pairs[num*2 + 1];
+		*--p = digit_pairs[num*2];
+	} else {
+		*--p = '0' + num;
+	}
+	while( p > dest ){
+		*--p = '0';
+	}
+}
+
+static int write_padded_decimal(char * dest, uint32_t num, int width){
+	int len = StringUtil::calc_decimal_length(num);
+	width = clamp_width(width);
+	if( width > len ){
+		len = width;
+	}
+	StringUtil::write_decimal(dest, num, len);
+	dest[len] = 0;
+	return len;
+}
 
 int StringUtil::itoa(char dest[BUF_SIZE], int32_t num, int width){
 
@@ -51,112 +114,330 @@ int StringUtil::itoa(char dest[BUF_SIZE], int32_t num, int width){
 	format[i+1] = 'd';
 	return sprintf(dest, format, num);
 #else
-	char buf[BUF_SIZE];
-	int i, j;
-	bool started;
-	bool neg;
-	j = 0;
-	neg = false;
+	if( num < 0 ){
+		dest[0] = '-';
+		//negate as unsigned so INT_MIN works
+		return write_padded_decimal(dest + 1, 0 - (uint32_t)num, width) + 1;
+	}
+	return write_padded_decimal(dest, num, width);
+#endif
+}
 
-	//special case because num*-1 will not fit in int32_t
-	if( num == INT_MIN ){
-		strcpy(dest, "-2147483648");
-		return 11;
+int StringUtil::ulltoa(char dest[BUF_SIZE], uint64_t num, int width){
+	if( num <= 0xffffffff ){
+		return write_padded_decimal(dest, (uint32_t)num, width);
 	}
 
-	if( num < 0 ){
-		neg = true;
-		num *= -1;
+	//split into 9 digit chunks so the rest of the work uses 32-bit math
+	uint32_t chunks[3];
+	int count = 0;
+	while( num > 999999999 ){
+		chunks[count++] = num % 1000000000;
+		num /= 1000000000;
 	}
-	memset(buf, '0', BUF_SIZE);
-	do {
-		buf[j++] = htoc(num%10);
-		num /= 10;
-	} while( (num >  0) && (j < BUF_SIZE));
-	started = false;
-	j = 0;
-	if( neg == true ){
-		dest[j++] = '-';
+	int len = write_padded_decimal(dest, (uint32_t)num, width - count*9);
+	while( count ){
+		write_decimal(dest + len, chunks[--count], 9);
+		len += 9;
 	}
-	for(i=BUF_SIZE-1; i >= 0; i--){
-		if( (buf[i] != '0') || (started == true) || (i<width)){
-			started = true;
-			dest[j++] = buf[i];
-		}
+	dest[len] = 0;
+	return len;
+}
+
+int StringUtil::lltoa(char dest[BUF_SIZE], int64_t num, int width){
+	if( num < 0 ){
+		dest[0] = '-';
+		return ulltoa(dest + 1, 0 - (uint64_t)num, width) + 1;
 	}
+	return ulltoa(dest, num, width);
+}
+
+/*
+ * Shortest round trip float to decimal conversion
+ *
+ * This is the Ryu algorithm (Ulf Adams, 2018). The interval of decimal
+ * numbers that round to the float is calculated exactly using
+ * multiplications by 64-bit approximations of powers of 5. Digits
+ * are then removed until the interval can't be narrowed further.
+ *
+ */
+
+#define FLOAT_MANTISSA_BITS 23
+#define FLOAT_EXPONENT_BITS 8
+#define FLOAT_BIAS 127
+#define FLOAT_POW5_INV_BITCOUNT 59
+#define FLOAT_POW5_BITCOUNT 61
+
+static const uint64_t float_pow5_inv_split[31] = {
+	0x0800000000000001ULL, 0x0666666666666667ULL, 0x051eb851eb851eb9ULL,
+	0x04189374bc6a7efaULL, 0x068db8bac710cb2aULL, 0x053e2d6238da3c22ULL,
+	0x0431bde82d7b634eULL, 0x06b5fca6af2bd216ULL, 0x055e63b88c230e78ULL,
+	0x044b82fa09b5a52dULL, 0x06df37f675ef6eaeULL, 0x057f5ff85e592558ULL,
+	0x0465e6604b7a8447ULL, 0x0709709a125da071ULL, 0x05a126e1a84ae6c1ULL,
+	0x0480ebe7b9d58567ULL, 0x0734aca5f6226f0bULL, 0x05c3bd5191b525a3ULL,
+	0x049c97747490eae9ULL, 0x0760f253edb4ab0eULL, 0x05e72843249088d8ULL,
+	0x04b8ed0283a6d3e0ULL, 0x078e480405d7b966ULL, 0x060b6cd004ac9452ULL,
+	0x04d5f0a66a23a9dbULL, 0x07bcb43d769f762bULL, 0x063090312bb2c4efULL,
+	0x04f3a68dbc8f03f3ULL, 0x07ec3daf94180651ULL, 0x065697bfa9acd1daULL,
+	0x051212ffbaf0a7e2ULL
+};
+
+static const uint64_t float_pow5_split[47] = {
+	0x1000000000000000ULL, 0x1400000000000000ULL, 0x1900000000000000ULL,
+	0x1f40000000000000ULL, 0x1388000000000000ULL, 0x186a000000000000ULL,
+	0x1e84800000000000ULL, 0x1312d00000000000ULL, 0x17d7840000000000ULL,
+	0x1dcd650000000000ULL, 0x12a05f2000000000ULL, 0x174876e800000000ULL,
+	0x1d1a94a200000000ULL, 0x12309ce540000000ULL, 0x16bcc41e90000000ULL,
+	0x1c6bf52634000000ULL, 0x11c37937e0800000ULL, 0x16345785d8a00000ULL,
+	0x1bc16d674ec80000ULL, 0x1158e460913d0000ULL, 0x15af1d78b58c4000ULL,
+	0x1b1ae4d6e2ef5000ULL, 0x10f0cf064dd59200ULL, 0x152d02c7e14af680ULL,
+	0x1a784379d99db420ULL, 0x108b2a2c28029094ULL, 0x14adf4b7320334b9ULL,
+	0x19d971e4fe8401e7ULL, 0x1027e72f1f128130ULL, 0x1431e0fae6d7217cULL,
+	0x193e5939a08ce9dbULL, 0x1f8def8808b02452ULL, 0x13b8b5b5056e16b3ULL,
+	0x18a6e32246c99c60ULL, 0x1ed09bead87c0378ULL, 0x13426172c74d822bULL,
+	0x1812f9cf7920e2b6ULL, 0x1e17b84357691b64ULL, 0x12ced32a16a1b11eULL,
+	0x178287f49c4a1d66ULL, 0x1d6329f1c35ca4bfULL, 0x125dfa371a19e6f7ULL,
+	0x16f578c4e0a060b5ULL, 0x1cb2d6f618c878e3ULL, 0x11efc659cf7d4b8dULL,
+	0x166bb7f0435c9e71ULL, 0x1c06a5ec5433c60dULL
+};
 
-	if( (j == 0) || ((j == 1) && neg) ){
-		dest[j++] = '0';
+//ceil(log2(5^e)) (1 when e is 0)
+static int32_t pow5_bits(int32_t e){ return (int32_t)(((uint32_t)e * 1217359) >> 19) + 1; }
+//floor(log10(2^e))
+static uint32_t log10_pow2(int32_t e){ return ((uint32_t)e * 78913) >> 18; }
+//floor(log10(5^e))
+static uint32_t log10_pow5(int32_t e){ return ((uint32_t)e * 732923) >> 20; }
+
+static uint32_t pow5_factor(uint32_t value){
+	uint32_t count = 0;
+	while( value % 5 == 0 ){
+		value /= 5;
+		count++;
 	}
+	return count;
+}
 
-	dest[j] = 0;
-	return j;
-#endif
+static bool is_multiple_of_pow5(uint32_t value, uint32_t p){ return pow5_factor(value) >= p; }
+static bool is_multiple_of_pow2(uint32_t value, uint32_t p){ return (value & ((1u << p) - 1)) == 0; }
+
+//(m * factor) >> shift using only 32x32 multiplies (shift > 32)
+static uint32_t mul_shift(uint32_t m, uint64_t factor, int32_t shift){
+	uint64_t low = (uint64_t)m * (uint32_t)factor;
+	uint64_t high = (uint64_t)m * (uint32_t)(factor >> 32);
+	uint64_t sum = (low >> 32) + high;
+	return (uint32_t)(sum >> (shift - 32));
 }
 
-#ifdef USE_FLOAT
-int StringUtil::ftoa(char dest[BUF_SIZE], float num, int width){
-	char buf[24];
-	int i, j;
-	int dec;
-	bool neg;
-	bool started;
-	char c;
-	const int base = 10;
-	int intnum;
-	j = 0;
-	dec = 0;
-
-	if( num < 0.0 ){
-		neg = true;
-		num *= -1;
-	}
-
-	while( num != (int)num ){
-		num *= base;
-		dec++;
-	}
-
-	memset(buf, '0', 24);
-	intnum = (int)num;
-	while( intnum > 0){
-		c = htoc(intnum%base);
-		if( (j == dec) && (j > 0) ){
-			buf[j++] = '.';
-		}
-		buf[j++] = c;
-		intnum /= base;
-	};
-	if( j == dec ){
-		buf[j++] = '.';
-	}
-	started = false;
-	j = 0;
-	if( neg == true ){
-		dest[j++] = '-';
-	}
-	for(i=23; i >= 0; i--){
-		if( (buf[i] != '0') || (started == true) || (i<width) || (buf[i] == '.') ){
-			if( (started == false) && (buf[i] == '.') ){
-				dest[j++] = '0';
+static uint32_t mul_pow5_inv_div_pow2(uint32_t m, uint32_t q, int32_t j){
+	return mul_shift(m, float_pow5_inv_split[q], j);
+}
+
+static uint32_t mul_pow5_div_pow2(uint32_t m, uint32_t i, int32_t j){
+	return mul_shift(m, float_pow5_split[i], j);
+}
+
+//calculates the shortest decimal (output * 10^exponent) that rounds to the float
+static void float_to_decimal(uint32_t ieee_mantissa, uint32_t ieee_exponent, uint32_t & output, int32_t & exponent){
+	int32_t e2;
+	uint32_t m2;
+	if( ieee_exponent == 0 ){
+		e2 = 1 - FLOAT_BIAS - FLOAT_MANTISSA_BITS - 2;
+		m2 = ieee_mantissa;
+	} else {
+		e2 = (int32_t)ieee_exponent - FLOAT_BIAS - FLOAT_MANTISSA_BITS - 2;
+		m2 = (1u << FLOAT_MANTISSA_BITS) | ieee_mantissa;
+	}
+	const bool accept_bounds = (m2 & 1) == 0;
+
+	//the float is mv, halfway to the neighbors are mm and mp (all times 4)
+	const uint32_t mv = 4 * m2;
+	const uint32_t mp = 4 * m2 + 2;
+	const uint32_t mm_shift = (ieee_mantissa != 0) || (ieee_exponent <= 1);
+	const uint32_t mm = 4 * m2 - 1 - mm_shift;
+
+	uint32_t vr, vp, vm;
+	int32_t e10;
+	bool vm_is_trailing_zeros = false;
+	bool vr_is_trailing_zeros = false;
+	uint8_t last_removed_digit = 0;
+	if( e2 >= 0 ){
+		const uint32_t q = log10_pow2(e2);
+		e10 = (int32_t)q;
+		const int32_t k = FLOAT_POW5_INV_BITCOUNT + pow5_bits((int32_t)q) - 1;
+		const int32_t i = -e2 + (int32_t)q + k;
+		vr = mul_pow5_inv_div_pow2(mv, q, i);
+		vp = mul_pow5_inv_div_pow2(mp, q, i);
+		vm = mul_pow5_inv_div_pow2(mm, q, i);
+		if( (q != 0) && ((vp - 1) / 10 <= vm / 10) ){
+			//one digit will be removed -- need it for rounding
+			const int32_t l = FLOAT_POW5_INV_BITCOUNT + pow5_bits((int32_t)(q - 1)) - 1;
+			last_removed_digit = (uint8_t)(mul_pow5_inv_div_pow2(mv, q - 1, -e2 + (int32_t)q - 1 + l) % 10);
+		}
+		if( q <= 9 ){
+			//only one of mp, mv, and mm can be a multiple of 5
+			if( mv % 5 == 0 ){
+				vr_is_trailing_zeros = is_multiple_of_pow5(mv, q);
+			} else if( accept_bounds ){
+				vm_is_trailing_zeros = is_multiple_of_pow5(mm, q);
+			} else {
+				vp -= is_multiple_of_pow5(mp, q);
+			}
+		}
+	} else {
+		const uint32_t q = log10_pow5(-e2);
+		e10 = (int32_t)q + e2;
+		const int32_t i = -e2 - (int32_t)q;
+		const int32_t k = pow5_bits(i) - FLOAT_POW5_BITCOUNT;
+		int32_t j = (int32_t)q - k;
+		vr = mul_pow5_div_pow2(mv, (uint32_t)i, j);
+		vp = mul_pow5_div_pow2(mp, (uint32_t)i, j);
+		vm = mul_pow5_div_pow2(mm, (uint32_t)i, j);
+		if( (q != 0) && ((vp - 1) / 10 <= vm / 10) ){
+			j = (int32_t)q - 1 - (pow5_bits(i + 1) - FLOAT_POW5_BITCOUNT);
+			last_removed_digit = (uint8_t)(mul_pow5_div_pow2(mv, (uint32_t)(i + 1), j) % 10);
+		}
+		if( q <= 1 ){
+			//mv = 4 * m2 always has at least two trailing zero bits
+			vr_is_trailing_zeros = true;
+			if( accept_bounds ){
+				vm_is_trailing_zeros = mm_shift == 1;
+			} else {
+				--vp;
+			}
+		} else if( q < 31 ){
+			vr_is_trailing_zeros = is_multiple_of_pow2(mv, q - 1);
+		}
+	}
+
+	//remove digits while the interval still contains a shorter number
+	int32_t removed = 0;
+	if( vm_is_trailing_zeros || vr_is_trailing_zeros ){
+		while( vp / 10 > vm / 10 ){
+			vm_is_trailing_zeros &= vm % 10 == 0;
+			vr_is_trailing_zeros &= last_removed_digit == 0;
+			last_removed_digit = (uint8_t)(vr % 10);
+			vr /= 10;
+			vp /= 10;
+			vm /= 10;
+			removed++;
+		}
+		if( vm_is_trailing_zeros ){
+			while( vm % 10 == 0 ){
+				vr_is_trailing_zeros &= last_removed_digit == 0;
+				last_removed_digit = (uint8_t)(vr % 10);
+				vr /= 10;
+				vp /= 10;
+				vm /= 10;
+				removed++;
 			}
-			started = true;
-			dest[j++] = buf[i];
 		}
+		if( vr_is_trailing_zeros && (last_removed_digit == 5) && (vr % 2 == 0) ){
+			//exactly halfway -- round to even
+			last_removed_digit = 4;
+		}
+		output = vr + (((vr == vm) && (!accept_bounds || !vm_is_trailing_zeros)) || (last_removed_digit >= 5));
+	} else {
+		//the common case
+		while( vp / 10 > vm / 10 ){
+			last_removed_digit = (uint8_t)(vr % 10);
+			vr /= 10;
+			vp /= 10;
+			vm /= 10;
+			removed++;
+		}
+		output = vr + ((vr == vm) || (last_removed_digit >= 5));
+	}
+	exponent = e10 + removed;
+}
+
+int StringUtil::ftoa(char dest[BUF_SIZE], float num, int width){
+	uint32_t bits;
+	memcpy(&bits, &num, sizeof(bits));
+
+	const uint32_t ieee_mantissa = bits & ((1u << FLOAT_MANTISSA_BITS) - 1);
+	const uint32_t ieee_exponent = (bits >> FLOAT_MANTISSA_BITS) & ((1u << FLOAT_EXPONENT_BITS) - 1);
+	char * p = dest;
+
+	if( (ieee_exponent == ((1u << FLOAT_EXPONENT_BITS) - 1)) && ieee_mantissa ){
+		strcpy(dest, "nan");
+		return 3;
+	}
+
+	if( bits >> 31 ){
+		*p++ = '-';
 	}
 
-	if( (j == 0) || ((j == 1) && neg) ){
-		dest[j++] = '0';
+	if( ieee_exponent == ((1u << FLOAT_EXPONENT_BITS) - 1) ){
+		strcpy(p, "inf");
+		return p - dest + 3;
 	}
 
-	if( dest[j-1] == '.' ){
-		dest[j++] = '0';
+	uint32_t output = 0;
+	int32_t exponent = 0;
+	if( ieee_exponent || ieee_mantissa ){
+		float_to_decimal(ieee_mantissa, ieee_exponent, output, exponent);
+	}
+
+	const int32_t length = calc_decimal_length(output);
+	//position of the decimal point relative to the first digit
+	const int32_t point = length + exponent;
+	width = clamp_width(width);
+
+	if( (point > -5) && (point <= 9) ){
+		if( point <= 0 ){
+			int32_t zeros = width > 0 ? width : 1;
+			memset(p, '0', zeros);
+			p += zeros;
+			*p++ = '.';
+			memset(p, '0', -point);
+			p += -point;
+			write_decimal(p, output, length);
+			p += length;
+		} else {
+			int32_t integer_length = point;
+			if( width > integer_length ){
+				memset(p, '0', width - integer_length);
+				p += width - integer_length;
+			}
+			if( exponent >= 0 ){
+				//whole number: digits then trailing zeros
+				write_decimal(p, output, length);
+				p += length;
+				memset(p, '0', exponent);
+				p += exponent;
+				*p++ = '.';
+				*p++ = '0';
+			} else {
+				write_decimal(p, output, length);
+				memmove(p + point + 1, p + point, length - point);
+				p[point] = '.';
+				p += length + 1;
+			}
+		}
+	} else {
+		//d.ddde+xx
+		write_decimal(p + 1, output, length);
+		p[0] = p[1];
+		if( length > 1 ){
+			p[1] = '.';
+			p += length + 1;
+		} else {
+			p++;
+		}
+		int32_t e = point - 1;
+		*p++ = 'e';
+		if( e < 0 ){
+			*p++ = '-';
+			e = -e;
+		} else {
+			*p++ = '+';
+		}
+		p += write_padded_decimal(p, e, 2);
 	}
 
-	dest[j] = 0;
-	return j;
+	*p = 0;
+	return p - dest;
 }
-#endif
 
 
 int StringUtil::utoa(char dest[BUF_SIZE], uint32_t num, int base, bool upper, int width){
@@ -183,34 +464,50 @@ int StringUtil::utoa(char dest[BUF_SIZE], uint32_t num, int base, bool upper, in
 
 #else
 
-	char buf[BUF_SIZE];
-	int i, j;
-	bool started;
-	char c;
-	j = 0;
-	memset(buf, '0', BUF_SIZE);
-	while( (num > 0) && (j < BUF_SIZE)){
-		if( upper ){
-			c = Htoc(num%base);
-		} else {
-			c = htoc(num%base);
-		}
-		buf[j++] = c;
-		num /= base;
-	};
-	started = false;
-	j = 0;
-	for(i=BUF_SIZE-1; i >= 0; i--){
-		if( (buf[i] != '0') || (started == true) || (i<width)){
-			started = true;
-			dest[j++] = buf[i];
-		}
+	if( base == 10 ){
+		return write_padded_decimal(dest, num, width);
+	}
+
+	if( (base < 2) || (base > 36) ){
+		dest[0] = 0;
+		return 0;
 	}
-	if( j == 0 ){
-		dest[j++] = '0';
+
+	//count the digits first then write them from the end
+	int len = 0;
+	uint32_t value = num;
+	do {
+		len++;
+		value /= base;
+	} while( value );
+
+	width = clamp_width(width);
+	if( width > len ){
+		len = width;
 	}
-	dest[j] = 0;
-	return j;
+
+	char * p = dest + len;
+	*p = 0;
+	if( (base & (base - 1)) == 0 ){
+		//power of two: shift and mask
+		int shift = 0;
+		while( (1 << shift) < base ){ shift++; }
+		do {
+			int digit = num & (base - 1);
+			*--p = upper ? Htoc(digit) : htoc(digit);
+			num >>= shift;
+		} while( num );
+	} else {
+		do {
+			int digit = num % base;
+			*--p = upper ? Htoc(digit) : htoc(digit);
+			num /= base;
+		} while( num );
+	}
+	while( p > dest ){
+		*--p = '0';
+	}
+	return len;
 #endif
 }
 
@@ -232,3 +529,222 @@ int StringUtil::utoa_mode(enum StringUtil::mode mode, char dest[BUF_SIZE], uint3
 	return len;
 }
 
+static bool is_space(char c){
+	return (c == ' ') || (c == '\t') || (c == '\n') || (c == '\r') || (c == '\f') || (c == '\v');
+}
+
+static int digit_value(char c){
+	if( (c >= '0') && (c <= '9') ){ return c - '0'; }
+	if( (c >= 'a') && (c <= 'z') ){ return c - 'a' + 10; }
+	if( (c >= 'A') && (c <= 'Z') ){ return c - 'A' + 10; }
+	return 36;
+}
+
+//with no end pointer, only whitespace may follow the number
+static int finish_parse(const char * p, const char ** end){
+	if( end ){
+		*end = p;
+		return 0;
+	}
+	while( is_space(*p) ){
+		p++;
+	}
+	if( *p != 0 ){
+		errno = EINVAL;
+		return -1;
+	}
+	return 0;
+}
+
+static int parse_magnitude(const char * & p, uint32_t & value, int base){
+	const char * start = p;
+	uint32_t limit = 0xffffffff / base;
+	int result = 0;
+	int digit;
+	value = 0;
+	while( (digit = digit_value(*p)) < base ){
+		if( (value > limit) || (value * base > 0xffffffff - digit) ){
+			result = -1;
+			value = 0xffffffff;
+		} else if( result == 0 ){
+			value = value * base + digit;
+		}
+		p++;
+	}
+	if( p == start ){
+		errno = EINVAL;
+		return -1;
+	}
+	if( result < 0 ){
+		errno = ERANGE;
+	}
+	return result;
+}
+
+int StringUtil::parse_uint(const char * str, uint32_t & value, int base, const char ** end){
+	const char * p = str;
+	value = 0;
+	if( end ){ *end = str; }
+	if( (base < 2) || (base > 16) ){
+		errno = EINVAL;
+		return -1;
+	}
+	while( is_space(*p) ){ p++; }
+	if( *p == '+' ){ p++; }
+	if( (base == 16) && (p[0] == '0') && ((p[1] == 'x') || (p[1] == 'X')) && (digit_value(p[2]) < 16) ){
+		p += 2;
+	}
+	const char * digits = p;
+	int result = parse_magnitude(p, value, base);
+	if( p == digits ){
+		return -1;
+	}
+	if( finish_parse(p, end) < 0 ){
+		return -1;
+	}
+	return result;
+}
+
+int StringUtil::parse_int(const char * str, int32_t & value, const char ** end){
+	const char * p = str;
+	bool is_negative = false;
+	uint32_t magnitude;
+	value = 0;
+	if( end ){ *end = str; }
+	while( is_space(*p) ){ p++; }
+	if( (*p == '-') || (*p == '+') ){
+		is_negative = *p == '-';
+		p++;
+	}
+	const char * digits = p;
+	int result = parse_magnitude(p, magnitude, 10);
+	if( p == digits ){
+		return -1;
+	}
+
+	uint32_t limit = is_negative ? 0x80000000 : 0x7fffffff;
+	if( magnitude > limit ){
+		magnitude = limit;
+		errno = ERANGE;
+		result = -1;
+	}
+	value = is_negative ? (int32_t)(0 - magnitude) : (int32_t)magnitude;
+	if( finish_parse(p, end) < 0 ){
+		return -1;
+	}
+	return result;
+}
+
+int StringUtil::parse_float(const char * str, float & value, const char ** end){
+	//powers of 10 that are exact in a float
+	static const float exact_powers[11] = {
+		1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f
+	};
+	const char * p = str;
+	const char * start;
+	bool is_negative = false;
+	uint64_t mantissa = 0;
+	int32_t exponent = 0;
+	bool is_truncated = false;
+
+	value = 0.0f;
+	if( end ){ *end = str; }
+	while( is_space(*p) ){ p++; }
+	start = p;
+	if( (*p == '-') || (*p == '+') ){
+		is_negative = *p == '-';
+		p++;
+	}
+
+	if( strncasecmp(p, "inf", 3) == 0 ){
+		p += 3;
+		if( strncasecmp(p, "inity", 5) == 0 ){ p += 5; }
+		value = is_negative ? -HUGE_VALF : HUGE_VALF;
+		return finish_parse(p, end);
+	}
+
+	if( strncasecmp(p, "nan", 3) == 0 ){
+		value = is_negative ? -NAN : NAN;
+		return finish_parse(p + 3, end);
+	}
+
+	const char * digits = p;
+	while( (*p >= '0') && (*p <= '9') ){
+		if( mantissa < 1000000000000000000ULL ){
+			mantissa = mantissa*10 + (*p - '0');
+		} else {
+			exponent++;
+			is_truncated |= *p != '0';
+		}
+		p++;
+	}
+	if( *p == '.' ){
+		p++;
+		while( (*p >= '0') && (*p <= '9') ){
+			if( mantissa < 1000000000000000000ULL ){
+				mantissa = mantissa*10 + (*p - '0');
+				exponent--;
+			} else {
+				is_truncated |= *p != '0';
+			}
+			p++;
+		}
+	}
+
+	if( (p == digits) || ((p == digits + 1) && (*digits == '.')) ){
+		errno = EINVAL;
+		return -1;
+	}
+
+	if( (*p == 'e') || (*p == 'E') ){
+		const char * e = p + 1;
+		bool is_exponent_negative = false;
+		int32_t exponent_value = 0;
+		if( (*e == '-') || (*e == '+') ){
+			is_exponent_negative = *e == '-';
+			e++;
+		}
+		if( (*e >= '0') && (*e <= '9') ){
+			while( (*e >= '0') && (*e <= '9') ){
+				if( exponent_value < 10000 ){
+					exponent_value = exponent_value*10 + (*e - '0');
+				}
+				e++;
+			}
+			exponent += is_exponent_negative ? -exponent_value : exponent_value;
+			p = e;
+		}
+	}
+
+	if( finish_parse(p, end) < 0 ){
+		return -1;
+	}
+
+	if( mantissa == 0 ){
+		value = is_negative ? -0.0f : 0.0f;
+		return 0;
+	}
+
+	if( !is_truncated && (mantissa < (1 << 24)) && (exponent >= -10) && (exponent <= 10) ){
+		//both operands are exact so the single rounding is correct
+		value = (float)mantissa;
+		if( exponent < 0 ){
+			value /= exact_powers[-exponent];
+		} else {
+			value *= exact_powers[exponent];
+		}
+		if( is_negative ){ value = -value; }
+		return 0;
+	}
+
+	char * strtof_end;
+	int saved_errno = errno;
+	errno = 0;
+	value = strtof(start, &strtof_end);
+	if( (errno == ERANGE) && ((value == 0.0f) || isinf(value)) ){
+		//too large or too small for a float (denormals are not an error)
+		return -1;
+	}
+	errno = saved_errno;
+	return 0;
+}
@@ -4,21 +4,54 @@
 #include <cstdio>
 #include <cstring>
 #include "var/Token.hpp"
+#include "sys/File.hpp"
 using namespace var;
 
+namespace {
+
+//one bit for each character value so membership is a single lookup
+class CharacterSet {
+public:
+    CharacterSet(const ConstString & characters){
+        const u8 * p = (const u8*)characters.str();
+        memset(m_bits, 0, sizeof(m_bits));
+        while( *p ){
+            m_bits[*p >> 5] |= (1 << (*p & 0x1f));
+            p++;
+        }
+    }
+
+    bool contains(u8 c) const { return (m_bits[c >> 5] & (1 << (c & 0x1f))) != 0; }
+
+private:
+    u32 m_bits[8];
+};
+
+}
+
 Token::Token(){
-	init_members();
     m_is_count_empty_tokens = false;
 }
 
-Token::Token(char * mem, u32 s, const ConstString & src, const ConstString & delim, const ConstString & ignore, bool count_empty) : String(mem, s, false){
-	init_members();
+Token::Token(char * mem, u32 s, const ConstString & src, const ConstString & delim, const ConstString & ignore, bool count_empty) : String(mem, string_size(mem, s, src.length()), false){
+    //the index uses the rest of mem so nothing is allocated
+    u32 used = Data::capacity();
 	m_is_count_empty_tokens = count_empty;
+    m_offsets.set(mem + used, s - used);
     clear(); assign(src); parse(delim, ignore);
 }
 
+u32 Token::string_size(char * mem, u32 s, u32 length){
+    //room for the string and its terminator then pad so the index is aligned
+    u32 size = length + 1;
+    size += (sizeof(u32) - ((size_t)(mem + size) & (sizeof(u32)-1))) & (sizeof(u32)-1);
+    if( (size < length) || (size > s) ){
+        return s;
+    }
+    return size;
+}
+
 Token::Token(const ConstString & src, const ConstString & delim, const ConstString & ignore, bool count_empty) : String(src){
-    init_members();
 	m_is_count_empty_tokens = count_empty;
     parse(delim, ignore);
 }
@@ -35,177 +68,170 @@ bool Token::belongs_to(const char c, const ConstString & src, unsigned int len){
 	return false;
 }
 
-void Token::init_members(){
-	m_num_tokens = 0; m_string_size = 0;
-}
+void Token::parse(const ConstString & delim, const ConstString & ignore){
+    CharacterSet delim_set(delim);
+    CharacterSet ignore_set(ignore);
+    //get the pointer after the length: writing the delimiters shortens the string
+    //and cdata() makes length() recalculate it
+    u32 len = String::length();
+    char * p = cdata();
+    u32 start = 0;
+    bool on_token = m_is_count_empty_tokens;
+
+    m_offsets.clear();
+    if( p == 0 ){
+        return;
+    }
 
+    //allocate the index once: there can't be more tokens than delimiters + 1
+    u32 delimiter_count = 0;
+    for(u32 i=0; i < len; i++){
+        if( delim_set.contains(p[i]) ){
+            delimiter_count++;
+        }
+    }
+    m_offsets.reserve(delimiter_count + 1);
 
-void Token::parse(const ConstString & delim, const ConstString & ignore){
-	char * p;
-	char * end;
-	unsigned int len0, len1;
-	bool on_token = false;
-	char end_match;
-	m_num_tokens = 0;
-    len0 = delim.length();
-    len1 = ignore.length();
-
-	p = cdata();
-    m_string_size = String::length();
-	end = p + m_string_size;
-	if( m_is_count_empty_tokens == true ){
-		m_num_tokens++;
-	}
-	while( p < end ){
-        if( len1 > 0 ){
+    for(u32 i=0; i < len; i++){
+        u8 c = p[i];
+
+        if( ignore_set.contains(c) ){
             //this can be used to skip items in quotes "ignore=this"
-            while( belongs_to(*p, ignore, len1) ){
-                end_match = *p;
-				//fast forward to next member of ignore
-				p++;
-                while( (*p != end_match) && (*p != 0) ){
-					p++;
-				}
-				p++;
+            if( on_token == false ){
+                start = i;
+                on_token = true;
             }
-		}
+            i++;
+            while( (i < len) && (p[i] != (char)c) ){
+                i++;
+            }
+            continue;
+        }
 
-		//check to see if the current character is part of the delimiter string
-		if( belongs_to(*p, delim, len0) ){
-            //::printf("mark token zero '%c'\n", *p);
-			*p = 0; //set the character to zero
-			if( m_is_count_empty_tokens == true ){
-				m_num_tokens++;
-			}
-		}
+        if( delim_set.contains(c) ){
+            p[i] = 0;
+            if( on_token ){
+                m_offsets.push_back(start);
+            }
+            on_token = m_is_count_empty_tokens;
+            start = i+1;
+        } else if( on_token == false ){
+            start = i;
+            on_token = true;
+        }
+    }
 
-		//check for an empty token
-		if( m_is_count_empty_tokens == false ){
-			if( *p != 0 ){
-				if( on_token == false ){
-					m_num_tokens++;
-					on_token = true;
-				}
-			} else {
-				on_token = false;
-			}
-		}
-		p++;
+    if( on_token ){
+        m_offsets.push_back(start);
     }
 }
 
-const ConstString Token::at(u32 n) const {
-    const char * p;
-    unsigned int i;
-	bool on_token = false;
-	unsigned int token = 0;
-    p = str();
+int Token::parse_line(const sys::File & file, const ConstString & delim, const ConstString & ignore, char term){
+    char buffer[LINE_BUFFER_SIZE];
+    //read a block at a time and seek back to the start of the next line --
+    //files that can't seek are read one byte at a time
+    int block_size = file.seek(0, sys::File::CURRENT) < 0 ? 1 : LINE_BUFFER_SIZE;
+    bool is_terminated = false;
+    u32 len;
+    int ret;
+
+    clear();
+    do {
+        ret = file.read(buffer, block_size);
+        if( ret > 0 ){
+            const char * end = (const char*)memchr(buffer, term, ret);
+            len = ret;
+            if( end ){
+                len = end - buffer;
+                is_terminated = true;
+                if( (u32)ret > len + 1 ){
+                    file.seek(len + 1 - ret, sys::File::CURRENT);
+                }
+            }
+            if( append(buffer, len) < 0 ){
+                m_offsets.clear();
+                return -1;
+            }
+        }
+    } while( (ret > 0) && (is_terminated == false) );
 
-	if( n >= size() ){
-        return ConstString();
-	}
+    len = String::length();
+    if( (is_terminated == false) && (len == 0) ){
+        m_offsets.clear();
+        return -1;
+    }
 
-	if( m_is_count_empty_tokens ){
-		while( token != n ){
-			if( *p == 0 ){
-				token++;
-			}
-			p++;
-		}
-	} else {
-		i = 0;
-		while( (i < m_string_size) && (*p == 0) ){
-			i++;
-			p++;
-		}
-		on_token = true;
-		while( token != n ){
-			p++;
-			if( *p != 0 ){
-				if( on_token == false ){
-					token++;
-					on_token = true;
-				}
-			} else {
-				on_token = false;
-			}
-		}
-	}
+    if( len && (term == '\n') && (cdata_const()[len-1] == '\r') ){
+        erase(len-1);
+    }
 
-    return p;
+    parse(delim, ignore);
+    return count();
 }
 
-void Token::sort(enum sort_options sort_option){
+bool Token::is_less(u32 a, u32 b, enum sort_options sort_option) const {
+    int result = strcmp(cdata_const() + a, cdata_const() + b);
+    if( sort_option == SORT_ZA ){
+        return result > 0;
+    }
+    return result < 0;
+}
 
-	u32 i;
-	u32 j;
-	Token tmp;
-	int current;
-    ConstString string_to_copy;
-	char * next;
-	u8 sort_init;
-	char a;
-	char b;
-
-	switch(sort_option){
-	case SORT_AZ:
-		sort_init = 255;
-		break;
-	case SORT_ZA:
-		sort_init = 0;
-		break;
-	default:
-		return;
-	}
+void Token::sift_down(u32 root, u32 count, enum sort_options sort_option){
+    u32 * offsets = m_offsets.vector_data();
+    for(;;){
+        u32 child = root*2 + 1;
+        if( child >= count ){
+            return;
+        }
+        if( (child + 1 < count) && is_less(offsets[child], offsets[child+1], sort_option) ){
+            child++;
+        }
+        if( !is_less(offsets[root], offsets[child], sort_option) ){
+            return;
+        }
+        u32 tmp = offsets[root];
+        offsets[root] = offsets[child];
+        offsets[child] = tmp;
+        root = child;
+    }
+}
 
+void Token::sort(enum sort_options sort_option){
+    u32 * offsets;
+    u32 n = count();
+
+    switch(sort_option){
+    case SORT_AZ:
+    case SORT_ZA:
+        break;
+    default:
+        return;
+    }
 
-	tmp = *this; //make a copy of the current object
-	u8 used[tmp.size()];
-
-	clear();
-	memset(used, 0, tmp.size());
-	next = cdata();
-
-	for(j=0; j < tmp.size(); j++){
-		a = sort_init;
-		current = 0;
-		for(i=0; i < tmp.size(); i++){
-			b = tmp.at(i)[0];
-			if( used[i] == 0 ){
-				switch(sort_option){
-				default: break;
-				case SORT_AZ:
-					if(b < a){
-						current = i;
-						a = b;
-					}
-					break;
-				case SORT_ZA:
-					if(b > a){
-						current = i;
-						a = b;
-					}
-					break;
-				}
-			}
-		}
-		string_to_copy = tmp.at(current);
-        strcpy(next, string_to_copy.str());
-        next += string_to_copy.length() + 1;
-		used[current] = 1;
+    if( n < 2 ){
+        return;
+    }
+
+    //heap sort the index -- O(n log n) without recursion or extra memory
+    offsets = m_offsets.vector_data();
+    for(u32 i = n/2; i > 0; i--){
+        sift_down(i-1, n, sort_option);
+    }
+    for(u32 end = n-1; end > 0; end--){
+        u32 tmp = offsets[0];
+        offsets[0] = offsets[end];
+        offsets[end] = tmp;
+        sift_down(0, end, sort_option);
     }
 }
 
 Token & Token::operator=(const Token & token){
-    set_capacity(token.capacity());
-    ::memcpy(data(), token.data_const(), token.capacity());
-	m_num_tokens = token.m_num_tokens;
-	m_string_size = token.m_string_size;
-    m_is_count_empty_tokens = token.m_is_count_empty_tokens;
+    if( this != &token ){
+        set_capacity(token.capacity());
+        ::memcpy(data(), token.data_const(), token.capacity());
+        m_offsets = token.m_offsets;
+        m_is_count_empty_tokens = token.m_is_count_empty_tokens;
+    }
 	return *this;
 }
-
-
-
-
-